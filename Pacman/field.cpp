@@ -1,10 +1,12 @@
 #include "field.hpp"
-#include "ghost.hpp"
+#include "ghost_policy.hpp"
 #include "pacman.hpp"
 #include "cherry.hpp"
 #include "pill.hpp"
 #include "game_controller.hpp"
+#include "game_view.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <GL/glew.h>
 
@@ -16,7 +18,7 @@ static const unsigned int NUM_LEVELS = 3;
   *   <li> ' ' = freies Feld</li>
   *   <li> '*' = Stein</li>
   *   <li> 'P' = Pacman</li>
-  *   <li> '0' - '3': Geist</li>
+  *   <li> '0' - '3': Geist (Verhalten siehe 'GhostPersonality')</li>
   *   <li> 'C' = Kirsche (Bonuspunkte)</li>
   *   <li> 'o' = Ernergiepille</li>
   *   <li> '#' = Gefaengnis</li>
@@ -93,6 +95,16 @@ std::string fieldLayout[NUM_LEVELS] = {
     "          P          "
 };
 
+/**
+  * Strategie der Geister je Level, solange nicht per
+  * Field::setGhostPolicy() eine andere festgelegt wird.
+  */
+const GhostPolicy fieldGhostPolicies[NUM_LEVELS] = {
+	ClassicGhosts,
+	ClassicGhosts,
+	ClassicGhosts
+};
+
 
 /**
   * Ein neues Spielfeld erzeugen.
@@ -102,6 +114,7 @@ Field::Field(/*Gosu::Graphics& graphics*/) {
 	this->cellHeight = 28;
 	this->cellWidth = this->cellHeight;
 	this->controller = new GameController(this);
+	this->ghostPolicies.assign(fieldGhostPolicies, fieldGhostPolicies + NUM_LEVELS);
 
 	setup(this->levelNumber);
 }
@@ -162,12 +175,13 @@ void Field::setup(unsigned int levelNumber) {
 						break;
 			case 'P':	controller->setPacman(new Pacman(x, y, controller));
 						break;
-			case 'C':	controller->addFigure(new Cherry(x, y, controller));
+			case 'C':	controller->addCherry(new Cherry(x, y, controller));
 						break;
-			case 'o':	controller->addFigure(new Pill(x, y, controller));
+			case 'o':	controller->addPill(new Pill(x, y, controller));
 						break;
             default :	if (buf[index] >= '0' && buf[index] <= '3') {
-						   controller->addFigure(new Ghost(x, y, controller));
+						   controller->addGhost(createGhost(ghostPolicies[ levelNumber - 1 ], x, y, controller,
+															GhostPersonality(buf[index] - '0')));
 						}
 		}
 
@@ -187,6 +201,42 @@ void Field::setup(unsigned int levelNumber) {
 		}
     }
 	controller->setFoodCount(foodCount);
+
+	buildMaze(buf);
+	controller->prepareStateHash();
+}
+
+
+/**
+  * Labyrinth, Kreuzungsgraph, Wegsuche und Bitboards aus den fertig
+  * eingerichteten Zellen aufbauen. Die Rahmen stehen erst fest, wenn alle Zellen
+  * eingelesen sind. Steine und Gefaengnismauern werden ganz
+  * geschlossen, da keine Figur sie betreten kann.
+  * @param layout Aufbau des Spielfeldes (siehe Erlaeuterung oben).
+  */
+void Field::buildMaze(const std::string& layout) {
+	maze.resize(FIELD_WIDTH, FIELD_HEIGHT);
+	for (unsigned int y = 0; y < FIELD_HEIGHT; ++y) {
+		for (unsigned int x = 0; x < FIELD_WIDTH; ++x) {
+			char symbol = layout[ y * FIELD_WIDTH + x ];
+			if (symbol == '*' || symbol == '#') {
+				continue;
+			}
+
+			unsigned int exits = Direction::NONE;
+			for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+				if (allowsBorderMovement(x, y, direction)) {
+					exits |= direction;
+				}
+			}
+			maze.setExits(maze.getIndex(x, y), exits);
+		}
+	}
+
+	junctions.build(maze);
+	pathfinder.build(maze);
+	bitboard.build(maze);
+	controller->prepareTargeting();
 }
 
 /**
@@ -220,7 +270,7 @@ void Field::setup(unsigned int levelNumber) {
 	}
 }*/
 
-void Field::draw(Gosu::Graphics& graphics) {
+void Field::draw(Gosu::Graphics& graphics, double tickFraction) {
 	glLoadIdentity();
 	glTranslatef(5.0f, 5.0f, 0.0f);
 
@@ -233,9 +283,13 @@ void Field::draw(Gosu::Graphics& graphics) {
 		}
 	}
 
+	// Animationen der Figuren auf den aktuellen Takt bringen
+	controller->synchronizeFigures();
+
 	for (std::vector<Figure*>::iterator iter = controller->getFigures().begin(); iter != controller->getFigures().end(); ++iter) {
 		Figure* figure = (*iter);
 		if (figure->getState() != Dead) {
+			figure->interpolate(tickFraction);
 			figure->draw(graphics, cellWidth, cellHeight);
 		}
 	}
@@ -254,6 +308,56 @@ Cell* Field::getCell(unsigned int x, unsigned int y) {
 }
 
 
+/**
+  * Liest die Zelle aus, die sich an der Koordinate (x,y)
+  * im Spielfeld befindet, nur zum Lesen.
+  * @param x X-Koordinate der Zelle
+  * @param y Y-Koordinate der Zelle
+  * @return Zeiger auf die Zelle.
+  */
+const Cell* Field::getCell(unsigned int x, unsigned int y) const {
+	return &cells[ x ][ y ];
+}
+
+
+/**
+  * Labyrinth des aktuellen Levels auslesen.
+  * @return Begehbare Richtungen aller Zellen.
+  */
+const MazeGrid& Field::getMaze() const {
+	return maze;
+}
+
+
+/**
+  * Kreuzungsgraph des aktuellen Levels auslesen.
+  * @return Kreuzungen und Korridore, Zellen wie in getMaze().
+  */
+const JunctionGraph& Field::getJunctionGraph() const {
+	return junctions;
+}
+
+
+/**
+  * Wegsuche des aktuellen Levels auslesen. Sie ist nicht konstant,
+  * da sie gefundene Wege aufbewahrt.
+  * @return Wegsuche, Zellen wie in getMaze().
+  */
+HierarchicalPathfinder& Field::getPathfinder() {
+	return pathfinder;
+}
+
+
+/**
+  * Bitboards des aktuellen Levels auslesen. Sie sind nicht konstant,
+  * da sie den Zustand der letzten Flutfuellung enthalten.
+  * @return Bitboards, Zellen wie in getMaze().
+  */
+MazeBitboard& Field::getBitboard() {
+	return bitboard;
+}
+
+
 /**
   * Kann sich eine Figur, die sich auf der Zelle an Position (x, y) befindet,
   * in die angegebene Richtung bewegen? Ist also dort kein Rahmen vorhanden?
@@ -327,6 +431,18 @@ void Field::nextTick() {
 }
 
 
+/**
+  * Schnellvorlauf bis zum naechsten Takt, in dem etwas passiert
+  * (siehe GameController::advanceUntilNextEvent()).
+  * @param maxTicks Hoechstens so viele Takte weiterschalten.
+  * @return Anzahl vergangener Takte.
+  */
+unsigned int Field::advanceUntilNextEvent(unsigned int maxTicks) {
+	// Aufruf an den Controller deligieren.
+	return controller->advanceUntilNextEvent(maxTicks);
+}
+
+
 /**
   * Eine Taste wurde gedrueckt, um die Figur in eine bestimmte
   * Richtung zu schicken. 
@@ -338,6 +454,123 @@ void Field::keyPressed(Direction direction) {
 	//update();
 }
 
+
+/**
+  * Der zweite Spieler haelt eine Richtung fuer seinen Geist.
+  * @param direction Gehaltene Richtung, NONE beim Loslassen.
+  */
+void Field::ghostKeyPressed(Direction direction) {
+	controller->ghostKeyPressed(direction);
+}
+
+
+/**
+  * Einen automatischen Spieler anmelden.
+  * @param agent Spieler oder 0 fuer die Steuerung per Tastatur.
+  */
+void Field::setPacmanAgent(PacmanAgent* agent) {
+	controller->setPacmanAgent(agent);
+}
+
+
+/**
+  * Gueltigkeit eines Richtungswunsches fuer Pacman festlegen.
+  * @param ticks Takte.
+  */
+void Field::setTurnBuffer(unsigned int ticks) {
+	controller->setTurnBuffer(ticks);
+}
+
+
+/**
+  * Verteilung der Verzoegerung bis zum Abbiegen anmelden.
+  * @param statistics Verteilung oder 0.
+  */
+void Field::setTurnStatistics(TurnStatistics* statistics) {
+	controller->setTurnStatistics(statistics);
+}
+
+
+/**
+  * Makroschritte entlang der Korridore ein- oder ausschalten.
+  * @param enabled <code>true</code> zum Einschalten.
+  */
+void Field::setCorridorSteps(bool enabled) {
+	controller->setCorridorSteps(enabled);
+}
+
+
+/**
+  * Pruefmodus des nachgefuehrten Hashes ein- oder ausschalten.
+  * @param enabled <code>true</code> zum Einschalten.
+  */
+void Field::setHashVerification(bool enabled) {
+	controller->setHashVerification(enabled);
+}
+
+
+/**
+  * Den Spielstand des Controllers lesbar schreiben.
+  * @param out Ziel der Ausgabe.
+  */
+void Field::writeState(std::ostream& out) const {
+	controller->writeState(out);
+}
+
+
+/**
+  * Anzahl der im Pruefmodus gefundenen Abweichungen auslesen.
+  * @return Anzahl Abweichungen.
+  */
+unsigned int Field::getHashMismatches() const {
+	return controller->getHashMismatches();
+}
+
+
+/**
+  * Zufallsgenerator des Spiels neu starten.
+  * @param seed Startwert.
+  */
+void Field::setRandomSeed(unsigned int seed) {
+	controller->setRandomSeed(seed);
+}
+
+
+/**
+  * Nur lesende Sicht auf den Spielstand.
+  * @return Sicht auf dieses Spielfeld.
+  */
+GameView Field::getView() {
+	return GameView(this, controller);
+}
+
+
+/**
+  * Den Spielstand eines anderen Spielfeldes uebernehmen.
+  * @param other Spielfeld mit dem zu kopierenden Stand.
+  */
+void Field::copyStateFrom(const Field& other) {
+	bool rebuild = levelNumber != other.levelNumber ||
+				   ghostPolicies[ levelNumber - 1 ] != other.ghostPolicies[ levelNumber - 1 ];
+	ghostPolicies = other.ghostPolicies;
+	if (rebuild) {
+		levelNumber = other.levelNumber;
+		setup(levelNumber);
+	}
+	std::copy(&other.cells[ 0 ][ 0 ], &other.cells[ 0 ][ 0 ] + FIELD_WIDTH * FIELD_HEIGHT, &cells[ 0 ][ 0 ]);
+	controller->copyStateFrom(*other.controller);
+}
+
+
+/**
+  * Einen waehrend der Entscheidung des automatischen Spielers
+  * kopierten Takt fortsetzen.
+  * @param direction Richtung fuer Pacmans Schritt.
+  */
+void Field::resumeTick(Direction direction) {
+	controller->resumeTick(direction);
+}
+
 	
 /**
   * Aktuelle Punktezahl auslesen.
@@ -373,6 +606,31 @@ unsigned int Field::getMaxLevels()
 	return NUM_LEVELS;
 }
 
+/**
+  * Strategie der Geister eines Levels festlegen, z.B. um eine
+  * neue KI im Stapelbetrieb zu erproben. Betrifft die Aenderung
+  * das laufende Level, wird es neu aufgebaut.
+  * @param levelNumber Nummer des Levels.
+  * @param policy      Strategie der Geister.
+  */
+void Field::setGhostPolicy(unsigned int levelNumber, GhostPolicy policy)
+{
+	ghostPolicies[ levelNumber - 1 ] = policy;
+	if (levelNumber == this->levelNumber) {
+		setup(levelNumber);
+	}
+}
+
+/**
+  * Strategie der Geister eines Levels auslesen.
+  * @param levelNumber Nummer des Levels.
+  * @return Strategie der Geister.
+  */
+GhostPolicy Field::getGhostPolicy(unsigned int levelNumber) const
+{
+	return ghostPolicies[ levelNumber - 1 ];
+}
+
 unsigned int Field::getLives()
 {
 	return this->controller->getLives();
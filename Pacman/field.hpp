@@ -2,10 +2,20 @@
 #define FIELD_H
 
 #include <Gosu/Gosu.hpp>
+#include <string>
+#include <vector>
 #include "cell.hpp" 
+#include "ghost_policy.hpp"
+#include "hierarchical_pathfinder.hpp"
+#include "junction_graph.hpp"
+#include "maze_bitboard.hpp"
+#include "maze_grid.hpp"
 
 class Pacman;
 class GameController;
+class GameView;
+class PacmanAgent;
+class TurnStatistics;
 enum GameState;
 
 class Field {
@@ -28,18 +38,40 @@ private:
 	// Aktuelles level
 	unsigned int levelNumber;
 
+	// Strategie der Geister je Level
+	std::vector<GhostPolicy> ghostPolicies;
+
 	// Breite einer Zelle in Pixeln
 	unsigned int cellWidth;
 
 	// Hoehe einer Zelle in Pixeln
 	unsigned int cellHeight;
 
+	// Begehbare Richtungen aller Zellen fuer Suchverfahren
+	MazeGrid maze;
+
+	// Kreuzungen und Korridore des aktuellen Levels
+	JunctionGraph junctions;
+
+	// Wegsuche fuer Figuren, die ein Ziel ansteuern
+	HierarchicalPathfinder pathfinder;
+
+	// Bitboards fuer Flutfuellungen ueber das ganze Labyrinth
+	MazeBitboard bitboard;
+
 	/**
 	  * Initialisierung des Spielfeldes aus einer textuellen Beschreibung.
 	  * @param levelNumber Nummer des Levels (siehe Erlaeuterung oben).
 	  */
 	void setup(unsigned int levelNumber);
 
+	/**
+	  * Labyrinth, Kreuzungsgraph, Wegsuche und Bitboards aus den fertig
+	  * eingerichteten Zellen aufbauen.
+	  * @param layout Aufbau des Spielfeldes (siehe Erlaeuterung oben).
+	  */
+	void buildMaze(const std::string& layout);
+
 public:
 	/**
 	  * Ein neues Spielfeld erzeugen.
@@ -57,6 +89,14 @@ public:
 	  */
 	void nextTick();
 
+	/**
+	  * Schnellvorlauf bis zum naechsten Takt, in dem etwas passiert
+	  * (siehe GameController::advanceUntilNextEvent()).
+	  * @param maxTicks Hoechstens so viele Takte weiterschalten.
+	  * @return Anzahl vergangener Takte.
+	  */
+	unsigned int advanceUntilNextEvent(unsigned int maxTicks);
+
 	/**
 	  * Eine Taste wurde gedrueckt, um die Figur in eine bestimmte
 	  * Richtung zu schicken. 
@@ -64,6 +104,13 @@ public:
 	  */
 	void keyPressed(Direction direction);
 
+	/**
+	  * Der zweite Spieler haelt eine Richtung fuer seinen Geist (siehe
+	  * GameController::ghostKeyPressed()).
+	  * @param direction Gehaltene Richtung, NONE beim Loslassen.
+	  */
+	void ghostKeyPressed(Direction direction);
+
 	/**
 	  * Kann eine Figur, die sich in der Zelle an der Koordinate
 	  * (x,y) befindet, in die Richtung 'direction' gehen oder
@@ -85,6 +132,41 @@ public:
 	  */
 	Cell* getCell(unsigned int x, unsigned int y);
 
+	/**
+	  * Liest die Zelle aus, die sich an der Koordinate (x,y)
+	  * im Spielfeld befindet, nur zum Lesen.
+	  * @param x X-Koordinate der Zelle
+	  * @param y Y-Koordinate der Zelle
+	  * @return Zeiger auf die Zelle.
+	  */
+	const Cell* getCell(unsigned int x, unsigned int y) const;
+
+	/**
+	  * Labyrinth des aktuellen Levels auslesen.
+	  * @return Begehbare Richtungen aller Zellen.
+	  */
+	const MazeGrid& getMaze() const;
+
+	/**
+	  * Kreuzungsgraph des aktuellen Levels auslesen.
+	  * @return Kreuzungen und Korridore, Zellen wie in getMaze().
+	  */
+	const JunctionGraph& getJunctionGraph() const;
+
+	/**
+	  * Wegsuche des aktuellen Levels auslesen. Sie ist nicht konstant,
+	  * da sie gefundene Wege aufbewahrt.
+	  * @return Wegsuche, Zellen wie in getMaze().
+	  */
+	HierarchicalPathfinder& getPathfinder();
+
+	/**
+	  * Bitboards des aktuellen Levels auslesen. Sie sind nicht konstant,
+	  * da sie den Zustand der letzten Flutfuellung enthalten.
+	  * @return Bitboards, Zellen wie in getMaze().
+	  */
+	MazeBitboard& getBitboard();
+
 	/**
 	  * Wird aufgerufen, wenn das Spielfeld neu
 	  * gezeichnet werden muss.
@@ -94,7 +176,15 @@ public:
 	  * @return <code>true</code>, wenn das Eriegnis 'verbraucht' wurde.
 	  */
 	//virtual void paintEvent(QPaintEvent* event);
-	virtual void draw(Gosu::Graphics& graphics);
+
+	/**
+	  * Spielfeld zeichnen, die Figuren gleitend auf ihren Kanten (siehe
+	  * Figure::interpolate()).
+	  * @param graphics     Ziel.
+	  * @param tickFraction Seit dem letzten Takt vergangener Anteil
+	  *                     eines Taktes zwischen 0 und 1.
+	  */
+	virtual void draw(Gosu::Graphics& graphics, double tickFraction = 0.0);
 
 	/**
 	  * Aktuelle Punktezahl auslesen.
@@ -115,6 +205,101 @@ public:
 	unsigned int getLevelNumber();
 	unsigned int getMaxLevels();
 
+	/**
+	  * Strategie der Geister eines Levels festlegen, z.B. um eine
+	  * neue KI im Stapelbetrieb zu erproben. Betrifft die Aenderung
+	  * das laufende Level, wird es neu aufgebaut.
+	  * @param levelNumber Nummer des Levels.
+	  * @param policy      Strategie der Geister.
+	  */
+	void setGhostPolicy(unsigned int levelNumber, GhostPolicy policy);
+
+	/**
+	  * Strategie der Geister eines Levels auslesen.
+	  * @param levelNumber Nummer des Levels.
+	  * @return Strategie der Geister.
+	  */
+	GhostPolicy getGhostPolicy(unsigned int levelNumber) const;
+
+	/**
+	  * Einen automatischen Spieler anmelden, im Fenster wie in Laeufen
+	  * ohne Fenster (siehe GameController::setPacmanAgent()). Er
+	  * bleibt ueber Levelwechsel hinweg angemeldet.
+	  * @param agent Spieler oder 0 fuer die Steuerung per Tastatur.
+	  */
+	void setPacmanAgent(PacmanAgent* agent);
+
+	/**
+	  * Gueltigkeit eines noch nicht ausfuehrbaren Richtungswunsches fuer
+	  * Pacman festlegen (siehe GameController::setTurnBuffer()).
+	  * @param ticks Takte, 0 ohne Vormerken.
+	  */
+	void setTurnBuffer(unsigned int ticks);
+
+	/**
+	  * Verteilung der Verzoegerung bis zum Abbiegen anmelden (siehe
+	  * GameController::setTurnStatistics()).
+	  * @param statistics Verteilung oder 0 ohne Messung.
+	  */
+	void setTurnStatistics(TurnStatistics* statistics);
+
+	/**
+	  * Makroschritte entlang der Korridore fuer Laeufe ohne Fenster ein-
+	  * oder ausschalten (siehe GameController::setCorridorSteps()).
+	  * @param enabled <code>true</code> zum Einschalten.
+	  */
+	void setCorridorSteps(bool enabled);
+
+	/**
+	  * Pruefmodus des nachgefuehrten Hashes ein- oder ausschalten (siehe
+	  * GameController::setHashVerification()).
+	  * @param enabled <code>true</code> zum Einschalten.
+	  */
+	void setHashVerification(bool enabled);
+
+	/**
+	  * Anzahl der im Pruefmodus gefundenen Abweichungen auslesen.
+	  * @return Anzahl Abweichungen.
+	  */
+	unsigned int getHashMismatches() const;
+
+	/**
+	  * Zufallsgenerator des Spiels neu starten (siehe
+	  * GameController::setRandomSeed()).
+	  * @param seed Startwert.
+	  */
+	void setRandomSeed(unsigned int seed);
+
+	/**
+	  * Nur lesende Sicht auf den Spielstand, z.B. fuer Lernverfahren,
+	  * die den Stand ausserhalb einer Entscheidung auswerten.
+	  * @return Sicht auf dieses Spielfeld.
+	  */
+	GameView getView();
+
+	/**
+	  * Den Spielstand eines anderen Spielfeldes uebernehmen, z.B. fuer
+	  * Simulationen einer Suche. Ist ein anderes Level aufgebaut,
+	  * wird es zuvor neu aufgebaut, sonst werden nur die Zellen und
+	  * der Zustand der Figuren kopiert.
+	  * @param other Spielfeld mit dem zu kopierenden Stand.
+	  */
+	void copyStateFrom(const Field& other);
+
+	/**
+	  * Den Spielstand des Controllers lesbar schreiben (siehe
+	  * GameController::writeState()).
+	  * @param out Ziel der Ausgabe.
+	  */
+	void writeState(std::ostream& out) const;
+
+	/**
+	  * Einen waehrend der Entscheidung des automatischen Spielers
+	  * kopierten Takt fortsetzen (siehe GameController::resumeTick()).
+	  * @param direction Richtung fuer Pacmans Schritt.
+	  */
+	void resumeTick(Direction direction);
+
 	unsigned int getLives();
 
 	bool nextLevel();
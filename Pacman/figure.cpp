@@ -1,4 +1,5 @@
 #include "figure.hpp"
+#include "game_controller.hpp"
 #include <GL/glew.h>
 
 /**
@@ -16,8 +17,15 @@ Figure::Figure(unsigned int x, unsigned int y, GameController* controller) {
 	this->startx = x;
 	this->starty = y;
 	this->controller = controller;
+	this->index = 0;
 	this->state = Alive;
-	this->ticks = 0;
+	this->speed = 0;
+	this->progress = 0;
+	this->edgeX = x;
+	this->edgeY = y;
+	this->edgeTick = 0;
+	this->drawOffsetX = 0.0;
+	this->drawOffsetY = 0.0;
 }
 
 
@@ -28,8 +36,8 @@ Figure::Figure(unsigned int x, unsigned int y, GameController* controller) {
   * @param cellWidth Breite der Zelle in Pixeln.
   * @return Relative X-Koordinate innerhalb der Zelle als Ursprung der Figur.
   */
-unsigned int Figure::getInnerX(unsigned int cellWidth) const {
-	return cellWidth * getX() + EMPTY_BORDER;
+int Figure::getInnerX(unsigned int cellWidth) const {
+	return (int) ((getX() + drawOffsetX) * cellWidth + 0.5) + EMPTY_BORDER;
 }
 
 
@@ -40,8 +48,8 @@ unsigned int Figure::getInnerX(unsigned int cellWidth) const {
   * @param cellHeight Hoehe der Zelle in Pixeln.
   * @return Relative Y-Koordinate innerhalb der Zelle als Ursprung der Figur.
   */
-unsigned int Figure::getInnerY(unsigned int cellHeight) const {
-	return cellHeight * getY() + EMPTY_BORDER;
+int Figure::getInnerY(unsigned int cellHeight) const {
+	return (int) ((getY() + drawOffsetY) * cellHeight + 0.5) + EMPTY_BORDER;
 }
 
 
@@ -112,6 +120,15 @@ void Figure::setDirection(Direction direction) {
 }
 
 
+/**
+  * Richtung, in der sich die Figur bewegt, auslesen.
+  * @return Aktuelle Richtung der Figur.
+  */
+Direction Figure::getDirection() const {
+	return this->direction;
+}
+
+
 /**
   * Einen Kreisbogen mit relativen Koordinaten zeichnen.
   * @param painter    Painter, der die Ausgaben vornimmt.
@@ -126,10 +143,10 @@ void Figure::drawArc(Gosu::Graphics& graphics, Gosu::Color color, int cellWidth,
 {
 	if(length > 360) return;
 
-	unsigned int x = getInnerX(cellWidth) + bounds.x * cellWidth - 3; //getInnerX(cellWidth) + (unsigned int) (bounds.x * getInnerW(cellWidth) + 0.5);
-	unsigned int y = getInnerY(cellHeight) + bounds.y * cellHeight - 3; //getInnerY(cellHeight) + (unsigned int) (bounds.y * getInnerH(cellHeight) + 0.5);
-	unsigned int w = bounds.w * cellWidth; //(unsigned int) (bounds.w * getInnerW(cellWidth) + 0.5);
-	unsigned int h = bounds.h * cellHeight; //(unsigned int) (bounds.h * getInnerH(cellHeight) + 0.5);
+	int x = getInnerX(cellWidth) + bounds.x * cellWidth - 3; //getInnerX(cellWidth) + (unsigned int) (bounds.x * getInnerW(cellWidth) + 0.5);
+	int y = getInnerY(cellHeight) + bounds.y * cellHeight - 3; //getInnerY(cellHeight) + (unsigned int) (bounds.y * getInnerH(cellHeight) + 0.5);
+	int w = bounds.w * cellWidth; //(unsigned int) (bounds.w * getInnerW(cellWidth) + 0.5);
+	int h = bounds.h * cellHeight; //(unsigned int) (bounds.h * getInnerH(cellHeight) + 0.5);
 
 	//std::cout << x << " " << this->cellX << " | " << w << " " << cellWidth << " " <<  bounds.w << std::endl;
 
@@ -181,10 +198,10 @@ void Figure::drawRectangle(Gosu::Graphics& graphics, Gosu::Color color,
 						bool fill,
 						BoundingBox bounds) {
 
-	unsigned int x = getInnerX(cellWidth) + bounds.x * cellWidth - 3;
-	unsigned int y = getInnerY(cellHeight) + bounds.y * cellHeight - 3;
-	unsigned int w = bounds.w * cellWidth;
-	unsigned int h = bounds.h * cellHeight;
+	int x = getInnerX(cellWidth) + bounds.x * cellWidth - 3;
+	int y = getInnerY(cellHeight) + bounds.y * cellHeight - 3;
+	int w = bounds.w * cellWidth;
+	int h = bounds.h * cellHeight;
 
 	glColor3f((float)color.red()/255, (float)color.green()/255, (float)color.blue()/255);
 
@@ -206,8 +223,8 @@ void Figure::drawRectangle(Gosu::Graphics& graphics, Gosu::Color color,
 void Figure::drawLine(Gosu::Graphics& graphics, Gosu::Color color, unsigned int cellWidth, unsigned int cellHeight,
 					  int x1, int y1, int x2, int y2)
 {
-	unsigned int x = getInnerX(cellWidth);
-	unsigned int y = getInnerY(cellHeight);
+	int x = getInnerX(cellWidth);
+	int y = getInnerY(cellHeight);
 
 	glColor3f((float)color.red()/255, (float)color.green()/255, (float)color.blue()/255);
 
@@ -219,13 +236,95 @@ void Figure::drawLine(Gosu::Graphics& graphics, Gosu::Color color, unsigned int
 
 
 /**
-  * Untersucht, ob die uebergebene Figur mit dieser kollidiert.
-  * Es wird also geprueft, ob sie dieselben Koordinaten besitzen.
+  * Index in der Figurenliste des Controllers eintragen.
+  * @param index Index der Figur.
+  */
+void Figure::setIndex(unsigned int index) {
+	this->index = index;
+}
+
+
+/**
+  * Index in der Figurenliste des Controllers auslesen.
+  * @return Index der Figur.
+  */
+unsigned int Figure::getIndex() const {
+	return this->index;
+}
+
+
+/**
+  * Beginn der Kante setzen, auf der die Figur die aktuelle Zelle
+  * erreicht hat, im aktuellen Takt des Controllers.
+  * @param x X-Koordinate der vorigen Zelle.
+  * @param y Y-Koordinate der vorigen Zelle.
+  */
+void Figure::setEdgeStart(unsigned int x, unsigned int y) {
+	this->edgeX = x;
+	this->edgeY = y;
+	this->edgeTick = controller->getTickCount();
+}
+
+
+/**
+  * Ort zum Zeichnen auf der Kante von der vorigen zur aktuellen Zelle
+  * bestimmen. Ein Sprung ueber mehr als eine Zelle ist ein Tunnel, die
+  * Figur kommt dann von jenseits des Randes.
+  * @param tickFraction Seit dem Takt vergangener Anteil eines Taktes.
+  */
+void Figure::interpolate(double tickFraction) {
+	int dx = (int) this->cellX - (int) this->edgeX;
+	int dy = (int) this->cellY - (int) this->edgeY;
+	if (dx > 1) dx = -1; else if (dx < -1) dx = 1;
+	if (dy > 1) dy = -1; else if (dy < -1) dy = 1;
+
+	double travelled = (this->progress + tickFraction * this->speed) / SUBCELLS;
+	if (travelled > 1.0) {
+		travelled = 1.0;
+	}
+	this->drawOffsetX = -dx * (1.0 - travelled);
+	this->drawOffsetY = -dy * (1.0 - travelled);
+}
+
+
+/**
+  * Untersucht, ob die uebergebene Figur mit dieser kollidiert: Sie
+  * stehen in derselben Zelle, oder sie haben im selben Takt die
+  * Zellen ueber dieselbe Kante getauscht. Kanten sind Paare von
+  * Zellen, eine Kante durch den Tunnel verbindet also die beiden
+  * Randzellen und wird wie jede andere erkannt.
   * @param otherFigure Figur, die auf Kollision mit dieser untersucht wird.
   * @return <code>true</code>, falls beide Figuren kollidieren.
   */
 bool Figure::isCollisionWith(Figure* otherFigure) const {
-	return cellX == otherFigure->getX() && cellY == otherFigure->getY();
+	if (cellX == otherFigure->getX() && cellY == otherFigure->getY()) {
+		return true;
+	}
+	return edgeTick == otherFigure->edgeTick
+		&& edgeX == otherFigure->cellX && edgeY == otherFigure->cellY
+		&& cellX == otherFigure->edgeX && cellY == otherFigure->edgeY;
+}
+
+
+/**
+  * Untersucht, ob die Figur eine Zelle trifft, auf der eine andere
+  * Figur nur logisch steht (siehe GameController::setCorridorSteps()).
+  * Ob die andere Figur im selben Takt gegangen ist, ist nicht
+  * bekannt; stand diese Figur vorher auf der Zelle, wurde die
+  * Kollision bereits dort erkannt.
+  * @param x         X-Koordinate der Zelle.
+  * @param y         Y-Koordinate der Zelle.
+  * @param previousX X-Koordinate der Zelle davor.
+  * @param previousY Y-Koordinate der Zelle davor.
+  * @return <code>true</code>, falls die Figur die Zelle trifft.
+  */
+bool Figure::isCollisionAt(unsigned int x, unsigned int y, unsigned int previousX, unsigned int previousY) const {
+	if (cellX == x && cellY == y) {
+		return true;
+	}
+	return edgeTick == controller->getTickCount()
+		&& edgeX == x && edgeY == y
+		&& cellX == previousX && cellY == previousY;
 }
 
 
@@ -249,7 +348,11 @@ bool Figure::isCollisionWith(Figure* otherFigure) const {
 
 void Figure::setState(FigureState state)
 {
+	FigureState oldState = this->state;
 	this->state = state;
+	if (oldState != state) {
+		controller->figureStateChanged(this, oldState);
+	}
 }
 
 FigureState Figure::getState()
@@ -261,5 +364,43 @@ void Figure::reset()
 {
 	this->cellX = startx;
 	this->cellY = starty;
+	this->edgeX = startx;
+	this->edgeY = starty;
+	this->edgeTick = 0;
 	this->state = Alive;
-}
\ No newline at end of file
+}
+
+
+/**
+  * Zustand einer gleichartigen Figur uebernehmen. Der Controller
+  * bleibt der eigene.
+  * @param other Figur desselben Typs an derselben Stelle der
+  *              Figurenliste.
+  */
+void Figure::copyStateFrom(const Figure& other) {
+	this->cellX = other.cellX;
+	this->cellY = other.cellY;
+	this->direction = other.direction;
+	this->speed = other.speed;
+	this->progress = other.progress;
+	this->edgeX = other.edgeX;
+	this->edgeY = other.edgeY;
+	this->edgeTick = other.edgeTick;
+	this->state = other.state;
+	this->startx = other.startx;
+	this->starty = other.starty;
+}
+
+
+/**
+  * Zustand der Figur als eine Zeile ohne Zeilenende schreiben: Zelle,
+  * Richtung, Zustand, Geschwindigkeit, Fortschritt auf der Kante, die
+  * Kante mit ihrem Takt und die Startzelle.
+  * @param out Ziel der Ausgabe.
+  */
+void Figure::writeState(std::ostream& out) const {
+	out << "x " << cellX << " y " << cellY << " direction " << direction.getValue()
+		<< " state " << (unsigned int) state << " speed " << speed << " progress " << progress
+		<< " edge " << edgeX << "," << edgeY << " at " << edgeTick
+		<< " start " << startx << "," << starty;
+}
@@ -1,6 +1,7 @@
 #ifndef FIGURE_H
 #define FIGURE_H
 
+#include <ostream>
 #include <Gosu/Gosu.hpp>
 #include "direction.hpp"
 
@@ -35,11 +36,25 @@ protected:
 	// Spiele-Controller, der die Aktionen bewertet und die Figuren steuert.
 	GameController* controller;
 
-	// Geschwindigkeit der Figur, angegeben in Ticks
+	// Index in der Figurenliste des Controllers
+	unsigned int index;
+
+	// Geschwindigkeit der Figur in Teilzellen je Takt
 	unsigned int speed;
 
-	// Tickcounter
-	unsigned int ticks;
+	// Auf der aktuellen Kante zurueckgelegte Teilzellen (Festkomma,
+	// SUBCELLS je Zelle). Bei SUBCELLS macht die Figur ihren Schritt.
+	unsigned int progress;
+
+	// Zelle vor dem letzten Schritt, die Kante fuehrt von dort zur
+	// aktuellen Zelle
+	unsigned int edgeX, edgeY;
+
+	// Takt, in dem die Figur die Kante betreten hat
+	unsigned int edgeTick;
+
+	// Versatz beim Zeichnen in Zellen (siehe interpolate())
+	double drawOffsetX, drawOffsetY;
 
 	// Status der Figur
 	FigureState state;	
@@ -51,6 +66,15 @@ public:
 	// Leerer Rahmen um die Figur: jeweils 4 Pixel
 	static const unsigned int EMPTY_BORDER = 4;
 
+	// Rueckgabewert von getTicksUntilAction() fuer Figuren,
+	// die von sich aus niemals handeln.
+	static const unsigned int NEVER = 0;
+
+	// Teilzellen je Zelle: gemeinsames Vielfaches der bisherigen
+	// Schrittweiten (5, 8, 10, 12 und 15 Takte je Zelle), damit diese
+	// ganzzahlige Geschwindigkeiten ergeben
+	static const unsigned int SUBCELLS = 120;
+
 	virtual void reset();
 
 protected:
@@ -97,7 +121,7 @@ protected:
 	  * @param cellWidth Breite der Zelle in Pixeln.
 	  * @return Relative X-Koordinate innerhalb der Zelle als Ursprung der Figur.
 	  */
-	unsigned int getInnerX(unsigned int cellWidth) const;
+	int getInnerX(unsigned int cellWidth) const;
 
 	/**
 	  * Liefert die relative Y-Koordinate innerhalb der Zelle zurueck,
@@ -106,7 +130,7 @@ protected:
 	  * @param cellHeight Hoehe der Zelle in Pixeln.
 	  * @return Relative Y-Koordinate innerhalb der Zelle als Ursprung der Figur.
 	  */
-	unsigned int getInnerY(unsigned int cellHeight) const;
+	int getInnerY(unsigned int cellHeight) const;
 
 	/**
 	  * Liefert die Breite fuer die Figur zurueck. Diese entspricht der
@@ -157,6 +181,23 @@ public:
 	  */
 	virtual void nextTick() { }
 
+	/**
+	  * Nach wievielen Aufrufen von nextTick() handelt die Figur das
+	  * naechste Mal, bewegt sich also oder aendert ihren Zustand?
+	  * Der Controller ruft nextTick() nur zu diesen Takten auf.
+	  * @return Anzahl Takte (mindestens 1) oder <code>NEVER</code>, wenn
+	  *         die Figur von sich aus nie handelt.
+	  */
+	virtual unsigned int getTicksUntilAction() const { return NEVER; }
+
+	/**
+	  * Die Zaehler der Figur um Takte weiterfuehren, in denen sie
+	  * nicht handelt. Das Ergebnis muss dasselbe sein wie bei 'count'
+	  * Aufrufen von nextTick().
+	  * @param count Anzahl uebersprungener Takte.
+	  */
+	virtual void skipTicks(unsigned int /*count*/) { }
+
 	/**
 	  * Ermittelt die X-Koordinate der Figur auf dem Spielfeld.
 	  * @return X-Koordinate der Figur auf dem Spielfeld.
@@ -187,14 +228,70 @@ public:
 	  */
 	virtual void setDirection(Direction direction);
 
+	/**
+	  * Richtung, in der sich die Figur bewegt, auslesen.
+	  * @return Aktuelle Richtung der Figur.
+	  */
+	virtual Direction getDirection() const;
+
+	/**
+	  * Index in der Figurenliste des Controllers eintragen, beim
+	  * Hinzufuegen der Figur (siehe GameController::addFigure()).
+	  * @param index Index der Figur.
+	  */
+	void setIndex(unsigned int index);
+
+	/**
+	  * Index in der Figurenliste des Controllers auslesen.
+	  * @return Index der Figur.
+	  */
+	unsigned int getIndex() const;
+
+	/**
+	  * Beginn der Kante setzen, auf der die Figur die aktuelle Zelle
+	  * erreicht hat. Ohne Schritt (Start, Sprung) ist es die aktuelle
+	  * Zelle selbst.
+	  * @param x X-Koordinate der vorigen Zelle.
+	  * @param y Y-Koordinate der vorigen Zelle.
+	  */
+	void setEdgeStart(unsigned int x, unsigned int y);
+
+	/**
+	  * Ort zum Zeichnen auf der Kante von der vorigen zur aktuellen
+	  * Zelle bestimmen: Die Figur steht dort so weit, wie sie seit dem
+	  * Schritt auf dem Weg zum naechsten gekommen ist, ergaenzt um den
+	  * Bruchteil des laufenden Taktes. So gleitet sie zwischen den
+	  * Zustaenden der Logik, liegt aber hoechstens einen Schritt hinter
+	  * ihrer Zelle. Tunnel werden ueber den Rand hinaus gezeichnet.
+	  * @param tickFraction Seit dem Takt vergangener Anteil eines
+	  *                     Taktes zwischen 0 und 1.
+	  */
+	void interpolate(double tickFraction);
+
 	/**
 	  * Untersucht, ob die uebergebene Figur mit dieser kollidiert.
-	  * Es wird also geprueft, ob sie dieselben Koordinaten besitzen.
+	  * Es wird also geprueft, ob sie dieselben Koordinaten besitzen
+	  * oder im selben Takt auf derselben Kante in entgegengesetzter
+	  * Richtung aneinander vorbei gelaufen sind, auch durch einen
+	  * Tunnel. Das Ergebnis haengt so nicht davon ab, welche der
+	  * beiden Figuren zuerst gezogen ist.
 	  * @param otherFigure Figur, die auf Kollision mit dieser untersucht wird.
 	  * @return <code>true</code>, falls beide Figuren kollidieren.
 	  */
 	virtual bool isCollisionWith(Figure* otherFigure) const;
 
+	/**
+	  * Untersucht, ob die Figur eine Zelle trifft, auf der eine andere
+	  * Figur nur logisch steht: Sie steht selbst dort, oder sie ist in
+	  * diesem Takt von dort in die Zelle davor gegangen.
+	  * @param x         X-Koordinate der Zelle.
+	  * @param y         Y-Koordinate der Zelle.
+	  * @param previousX X-Koordinate der Zelle davor.
+	  * @param previousY Y-Koordinate der Zelle davor.
+	  * @return <code>true</code>, falls die Figur die Zelle trifft.
+	  */
+	bool isCollisionAt(unsigned int x, unsigned int y, unsigned int previousX, unsigned int previousY) const;
+
 	/**
 	  * Kollisionsbehandlung: Diese Figur ist mit der uebergebenen
 	  * zusammen gestossen.
@@ -217,6 +314,22 @@ public:
 
 	virtual void setState(FigureState state);
 	virtual FigureState getState();
+
+	/**
+	  * Zustand einer gleichartigen Figur uebernehmen, z.B. um einen
+	  * Spielstand fuer eine Suche zu kopieren. Der Controller bleibt
+	  * der eigene.
+	  * @param other Figur desselben Typs an derselben Stelle der
+	  *              Figurenliste.
+	  */
+	virtual void copyStateFrom(const Figure& other);
+
+	/**
+	  * Zustand der Figur als eine Zeile ohne Zeilenende schreiben, z.B.
+	  * fuer den Vergleich zweier Prozesse nach einer Abweichung.
+	  * @param out Ziel der Ausgabe.
+	  */
+	virtual void writeState(std::ostream& out) const;
 };
 
 #endif // FIGURE_H
@@ -1,10 +1,30 @@
+#include "cell.hpp"
 #include "cherry.hpp"
 #include "pill.hpp"
 #include "direction.hpp"
 #include "field.hpp"
 #include "game_controller.hpp"
+#include "game_view.hpp"
 #include "ghost.hpp"
 #include "pacman.hpp"
+#include "pacman_agent.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+// Zeitplan der Modi je Level: Dauer der Abschnitte in Takten (60 je
+// Sekunde), beginnend mit Scatter, danach abwechselnd Chase und
+// Scatter. Der Abschnitt mit NONE endet nicht. Ab dem letzten Level
+// der Tabelle gilt dessen Zeitplan.
+const unsigned int MODE_LEVELS = 3;
+const unsigned int MODE_PHASES = 8;
+const unsigned int ModeSchedule[ MODE_LEVELS ][ MODE_PHASES ] = {
+	{ 420, 1200, 420, 1200, 300, 1200,  300, TimingWheel::NONE },
+	{ 420, 1200, 420, 1200, 300, 3600,   60, TimingWheel::NONE },
+	{ 300, 1200, 300, 1200, 300, 3600,   60, TimingWheel::NONE }
+};
+}
 
 /**
   * Einen neuen Spielecontroller erzeugen.
@@ -14,6 +34,27 @@ GameController::GameController(Field* field) {
 	this->field = field;
 	this->points = 0;
 	this->lives = 3;
+	this->state = Starting;
+	this->tickCount = 0;
+	this->dueIndex = 0;
+	this->figureCursor = TimingWheel::NONE;
+	this->targetingTick = TimingWheel::NONE;
+	this->pacmanAgent = 0;
+	this->agentDeciding = false;
+	this->ghostPlayerDirection = Direction::NONE;
+	this->turnBufferTicks = Pacman::TURN_BUFFER_TICKS;
+	this->corridorSteps = false;
+	this->corridorEdge = JunctionGraph::NONE;
+	this->corridorStop = 0;
+	this->turnStatistics = 0;
+	this->hashVerification = false;
+	this->hashMismatches = 0;
+	this->ghostMode = Scatter;
+	this->modePhase = 0;
+	this->modeTicks = TimingWheel::NONE;
+	this->modeEnd = 0;
+	this->modeRunning = false;
+	setRandomSeed(DEFAULT_SEED);
 	reset();
 }
 
@@ -26,14 +67,23 @@ GameController::~GameController() {
 
 void GameController::reset()
 {
-	this->ghostStateHarmless = false;
-	this->setState(Starting);
-
 	while(figures.size() > 0) {
 		Figure* figure = figures.back();
 		figures.pop_back();
 		delete figure;
 	}
+	ghosts.clear();
+	pills.clear();
+	cherries.clear();
+	figureTicks.clear();
+	dueEntries.clear();
+	scheduler.clear(tickCount);
+	scheduler.resize(FIRST_FIGURE_ENTRY);
+	modeRunning = false;
+
+	this->ghostStateHarmless = false;
+	this->targetingTick = TimingWheel::NONE;
+	this->setState(Starting);
 }
 
 /**
@@ -44,7 +94,11 @@ void GameController::reset()
   * @param figure Neue Figur.
   */
 void GameController::addFigure(Figure *figure) {
+	figure->setIndex(figures.size());
 	figures.push_back(figure);
+	figureTicks.push_back(tickCount);
+	scheduler.resize(FIRST_FIGURE_ENTRY + figures.size());
+	scheduleFigure(figures.size() - 1);
 }
 
 
@@ -66,6 +120,86 @@ std::vector<Figure*>& GameController::getFigures() {
 }
 
 
+/**
+  * Pacman auslesen.
+  * @return Zeiger auf die Pacman-Figur.
+  */
+Pacman* GameController::getPacman() const {
+	return pacman;
+}
+
+
+/**
+  * Alle Geister auslesen.
+  * @return Referenz auf einen Vektor mit allen Geistern.
+  */
+const std::vector<Ghost*>& GameController::getGhosts() const {
+	return ghosts;
+}
+
+
+/**
+  * Alle Pillen auslesen.
+  * @return Referenz auf einen Vektor mit allen Pillen.
+  */
+const std::vector<Pill*>& GameController::getPills() const {
+	return pills;
+}
+
+
+/**
+  * Alle Kirschen auslesen.
+  * @return Referenz auf einen Vektor mit allen Kirschen.
+  */
+const std::vector<Cherry*>& GameController::getCherries() const {
+	return cherries;
+}
+
+
+/**
+  * Einen automatischen Spieler anmelden.
+  * @param agent Spieler oder 0 fuer die Steuerung per Tastatur.
+  */
+void GameController::setPacmanAgent(PacmanAgent* agent) {
+	pacmanAgent = agent;
+}
+
+
+/**
+  * Angemeldeten automatischen Spieler auslesen.
+  * @return Spieler oder 0.
+  */
+PacmanAgent* GameController::getPacmanAgent() const {
+	return pacmanAgent;
+}
+
+
+/**
+  * Zufallsgenerator des Spiels neu starten. Der Startwert wird
+  * verwuerfelt, damit auch benachbarte Startwerte verschiedene Folgen
+  * ergeben, und darf nicht 0 werden.
+  * @param seed Startwert.
+  */
+void GameController::setRandomSeed(unsigned int seed) {
+	randomState = (boost::uint32_t) (seed * 2654435761u) ^ 0x9E3779B9u;
+	if (randomState == 0) {
+		randomState = 0x9E3779B9u;
+	}
+}
+
+
+/**
+  * Naechste Zufallszahl des Spiels.
+  * @return Zufallszahl.
+  */
+unsigned int GameController::random() {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+
 /**
   * Pacman am Controller anmelden. Ab diesem Zeitpunkt
   * 'gehoert' Pacman dem Controller. Er ist also auch fuer das
@@ -79,6 +213,209 @@ void GameController::setPacman(Pacman* pacman) {
 }
 
 
+/**
+  * Einen Geist am Controller anmelden. Er wird wie jede andere
+  * Figur hinzugefuegt und zusaetzlich fuer die Zielermittlung
+  * vermerkt.
+  * @param ghost Zeiger auf den Geist.
+  */
+void GameController::addGhost(Ghost* ghost) {
+	ghosts.push_back(ghost);
+	addFigure(ghost);
+}
+
+
+/**
+  * Eine Pille am Controller anmelden.
+  * @param pill Zeiger auf die Pille.
+  */
+void GameController::addPill(Pill* pill) {
+	pills.push_back(pill);
+	addFigure(pill);
+}
+
+
+/**
+  * Eine Kirsche am Controller anmelden.
+  * @param cherry Zeiger auf die Kirsche.
+  */
+void GameController::addCherry(Cherry* cherry) {
+	cherries.push_back(cherry);
+	addFigure(cherry);
+}
+
+
+/**
+  * Die Zielermittlung fuer das fertig aufgebaute Spielfeld
+  * vorbereiten. Wird nach jedem Aufbau eines Levels aufgerufen.
+  */
+void GameController::prepareTargeting() {
+	targeting.build(field->getMaze(), field->getBitboard());
+	targetingTick = TimingWheel::NONE;
+	startModeSchedule();
+}
+
+
+/**
+  * Den Zeitplan der Modi fuer das aktuelle Level von vorn beginnen.
+  */
+void GameController::startModeSchedule() {
+	pauseModeSchedule();
+	modePhase = 0;
+	ghostMode = Scatter;
+	stateHash.setScalar(ZobristHash::Mode, ghostMode);
+	unsigned int level = std::min(field->getLevelNumber(), MODE_LEVELS) - 1;
+	modeTicks = ModeSchedule[ level ][ 0 ];
+	targeting.setMode(ghostMode);
+	targetingTick = TimingWheel::NONE;
+	resumeModeSchedule();
+}
+
+
+/**
+  * Zum naechsten Abschnitt des Zeitplans wechseln. Nur hier aendern
+  * sich die Ziele im Modus Scatter, im Modus Chase werden sie ab
+  * jetzt wieder je Takt berechnet.
+  */
+void GameController::advanceModeSchedule() {
+	modeRunning = false;
+	modePhase++;
+	ghostMode = (modePhase % 2 == 0) ? Scatter : Chase;
+	stateHash.setScalar(ZobristHash::Mode, ghostMode);
+	unsigned int level = std::min(field->getLevelNumber(), MODE_LEVELS) - 1;
+	modeTicks = (modePhase < MODE_PHASES) ? ModeSchedule[ level ][ modePhase ] : TimingWheel::NONE;
+	targeting.setMode(ghostMode);
+	targetingTick = TimingWheel::NONE;
+	resumeModeSchedule();
+}
+
+
+/**
+  * Den Zeitplan anhalten und die Restdauer des Abschnitts festhalten.
+  */
+void GameController::pauseModeSchedule() {
+	if (modeRunning) {
+		modeTicks = modeEnd - tickCount;
+		scheduler.cancel(MODE_TIMER);
+		modeRunning = false;
+	}
+}
+
+
+/**
+  * Den Zeitplan fortsetzen, sofern gespielt wird und die Geister
+  * nicht harmlos sind. Ein Abschnitt ohne Ende wird nicht eingeplant.
+  */
+void GameController::resumeModeSchedule() {
+	if (modeRunning || state != Playing || ghostStateHarmless || modeTicks == TimingWheel::NONE) {
+		return;
+	}
+	modeEnd = tickCount + modeTicks;
+	scheduler.schedule(MODE_TIMER, modeEnd);
+	modeRunning = true;
+}
+
+
+/**
+  * Den Hash fuer das fertig aufgebaute Spielfeld vollstaendig
+  * berechnen. Wird nach jedem Aufbau eines Levels aufgerufen.
+  */
+void GameController::prepareStateHash() {
+	buildStateHash(stateHash);
+}
+
+
+/**
+  * Eine Figur meldet die Aenderung ihres Zustands. Figuren, die noch
+  * nicht angemeldet sind, gehen erst mit prepareStateHash() ein.
+  * @param figure   Betroffene Figur mit dem neuen Zustand.
+  * @param oldState Bisheriger Zustand.
+  */
+void GameController::figureStateChanged(Figure* figure, FigureState oldState) {
+	unsigned int index = getFigureIndex(figure);
+	if (index < figures.size()) {
+		stateHash.toggleFigure(index, figure->getX(), figure->getY(), oldState);
+		stateHash.toggleFigure(index, figure->getX(), figure->getY(), figure->getState());
+	}
+}
+
+
+/**
+  * 64-Bit-Hash des Spielstandes auslesen.
+  * @return Hash.
+  */
+boost::uint64_t GameController::getStateHash() const {
+	return stateHash.getValue();
+}
+
+
+/**
+  * Den Hash des Spielstandes neu berechnen.
+  * @return Hash.
+  */
+boost::uint64_t GameController::computeStateHash() const {
+	ZobristHash hash;
+	buildStateHash(hash);
+	return hash.getValue();
+}
+
+
+/**
+  * Den Hash des aktuellen Spielstandes vollstaendig berechnen.
+  * @param hash Erhaelt den Hash.
+  */
+void GameController::buildStateHash(ZobristHash& hash) const {
+	hash.clear();
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		Figure* figure = figures[ index ];
+		hash.toggleFigure(index, figure->getX(), figure->getY(), figure->getState());
+	}
+	for (unsigned int y = 0; y < Field::FIELD_HEIGHT; ++y) {
+		for (unsigned int x = 0; x < Field::FIELD_WIDTH; ++x) {
+			if (field->getCell(x, y)->isFood()) {
+				hash.toggleFood(x, y);
+			}
+		}
+	}
+	hash.setScalar(ZobristHash::Points, points);
+	hash.setScalar(ZobristHash::Lives, lives);
+	hash.setScalar(ZobristHash::HarmlessTicks, ghostStateHarmless ? getGhostHarmlessTicks() : 0);
+	hash.setScalar(ZobristHash::Mode, ghostMode);
+	hash.setScalar(ZobristHash::State, state);
+}
+
+
+/**
+  * Den nachgefuehrten Hash mit einer vollstaendigen Berechnung
+  * vergleichen. Nach einer Abweichung wird der berechnete Wert
+  * uebernommen, damit jeder Fehler nur einmal gezaehlt wird.
+  */
+void GameController::verifyStateHash() {
+	if (stateHash.getValue() != computeStateHash()) {
+		++hashMismatches;
+		buildStateHash(stateHash);
+	}
+}
+
+
+/**
+  * Pruefmodus ein- oder ausschalten.
+  * @param enabled <code>true</code> zum Einschalten.
+  */
+void GameController::setHashVerification(bool enabled) {
+	hashVerification = enabled;
+}
+
+
+/**
+  * Anzahl der im Pruefmodus gefundenen Abweichungen auslesen.
+  * @return Anzahl Abweichungen.
+  */
+unsigned int GameController::getHashMismatches() const {
+	return hashMismatches;
+}
+
+
 /**
   * Sind die Geister harmlos?
   * @return <code>true</code>, falls sie harmlos sind.
@@ -93,18 +430,42 @@ bool GameController::isGhostStateHarmless() const {
   * @return Verbleibende Anzahl Takte.
   */
 unsigned int GameController::getGhostHarmlessTicks() const {
+	// Waehrend des Spiels laeuft der Zaehler ueber das Zeitrad ab.
+	if (ghostStateHarmless && state == Playing) {
+		return ghostHarmlessEnd - tickCount;
+	}
 	return ghostHarmlessTicks;
 }
 
 
+/**
+  * Modus der Geister auslesen. Harmlose Geister sind im Modus
+  * Frightened, ansonsten gilt der Zeitplan des Levels.
+  * @return Aktueller Modus.
+  */
+GhostMode GameController::getGhostMode() const {
+	return ghostStateHarmless ? Frightened : ghostMode;
+}
+
+
 /**
   * Eine Figur verschieben. Dabei werden die Zellenrahmen beachtet.
   * @param figure Die zu verschiebende Figur.
   * @param direction Richtung, in die die Figur verschoben werden soll.
   */
 void GameController::move(Figure* figure, Direction& direction) {
+	// Makroschritt: Pacman laeuft den ganzen Korridor und wartet die
+	// uebrigen Schritte am Ende ab. Die Richtung ist die der Ankunft.
+	if (figure == pacman && corridorSteps) {
+		if (moveAlongCorridor(figure, direction, Field::FIELD_WIDTH * Field::FIELD_HEIGHT) > 0) {
+			direction = figure->getDirection();
+			return;
+		}
+	}
+
 	unsigned int x = figure->getX();
 	unsigned int y = figure->getY();
+	figure->setEdgeStart(x, y);
 	if (field->allowsBorderMovement(x, y, direction)) {
 		switch (direction.getValue()) {
 			case Direction::UP:    y--; break;
@@ -117,19 +478,140 @@ void GameController::move(Figure* figure, Direction& direction) {
 	x = (x + Field::FIELD_WIDTH)  % Field::FIELD_WIDTH;
 	y = (y + Field::FIELD_HEIGHT) % Field::FIELD_HEIGHT;
 
-	figure->setX(x);
-	figure->setY(y);
+	placeFigure(figure, x, y);
 	figure->setDirection(direction);
 
 	// Wenn Pacman bewegt wurde: Nachsehen, ob sich auf dem neuen
 	// Feld Essen befindet.
 	if (figure == pacman) {
-		if (field->getCell(pacman->getX(), pacman->getY())->isFood()) {
-			points += DOT_POINTS;
-			foodCount--;
+		eatFood(x, y);
+	}
+}
+
+
+/**
+  * Pacman frisst das Essen in einer Zelle, falls noch vorhanden.
+  * @param x X-Koordinate der Zelle.
+  * @param y Y-Koordinate der Zelle.
+  */
+void GameController::eatFood(unsigned int x, unsigned int y) {
+	Cell* cell = field->getCell(x, y);
+	if (cell->isFood()) {
+		addPoints(DOT_POINTS);
+		foodCount--;
+		stateHash.toggleFood(x, y);
+	}
+	cell->setFood(false);
+}
+
+
+/**
+  * Punkte gutschreiben.
+  * @param bonus Zusaetzliche Punkte.
+  */
+void GameController::addPoints(unsigned int bonus) {
+	points += bonus;
+	stateHash.setScalar(ZobristHash::Points, points);
+}
+
+
+/**
+  * Eine Figur in eine Zelle setzen: Der Schluessel der alten Zelle
+  * geht aus dem Hash heraus, der der neuen hinein.
+  * @param figure Zu setzende Figur.
+  * @param x      X-Koordinate der Zelle.
+  * @param y      Y-Koordinate der Zelle.
+  */
+void GameController::placeFigure(Figure* figure, unsigned int x, unsigned int y) {
+	unsigned int index = getFigureIndex(figure);
+	stateHash.toggleFigure(index, figure->getX(), figure->getY(), figure->getState());
+	figure->setX(x);
+	figure->setY(y);
+	stateHash.toggleFigure(index, x, y, figure->getState());
+}
+
+
+/**
+  * Eine Figur auf ihre Startzelle zuruecksetzen und den Hash
+  * nachfuehren.
+  * @param figure Zurueckzusetzende Figur.
+  */
+void GameController::resetFigure(Figure* figure) {
+	unsigned int index = getFigureIndex(figure);
+	stateHash.toggleFigure(index, figure->getX(), figure->getY(), figure->getState());
+	figure->reset();
+	stateHash.toggleFigure(index, figure->getX(), figure->getY(), figure->getState());
+}
+
+
+/**
+  * Die Restdauer der harmlosen Phase im Hash nachfuehren.
+  */
+void GameController::updateHarmlessKey() {
+	stateHash.setScalar(ZobristHash::HarmlessTicks, ghostStateHarmless ? getGhostHarmlessTicks() : 0);
+}
+
+
+/**
+  * Makroschritt fuer Laeufe ohne Fenster (Suche, Stapelbetrieb):
+  * Die Figur laeuft in einem Aufruf den Korridor bis zur naechsten
+  * Kreuzung entlang, hoechstens aber 'maxSteps' Zellen. Statt jede
+  * Zelle zu pruefen, wird fuer jede andere Figur ueber den
+  * Kreuzungsgraphen ermittelt, ob und nach wievielen Schritten sie
+  * auf dem Korridor im Weg steht. Nur Pacman frisst unterwegs, er
+  * wartet danach die uebrigen Schritte ab und gilt bis dahin als
+  * auf der Zelle, die er ohne Makroschritt erreicht haette.
+  * @param figure    Die zu verschiebende Figur.
+  * @param direction Richtung, in die die Figur losgeht.
+  * @param maxSteps  Hoechstens so viele Zellen weit laufen.
+  * @return Anzahl zurueckgelegter Zellen (0, wenn die Richtung
+  *         versperrt ist).
+  */
+unsigned int GameController::moveAlongCorridor(Figure* figure, Direction direction, unsigned int maxSteps) {
+	const MazeGrid& maze = field->getMaze();
+	const JunctionGraph& junctions = field->getJunctionGraph();
+
+	unsigned int edge;
+	unsigned int start;
+	unsigned int cell = maze.getIndex(figure->getX(), figure->getY());
+	if (maxSteps == 0 || !junctions.locate(maze, cell, direction.getValue(), edge, start)) {
+		return 0;
+	}
+
+	unsigned int length = junctions.getEdge(edge).length;
+	unsigned int stop = (length - start > maxSteps) ? start + maxSteps : length;
+
+	// Erste Begegnung auf dem Weg suchen
+	for (std::vector<Figure*>::iterator iter = this->figures.begin(); iter != this->figures.end(); ++iter) {
+		Figure* other = *iter;
+		if (other == figure || other->getState() != Alive || (figure != pacman && other != pacman)) {
+			continue;
+		}
+		unsigned int step = junctions.getStepOnEdge(edge, maze.getIndex(other->getX(), other->getY()));
+		if (step != JunctionGraph::NONE && step > start && step < stop) {
+			stop = step;
 		}
-		field->getCell(pacman->getX(), pacman->getY())->setFood(false);
 	}
+
+	if (figure == pacman) {
+		for (unsigned int step = start + 1; step <= stop; ++step) {
+			unsigned int passed = junctions.getCellOnEdge(edge, step);
+			eatFood(maze.getX(passed), maze.getY(passed));
+		}
+	}
+
+	unsigned int target = junctions.getCellOnEdge(edge, stop);
+	placeFigure(figure, maze.getX(target), maze.getY(target));
+	figure->setEdgeStart(maze.getX(target), maze.getY(target));
+	figure->setDirection(Direction(junctions.getArrivalDirection(maze, edge, stop)));
+	if (figure == pacman) {
+		corridorEdge = edge;
+		corridorStop = stop;
+		pacman->setCellsAhead(stop - start - 1);
+	}
+	handleCollisionWithPacman(figure);
+
+	return stop - start;
 }
 
 
@@ -147,8 +629,27 @@ Direction GameController::getDirectionToPacman(Figure* figure, Direction figureC
 	return this->getDirectionToCoordinates(figure, pacman->getX(), pacman->getY(), figureCurrentDirection);
 }
 
+/**
+  * Ermittelt die Richtung, in die sich eine Figur bewegen muss, um
+  * die Zelle (x,y) zu erreichen. Der Weg kommt aus der hierarchischen
+  * Wegsuche des Spielfeldes und fuehrt auch durch die Tunnel. Nur wenn
+  * es keinen Weg gibt, wird wie frueher abwechselnd horizontal und
+  * vertikal auf das Ziel zugesteuert.
+  * @param figure Zu bewegende Figur.
+  * @param x X-Koordinate der Zielzelle.
+  * @param y Y-Koordinate der Zielzelle.
+  * @param figureCurrentDirection Aktuelle Bewegungsrichtung der Figur.
+  * @return Einzuschlagende Richtung.
+  */
 Direction GameController::getDirectionToCoordinates(Figure* figure, unsigned int x, unsigned int y, Direction figureCurrentDirection) const
 {
+	const MazeGrid& maze = field->getMaze();
+	unsigned int direction = field->getPathfinder().getDirection(
+		maze.getIndex(figure->getX(), figure->getY()), maze.getIndex(x, y));
+	if (direction != Direction::NONE) {
+		return Direction(direction);
+	}
+
 	if (figureCurrentDirection.isVertical()) {
 		if (x < figure->getX()) {
 			return Direction::LEFT;
@@ -168,6 +669,57 @@ Direction GameController::getDirectionToCoordinates(Figure* figure, unsigned int
     return figureCurrentDirection;
 }
 
+/**
+  * Ermittelt die Richtung, in die sich ein Geist gemaess seinem
+  * Verhalten bewegen muss. Die Ziele und ihre Abstandsfelder werden
+  * einmal je Takt fuer alle Geister gemeinsam berechnet, danach
+  * liest jeder Geist die Richtung am Feld seines Ziels ab. Nur wenn
+  * er schon am Ziel steht oder es nicht erreicht, hilft die Wegsuche.
+  * @param ghost Zu bewegender Geist.
+  * @param ghostCurrentDirection Aktuelle Bewegungsrichtung des Geistes.
+  * @return Einzuschlagende Richtung.
+  */
+Direction GameController::getDirectionToTarget(Ghost* ghost, Direction ghostCurrentDirection)
+{
+	updateTargeting();
+
+	const MazeGrid& maze = field->getMaze();
+	unsigned int cell = maze.getIndex(ghost->getX(), ghost->getY());
+	unsigned int direction = targeting.getDirectionToTarget(ghost->getPersonality(), cell);
+	if (direction != Direction::NONE) {
+		return Direction(direction);
+	}
+	unsigned int target = targeting.getTarget(ghost->getPersonality(), cell);
+	return getDirectionToCoordinates(ghost, maze.getX(target), maze.getY(target), ghostCurrentDirection);
+}
+
+
+/**
+  * Die Ziele der Geister fuer den aktuellen Takt berechnen, falls
+  * das in diesem Takt noch nicht geschehen ist. Der Flanker richtet
+  * sich nach dem ersten lebenden Verfolger. Im Modus Scatter stehen
+  * die Ziele seit dem Wechsel des Abschnitts fest.
+  */
+void GameController::updateTargeting() {
+	if (targeting.getMode() == Scatter || targetingTick == tickCount) {
+		return;
+	}
+	targetingTick = tickCount;
+
+	const MazeGrid& maze = field->getMaze();
+	unsigned int chaserCell = TargetingService::NONE;
+	for (std::vector<Ghost*>::iterator iter = ghosts.begin(); iter != ghosts.end(); ++iter) {
+		if ((*iter)->getPersonality() == Chaser && (*iter)->getState() == Alive) {
+			chaserCell = maze.getIndex((*iter)->getX(), (*iter)->getY());
+			break;
+		}
+	}
+
+	targeting.update(field->getBitboard(), maze.getIndex(pacman->getX(), pacman->getY()),
+					 pacman->getDirection().getValue(), chaserCell);
+}
+
+
 /**
   * Kann sich die Figur in die gewuenschte Richtung bewegen?
   * Befindet sich z.B. dort ein Rand?
@@ -181,19 +733,29 @@ bool GameController::canMove(Figure* figure, Direction& direction) const {
 
 
 /**
-  * Zeitablauf: Alle Figuren bewegen.
+  * Zeitablauf: Alle Figuren bewegen. Es kommen nur die Figuren an
+  * die Reihe, deren naechste Aktion laut Zeitrad in diesem Takt
+  * faellig ist, und zwar in derselben Reihenfolge wie im Vektor
+  * <code>figures</code>. Die Zaehler der uebrigen Figuren werden
+  * erst nachgefuehrt, wenn sie wieder handeln.
   */
 void GameController::nextTick() {
+	this->tickCount++;
+	updateHarmlessKey();
+	this->dueEntries.clear();
+	this->scheduler.advance(this->tickCount, this->dueEntries);
+	std::sort(this->dueEntries.begin(), this->dueEntries.end());
+
+	bool stateTimerExpired = !this->dueEntries.empty() && this->dueEntries.front() == STATE_TIMER;
+
 	if(this->state == Starting)
 	{
-		this->ticks--;
-		if(this->ticks == 0)
+		if(stateTimerExpired)
 			this->setState(Playing);
 	}
 	else if(this->state == LevelOver)
 	{
-		this->ticks--;
-		if(this->ticks == 0)
+		if(stateTimerExpired)
 		{
 			if(this->field->nextLevel())
 			{
@@ -207,49 +769,406 @@ void GameController::nextTick() {
 	}
 	else if(this->state == Playing)
 	{
-		if (ghostStateHarmless) {
-			if (--ghostHarmlessTicks <= 0) {
-				ghostStateHarmless = false;
-			}
-		}
+		this->figureCursor = 0;
+		this->dueIndex = 0;
+		runDueEntries();
+	}
 
-		for (std::vector<Figure*>::iterator iter = this->figures.begin(); iter != this->figures.end(); ++iter ) {
-			// Die Figur darf noch nicht tot sein.
-			Figure* figure = *iter;
-			if (figure->getState() != Dead) {
-				figure->nextTick();
-				handleCollisionWithPacman(figure);
-			}
+	if (hashVerification) {
+		verifyStateHash();
+	}
+}
+
+
+/**
+  * Die faelligen Kennungen des Taktes ab 'dueIndex' abarbeiten und
+  * danach Levelende und Tod von Pacman behandeln.
+  */
+void GameController::runDueEntries() {
+	for (; this->dueIndex < this->dueEntries.size(); ++this->dueIndex) {
+		unsigned int entry = this->dueEntries[ this->dueIndex ];
+		if (entry == HARMLESS_TIMER) {
+			// Die Geister werden wieder gefaehrlich und damit schneller.
+			synchronizeFigures();
+			ghostStateHarmless = false;
+			updateHarmlessKey();
+			resumeModeSchedule();
+			scheduleFigures();
+		}
+		else if (entry == MODE_TIMER) {
+			advanceModeSchedule();
+		}
+		else if (entry >= FIRST_FIGURE_ENTRY) {
+			tickFigure(entry - FIRST_FIGURE_ENTRY);
 		}
+	}
+	this->figureCursor = TimingWheel::NONE;
+
+	if(this->foodCount == 0)
+	{
+		this->setState(LevelOver);
+	}
 
-		if(this->foodCount == 0)
+	if(pacman->getState() == Dead)
+	{
+		--this->lives;
+		stateHash.setScalar(ZobristHash::Lives, lives);
+		if(this->lives == 0)
 		{
-			this->setState(LevelOver);
+			this->setState(GameOver);
 		}
-
-		if(pacman->getState() == Dead)
+		else
 		{
-			if(--this->lives == 0)
-			{
-				this->state = GameOver;
-			}
-			else
-			{
-				for (std::vector<Figure*>::iterator iter = this->figures.begin(); iter != this->figures.end(); ++iter ) {
-					// Die Figur darf noch nicht tot sein.
-					Figure* figure = *iter;
-					if (figure->getState() != Dead) {
-						figure->reset();
-					}
+			// Zuerst anhalten, damit die Zaehler noch zum alten
+			// Zustand der Figuren nachgefuehrt werden.
+			this->setState(Starting);
+			for (std::vector<Figure*>::iterator iter = this->figures.begin(); iter != this->figures.end(); ++iter ) {
+				// Die Figur darf noch nicht tot sein.
+				Figure* figure = *iter;
+				if (figure->getState() != Dead) {
+					resetFigure(figure);
 				}
-				pacman->reset();
-				this->setState(Starting);
 			}
+			resetFigure(pacman);
 		}
 	}
 }
 
 
+/**
+  * Schnellvorlauf fuer Laeufe ohne Fenster: Alle Takte, in denen
+  * weder eine Figur handelt noch ein Zaehler ablaeuft, werden
+  * uebersprungen und der naechste Takt mit einem solchen Ereignis
+  * wird ausgefuehrt. In den uebersprungenen Takten haette nextTick()
+  * nur den Zeittakt erhoeht, da alle anderen Zaehler erst bei der
+  * naechsten Aktion nachgefuehrt werden.
+  * @param maxTicks Hoechstens so viele Takte weiterschalten. Liegt das
+  *                 naechste Ereignis spaeter, wird nur vorgespult.
+  * @return Anzahl vergangener Takte (inkl. des ausgefuehrten).
+  */
+unsigned int GameController::advanceUntilNextEvent(unsigned int maxTicks) {
+	if (maxTicks == 0) {
+		return 0;
+	}
+
+	// Ohne Termine (Spielende) gibt es nichts zu ueberspringen.
+	unsigned int next = scheduler.getNextDueTick();
+	if (next == TimingWheel::NONE) {
+		nextTick();
+		return 1;
+	}
+
+	unsigned int idle = next - tickCount - 1;
+	if (idle >= maxTicks) {
+		tickCount += maxTicks;
+		updateHarmlessKey();
+		if (hashVerification) {
+			verifyStateHash();
+		}
+		return maxTicks;
+	}
+
+	tickCount += idle;
+	nextTick();
+	return idle + 1;
+}
+
+
+/**
+  * Den Spielstand eines anderen Controllers uebernehmen. Die Ziele
+  * der Geister werden im naechsten Takt neu berechnet.
+  * @param other Controller mit dem zu kopierenden Stand.
+  */
+void GameController::copyStateFrom(const GameController& other) {
+	assert(figures.size() == other.figures.size());
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		figures[ index ]->copyStateFrom(*other.figures[ index ]);
+	}
+
+	ghostStateHarmless = other.ghostStateHarmless;
+	ghostHarmlessTicks = other.ghostHarmlessTicks;
+	ghostHarmlessEnd = other.ghostHarmlessEnd;
+	ghostMode = other.ghostMode;
+	modePhase = other.modePhase;
+	modeTicks = other.modeTicks;
+	modeEnd = other.modeEnd;
+	modeRunning = other.modeRunning;
+	targeting.setMode(other.targeting.getMode());
+	targetingTick = TimingWheel::NONE;
+	agentDeciding = other.agentDeciding;
+	ghostPlayerDirection = other.ghostPlayerDirection;
+	turnBufferTicks = other.turnBufferTicks;
+	corridorSteps = other.corridorSteps;
+	corridorEdge = other.corridorEdge;
+	corridorStop = other.corridorStop;
+	points = other.points;
+	foodCount = other.foodCount;
+	lives = other.lives;
+	tickCount = other.tickCount;
+	scheduler = other.scheduler;
+	figureTicks = other.figureTicks;
+	dueEntries = other.dueEntries;
+	dueIndex = other.dueIndex;
+	figureCursor = other.figureCursor;
+	state = other.state;
+	stateHash = other.stateHash;
+	randomState = other.randomState;
+}
+
+
+/**
+  * Den ganzen Spielstand ausser den Zellen lesbar schreiben, eine
+  * Zeile je Gruppe und je Figur. Er umfasst alles, was copyStateFrom()
+  * uebernimmt, damit zwei auseinandergelaufene Prozesse auch dann
+  * verschiedene Ausgaben liefern, wenn sich nur der Zufallsgenerator
+  * oder ein Zaehler unterscheidet.
+  * @param out Ziel der Ausgabe.
+  */
+void GameController::writeState(std::ostream& out) const {
+	out << "tick " << tickCount << " state " << (unsigned int) state << " points " << points
+		<< " food " << foodCount << " lives " << lives << std::endl;
+	out << std::hex << "hash " << stateHash.getValue() << " random " << randomState << std::dec << std::endl;
+	out << "harmless " << (ghostStateHarmless ? 1 : 0) << " ticks " << ghostHarmlessTicks
+		<< " end " << ghostHarmlessEnd << std::endl;
+	out << "mode " << (unsigned int) ghostMode << " phase " << modePhase << " ticks " << modeTicks
+		<< " end " << modeEnd << (modeRunning ? " running" : "") << std::endl;
+	out << "timers state " << scheduler.getDueTick(STATE_TIMER) << " harmless " << scheduler.getDueTick(HARMLESS_TIMER)
+		<< " mode " << scheduler.getDueTick(MODE_TIMER) << std::endl;
+	out << "ghost player " << ghostPlayerDirection.getValue() << " corridor edge " << corridorEdge
+		<< " stop " << corridorStop << std::endl;
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		out << "figure " << index << " ";
+		figures[ index ]->writeState(out);
+		out << " ticked " << figureTicks[ index ] << " due " << scheduler.getDueTick(FIRST_FIGURE_ENTRY + index) << std::endl;
+	}
+}
+
+
+/**
+  * Einen mitten in der Entscheidung des automatischen Spielers
+  * kopierten Takt fortsetzen. Das entspricht dem Rest von
+  * tickFigure() fuer Pacman und dem Rest von nextTick().
+  * @param direction Richtung fuer Pacmans Schritt.
+  */
+void GameController::resumeTick(Direction direction) {
+	assert(agentDeciding);
+	agentDeciding = false;
+	pacman->keyPressed(direction);
+	finishFigureTick(figureCursor - 1);
+	++dueIndex;
+	runDueEntries();
+}
+
+
+/**
+  * Steht der Takt gerade bei der Entscheidung des automatischen
+  * Spielers?
+  * @return <code>true</code>, wenn resumeTick() erwartet wird.
+  */
+bool GameController::isAgentDeciding() const {
+	return agentDeciding;
+}
+
+
+/**
+  * Laufenden Zeittakt auslesen.
+  * @return Anzahl bisheriger Aufrufe von nextTick() (inkl. der
+  *         uebersprungenen Takte).
+  */
+unsigned int GameController::getTickCount() const {
+	return tickCount;
+}
+
+
+/**
+  * Eine Figur im aktuellen Takt handeln lassen. Die Takte seit
+  * ihrer letzten Aktion werden dabei nachgeholt.
+  * @param index Index der Figur.
+  */
+void GameController::tickFigure(unsigned int index) {
+	Figure* figure = figures[ index ];
+	figureCursor = index + 1;
+
+	// Die Figur darf noch nicht tot sein.
+	if (figure->getState() == Dead) {
+		return;
+	}
+
+	assert(tickCount > figureTicks[ index ]);
+	figure->skipTicks(tickCount - figureTicks[ index ] - 1);
+	figureTicks[ index ] = tickCount;
+
+	// Pacman ist nur an der Reihe, wenn er einen Schritt macht: Das
+	// ist der Moment, in dem der automatische Spieler entscheidet. Im
+	// Makroschritt steht der Schritt schon fest.
+	if (figure == pacman && pacmanAgent != 0 && pacman->getState() == Alive && pacman->getCellsAhead() == 0) {
+		agentDeciding = true;
+		pacman->keyPressed(pacmanAgent->decide(GameView(field, this)));
+		agentDeciding = false;
+	}
+
+	finishFigureTick(index);
+}
+
+
+/**
+  * Den Zug einer Figur ausfuehren, deren Zaehler bereits auf den
+  * aktuellen Takt gebracht sind, und sie neu einplanen.
+  * @param index Index der Figur.
+  */
+void GameController::finishFigureTick(unsigned int index) {
+	Figure* figure = figures[ index ];
+	figure->nextTick();
+	handleCollisionWithPacman(figure);
+
+	// Ist Pacman gerade gestorben, pruefen alle folgenden Figuren in
+	// diesem Takt noch auf Kollision mit ihm.
+	if (figure == pacman && pacman->getState() == Dead) {
+		for (unsigned int other = index + 1; other < figures.size(); ++other) {
+			if (figures[ other ]->getState() != Dead) {
+				addDueEntry(FIRST_FIGURE_ENTRY + other);
+			}
+		}
+	}
+
+	scheduleFigure(index);
+}
+
+
+/**
+  * Die naechste Aktion einer Figur anhand ihrer nachgefuehrten
+  * Zaehler im Zeitrad eintragen. Ist sie noch im aktuellen Takt
+  * faellig, kommt sie in diesem Takt noch an die Reihe.
+  * @param index Index der Figur.
+  */
+void GameController::scheduleFigure(unsigned int index) {
+	if (state != Playing) {
+		return;
+	}
+
+	unsigned int entry = FIRST_FIGURE_ENTRY + index;
+	unsigned int wait = figures[ index ]->getTicksUntilAction();
+	if (wait == Figure::NEVER) {
+		scheduler.cancel(entry);
+		return;
+	}
+
+	unsigned int due = figureTicks[ index ] + wait;
+	if (due <= tickCount) {
+		scheduler.cancel(entry);
+		addDueEntry(entry);
+	}
+	else {
+		scheduler.schedule(entry, due);
+	}
+}
+
+
+/**
+  * Alle Figuren neu einplanen.
+  */
+void GameController::scheduleFigures() {
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		scheduleFigure(index);
+	}
+}
+
+
+/**
+  * Die Zaehler einer Figur auf den aktuellen Takt bringen. Figuren,
+  * die in diesem Takt noch nicht an der Reihe waren, werden bis
+  * zum vorherigen Takt nachgefuehrt. Das muss geschehen, bevor sich
+  * Zustand oder Geschwindigkeit der Figur von aussen aendern.
+  * @param index Index der Figur.
+  */
+void GameController::synchronizeFigure(unsigned int index) {
+	if (state != Playing) {
+		return;
+	}
+
+	unsigned int synchronized = (index < figureCursor) ? tickCount : tickCount - 1;
+	if (synchronized > figureTicks[ index ]) {
+		figures[ index ]->skipTicks(synchronized - figureTicks[ index ]);
+		figureTicks[ index ] = synchronized;
+	}
+}
+
+
+/**
+  * Die Zaehler aller Figuren auf den aktuellen Takt bringen, z.B.
+  * damit ihre Animationen korrekt gezeichnet werden.
+  */
+void GameController::synchronizeFigures() {
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		synchronizeFigure(index);
+	}
+}
+
+
+/**
+  * Index einer Figur im Vektor <code>figures</code> ermitteln. Die
+  * Figur kennt ihn seit addFigure().
+  * @param figure Gesuchte Figur.
+  * @return Index der Figur.
+  */
+unsigned int GameController::getFigureIndex(Figure* figure) const {
+	assert(figure->getIndex() < figures.size() && figures[ figure->getIndex() ] == figure);
+	return figure->getIndex();
+}
+
+
+/**
+  * Eine Kennung im aktuellen Takt noch nachtraeglich faellig machen.
+  * Sie wird passend zu ihrer Reihenfolge hinter der gerade
+  * bearbeiteten Kennung einsortiert.
+  * @param entry Kennung im Zeitrad.
+  */
+void GameController::addDueEntry(unsigned int entry) {
+	assert(figureCursor != TimingWheel::NONE);
+	std::vector<unsigned int>::iterator position =
+		std::lower_bound(dueEntries.begin() + dueIndex + 1, dueEntries.end(), entry);
+	if (position == dueEntries.end() || *position != entry) {
+		dueEntries.insert(position, entry);
+	}
+}
+
+
+/**
+  * Das Spiel wird unterbrochen: Alle Zaehler festhalten und
+  * die Figuren aus dem Zeitrad nehmen. Der Zeitplan der Modi ruht.
+  */
+void GameController::suspendFigures() {
+	synchronizeFigures();
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		scheduler.cancel(FIRST_FIGURE_ENTRY + index);
+	}
+
+	if (ghostStateHarmless) {
+		ghostHarmlessTicks = ghostHarmlessEnd - tickCount;
+	}
+	scheduler.cancel(HARMLESS_TIMER);
+	pauseModeSchedule();
+}
+
+
+/**
+  * Das Spiel geht (wieder) los: Alle Figuren, die harmlose
+  * Phase und den Zeitplan der Modi ab dem aktuellen Takt einplanen.
+  */
+void GameController::resumeFigures() {
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		figureTicks[ index ] = tickCount;
+	}
+	scheduleFigures();
+
+	if (ghostStateHarmless) {
+		ghostHarmlessEnd = tickCount + ghostHarmlessTicks;
+		scheduler.schedule(HARMLESS_TIMER, ghostHarmlessEnd);
+	}
+	resumeModeSchedule();
+}
+
+
 /**
   * Eine Taste wurde gedrueckt, um die Figur in eine bestimmte
   * Richtung zu schicken. 
@@ -260,17 +1179,89 @@ void GameController::keyPressed(Direction direction) {
 	handleCollisionWithPacman(pacman);
 }
 
+
+/**
+  * Der zweite Spieler haelt eine Richtung fuer seinen Geist.
+  * @param direction Gehaltene Richtung, NONE beim Loslassen.
+  */
+void GameController::ghostKeyPressed(Direction direction) {
+	ghostPlayerDirection = direction;
+}
+
+
+/**
+  * Vom zweiten Spieler gehaltene Richtung auslesen.
+  * @return Richtung oder NONE.
+  */
+Direction GameController::getGhostPlayerDirection() const {
+	return ghostPlayerDirection;
+}
+
+
+/**
+  * Gueltigkeit eines Richtungswunsches fuer Pacman festlegen.
+  * @param ticks Takte.
+  */
+void GameController::setTurnBuffer(unsigned int ticks) {
+	turnBufferTicks = ticks;
+}
+
+
+/**
+  * Gueltigkeit eines Richtungswunsches auslesen.
+  * @return Takte.
+  */
+unsigned int GameController::getTurnBuffer() const {
+	return turnBufferTicks;
+}
+
+
+/**
+  * Makroschritte fuer Laeufe ohne Fenster ein- oder ausschalten.
+  * @param enabled <code>true</code> zum Einschalten.
+  */
+void GameController::setCorridorSteps(bool enabled) {
+	corridorSteps = enabled;
+}
+
+
+/**
+  * Sind Makroschritte eingeschaltet?
+  * @return <code>true</code>, wenn Pacman Korridore in einem Zug laeuft.
+  */
+bool GameController::getCorridorSteps() const {
+	return corridorSteps;
+}
+
+
+/**
+  * Verteilung der Verzoegerung bis zum Abbiegen anmelden.
+  * @param statistics Verteilung oder 0.
+  */
+void GameController::setTurnStatistics(TurnStatistics* statistics) {
+	turnStatistics = statistics;
+}
+
+
+/**
+  * Angemeldete Verteilung auslesen.
+  * @return Verteilung oder 0.
+  */
+TurnStatistics* GameController::getTurnStatistics() const {
+	return turnStatistics;
+}
+
 	
 /**
   * Auf Kollisionen untersuchen: Hat die uebergebene Figur dieselbe
-  * Koordinate wie Pacman? Dann wird bei dieser Figur die
+  * Koordinate wie Pacman oder mit ihm die Zellen getauscht? Dann wird bei dieser Figur die
   * Kollisionsbehandlung ausgeloest und Pacman uebergeben.
   * @param figure Zu untersuchende Figur.
   */
 void GameController::handleCollisionWithPacman(Figure* figure) {
 	// Wurde eine andere Figur als Pacman bewegt?
 	if (figure != pacman) {
-		if (pacman->isCollisionWith(figure)) {
+		if (isCollisionWithPacman(figure)) {
 			figure->handleCollisionWith(pacman);
 		}
 	}
@@ -286,6 +1277,28 @@ void GameController::handleCollisionWithPacman(Figure* figure) {
 }
 
 
+/**
+  * Kollidiert eine Figur mit Pacman? Ist er im Makroschritt noch
+  * 'ahead' Zellen voraus, steht er logisch 'ahead' Schritte vor dem
+  * Ende des Korridors, und die Figur trifft ihn dort oder auf der
+  * Kante davor.
+  * @param figure Zu untersuchende Figur.
+  * @return <code>true</code>, falls sie mit Pacman kollidiert.
+  */
+bool GameController::isCollisionWithPacman(Figure* figure) const {
+	unsigned int ahead = pacman->getCellsAhead();
+	if (ahead == 0) {
+		return pacman->isCollisionWith(figure);
+	}
+
+	const MazeGrid& maze = field->getMaze();
+	const JunctionGraph& junctions = field->getJunctionGraph();
+	unsigned int cell = junctions.getCellOnEdge(corridorEdge, corridorStop - ahead);
+	unsigned int previous = junctions.getCellOnEdge(corridorEdge, corridorStop - ahead - 1);
+	return figure->isCollisionAt(maze.getX(cell), maze.getY(cell), maze.getX(previous), maze.getY(previous));
+}
+
+
 /**
   * Ein Geist ist mit Pacman kollidiert. Daraufhin
   * soll Pacman als tot markiert werden, wenn der
@@ -295,12 +1308,19 @@ void GameController::handleCollisionWithPacman(Figure* figure) {
 void GameController::collisionOfPacmanWith(Ghost* ghost) {
 	if(ghost->getState() != Alive) return;
 
+	// Die betroffene Figur wird mit neuem Zustand neu eingeplant.
 	if (ghostStateHarmless) {
+		unsigned int index = getFigureIndex(ghost);
+		synchronizeFigure(index);
 		ghost->setState(Dying);
-		points += DEAD_GHOST_POINTS;
+		scheduleFigure(index);
+		addPoints(DEAD_GHOST_POINTS);
 	}
 	else {
+		unsigned int index = getFigureIndex(pacman);
+		synchronizeFigure(index);
 		pacman->setState(Dying);
+		scheduleFigure(index);
 	}
 }
 
@@ -312,10 +1332,18 @@ void GameController::collisionOfPacmanWith(Ghost* ghost) {
   * @param pill Pille, mit der Pacman kollidiert ist.
   */
 void GameController::collisionOfPacmanWith(Pill* pill) {
-	points += PILL_POINTS;
+	addPoints(PILL_POINTS);
+
+	// Die Geister werden langsamer und muessen neu eingeplant werden.
+	synchronizeFigures();
+	pauseModeSchedule();
 	ghostStateHarmless = true;
 	ghostHarmlessTicks = GHOSTS_HARMLESS_TICKS;
+	ghostHarmlessEnd = tickCount + GHOSTS_HARMLESS_TICKS;
+	scheduler.schedule(HARMLESS_TIMER, ghostHarmlessEnd);
+	updateHarmlessKey();
 	pill->setState(Dead);
+	scheduleFigures();
 }
 
 /**
@@ -325,7 +1353,7 @@ void GameController::collisionOfPacmanWith(Pill* pill) {
   * @param cherry Kirsche, mit der Pacman kollidiert ist.
   */
 void GameController::collisionOfPacmanWith(Cherry* cherry) {
-	points += CHERRY_POINTS;
+	addPoints(CHERRY_POINTS);
 	cherry->setState(Dead);
 }
 
@@ -338,6 +1366,15 @@ unsigned int GameController::getPoints() const {
 }
 
 
+/**
+  * Anzahl verbleibender Essensportionen auslesen.
+  * @return Anzahl Essensportionen.
+  */
+unsigned int GameController::getFoodCount() const {
+	return foodCount;
+}
+
+
 /**
   * Ist das Spiel zuende? Es ist dann vorueber, wenn
   * entweder Pacman tot ist oder aber das ganze
@@ -349,12 +1386,21 @@ unsigned int GameController::getPoints() const {
 }*/
 void GameController::setState(GameState state)
 {
+	// Beim Verlassen des Spiels werden die Figuren angehalten.
+	if(this->state == Playing && state != Playing)
+		suspendFigures();
+
 	this->state = state;
+	this->stateHash.setScalar(ZobristHash::State, state);
+	this->scheduler.cancel(STATE_TIMER);
 	if(this->state == Starting) 
-		this->ticks = STARTING_TICKS;
+		this->scheduler.schedule(STATE_TIMER, tickCount + STARTING_TICKS);
 
 	if(this->state == LevelOver)
-		this->ticks = LEVELCHANGE_TICKS;
+		this->scheduler.schedule(STATE_TIMER, tickCount + LEVELCHANGE_TICKS);
+
+	if(this->state == Playing)
+		resumeFigures();
 }
 
 GameState GameController::getState()
@@ -1,7 +1,11 @@
 #ifndef GAMECONTROLLER_H
 #define GAMECONTROLLER_H
 
+#include <ostream>
 #include <vector>
+#include "targeting_service.hpp"
+#include "timing_wheel.hpp"
+#include "zobrist_hash.hpp"
 
 class Direction;
 class Pacman;
@@ -10,6 +14,8 @@ class Cherry;
 class Pill;
 class Ghost;
 class Figure;
+class PacmanAgent;
+class TurnStatistics;
 
 
 enum GameState { Starting = 0, Playing, LevelOver, GameOver };
@@ -37,6 +43,9 @@ public:
 
 	static const unsigned int LEVELCHANGE_TICKS = 70;
 
+	// Startwert des Zufallsgenerators, solange keiner festgelegt wurde
+	static const unsigned int DEFAULT_SEED = 1;
+
 private:
 	// Zeiger auf das Spielfeld mit den Figuren.
 	Field* field;
@@ -45,10 +54,30 @@ private:
 	// ansonsten <code>false</code>.
 	bool ghostStateHarmless;
 
-	// Rueckwaertslaufender Zaehler fuer die Anzahl Zeittakte,
-	// die die Geister noch harmlos sind.
+	// Anzahl Zeittakte, die die Geister noch harmlos sind. Waehrend
+	// des Spiels gilt stattdessen 'ghostHarmlessEnd', der Wert wird
+	// nur fuer die Pausen (Start, Levelwechsel) festgehalten.
 	unsigned int ghostHarmlessTicks;
 
+	// Zeittakt, zu dem die Geister wieder gefaehrlich werden.
+	unsigned int ghostHarmlessEnd;
+
+	// Modus laut Zeitplan (Scatter oder Chase) und Index des
+	// laufenden Abschnitts im Zeitplan des Levels.
+	GhostMode ghostMode;
+	unsigned int modePhase;
+
+	// Restdauer des Abschnitts, solange der Zeitplan ruht (harmlose
+	// Geister, Start, Levelwechsel), oder TimingWheel::NONE, wenn
+	// der Abschnitt nicht endet.
+	unsigned int modeTicks;
+
+	// Zeittakt, zu dem der Abschnitt endet, solange er laeuft.
+	unsigned int modeEnd;
+
+	// <code>true</code>, wenn das Ende des Abschnitts im Zeitrad steht.
+	bool modeRunning;
+
 	// Vektor mit allen Figuren (inkl. Pacman) auf dem Spielfeld.
 	std::vector<Figure*> figures;
 
@@ -56,6 +85,64 @@ private:
 	// im Vektor <code>figures</code> abgelegt.
 	Pacman* pacman;
 
+	// Alle Geister. Die Zeiger sind auch im Vektor
+	// <code>figures</code> abgelegt.
+	std::vector<Ghost*> ghosts;
+
+	// Alle Pillen und Kirschen. Die Zeiger sind auch im Vektor
+	// <code>figures</code> abgelegt.
+	std::vector<Pill*> pills;
+	std::vector<Cherry*> cherries;
+
+	// Gemeinsame Ziele aller Geister
+	TargetingService targeting;
+
+	// Automatischer Spieler, der Pacman steuert, oder 0. Er gehoert
+	// nicht dem Controller.
+	PacmanAgent* pacmanAgent;
+
+	// <code>true</code>, solange der Spieler mitten im Takt ueber
+	// Pacmans naechsten Schritt entscheidet.
+	bool agentDeciding;
+
+	// Vom zweiten Spieler gehaltene Richtung des Geistes mit der
+	// Strategie PlayerGhosts, NONE, solange keine Taste gedrueckt ist
+	Direction ghostPlayerDirection;
+
+	// So viele Takte bleibt ein Richtungswunsch fuer Pacman gueltig,
+	// der noch nicht ausfuehrbar ist (siehe Pacman::keyPressed())
+	unsigned int turnBufferTicks;
+
+	// Laeuft Pacman in Laeufen ohne Fenster jeden Korridor in einem
+	// Makroschritt (siehe setCorridorSteps())?
+	bool corridorSteps;
+
+	// Kante und Endschritt des letzten Makroschrittes von Pacman. Solange
+	// er Zellen voraus ist, steht er logisch noch auf dieser Kante.
+	unsigned int corridorEdge;
+	unsigned int corridorStop;
+
+	// Verteilung der Verzoegerung bis zum Abbiegen oder 0. Sie
+	// gehoert nicht dem Controller und wird nicht mitkopiert.
+	TurnStatistics* turnStatistics;
+
+	// Inkrementell nachgefuehrter Hash des Spielstandes
+	ZobristHash stateHash;
+
+	// Zustand des Zufallsgenerators (xorshift). Er gehoert zum
+	// Spielstand, damit Kopien und Wiederholungen gleich verlaufen.
+	boost::uint32_t randomState;
+
+	// <code>true</code>, wenn der Hash nach jedem Takt mit einer
+	// vollstaendigen Neuberechnung verglichen wird, und Anzahl der
+	// dabei gefundenen Abweichungen.
+	bool hashVerification;
+	unsigned int hashMismatches;
+
+	// Zeittakt, fuer den die Ziele berechnet wurden, oder
+	// TimingWheel::NONE, wenn sie neu berechnet werden muessen.
+	unsigned int targetingTick;
+
 	// Aktuelle Punktzahl des Spielers.
 	unsigned int points;
 
@@ -66,22 +153,175 @@ private:
 	// Anzahl an "Leben" des Pacmans
 	unsigned int lives;
 
-	// Ticks, wird zum Starten bzw Levelwechselbergang verwendet
-	unsigned int ticks;
+	// Laufender Zeittakt, wird bei jedem Aufruf von nextTick() erhoeht.
+	unsigned int tickCount;
+
+	// Kennungen im Zeitrad: Ende des Start- bzw. Levelwechseluebergangs,
+	// Ende der harmlosen Phase, Ende des Abschnitts im Zeitplan der
+	// Modi, danach eine Kennung je Figur.
+	enum { STATE_TIMER = 0, HARMLESS_TIMER, MODE_TIMER, FIRST_FIGURE_ENTRY };
+
+	// Zeitrad mit den naechsten Aktionen aller Figuren und den
+	// Ablaufzeitpunkten der Zaehler.
+	TimingWheel scheduler;
+
+	// Fuer jede Figur der Zeittakt, bis zu dem ihre Zaehler
+	// nachgefuehrt sind.
+	std::vector<unsigned int> figureTicks;
+
+	// Die im aktuellen Takt faelligen Kennungen (aufsteigend sortiert)
+	// und die Position der gerade bearbeiteten.
+	std::vector<unsigned int> dueEntries;
+	unsigned int dueIndex;
+
+	// Alle Figuren mit kleinerem Index sind im aktuellen Takt bereits
+	// an der Reihe gewesen.
+	unsigned int figureCursor;
 
 	/**
-	  * Auf Kollisionen untersuchen: Hat die uebergebene Figur dieselbe
-	  * Koordinate wie Pacman? Dann wird bei dieser Figur die
-	  * Kollisionsbehandlung ausgeloest und Pacman uebergeben.
-	  * @param figure Zu untersuchende Figur.
+	  * Pacman frisst das Essen in einer Zelle, falls noch vorhanden.
+	  * @param x X-Koordinate der Zelle.
+	  * @param y Y-Koordinate der Zelle.
 	  */
-	void handleCollisionWithPacman(Figure* figure);
+	void eatFood(unsigned int x, unsigned int y);
+
+	/**
+	  * Punkte gutschreiben.
+	  * @param bonus Zusaetzliche Punkte.
+	  */
+	void addPoints(unsigned int bonus);
+
+	/**
+	  * Eine Figur in eine Zelle setzen und den Hash nachfuehren.
+	  * @param figure Zu setzende Figur.
+	  * @param x      X-Koordinate der Zelle.
+	  * @param y      Y-Koordinate der Zelle.
+	  */
+	void placeFigure(Figure* figure, unsigned int x, unsigned int y);
+
+	/**
+	  * Eine Figur auf ihre Startzelle zuruecksetzen und den Hash
+	  * nachfuehren.
+	  * @param figure Zurueckzusetzende Figur.
+	  */
+	void resetFigure(Figure* figure);
+
+	/**
+	  * Die Restdauer der harmlosen Phase im Hash nachfuehren. Sie
+	  * aendert sich waehrend der Phase mit jedem Takt.
+	  */
+	void updateHarmlessKey();
+
+	/**
+	  * Den Hash des aktuellen Spielstandes vollstaendig berechnen.
+	  * @param hash Erhaelt den Hash.
+	  */
+	void buildStateHash(ZobristHash& hash) const;
+
+	/**
+	  * Den nachgefuehrten Hash mit einer vollstaendigen Berechnung
+	  * vergleichen. Eine Abweichung wird gezaehlt und korrigiert.
+	  */
+	void verifyStateHash();
+
+	/**
+	  * Die Ziele der Geister fuer den aktuellen Takt berechnen, falls
+	  * das in diesem Takt noch nicht geschehen ist.
+	  */
+	void updateTargeting();
+
+	/**
+	  * Den Zeitplan der Modi fuer das aktuelle Level von vorn beginnen.
+	  */
+	void startModeSchedule();
+
+	/**
+	  * Zum naechsten Abschnitt des Zeitplans wechseln.
+	  */
+	void advanceModeSchedule();
+
+	/**
+	  * Den Zeitplan anhalten und die Restdauer des Abschnitts festhalten.
+	  */
+	void pauseModeSchedule();
+
+	/**
+	  * Den Zeitplan fortsetzen, sofern gespielt wird und die Geister
+	  * nicht harmlos sind.
+	  */
+	void resumeModeSchedule();
 
 	// Aktueller Zustand des Spiels
 	GameState state;
 
 	void setState(GameState state);
 
+	/**
+	  * Eine Figur im aktuellen Takt handeln lassen. Die Takte seit
+	  * ihrer letzten Aktion werden dabei nachgeholt.
+	  * @param index Index der Figur.
+	  */
+	void tickFigure(unsigned int index);
+
+	/**
+	  * Den Zug einer Figur ausfuehren, deren Zaehler bereits auf den
+	  * aktuellen Takt gebracht sind, und sie neu einplanen.
+	  * @param index Index der Figur.
+	  */
+	void finishFigureTick(unsigned int index);
+
+	/**
+	  * Die faelligen Kennungen des Taktes ab 'dueIndex' abarbeiten und
+	  * danach Levelende und Tod von Pacman behandeln.
+	  */
+	void runDueEntries();
+
+	/**
+	  * Die naechste Aktion einer Figur anhand ihrer nachgefuehrten
+	  * Zaehler im Zeitrad eintragen.
+	  * @param index Index der Figur.
+	  */
+	void scheduleFigure(unsigned int index);
+
+	/**
+	  * Alle Figuren neu einplanen.
+	  */
+	void scheduleFigures();
+
+	/**
+	  * Die Zaehler einer Figur auf den aktuellen Takt bringen. Figuren,
+	  * die in diesem Takt noch nicht an der Reihe waren, werden bis
+	  * zum vorherigen Takt nachgefuehrt. Das muss geschehen, bevor sich
+	  * Zustand oder Geschwindigkeit der Figur von aussen aendern.
+	  * @param index Index der Figur.
+	  */
+	void synchronizeFigure(unsigned int index);
+
+	/**
+	  * Index einer Figur im Vektor <code>figures</code> ermitteln.
+	  * @param figure Gesuchte Figur.
+	  * @return Index der Figur.
+	  */
+	unsigned int getFigureIndex(Figure* figure) const;
+
+	/**
+	  * Eine Kennung im aktuellen Takt noch nachtraeglich faellig machen.
+	  * @param entry Kennung im Zeitrad.
+	  */
+	void addDueEntry(unsigned int entry);
+
+	/**
+	  * Das Spiel wird unterbrochen: Alle Zaehler festhalten und
+	  * die Figuren aus dem Zeitrad nehmen. Der Zeitplan der Modi ruht.
+	  */
+	void suspendFigures();
+
+	/**
+	  * Das Spiel geht (wieder) los: Alle Figuren, die harmlose
+	  * Phase und den Zeitplan der Modi ab dem aktuellen Takt einplanen.
+	  */
+	void resumeFigures();
+
 public:
 	/**
 	  * Einen neuen Spielecontroller erzeugen.
@@ -103,6 +343,58 @@ public:
 	  */
 	void addFigure(Figure* figure);
 
+	/**
+	  * Pacman auslesen.
+	  * @return Zeiger auf die Pacman-Figur.
+	  */
+	Pacman* getPacman() const;
+
+	/**
+	  * Alle Geister auslesen.
+	  * @return Referenz auf einen Vektor mit allen Geistern.
+	  */
+	const std::vector<Ghost*>& getGhosts() const;
+
+	/**
+	  * Alle Pillen auslesen (auch gefressene).
+	  * @return Referenz auf einen Vektor mit allen Pillen.
+	  */
+	const std::vector<Pill*>& getPills() const;
+
+	/**
+	  * Alle Kirschen auslesen (auch gefressene).
+	  * @return Referenz auf einen Vektor mit allen Kirschen.
+	  */
+	const std::vector<Cherry*>& getCherries() const;
+
+	/**
+	  * Einen automatischen Spieler anmelden, der ab jetzt immer dann
+	  * nach der Richtung gefragt wird, wenn Pacman einen Schritt macht.
+	  * Tastendruecke werden dann ueberstimmt.
+	  * @param agent Spieler oder 0 fuer die Steuerung per Tastatur.
+	  */
+	void setPacmanAgent(PacmanAgent* agent);
+
+	/**
+	  * Angemeldeten automatischen Spieler auslesen.
+	  * @return Spieler oder 0.
+	  */
+	PacmanAgent* getPacmanAgent() const;
+
+	/**
+	  * Zufallsgenerator des Spiels neu starten. Jedes Spiel hat einen
+	  * eigenen Generator, gleiche Startwerte ergeben bei gleichen
+	  * Eingaben denselben Spielverlauf.
+	  * @param seed Startwert.
+	  */
+	void setRandomSeed(unsigned int seed);
+
+	/**
+	  * Naechste Zufallszahl des Spiels, z.B. fuer die Geister.
+	  * @return Zufallszahl.
+	  */
+	unsigned int random();
+
 	/**
 	  * Anzahl Essenspotionen im Spielfeld uebergeben.
 	  * @param foodCount Anzahl Essensportionen.
@@ -124,6 +416,80 @@ public:
 	  */
 	void setPacman(Pacman* pacman);
 
+	/**
+	  * Einen Geist am Controller anmelden. Er wird wie jede andere
+	  * Figur hinzugefuegt und zusaetzlich fuer die Zielermittlung
+	  * vermerkt.
+	  * @param ghost Zeiger auf den Geist.
+	  */
+	void addGhost(Ghost* ghost);
+
+	/**
+	  * Eine Pille am Controller anmelden. Sie wird wie jede andere
+	  * Figur hinzugefuegt und zusaetzlich als Pille vermerkt.
+	  * @param pill Zeiger auf die Pille.
+	  */
+	void addPill(Pill* pill);
+
+	/**
+	  * Eine Kirsche am Controller anmelden. Sie wird wie jede andere
+	  * Figur hinzugefuegt und zusaetzlich als Kirsche vermerkt.
+	  * @param cherry Zeiger auf die Kirsche.
+	  */
+	void addCherry(Cherry* cherry);
+
+	/**
+	  * Die Zielermittlung fuer das fertig aufgebaute Spielfeld
+	  * vorbereiten. Wird nach jedem Aufbau eines Levels aufgerufen.
+	  */
+	void prepareTargeting();
+
+	/**
+	  * Den Hash fuer das fertig aufgebaute Spielfeld vollstaendig
+	  * berechnen. Danach wird er bei jeder Aenderung nachgefuehrt.
+	  */
+	void prepareStateHash();
+
+	/**
+	  * Eine Figur meldet die Aenderung ihres Zustands, damit der Hash
+	  * nachgefuehrt wird.
+	  * @param figure   Betroffene Figur mit dem neuen Zustand.
+	  * @param oldState Bisheriger Zustand.
+	  */
+	void figureStateChanged(Figure* figure, FigureState oldState);
+
+	/**
+	  * 64-Bit-Hash des Spielstandes auslesen, z.B. fuer
+	  * Transpositionstabellen, zum Erkennen auseinanderlaufender
+	  * Spiele oder zum Pruefen von Wiederholungen. Er umfasst Zelle
+	  * und Zustand aller Figuren, das Essen, Punkte, Leben, Restdauer
+	  * der harmlosen Phase, Modus und Spielzustand, nicht aber den
+	  * Zeittakt.
+	  * @return Hash.
+	  */
+	boost::uint64_t getStateHash() const;
+
+	/**
+	  * Den Hash des Spielstandes ohne den nachgefuehrten Wert neu
+	  * berechnen.
+	  * @return Hash.
+	  */
+	boost::uint64_t computeStateHash() const;
+
+	/**
+	  * Pruefmodus ein- oder ausschalten: Nach jedem Takt wird der
+	  * nachgefuehrte Hash mit einer vollstaendigen Berechnung
+	  * verglichen.
+	  * @param enabled <code>true</code> zum Einschalten.
+	  */
+	void setHashVerification(bool enabled);
+
+	/**
+	  * Anzahl der im Pruefmodus gefundenen Abweichungen auslesen.
+	  * @return Anzahl Abweichungen.
+	  */
+	unsigned int getHashMismatches() const;
+
 	/**
 	  * Sind die Geister harmlos?
 	  * @return <code>true</code>, falls sie harmlos sind.
@@ -136,6 +502,13 @@ public:
 	  */
 	unsigned int getGhostHarmlessTicks() const;
 
+	/**
+	  * Modus der Geister auslesen. Harmlose Geister sind im Modus
+	  * Frightened, ansonsten gilt der Zeitplan des Levels.
+	  * @return Aktueller Modus.
+	  */
+	GhostMode getGhostMode() const;
+
 	/**
 	  * Eine Figur verschieben. Dabei werden die Zellenrahmen beachtet.
 	  * @param figure Die zu verschiebende Figur.
@@ -143,6 +516,25 @@ public:
 	  */
 	void move(Figure* figure, Direction& direction);
 
+	/**
+	  * Makroschritt fuer Laeufe ohne Fenster (Suche, Stapelbetrieb):
+	  * Die Figur laeuft in einem Aufruf den Korridor bis zur naechsten
+	  * Kreuzung entlang, hoechstens aber 'maxSteps' Zellen. Die anderen
+	  * Figuren stehen dabei still. Steht eine von ihnen unterwegs im
+	  * Weg (Pacman bzw. fuer Pacman jede lebende Figur), endet der
+	  * Lauf dort. Die Zeit laeuft nicht weiter: Pacman wartet die
+	  * uebrigen Schritte ab (Pacman::setCellsAhead()) und gilt bis
+	  * dahin als auf der Zelle, die er ohne Makroschritt erreicht
+	  * haette (siehe isCollisionWithPacman()). Andere Figuren werden
+	  * sofort auf Kollision geprueft.
+	  * @param figure    Die zu verschiebende Figur.
+	  * @param direction Richtung, in die die Figur losgeht.
+	  * @param maxSteps  Hoechstens so viele Zellen weit laufen.
+	  * @return Anzahl zurueckgelegter Zellen (0, wenn die Richtung
+	  *         versperrt ist).
+	  */
+	unsigned int moveAlongCorridor(Figure* figure, Direction direction, unsigned int maxSteps);
+
 	/**
 	  * Ermittelt die Richtung, in die sich eine Figure bewegen muss,
 	  * wenn sie Pacman treffen mchte. Es wird dabei immer 
@@ -157,6 +549,16 @@ public:
 
 	Direction getDirectionToCoordinates(Figure* figure, unsigned int x, unsigned int y, Direction figureCurrentDirection) const;
 
+	/**
+	  * Ermittelt die Richtung, in die sich ein Geist gemaess seinem
+	  * Verhalten bewegen muss. Die Ziele werden einmal je Takt fuer
+	  * alle Geister gemeinsam berechnet.
+	  * @param ghost Zu bewegender Geist.
+	  * @param ghostCurrentDirection Aktuelle Bewegungsrichtung des Geistes.
+	  * @return Einzuschlagende Richtung.
+	  */
+	Direction getDirectionToTarget(Ghost* ghost, Direction ghostCurrentDirection);
+
 	/**
 	  * Kann sich die Figur in die gewuenschte Richtung bewegen?
 	  * Befindet sich z.B. dort ein Rand?
@@ -167,10 +569,70 @@ public:
 	bool canMove(Figure* figure, Direction& direction) const;
 
 	/**
-	  * Zeitablauf: Alle Figuren bewegen.
+	  * Zeitablauf: Alle Figuren bewegen. Dabei kommen nur die Figuren
+	  * an die Reihe, die in diesem Takt tatsaechlich handeln.
 	  */
 	void nextTick();
 
+	/**
+	  * Schnellvorlauf fuer Laeufe ohne Fenster: Alle Takte, in denen
+	  * weder eine Figur handelt noch ein Zaehler ablaeuft, werden
+	  * uebersprungen und der naechste Takt mit einem solchen Ereignis
+	  * wird ausgefuehrt. Das Ergebnis ist dasselbe wie bei entsprechend
+	  * vielen Aufrufen von nextTick().
+	  * @param maxTicks Hoechstens so viele Takte weiterschalten. Liegt das
+	  *                 naechste Ereignis spaeter, wird nur vorgespult.
+	  * @return Anzahl vergangener Takte (inkl. des ausgefuehrten).
+	  */
+	unsigned int advanceUntilNextEvent(unsigned int maxTicks = TimingWheel::NONE);
+
+	/**
+	  * Den Spielstand eines anderen Controllers uebernehmen, z.B. fuer
+	  * eine Suche. Beide muessen dasselbe Level mit denselben Figuren
+	  * verwalten. Spielfeld und automatischer Spieler bleiben die
+	  * eigenen. Wird der Stand waehrend einer Entscheidung des
+	  * automatischen Spielers kopiert, muss der Takt danach mit
+	  * resumeTick() fortgesetzt werden.
+	  * @param other Controller mit dem zu kopierenden Stand.
+	  */
+	void copyStateFrom(const GameController& other);
+
+	/**
+	  * Den ganzen Spielstand ausser den Zellen lesbar schreiben: Zaehler,
+	  * Hash, Zufallsgenerator, harmlose Phase, Zeitplan der Modi, Termine
+	  * im Zeitrad und alle Figuren (siehe Figure::writeState()).
+	  * @param out Ziel der Ausgabe.
+	  */
+	void writeState(std::ostream& out) const;
+
+	/**
+	  * Einen mitten in der Entscheidung des automatischen Spielers
+	  * kopierten Takt fortsetzen: Pacman erhaelt die Richtung, dann
+	  * wird der Rest des Taktes ausgefuehrt.
+	  * @param direction Richtung fuer Pacmans Schritt.
+	  */
+	void resumeTick(Direction direction);
+
+	/**
+	  * Steht der Takt gerade bei der Entscheidung des automatischen
+	  * Spielers?
+	  * @return <code>true</code>, wenn resumeTick() erwartet wird.
+	  */
+	bool isAgentDeciding() const;
+
+	/**
+	  * Laufenden Zeittakt auslesen.
+	  * @return Anzahl bisheriger Aufrufe von nextTick() (inkl. der
+	  *         uebersprungenen Takte).
+	  */
+	unsigned int getTickCount() const;
+
+	/**
+	  * Die Zaehler aller Figuren auf den aktuellen Takt bringen, z.B.
+	  * damit ihre Animationen korrekt gezeichnet werden.
+	  */
+	void synchronizeFigures();
+
 	/**
 	  * Eine Taste wurde gedrueckt, um die Figur in eine bestimmte
 	  * Richtung zu schicken. 
@@ -178,6 +640,86 @@ public:
 	  */
 	void keyPressed(Direction direction);
 
+	/**
+	  * Der zweite Spieler haelt eine Richtung fuer seinen Geist (siehe
+	  * PlayerPolicy). Der Geist biegt ab, sobald der Weg frei ist.
+	  * @param direction Gehaltene Richtung, NONE beim Loslassen.
+	  */
+	void ghostKeyPressed(Direction direction);
+
+	/**
+	  * Vom zweiten Spieler gehaltene Richtung auslesen.
+	  * @return Richtung oder NONE.
+	  */
+	Direction getGhostPlayerDirection() const;
+
+	/**
+	  * Gueltigkeit eines noch nicht ausfuehrbaren Richtungswunsches fuer
+	  * Pacman festlegen, z.B. Pacman::TURN_BUFFER_TICKS.
+	  * @param ticks Takte, 0 verwirft ihn wie frueher sofort.
+	  */
+	void setTurnBuffer(unsigned int ticks);
+
+	/**
+	  * Gueltigkeit eines Richtungswunsches auslesen.
+	  * @return Takte.
+	  */
+	unsigned int getTurnBuffer() const;
+
+	/**
+	  * Makroschritte fuer Laeufe ohne Fenster ein- oder ausschalten:
+	  * Geht Pacman los, laeuft er mit moveAlongCorridor() in einem Zug
+	  * bis zur naechsten Kreuzung (oder bis zur ersten Figur auf dem
+	  * Weg) und wartet dort die Schritte ab, die er dafuer gebraucht
+	  * haette. Die Geister ziehen in dieser Zeit wie gewohnt und
+	  * treffen ihn auf der Zelle, die er im jeweiligen Takt erreicht
+	  * haette. Nur das Essen ist schon gefressen, und wer nach ihm
+	  * zielt, sieht ihn am Ende des Korridors. Ein automatischer
+	  * Spieler entscheidet nur noch an Kreuzungen. Das ist eine
+	  * Naeherung des Spiels und gehoert nicht in ein Fenster.
+	  * @param enabled <code>true</code> zum Einschalten.
+	  */
+	void setCorridorSteps(bool enabled);
+
+	/**
+	  * Sind Makroschritte eingeschaltet?
+	  * @return <code>true</code>, wenn Pacman Korridore in einem Zug laeuft.
+	  */
+	bool getCorridorSteps() const;
+
+	/**
+	  * Verteilung anmelden, in der Pacman die Verzoegerung vom Wunsch
+	  * bis zum Abbiegen zaehlt.
+	  * @param statistics Verteilung oder 0 ohne Messung.
+	  */
+	void setTurnStatistics(TurnStatistics* statistics);
+
+	/**
+	  * Angemeldete Verteilung auslesen.
+	  * @return Verteilung oder 0.
+	  */
+	TurnStatistics* getTurnStatistics() const;
+
+	/**
+	  * Auf Kollisionen untersuchen: Hat die uebergebene Figur dieselbe
+	  * Koordinate wie Pacman oder hat sie mit ihm die Zellen getauscht
+	  * (siehe Figure::isCollisionWith())? Dann wird bei dieser Figur
+	  * die Kollisionsbehandlung ausgeloest und Pacman uebergeben.
+	  * Figuren, die in einem Takt mehrere Zellen laufen, rufen das
+	  * nach jeder Zelle auf, der Controller nach dem letzten Schritt.
+	  * @param figure Zu untersuchende Figur.
+	  */
+	void handleCollisionWithPacman(Figure* figure);
+
+	/**
+	  * Kollidiert eine Figur mit Pacman? Waehrend eines Makroschrittes
+	  * zaehlt die Zelle auf dem Korridor, die er ohne Makroschritt
+	  * erreicht haette, sonst Figure::isCollisionWith().
+	  * @param figure Zu untersuchende Figur.
+	  * @return <code>true</code>, falls sie mit Pacman kollidiert.
+	  */
+	bool isCollisionWithPacman(Figure* figure) const;
+
 	/**
 	  * Ein Geist ist mit Pacman kollidiert. Daraufhin
 	  * soll Pacman als tot markiert werden, wenn der
@@ -209,6 +751,12 @@ public:
 	  */
 	unsigned int getPoints() const;
 
+	/**
+	  * Anzahl verbleibender Essensportionen auslesen.
+	  * @return Anzahl Essensportionen.
+	  */
+	unsigned int getFoodCount() const;
+
 	/**
 	  * Ist das Spiel zuende? Es ist dann vorueber, wenn
 	  * entweder Pacman tot ist oder aber das ganze
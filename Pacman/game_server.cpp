@@ -0,0 +1,398 @@
+#include "game_server.hpp"
+#include "state_stream.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread/thread.hpp>
+
+/**
+  * Ein Spiel mit seiner Verbindung. Alle Methoden laufen im Thread
+  * der Schleife, der das Spiel gehoert. Ausstehende Aufrufe der
+  * Ereignisschleife halten das Spiel am Leben.
+  */
+class GameServer::Session : public boost::enable_shared_from_this<GameServer::Session> {
+	// Verbindung zum Client
+	boost::asio::generic::stream_protocol::socket socket;
+
+	// Das Spiel und die gehaltene Richtung
+	Field field;
+	Direction held;
+
+	// Empfangene, noch nicht gelesene Bytes
+	unsigned char input[ 64 ];
+	std::vector<unsigned char> received;
+
+	// Datenstrom der Staende
+	StateSnapshot snapshot;
+	StateEncoder encoder;
+
+	// Gerade gesendeter und danach zu sendender Stand
+	std::vector<unsigned char> sending;
+	std::vector<unsigned char> pending;
+	bool writing;
+	bool closed;
+
+	/**
+	  * Auf Tasten warten.
+	  */
+	void read() {
+		socket.async_read_some(boost::asio::buffer(input),
+			boost::bind(&Session::handleRead, shared_from_this(),
+						boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+	}
+
+	/**
+	  * Tasten und Bestaetigungen uebernehmen, die letzte Taste gilt.
+	  * Eine unvollstaendige Bestaetigung bleibt fuer den naechsten
+	  * Aufruf liegen.
+	  * @param error Fehler beim Lesen.
+	  * @param bytes Anzahl empfangener Bytes.
+	  */
+	void handleRead(const boost::system::error_code& error, std::size_t bytes) {
+		if (error) {
+			close();
+			return;
+		}
+		received.insert(received.end(), input, input + bytes);
+
+		std::size_t index = 0;
+		while (index < received.size()) {
+			unsigned int value = received[ index ];
+			if (value == StateEncoder::ACK) {
+				unsigned int length = encoder.acknowledge(&received[ index ], received.size() - index);
+				if (length == 0) {
+					break;
+				}
+				index += length;
+				continue;
+			}
+			if (value == Direction::NONE || value == Direction::UP || value == Direction::LEFT
+				|| value == Direction::DOWN || value == Direction::RIGHT) {
+				held = Direction(value);
+			}
+			++index;
+		}
+		received.erase(received.begin(), received.begin() + index);
+		read();
+	}
+
+	/**
+	  * Den zuletzt vorbereiteten Stand senden.
+	  */
+	void write() {
+		sending.swap(pending);
+		pending.clear();
+		writing = true;
+		boost::asio::async_write(socket, boost::asio::buffer(sending),
+			boost::bind(&Session::handleWrite, shared_from_this(), boost::asio::placeholders::error));
+	}
+
+	/**
+	  * Einen inzwischen neueren Stand hinterher senden.
+	  * @param error Fehler beim Senden.
+	  */
+	void handleWrite(const boost::system::error_code& error) {
+		writing = false;
+		if (error) {
+			close();
+		}
+		else if (!pending.empty()) {
+			write();
+		}
+	}
+
+public:
+	/**
+	  * Spiel fuer eine noch anzunehmende Verbindung erzeugen.
+	  * @param service Ereignisschleife des Spiels.
+	  * @param seed    Startwert des Zufallsgenerators.
+	  */
+	Session(boost::asio::io_service& service, unsigned int seed)
+			:	socket(service), held(Direction::NONE), writing(false), closed(false)
+	{
+		field.setRandomSeed(seed);
+	}
+
+	/**
+	  * Verbindung zum Client.
+	  * @return Socket.
+	  */
+	boost::asio::generic::stream_protocol::socket& getSocket() {
+		return socket;
+	}
+
+	/**
+	  * Tasten empfangen. Ueber TCP wird jeder Stand sofort gesendet,
+	  * beim Unix-Domain-Socket gibt es die Option nicht.
+	  */
+	void start() {
+		boost::system::error_code ignored;
+		socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+		read();
+	}
+
+	/**
+	  * Einen Takt weiterschalten, wie PacmanWindow::update(), und den
+	  * Stand senden. Nach dem Ende beginnt das Spiel von vorn.
+	  * @param start Unberuehrtes Spielfeld fuer den Neubeginn.
+	  */
+	void tick(const Field& start) {
+		field.nextTick();
+		if (field.getState() == Playing && held != Direction::NONE) {
+			field.keyPressed(held);
+		}
+		else if (field.getState() == GameOver) {
+			field.copyStateFrom(start);
+		}
+
+		snapshot.read(field);
+		pending.clear();
+		encoder.encode(snapshot, pending);
+		if (!writing) {
+			write();
+		}
+	}
+
+	/**
+	  * Verbindung schliessen, ausstehende Aufrufe enden mit Fehler.
+	  */
+	void close() {
+		closed = true;
+		boost::system::error_code ignored;
+		socket.close(ignored);
+	}
+
+	/**
+	  * Ist die Verbindung geschlossen?
+	  * @return <code>true</code>, wenn das Spiel entfernt werden kann.
+	  */
+	bool isClosed() const {
+		return closed;
+	}
+};
+
+
+/**
+  * Eine Ereignisschleife mit ihren Spielen und ihrem Taktgeber.
+  */
+class GameServer::Shard : public boost::enable_shared_from_this<GameServer::Shard> {
+	boost::asio::io_service service;
+	boost::asio::deadline_timer timer;
+	boost::posix_time::ptime nextTick;
+
+	// Spiele der Schleife
+	std::vector<boost::shared_ptr<Session> > sessions;
+
+	// Unberuehrtes Spielfeld fuer den Neubeginn
+	Field start;
+
+	// Zaehler des Servers
+	boost::atomic<unsigned int>& sessionCount;
+
+	/**
+	  * Auf den naechsten Takt warten. Die Zeitpunkte folgen einem
+	  * festen Raster, damit sich Verzoegerungen nicht aufsummieren.
+	  * Liegt die Schleife mehr als eine Sekunde zurueck, beginnt das
+	  * Raster neu, statt alle Takte nachzuholen.
+	  */
+	void schedule() {
+		boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+		nextTick += boost::posix_time::microseconds(1000000 / TICKS_PER_SECOND);
+		if (nextTick + boost::posix_time::seconds(1) < now) {
+			nextTick = now;
+		}
+		timer.expires_at(nextTick);
+		timer.async_wait(boost::bind(&Shard::handleTick, shared_from_this(), boost::asio::placeholders::error));
+	}
+
+	/**
+	  * Alle Spiele einen Takt weiterschalten und geschlossene entfernen.
+	  * @param error Fehler des Taktgebers.
+	  */
+	void handleTick(const boost::system::error_code& error) {
+		if (error) {
+			return;
+		}
+		for (unsigned int index = 0; index < sessions.size(); ) {
+			if (sessions[ index ]->isClosed()) {
+				sessions[ index ] = sessions.back();
+				sessions.pop_back();
+				--sessionCount;
+			}
+			else {
+				sessions[ index++ ]->tick(start);
+			}
+		}
+		schedule();
+	}
+
+	/**
+	  * Ein Spiel aufnehmen.
+	  * @param session Spiel mit angenommener Verbindung.
+	  */
+	void add(boost::shared_ptr<Session> session) {
+		sessions.push_back(session);
+		session->start();
+	}
+
+public:
+	/**
+	  * Leere Schleife erzeugen.
+	  * @param sessionCount Zaehler der Spiele des Servers.
+	  */
+	Shard(boost::atomic<unsigned int>& sessionCount)
+			:	timer(service), sessionCount(sessionCount)
+	{
+	}
+
+	/**
+	  * Ereignisschleife der Spiele.
+	  * @return Schleife.
+	  */
+	boost::asio::io_service& getService() {
+		return service;
+	}
+
+	/**
+	  * Ein Spiel aus einem beliebigen Thread aufnehmen.
+	  * @param session Spiel mit angenommener Verbindung.
+	  */
+	void post(boost::shared_ptr<Session> session) {
+		service.post(boost::bind(&Shard::add, shared_from_this(), session));
+	}
+
+	/**
+	  * Taktgeber starten und die Schleife laufen lassen, bis sie
+	  * angehalten wird.
+	  */
+	void run() {
+		nextTick = boost::posix_time::microsec_clock::universal_time();
+		schedule();
+		service.run();
+	}
+};
+
+
+/**
+  * Server ohne offene Adresse erzeugen.
+  * @param threads Anzahl Threads.
+  */
+GameServer::GameServer(unsigned int threads)
+		:	nextShard(0), sessionCount(0)
+{
+	for (unsigned int index = 0; index < std::max(threads, 1u); ++index) {
+		shards.push_back(boost::shared_ptr<Shard>(new Shard(sessionCount)));
+	}
+}
+
+
+/**
+  * Server beenden.
+  */
+GameServer::~GameServer() {
+	stop();
+}
+
+
+/**
+  * Die naechste Verbindung annehmen. Der Socket gehoert bereits der
+  * Schleife, die das Spiel erhaelt.
+  * @param acceptor Annehmende Seite.
+  */
+template <class Acceptor>
+void GameServer::accept(Acceptor& acceptor) {
+	boost::shared_ptr<Shard> shard = shards[ nextShard ];
+	nextShard = (nextShard + 1) % shards.size();
+
+	boost::shared_ptr<Session> session(new Session(shard->getService(), sessionCount.load() + 1));
+	acceptor.async_accept(session->getSocket(),
+		boost::bind(&GameServer::handleAccept<Acceptor>, this, &acceptor, session, shard,
+					boost::asio::placeholders::error));
+}
+
+
+/**
+  * Eine angenommene Verbindung einer Schleife uebergeben und die
+  * naechste annehmen.
+  * @param acceptor Annehmende Seite.
+  * @param session  Spiel der Verbindung.
+  * @param shard    Schleife des Spiels.
+  * @param error    Fehler der Annahme.
+  */
+template <class Acceptor>
+void GameServer::handleAccept(Acceptor* acceptor, boost::shared_ptr<Session> session,
+							  boost::shared_ptr<Shard> shard, const boost::system::error_code& error) {
+	if (error == boost::asio::error::operation_aborted) {
+		return;
+	}
+	if (!error) {
+		++sessionCount;
+		shard->post(session);
+	}
+	accept(*acceptor);
+}
+
+
+/**
+  * Verbindungen ueber TCP auf der Loopback-Schnittstelle annehmen.
+  * @param port Port.
+  */
+void GameServer::listen(unsigned short port) {
+	using boost::asio::ip::tcp;
+	tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port);
+	tcpAcceptor.reset(new tcp::acceptor(shards[ 0 ]->getService(), endpoint));
+	accept(*tcpAcceptor);
+}
+
+
+/**
+  * Verbindungen ueber einen Unix-Domain-Socket annehmen.
+  * @param path Pfad des Sockets.
+  */
+void GameServer::listen(const std::string& path) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	using boost::asio::local::stream_protocol;
+	std::remove(path.c_str());
+	localAcceptor.reset(new stream_protocol::acceptor(shards[ 0 ]->getService(), stream_protocol::endpoint(path)));
+	accept(*localAcceptor);
+#else
+	throw boost::system::system_error(boost::asio::error::operation_not_supported);
+#endif
+}
+
+
+/**
+  * Alle Schleifen laufen lassen, die erste im aufrufenden Thread.
+  */
+void GameServer::run() {
+	boost::asio::signal_set signals(shards[ 0 ]->getService(), SIGINT, SIGTERM);
+	signals.async_wait(boost::bind(&GameServer::stop, this));
+
+	boost::thread_group threads;
+	for (unsigned int index = 1; index < shards.size(); ++index) {
+		threads.create_thread(boost::bind(&Shard::run, shards[ index ]));
+	}
+	shards[ 0 ]->run();
+	threads.join_all();
+}
+
+
+/**
+  * Alle Schleifen anhalten.
+  */
+void GameServer::stop() {
+	for (unsigned int index = 0; index < shards.size(); ++index) {
+		shards[ index ]->getService().stop();
+	}
+}
+
+
+/**
+  * Anzahl verbundener Spiele auslesen.
+  * @return Anzahl Spiele.
+  */
+unsigned int GameServer::getSessionCount() const {
+	return sessionCount.load();
+}
@@ -0,0 +1,118 @@
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include "field.hpp"
+
+/**
+  * Viele Spiele in einem Prozess, je eines pro verbundenem Client
+  * (TCP auf der Loopback-Schnittstelle oder Unix-Domain-Socket). Der
+  * Client schickt je Tastendruck ein Byte mit der gehaltenen Richtung
+  * (Konstante aus Direction, NONE beim Loslassen) und bestaetigt die
+  * gelesenen Staende (siehe StateDecoder::acknowledge()). Nach jedem
+  * Takt erhaelt er den Unterschied zum zuletzt bestaetigten Stand
+  * (siehe StateEncoder).
+  *
+  * Die Spiele sind auf wenige Threads verteilt, jeder mit eigener
+  * Ereignisschleife (boost::asio, unter Linux mit epoll) und eigenem
+  * Taktgeber. Ein Spiel gehoert immer demselben Thread und braucht
+  * deshalb weder Sperren noch einen eigenen Thread, es kostet nur
+  * seinen Zustand. Ein langsamer Client erhaelt nur den jeweils
+  * neuesten Stand, es staut sich nichts an.
+  */
+class GameServer {
+public:
+	// Takte je Sekunde, wie im Fenster
+	static const unsigned int TICKS_PER_SECOND = 60;
+
+private:
+	class Session;
+	class Shard;
+
+	// Ereignisschleifen mit ihren Spielen, eine je Thread
+	std::vector<boost::shared_ptr<Shard> > shards;
+
+	// Annahme der Verbindungen, laeuft in der ersten Schleife
+	boost::shared_ptr<boost::asio::ip::tcp::acceptor> tcpAcceptor;
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	boost::shared_ptr<boost::asio::local::stream_protocol::acceptor> localAcceptor;
+#endif
+
+	// Schleife, die das naechste Spiel erhaelt
+	unsigned int nextShard;
+
+	// Anzahl verbundener Spiele
+	boost::atomic<unsigned int> sessionCount;
+
+	/**
+	  * Die naechste Verbindung annehmen.
+	  * @param acceptor Annehmende Seite.
+	  */
+	template <class Acceptor>
+	void accept(Acceptor& acceptor);
+
+	/**
+	  * Eine angenommene Verbindung einer Schleife uebergeben und die
+	  * naechste annehmen.
+	  * @param acceptor Annehmende Seite.
+	  * @param session  Spiel der Verbindung.
+	  * @param shard    Schleife des Spiels.
+	  * @param error    Fehler der Annahme.
+	  */
+	template <class Acceptor>
+	void handleAccept(Acceptor* acceptor, boost::shared_ptr<Session> session,
+					  boost::shared_ptr<Shard> shard, const boost::system::error_code& error);
+
+	// Nicht kopierbar
+	GameServer(const GameServer&);
+	GameServer& operator=(const GameServer&);
+
+public:
+	/**
+	  * Server ohne offene Adresse erzeugen.
+	  * @param threads Anzahl Threads.
+	  */
+	GameServer(unsigned int threads);
+
+	/**
+	  * Server beenden.
+	  */
+	~GameServer();
+
+	/**
+	  * Verbindungen ueber TCP auf der Loopback-Schnittstelle annehmen.
+	  * @param port Port.
+	  */
+	void listen(unsigned short port);
+
+	/**
+	  * Verbindungen ueber einen Unix-Domain-Socket annehmen. Eine alte
+	  * Datei gleichen Namens wird ersetzt.
+	  * @param path Pfad des Sockets.
+	  */
+	void listen(const std::string& path);
+
+	/**
+	  * Alle Schleifen laufen lassen, bis stop() aufgerufen oder der
+	  * Prozess mit SIGINT bzw. SIGTERM beendet wird.
+	  */
+	void run();
+
+	/**
+	  * Alle Schleifen anhalten, aus einem beliebigen Thread.
+	  */
+	void stop();
+
+	/**
+	  * Anzahl verbundener Spiele auslesen.
+	  * @return Anzahl Spiele.
+	  */
+	unsigned int getSessionCount() const;
+};
+
+#endif // GAME_SERVER_H
@@ -0,0 +1,271 @@
+#include "cell.hpp"
+#include "cherry.hpp"
+#include "field.hpp"
+#include "game_controller.hpp"
+#include "game_view.hpp"
+#include "ghost.hpp"
+#include "maze_grid.hpp"
+#include "pacman.hpp"
+#include "pill.hpp"
+
+#include <algorithm>
+
+/**
+  * Eine Sicht auf ein Spiel erzeugen.
+  * @param field      Spielfeld.
+  * @param controller Controller desselben Spiels.
+  */
+GameView::GameView(Field* field, GameController* controller) {
+	this->field = field;
+	this->controller = controller;
+}
+
+
+/**
+  * Spielfeld nur zum Lesen auslesen.
+  * @return Spielfeld.
+  */
+const Field& GameView::getField() const {
+	return *field;
+}
+
+
+/**
+  * Labyrinth des aktuellen Levels auslesen.
+  * @return Begehbare Richtungen aller Zellen.
+  */
+const MazeGrid& GameView::getMaze() const {
+	return field->getMaze();
+}
+
+
+/**
+  * Nummer des aktuellen Levels auslesen.
+  * @return Nummer des Levels (ab 1).
+  */
+unsigned int GameView::getLevelNumber() const {
+	return field->getLevelNumber();
+}
+
+
+/**
+  * Laufenden Zeittakt auslesen.
+  * @return Anzahl bisheriger Takte.
+  */
+unsigned int GameView::getTickCount() const {
+	return controller->getTickCount();
+}
+
+
+/**
+  * Aktuelle Punktezahl auslesen.
+  * @return Punktezahl.
+  */
+unsigned int GameView::getPoints() const {
+	return controller->getPoints();
+}
+
+
+/**
+  * Verbleibende Leben auslesen.
+  * @return Anzahl Leben.
+  */
+unsigned int GameView::getLives() const {
+	return controller->getLives();
+}
+
+
+/**
+  * Zelle von Pacman auslesen.
+  * @return Index der Zelle.
+  */
+unsigned int GameView::getPacmanCell() const {
+	Figure* pacman = controller->getPacman();
+	return getMaze().getIndex(pacman->getX(), pacman->getY());
+}
+
+
+/**
+  * Richtung, in die Pacman zuletzt gelaufen ist.
+  * @return Richtung.
+  */
+Direction GameView::getPacmanDirection() const {
+	return controller->getPacman()->getDirection();
+}
+
+
+/**
+  * Zustand von Pacman auslesen.
+  * @return Zustand.
+  */
+FigureState GameView::getPacmanState() const {
+	return controller->getPacman()->getState();
+}
+
+
+/**
+  * Kann Pacman in die Richtung gehen?
+  * @param direction Gewuenschte Richtung.
+  * @return <code>true</code>, wenn kein Rahmen im Weg ist.
+  */
+bool GameView::canPacmanMove(Direction direction) const {
+	return controller->canMove(controller->getPacman(), direction);
+}
+
+
+/**
+  * Anzahl Geister auslesen.
+  * @return Anzahl Geister (auch tote).
+  */
+unsigned int GameView::getGhostCount() const {
+	return controller->getGhosts().size();
+}
+
+
+/**
+  * Zelle eines Geistes auslesen.
+  * @param index Index des Geistes.
+  * @return Index der Zelle.
+  */
+unsigned int GameView::getGhostCell(unsigned int index) const {
+	Ghost* ghost = controller->getGhosts()[ index ];
+	return getMaze().getIndex(ghost->getX(), ghost->getY());
+}
+
+
+/**
+  * Zustand eines Geistes auslesen.
+  * @param index Index des Geistes.
+  * @return Zustand.
+  */
+FigureState GameView::getGhostState(unsigned int index) const {
+	return controller->getGhosts()[ index ]->getState();
+}
+
+
+/**
+  * Richtung, in die ein Geist zuletzt gelaufen ist.
+  * @param index Index des Geistes.
+  * @return Richtung.
+  */
+Direction GameView::getGhostDirection(unsigned int index) const {
+	return controller->getGhosts()[ index ]->getDirection();
+}
+
+
+/**
+  * Verhalten eines Geistes auslesen.
+  * @param index Index des Geistes.
+  * @return Verhalten.
+  */
+GhostPersonality GameView::getGhostPersonality(unsigned int index) const {
+	return controller->getGhosts()[ index ]->getPersonality();
+}
+
+
+/**
+  * Modus der Geister auslesen.
+  * @return Aktueller Modus.
+  */
+GhostMode GameView::getGhostMode() const {
+	return controller->getGhostMode();
+}
+
+
+/**
+  * Wieviele Takte lang bleiben die Geister noch harmlos?
+  * @return Verbleibende Anzahl Takte, 0 wenn sie gefaehrlich sind.
+  */
+unsigned int GameView::getGhostHarmlessTicks() const {
+	return controller->isGhostStateHarmless() ? controller->getGhostHarmlessTicks() : 0;
+}
+
+
+/**
+  * Liegt in der Zelle Essen?
+  * @param cell Index der Zelle.
+  * @return <code>true</code>, wenn dort Essen liegt.
+  */
+bool GameView::isFood(unsigned int cell) const {
+	const MazeGrid& maze = getMaze();
+	const Field* constField = field;
+	return constField->getCell(maze.getX(cell), maze.getY(cell))->isFood();
+}
+
+
+/**
+  * Hash des Spielstandes auslesen.
+  * @return Hash.
+  */
+boost::uint64_t GameView::getStateHash() const {
+	return controller->getStateHash();
+}
+
+
+/**
+  * Anzahl verbleibender Essensportionen auslesen.
+  * @return Anzahl Essensportionen.
+  */
+unsigned int GameView::getFoodCount() const {
+	return controller->getFoodCount();
+}
+
+
+/**
+  * Zellen aller noch vorhandenen Pillen und Kirschen ermitteln. Das
+  * sind alle lebenden Figuren ausser Pacman und den Geistern.
+  * @param cells Erhaelt die Indizes der Zellen.
+  */
+void GameView::getItemCells(std::vector<unsigned int>& cells) const {
+	const MazeGrid& maze = getMaze();
+	const std::vector<Ghost*>& ghosts = controller->getGhosts();
+	std::vector<Figure*>& figures = controller->getFigures();
+
+	cells.clear();
+	for (std::vector<Figure*>::iterator iter = figures.begin(); iter != figures.end(); ++iter) {
+		Figure* figure = *iter;
+		if (figure == controller->getPacman() || figure->getState() != Alive ||
+			std::find(ghosts.begin(), ghosts.end(), figure) != ghosts.end()) {
+			continue;
+		}
+		cells.push_back(maze.getIndex(figure->getX(), figure->getY()));
+	}
+}
+
+
+/**
+  * Zellen aller noch vorhandenen Pillen und Kirschen getrennt
+  * ermitteln.
+  * @param pills    Erhaelt die Indizes der Zellen mit Pillen.
+  * @param cherries Erhaelt die Indizes der Zellen mit Kirschen.
+  */
+void GameView::getItemCells(std::vector<unsigned int>& pills, std::vector<unsigned int>& cherries) const {
+	const MazeGrid& maze = getMaze();
+	const std::vector<Pill*>& allPills = controller->getPills();
+	const std::vector<Cherry*>& allCherries = controller->getCherries();
+
+	pills.clear();
+	for (std::vector<Pill*>::const_iterator iter = allPills.begin(); iter != allPills.end(); ++iter) {
+		if ((*iter)->getState() == Alive) {
+			pills.push_back(maze.getIndex((*iter)->getX(), (*iter)->getY()));
+		}
+	}
+	cherries.clear();
+	for (std::vector<Cherry*>::const_iterator iter = allCherries.begin(); iter != allCherries.end(); ++iter) {
+		if ((*iter)->getState() == Alive) {
+			cherries.push_back(maze.getIndex((*iter)->getX(), (*iter)->getY()));
+		}
+	}
+}
+
+
+/**
+  * Ist die Zelle ein Ausgang des Gefaengnisses der Geister?
+  * @param cell Index der Zelle.
+  * @return <code>true</code>, wenn die Zelle ein Ausgang ist.
+  */
+bool GameView::isPrisonExit(unsigned int cell) const {
+	const MazeGrid& maze = getMaze();
+	const Field* constField = field;
+	return constField->getCell(maze.getX(cell), maze.getY(cell))->isPrisonExit();
+}
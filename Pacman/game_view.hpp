@@ -0,0 +1,185 @@
+#ifndef GAME_VIEW_H
+#define GAME_VIEW_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include "direction.hpp"
+#include "figure.hpp"
+#include "targeting_service.hpp"
+
+class Field;
+class GameController;
+class MazeGrid;
+
+/**
+  * Nur lesende Sicht auf den Spielstand fuer automatische Spieler.
+  * Zellen werden wie in MazeGrid als Index angegeben. Die Sicht
+  * selbst haelt keinen Zustand, jeder Aufruf liest den aktuellen
+  * Stand aus Spielfeld und Controller.
+  */
+class GameView {
+	// Spielfeld mit den Zellen
+	Field* field;
+
+	// Controller mit den Figuren
+	GameController* controller;
+
+public:
+	/**
+	  * Eine Sicht auf ein Spiel erzeugen.
+	  * @param field      Spielfeld.
+	  * @param controller Controller desselben Spiels.
+	  */
+	GameView(Field* field, GameController* controller);
+
+	/**
+	  * Spielfeld nur zum Lesen auslesen, z.B. um den Spielstand fuer
+	  * eine Suche zu kopieren (siehe Field::copyStateFrom()).
+	  * @return Spielfeld.
+	  */
+	const Field& getField() const;
+
+	/**
+	  * Labyrinth des aktuellen Levels auslesen.
+	  * @return Begehbare Richtungen aller Zellen.
+	  */
+	const MazeGrid& getMaze() const;
+
+	/**
+	  * Nummer des aktuellen Levels auslesen.
+	  * @return Nummer des Levels (ab 1).
+	  */
+	unsigned int getLevelNumber() const;
+
+	/**
+	  * Laufenden Zeittakt auslesen.
+	  * @return Anzahl bisheriger Takte.
+	  */
+	unsigned int getTickCount() const;
+
+	/**
+	  * Aktuelle Punktezahl auslesen.
+	  * @return Punktezahl.
+	  */
+	unsigned int getPoints() const;
+
+	/**
+	  * Verbleibende Leben auslesen.
+	  * @return Anzahl Leben.
+	  */
+	unsigned int getLives() const;
+
+	/**
+	  * Zelle von Pacman auslesen.
+	  * @return Index der Zelle.
+	  */
+	unsigned int getPacmanCell() const;
+
+	/**
+	  * Richtung, in die Pacman zuletzt gelaufen ist.
+	  * @return Richtung.
+	  */
+	Direction getPacmanDirection() const;
+
+	/**
+	  * Zustand von Pacman auslesen.
+	  * @return Zustand.
+	  */
+	FigureState getPacmanState() const;
+
+	/**
+	  * Kann Pacman in die Richtung gehen?
+	  * @param direction Gewuenschte Richtung.
+	  * @return <code>true</code>, wenn kein Rahmen im Weg ist.
+	  */
+	bool canPacmanMove(Direction direction) const;
+
+	/**
+	  * Anzahl Geister auslesen.
+	  * @return Anzahl Geister (auch tote).
+	  */
+	unsigned int getGhostCount() const;
+
+	/**
+	  * Zelle eines Geistes auslesen.
+	  * @param index Index des Geistes.
+	  * @return Index der Zelle.
+	  */
+	unsigned int getGhostCell(unsigned int index) const;
+
+	/**
+	  * Zustand eines Geistes auslesen.
+	  * @param index Index des Geistes.
+	  * @return Zustand.
+	  */
+	FigureState getGhostState(unsigned int index) const;
+
+	/**
+	  * Richtung, in die ein Geist zuletzt gelaufen ist.
+	  * @param index Index des Geistes.
+	  * @return Richtung.
+	  */
+	Direction getGhostDirection(unsigned int index) const;
+
+	/**
+	  * Verhalten eines Geistes auslesen.
+	  * @param index Index des Geistes.
+	  * @return Verhalten.
+	  */
+	GhostPersonality getGhostPersonality(unsigned int index) const;
+
+	/**
+	  * Modus der Geister auslesen.
+	  * @return Aktueller Modus.
+	  */
+	GhostMode getGhostMode() const;
+
+	/**
+	  * Wieviele Takte lang bleiben die Geister noch harmlos?
+	  * @return Verbleibende Anzahl Takte, 0 wenn sie gefaehrlich sind.
+	  */
+	unsigned int getGhostHarmlessTicks() const;
+
+	/**
+	  * Liegt in der Zelle Essen?
+	  * @param cell Index der Zelle.
+	  * @return <code>true</code>, wenn dort Essen liegt.
+	  */
+	bool isFood(unsigned int cell) const;
+
+	/**
+	  * Hash des Spielstandes auslesen (siehe
+	  * GameController::getStateHash()).
+	  * @return Hash.
+	  */
+	boost::uint64_t getStateHash() const;
+
+	/**
+	  * Anzahl verbleibender Essensportionen auslesen.
+	  * @return Anzahl Essensportionen.
+	  */
+	unsigned int getFoodCount() const;
+
+	/**
+	  * Zellen aller noch vorhandenen Pillen und Kirschen ermitteln.
+	  * @param cells Erhaelt die Indizes der Zellen.
+	  */
+	void getItemCells(std::vector<unsigned int>& cells) const;
+
+	/**
+	  * Zellen aller noch vorhandenen Pillen und Kirschen getrennt
+	  * ermitteln.
+	  * @param pills    Erhaelt die Indizes der Zellen mit Pillen.
+	  * @param cherries Erhaelt die Indizes der Zellen mit Kirschen.
+	  */
+	void getItemCells(std::vector<unsigned int>& pills, std::vector<unsigned int>& cherries) const;
+
+	/**
+	  * Ist die Zelle ein Ausgang des Gefaengnisses der Geister?
+	  * @param cell Index der Zelle.
+	  * @return <code>true</code>, wenn die Zelle ein Ausgang ist.
+	  */
+	bool isPrisonExit(unsigned int cell) const;
+};
+
+#endif // GAME_VIEW_H
@@ -80,11 +80,22 @@ GhostDescriptor Descriptor = {
   *          platziert wird.
   * @param controller  Spiele-Controller, der die Aktionen
   *                    bewertet und die Figuren steuert.
+  * @param personality Verhalten bei der Verfolgung.
   */
-Ghost::Ghost(unsigned int x, unsigned int y, GameController* controller)
+Ghost::Ghost(unsigned int x, unsigned int y, GameController* controller,
+			 GhostPersonality personality)
 			:	Figure(x, y, controller) 
 {
 	this->speed = Ghost::NORMAL_SPEED;
+	this->personality = personality;
+}
+
+/**
+  * Verhalten des Geistes bei der Verfolgung auslesen.
+  * @return Verhalten des Geistes.
+  */
+GhostPersonality Ghost::getPersonality() const {
+	return personality;
 }
 
 /**
@@ -115,7 +126,13 @@ void Ghost::draw(Gosu::Graphics& graphics, int cellWidth, int cellHeight)
 	}
 	else
 	{
-		color = Gosu::Color(255, 0, 0);
+		// Jedes Verhalten hat seine eigene Farbe.
+		switch (personality) {
+			case Ambusher: color = Gosu::Color(255, 184, 255); break;
+			case Flanker:  color = Gosu::Color(0, 255, 255);   break;
+			case Shy:      color = Gosu::Color(255, 184, 82);  break;
+			default:       color = Gosu::Color(255, 0, 0);     break;
+		}
 	}
 
 	if(this->getState() == Alive)
@@ -123,7 +140,7 @@ void Ghost::draw(Gosu::Graphics& graphics, int cellWidth, int cellHeight)
 		drawArc(graphics, color, cellWidth, cellHeight, true, Descriptor.topCircle, 0, 180);
 		drawRectangle(graphics, color, cellWidth, cellHeight, true, Descriptor.rectangle);
 		for (unsigned int i = 0; i < BOTTOM_CIRCLES; ++i) {
-			drawArc(graphics, color, cellWidth, cellHeight, true, Descriptor.bottomCircles[(ticks % 5 ? 0 : 1)][ i ], 180, 180);
+			drawArc(graphics, color, cellWidth, cellHeight, true, Descriptor.bottomCircles[(controller->getTickCount() % 5 ? 0 : 1)][ i ], 180, 180);
 		}
 	}
 
@@ -149,77 +166,121 @@ void Ghost::draw(Gosu::Graphics& graphics, int cellWidth, int cellHeight)
 }
 
 /**
-  * Naechster Zeittakt. Die Methode muss uerberschrieben werden,
-  * um zeitgesteuerte Aktionen ausloesen zu koennen.
+  * Auf der Kante weiterruecken. Wechselt die Geschwindigkeit, gilt die
+  * neue fuer den Rest der Kante.
+  * @return <code>true</code>, wenn sich der Geist in diesem Takt
+  *         bewegt.
   */
-void Ghost::nextTick() {
-	if(this->getState() != Dead)
+bool Ghost::advanceTicks() {
+	if(this->getState() == Dead)
 	{
-		if(this->getState() == Dying)
-		{
-			this->speed = Ghost::DEAD_SPEED;
-		}
-		else if(controller->isGhostStateHarmless())
-		{
-			this->speed = Ghost::HARMLESS_SPEED;
-		}
-		else
-		{
-			this->speed = Ghost::NORMAL_SPEED;
-		}
+		return false;
+	}
 
-		this->ticks++;
-		if(this->ticks >= this->speed)
-		{
-			this->ticks = 0;
-		}
-		else
-		{
-			return;
-		}
-		
-		Direction newDirection;
-		unsigned int curIQ = IQ;
-		if(this->getState() == Dying) curIQ = DEAD_IQ;
+	this->speed = getCurrentSpeed();
 
-		if (rand() % (unsigned int) ((MAX_IQ-curIQ)/10) == 0) 
-		{
-			if(this->getState() == Alive)
-			{
-				newDirection = controller->getDirectionToPacman(this, direction);
-			}
-			else
-			{
-				newDirection = controller->getDirectionToCoordinates(this, this->startx, this->starty, direction);
-			}
-
-			if (controller->isGhostStateHarmless()) {
-				newDirection = newDirection.turn180Degree();
-			}
-		}
-		else 
-		{
-			do {	// neue Richtung, aber keine Umkehr
-				newDirection = Direction::random();
-			} while (newDirection == direction.turn180Degree());
-
-			// Weiterdrehen, bis das Feld am Ziel frei ist
-			while (!controller->canMove(this, newDirection)) 
-			{
-				if (newDirection != direction) {
-					newDirection = direction;
-				}
-				else {
-					newDirection = Direction::random();
-				}
-			}
-		}
+	this->progress += this->speed;
+	if(this->progress >= SUBCELLS)
+	{
+		this->progress -= SUBCELLS;
+		return true;
+	}
+	return false;
+}
 
-		direction = newDirection;
-		controller->move(this, direction);
 
-		if(this->getX() == this->startx && this->getY() == this->starty) 
-			this->setState(Alive);
+/**
+  * Reicht der Rest auf der Kante fuer einen weiteren Schritt im selben
+  * Takt, wird der vorige zuerst auf Kollision mit Pacman geprueft.
+  * @return <code>true</code>, wenn der Geist noch einen Schritt macht.
+  */
+bool Ghost::continueTicks() {
+	if(this->getState() == Dead || this->progress < SUBCELLS)
+	{
+		return false;
+	}
+
+	controller->handleCollisionWithPacman(this);
+	this->progress -= SUBCELLS;
+	return true;
+}
+
+
+/**
+  * Einen Schritt in die gewaehlte Richtung gehen. Ein toter Geist
+  * lebt wieder auf, sobald er seine Startzelle erreicht.
+  * @param newDirection Von der Strategie gewaehlte Richtung.
+  */
+void Ghost::walk(Direction newDirection) {
+	direction = newDirection;
+	controller->move(this, direction);
+
+	if(this->getX() == this->startx && this->getY() == this->starty) 
+		this->setState(Alive);
+}
+
+
+/**
+  * Startkoordinaten des Geistes auslesen, zu denen er nach dem
+  * Tod zurueckkehrt.
+  * @return X-Koordinate der Startzelle.
+  */
+unsigned int Ghost::getStartX() const {
+	return startx;
+}
+
+
+/**
+  * Startkoordinaten des Geistes auslesen.
+  * @return Y-Koordinate der Startzelle.
+  */
+unsigned int Ghost::getStartY() const {
+	return starty;
+}
+
+
+/**
+  * Geschwindigkeit ermitteln, die im aktuellen Zustand des
+  * Geistes und des Spiels gilt.
+  * @return Geschwindigkeit in Teilzellen je Takt.
+  */
+unsigned int Ghost::getCurrentSpeed() const {
+	if(this->state == Dying)
+	{
+		return Ghost::DEAD_SPEED;
+	}
+	else if(controller->isGhostStateHarmless())
+	{
+		return Ghost::HARMLESS_SPEED;
+	}
+	return Ghost::NORMAL_SPEED;
+}
+
+
+/**
+  * Nach wievielen Aufrufen von nextTick() bewegt sich der Geist?
+  * Gerundet wird auf, die Kante kann nach einem Wechsel der
+  * Geschwindigkeit bereits zurueckgelegt sein, dann bewegt er sich
+  * schon beim naechsten Takt.
+  * @return Anzahl Takte oder <code>NEVER</code>.
+  */
+unsigned int Ghost::getTicksUntilAction() const {
+	if(this->state == Dead) return NEVER;
+
+	unsigned int currentSpeed = getCurrentSpeed();
+	return (this->progress < SUBCELLS) ? (SUBCELLS - this->progress + currentSpeed - 1) / currentSpeed : 1;
+}
+
+
+/**
+  * Um Takte ohne Bewegung auf der Kante weiterruecken.
+  * @param count Anzahl uebersprungener Takte.
+  */
+void Ghost::skipTicks(unsigned int count) {
+	if(this->state != Dead)
+	{
+		this->speed = getCurrentSpeed();
+		this->progress += count * this->speed;
 	}
 }
 
@@ -3,6 +3,7 @@
 
 #include <Gosu/Gosu.hpp>
 #include "figure.hpp"
+#include "targeting_service.hpp"
 
 struct Eye {
 	BoundingBox outerCircle;
@@ -24,28 +25,61 @@ struct GhostDescriptor {
 	Eyes        eyes[ DIRECTIONS ]; // fuer alle Bewegungsrichtungen (keine, up, left, down, right)
 };
 
+/**
+  * Basisklasse aller Geister: Zeichnen, Geschwindigkeit und
+  * Kollisionen. Wohin ein Geist laeuft, entscheidet eine Strategie,
+  * die ueber die Vorlage 'PolicyGhost' (siehe ghost_policy.hpp)
+  * statisch eingebunden wird.
+  */
 class Ghost: public Figure {
-	// 'Intelligenz' festlegen (0-190 als Hinweis
-	// auf die Qualitaet, mit der sie Pacman folgen).
-	// Der Wert darf nicht hoeher als 'MAX_IQ' sein.
-	// 0: Strohdoof
-	// 190: ziemlich 'intelligent'
-	static const unsigned int IQ = 70;
+public:
+	// Geschwindigkeit eines normalen Geistes in Teilzellen je Takt
+	static const unsigned int NORMAL_SPEED = 12;
 
-	static const unsigned int DEAD_IQ = 170;
+	// Geschwindigkeit eines verwundbaren Geistes
+	static const unsigned int HARMLESS_SPEED = 8;
 
-	// Maximale 'Intelligenz' eines Geistes
-	static const unsigned int MAX_IQ = 190;
+	// Geschwindigkeit eines "toten" Geistes
+	static const unsigned int DEAD_SPEED = 10;
 
-	// Geschwindigkeit eines normalen Geistes
-	static const unsigned int NORMAL_SPEED = 10;
+	// Takte je Zelle eines normalen Geistes, fuer Rechnungen ohne
+	// Figuren (z.B. LockstepBatch)
+	static const unsigned int NORMAL_PERIOD = SUBCELLS / NORMAL_SPEED;
 
-	// Geschwindigkeit eines verwundbaren Geistes
-	static const unsigned int HARMLESS_SPEED = 15;
+private:
+	// Verhalten des Geistes bei der Verfolgung
+	GhostPersonality personality;
 
-	// Geschwindigkeit eines "toten" Geistes
-	static const unsigned int DEAD_SPEED = 12;
+	/**
+	  * Geschwindigkeit ermitteln, die im aktuellen Zustand des
+	  * Geistes und des Spiels gilt.
+	  * @return Geschwindigkeit in Teilzellen je Takt.
+	  */
+	unsigned int getCurrentSpeed() const;
 
+protected:
+	/**
+	  * Auf der Kante weiterruecken.
+	  * @return <code>true</code>, wenn sich der Geist in diesem Takt
+	  *         bewegt.
+	  */
+	bool advanceTicks();
+
+	/**
+	  * Noch einen Schritt im selben Takt machen? Ist der Geist schneller
+	  * als eine Zelle je Takt, folgt auf advanceTicks() ein Schritt je
+	  * weiterer zurueckgelegter Zelle. Davor wird der vorige Schritt auf
+	  * Kollision geprueft, sonst liefe der Geist durch Pacman hindurch.
+	  * @return <code>true</code>, wenn der Geist noch einen Schritt macht.
+	  */
+	bool continueTicks();
+
+	/**
+	  * Einen Schritt in die gewaehlte Richtung gehen. Ein toter Geist
+	  * lebt wieder auf, sobald er seine Startzelle erreicht.
+	  * @param newDirection Von der Strategie gewaehlte Richtung.
+	  */
+	void walk(Direction newDirection);
 
 public:
 	/**
@@ -56,8 +90,16 @@ public:
 	  *          platziert wird.
 	  * @param controller  Spiele-Controller, der die Aktionen
 	  *                    bewertet und die Figuren steuert.
+	  * @param personality Verhalten bei der Verfolgung.
 	  */
-	Ghost(unsigned int x, unsigned int y, GameController* controller);
+	Ghost(unsigned int x, unsigned int y, GameController* controller,
+		  GhostPersonality personality = Chaser);
+
+	/**
+	  * Verhalten des Geistes bei der Verfolgung auslesen.
+	  * @return Verhalten des Geistes.
+	  */
+	GhostPersonality getPersonality() const;
 
 	/**
 	  * Aufforderung zur Neuzeichnung.
@@ -69,10 +111,35 @@ public:
 	virtual void draw(Gosu::Graphics& graphics, int cellWidth, int cellHeight);
 
 	/**
-	  * Naechster Zeittakt. Die Methode muss uerberschrieben werden,
-	  * um zeitgesteuerte Aktionen ausloesen zu koennen.
+	  * Naechster Zeittakt. Die Methode wird von 'PolicyGhost'
+	  * mit der jeweiligen Strategie ueberschrieben.
+	  */
+	virtual void nextTick() = 0;
+
+	/**
+	  * Startkoordinaten des Geistes auslesen, zu denen er nach dem
+	  * Tod zurueckkehrt.
+	  * @return X-Koordinate der Startzelle.
+	  */
+	unsigned int getStartX() const;
+
+	/**
+	  * Startkoordinaten des Geistes auslesen.
+	  * @return Y-Koordinate der Startzelle.
+	  */
+	unsigned int getStartY() const;
+
+	/**
+	  * Nach wievielen Aufrufen von nextTick() bewegt sich der Geist?
+	  * @return Anzahl Takte oder <code>NEVER</code>.
+	  */
+	virtual unsigned int getTicksUntilAction() const;
+
+	/**
+	  * Um Takte ohne Bewegung auf der Kante weiterruecken.
+	  * @param count Anzahl uebersprungener Takte.
 	  */
-	virtual void nextTick();
+	virtual void skipTicks(unsigned int count);
 
 	/**
 	  * Kollisionsbehandlung: Diese Figur ist mit der uebergebenen
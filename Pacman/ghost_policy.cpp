@@ -0,0 +1,26 @@
+#include "ghost_policy.hpp"
+
+/**
+  * Einen Geist mit der Strategie eines Levels erzeugen. Nur hier wird
+  * zur Laufzeit unterschieden, danach ist die Strategie fest.
+  * @param policy      Strategie der Geister.
+  * @param x           X-Position der Startzelle.
+  * @param y           Y-Position der Startzelle.
+  * @param controller  Spiele-Controller.
+  * @param personality Verhalten bei der Verfolgung.
+  * @return Neuer Geist.
+  */
+Ghost* createGhost(GhostPolicy policy, unsigned int x, unsigned int y,
+				   GameController* controller, GhostPersonality personality) {
+	switch (policy) {
+		case GreedyGhosts: return new PolicyGhost<GreedyPolicy>(x, y, controller, personality);
+		case RandomGhosts: return new PolicyGhost<RandomPolicy>(x, y, controller, personality);
+		case PlayerGhosts:
+			// Nur der Jaeger gehoert dem Spieler, die uebrigen bleiben klassisch
+			if (personality == Chaser) {
+				return new PolicyGhost<PlayerPolicy>(x, y, controller, personality);
+			}
+			return new PolicyGhost<ClassicPolicy>(x, y, controller, personality);
+		default:           return new PolicyGhost<ClassicPolicy>(x, y, controller, personality);
+	}
+}
@@ -0,0 +1,254 @@
+#ifndef GHOST_POLICY_H
+#define GHOST_POLICY_H
+
+#include "game_controller.hpp"
+#include "ghost.hpp"
+
+// Auswahl der Strategie fuer die Geister eines Levels
+// (PlayerGhosts: den Jaeger steuert ein zweiter Spieler, siehe
+// PlayerPolicy)
+enum GhostPolicy { ClassicGhosts = 0, GreedyGhosts, RandomGhosts, PlayerGhosts };
+
+/**
+  * Richtung zum Ziel des Geistes: im Leben das Ziel seines
+  * Verhaltens, nach dem Tod die Startzelle. Harmlose Geister
+  * laufen in die Gegenrichtung.
+  * @param ghost      Zu bewegender Geist.
+  * @param controller Spiele-Controller.
+  * @return Einzuschlagende Richtung.
+  */
+inline Direction getTargetDirection(Ghost& ghost, GameController& controller) {
+	Direction newDirection;
+	if (ghost.getState() == Alive) {
+		newDirection = controller.getDirectionToTarget(&ghost, ghost.getDirection());
+	}
+	else {
+		newDirection = controller.getDirectionToCoordinates(&ghost, ghost.getStartX(), ghost.getStartY(), ghost.getDirection());
+	}
+
+	if (controller.isGhostStateHarmless()) {
+		newDirection = newDirection.turn180Degree();
+	}
+	return newDirection;
+}
+
+/**
+  * Zufaellige Richtung aus dem Zufallsgenerator des Spiels.
+  * @param controller Spiele-Controller.
+  * @return Zufaellige Richtung (oben, unten, links, rechts).
+  */
+inline Direction getRandomStep(GameController& controller) {
+	return Direction(1u << controller.random() % 4);
+}
+
+/**
+  * Zufaellige Richtung ohne Umkehr. Ist die Zelle in dieser Richtung
+  * versperrt, wird weitergedreht.
+  * @param ghost      Zu bewegender Geist.
+  * @param controller Spiele-Controller.
+  * @return Einzuschlagende Richtung.
+  */
+inline Direction getRandomDirection(Ghost& ghost, GameController& controller) {
+	Direction direction = ghost.getDirection();
+	Direction newDirection;
+	do {	// neue Richtung, aber keine Umkehr
+		newDirection = getRandomStep(controller);
+	} while (newDirection == direction.turn180Degree());
+
+	// Weiterdrehen, bis das Feld am Ziel frei ist
+	while (!controller.canMove(&ghost, newDirection))
+	{
+		if (newDirection != direction) {
+			newDirection = direction;
+		}
+		else {
+			newDirection = getRandomStep(controller);
+		}
+	}
+	return newDirection;
+}
+
+/**
+  * Strategie der urspruenglichen Geister: Je nach 'Intelligenz'
+  * wird mehr oder weniger oft das Ziel angesteuert, sonst geht es
+  * zufaellig weiter.
+  */
+template <unsigned int IQ>
+class IqPolicy {
+public:
+	// 'Intelligenz' festlegen (0-190 als Hinweis
+	// auf die Qualitaet, mit der sie Pacman folgen).
+	// Der Wert darf nicht hoeher als 'MAX_IQ' - 10 sein.
+	// 0: Strohdoof
+	// 180: ziemlich 'intelligent'
+	static const unsigned int LIVING_IQ = IQ;
+
+	// 'Intelligenz' auf dem Weg zurueck zur Startzelle
+	static const unsigned int DEAD_IQ = 170;
+
+	// Maximale 'Intelligenz' eines Geistes
+	static const unsigned int MAX_IQ = 190;
+
+	/**
+	  * Richtung fuer den naechsten Schritt waehlen.
+	  * @param ghost      Zu bewegender Geist.
+	  * @param controller Spiele-Controller.
+	  * @return Einzuschlagende Richtung.
+	  */
+	Direction chooseDirection(Ghost& ghost, GameController& controller) {
+		unsigned int curIQ = LIVING_IQ;
+		if (ghost.getState() == Dying) curIQ = DEAD_IQ;
+
+		if (controller.random() % (unsigned int) ((MAX_IQ - curIQ) / 10) == 0) {
+			return getTargetDirection(ghost, controller);
+		}
+		return getRandomDirection(ghost, controller);
+	}
+};
+
+/**
+  * Strategie, die immer das Ziel ansteuert.
+  */
+class GreedyPolicy {
+public:
+	/**
+	  * Richtung fuer den naechsten Schritt waehlen.
+	  * @param ghost      Zu bewegender Geist.
+	  * @param controller Spiele-Controller.
+	  * @return Einzuschlagende Richtung.
+	  */
+	Direction chooseDirection(Ghost& ghost, GameController& controller) {
+		return getTargetDirection(ghost, controller);
+	}
+};
+
+/**
+  * Strategie, die im Leben nur zufaellig umherirrt. Tote Geister
+  * laufen trotzdem zielstrebig zurueck, um wieder aufzuleben.
+  */
+class RandomPolicy {
+public:
+	/**
+	  * Richtung fuer den naechsten Schritt waehlen.
+	  * @param ghost      Zu bewegender Geist.
+	  * @param controller Spiele-Controller.
+	  * @return Einzuschlagende Richtung.
+	  */
+	Direction chooseDirection(Ghost& ghost, GameController& controller) {
+		if (ghost.getState() == Dying) {
+			return getTargetDirection(ghost, controller);
+		}
+		return getRandomDirection(ghost, controller);
+	}
+};
+
+// Strategie der urspruenglichen Geister
+typedef IqPolicy<70> ClassicPolicy;
+
+/**
+  * Strategie eines Geistes, den ein zweiter Spieler steuert (siehe
+  * GameController::ghostKeyPressed()). Der Geist biegt in die
+  * gehaltene Richtung ab, sobald sie frei ist, auch zur Umkehr, und
+  * laeuft sonst geradeaus weiter. An einer Wand ohne passende Taste
+  * geht es zufaellig weiter. Nach dem Tod laeuft er von selbst zur
+  * Startzelle zurueck.
+  */
+class PlayerPolicy {
+public:
+	/**
+	  * Richtung fuer den naechsten Schritt waehlen.
+	  * @param ghost      Zu bewegender Geist.
+	  * @param controller Spiele-Controller.
+	  * @return Einzuschlagende Richtung.
+	  */
+	Direction chooseDirection(Ghost& ghost, GameController& controller) {
+		if (ghost.getState() == Dying) {
+			return getTargetDirection(ghost, controller);
+		}
+		Direction wanted = controller.getGhostPlayerDirection();
+		if (wanted != Direction::NONE && controller.canMove(&ghost, wanted)) {
+			return wanted;
+		}
+		Direction straight = ghost.getDirection();
+		if (straight != Direction::NONE && controller.canMove(&ghost, straight)) {
+			return straight;
+		}
+		return getRandomDirection(ghost, controller);
+	}
+};
+
+/**
+  * Geist mit fest eingebundener Strategie. Die Strategie ist ein
+  * Typparameter, ihr Aufruf in nextTick() wird daher ohne virtuellen
+  * Aufruf aufgeloest und kann eingebettet werden. Eine Strategie
+  * braucht nur die Methode
+  * <code>Direction chooseDirection(Ghost&, GameController&)</code>.
+  */
+template <class Policy>
+class PolicyGhost: public Ghost {
+	// Strategie samt eventuellem eigenen Zustand
+	Policy policy;
+
+public:
+	/**
+	  * Geist erzeugen.
+	  * @param x X-Position der Zelle des Spielfeldes, in der Geist
+	  *          platziert wird.
+	  * @param y Y-Position der Zelle des Spielfeldes, in der Geist
+	  *          platziert wird.
+	  * @param controller  Spiele-Controller, der die Aktionen
+	  *                    bewertet und die Figuren steuert.
+	  * @param personality Verhalten bei der Verfolgung.
+	  * @param policy      Strategie, die die Richtung waehlt.
+	  */
+	PolicyGhost(unsigned int x, unsigned int y, GameController* controller,
+				GhostPersonality personality = Chaser, const Policy& policy = Policy())
+			:	Ghost(x, y, controller, personality), policy(policy)
+	{
+	}
+
+	/**
+	  * Naechster Zeittakt: Ist der Geist an der Reihe, waehlt die
+	  * Strategie die Richtung, bei mehreren Zellen im Takt fuer jede.
+	  */
+	virtual void nextTick() {
+		if (advanceTicks()) {
+			do {
+				walk(policy.chooseDirection(*this, *controller));
+			} while (continueTicks());
+		}
+	}
+
+	/**
+	  * Zustand eines Geistes mit derselben Strategie uebernehmen.
+	  * @param other Anderer Geist.
+	  */
+	virtual void copyStateFrom(const Figure& other) {
+		Ghost::copyStateFrom(other);
+		policy = static_cast<const PolicyGhost&>(other).policy;
+	}
+
+	/**
+	  * Strategie des Geistes auslesen, z.B. um ihren Zustand
+	  * einzustellen.
+	  * @return Referenz auf die Strategie.
+	  */
+	Policy& getPolicy() {
+		return policy;
+	}
+};
+
+/**
+  * Einen Geist mit der Strategie eines Levels erzeugen. Nur hier wird
+  * zur Laufzeit unterschieden, danach ist die Strategie fest.
+  * @param policy      Strategie der Geister.
+  * @param x           X-Position der Startzelle.
+  * @param y           Y-Position der Startzelle.
+  * @param controller  Spiele-Controller.
+  * @param personality Verhalten bei der Verfolgung.
+  * @return Neuer Geist.
+  */
+Ghost* createGhost(GhostPolicy policy, unsigned int x, unsigned int y,
+				   GameController* controller, GhostPersonality personality);
+
+#endif // GHOST_POLICY_H
@@ -0,0 +1,523 @@
+#include "direction.hpp"
+#include "hierarchical_pathfinder.hpp"
+#include "maze_grid.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+const unsigned int HierarchicalPathfinder::NONE;
+
+
+/**
+  * Eine Wegsuche ohne Labyrinth erzeugen.
+  * @param clusterSize Kantenlaenge eines Blocks in Zellen.
+  */
+HierarchicalPathfinder::HierarchicalPathfinder(unsigned int clusterSize) {
+	this->maze = 0;
+	this->clusterSize = (clusterSize > 0) ? clusterSize : DEFAULT_CLUSTER_SIZE;
+	this->clustersX = 0;
+	this->clustersY = 0;
+	this->forward.stamp = 0;
+	this->backward.stamp = 0;
+	this->nodeStamp = 0;
+	this->nextCachedPath = 0;
+}
+
+
+/**
+  * Den abstrakten Graphen fuer ein Labyrinth aufbauen. Das
+  * Labyrinth muss bis zum naechsten Aufruf unveraendert bleiben.
+  * @param maze Labyrinth.
+  */
+void HierarchicalPathfinder::build(const MazeGrid& maze) {
+	this->maze = &maze;
+	clustersX = (maze.getWidth() + clusterSize - 1) / clusterSize;
+	clustersY = (maze.getHeight() + clusterSize - 1) / clusterSize;
+	unsigned int clusterCount = clustersX * clustersY;
+	unsigned int cellCount = maze.getCellCount();
+
+	nodes.clear();
+	edges.clear();
+	edgeCells.clear();
+	cellNodes.assign(cellCount, NONE);
+
+	Search* searches[2] = { &forward, &backward };
+	for (unsigned int index = 0; index < 2; ++index) {
+		searches[ index ]->stamps.assign(cellCount, 0);
+		searches[ index ]->distances.resize(cellCount);
+		searches[ index ]->parents.resize(cellCount);
+		searches[ index ]->queue.clear();
+		searches[ index ]->queue.reserve(clusterSize * clusterSize);
+		searches[ index ]->stamp = 0;
+	}
+
+	// Uebergaenge an allen Seiten aller Bloecke
+	std::vector<unsigned int> links;
+	for (unsigned int cluster = 0; cluster < clusterCount; ++cluster) {
+		for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+			findEntrances(cluster, direction, links);
+		}
+	}
+
+	// Knoten nach Bloecken sortiert ablegen
+	clusterFirst.assign(clusterCount + 1, 0);
+	for (unsigned int node = 0; node < nodes.size(); ++node) {
+		clusterFirst[ nodes[ node ].cluster + 1 ]++;
+	}
+	for (unsigned int cluster = 0; cluster < clusterCount; ++cluster) {
+		clusterFirst[ cluster + 1 ] += clusterFirst[ cluster ];
+	}
+	clusterNodes.resize(nodes.size());
+	std::vector<unsigned int> filled(clusterFirst.begin(), clusterFirst.end() - 1);
+	for (unsigned int node = 0; node < nodes.size(); ++node) {
+		clusterNodes[ filled[ nodes[ node ].cluster ]++ ] = node;
+	}
+
+	// Kanten je Knoten sammeln: Uebergaenge kosten einen Schritt,
+	// innerhalb eines Blocks entscheidet die Breitensuche.
+	std::vector< std::vector<Edge> > adjacency(nodes.size());
+	for (unsigned int index = 0; index < links.size(); index += 2) {
+		Edge edge;
+		edge.target = cellNodes[ links[ index + 1 ] ];
+		edge.cost = 1;
+		edge.firstCell = edgeCells.size();
+		edgeCells.push_back(links[ index + 1 ]);
+		adjacency[ cellNodes[ links[ index ] ] ].push_back(edge);
+	}
+	for (unsigned int cluster = 0; cluster < clusterCount; ++cluster) {
+		for (unsigned int first = clusterFirst[ cluster ]; first < clusterFirst[ cluster + 1 ]; ++first) {
+			unsigned int node = clusterNodes[ first ];
+			searchCluster(forward, nodes[ node ].cell, false, NONE);
+			for (unsigned int other = clusterFirst[ cluster ]; other < clusterFirst[ cluster + 1 ]; ++other) {
+				unsigned int target = clusterNodes[ other ];
+				if (target != node && isReached(forward, nodes[ target ].cell)) {
+					Edge edge;
+					edge.target = target;
+					edge.cost = forward.distances[ nodes[ target ].cell ];
+					edge.firstCell = NONE;
+					adjacency[ node ].push_back(edge);
+				}
+			}
+		}
+	}
+
+	for (unsigned int node = 0; node < nodes.size(); ++node) {
+		nodes[ node ].firstEdge = edges.size();
+		nodes[ node ].edgeCount = adjacency[ node ].size();
+		edges.insert(edges.end(), adjacency[ node ].begin(), adjacency[ node ].end());
+	}
+
+	// Zusaetzlicher Platz fuer den virtuellen Zielknoten der Suche
+	nodeStamps.assign(nodes.size() + 1, 0);
+	nodeCosts.resize(nodes.size() + 1);
+	nodeParents.resize(nodes.size() + 1);
+	nodeParentEdges.resize(nodes.size() + 1);
+	nodeStamp = 0;
+
+	CachedPath unused;
+	unused.start = NONE;
+	unused.goal = NONE;
+	unused.direction = Direction::NONE;
+	cachedPaths.assign(CACHED_PATHS, unused);
+	nextCachedPath = 0;
+}
+
+
+/**
+  * Block einer Zelle ermitteln.
+  * @param cell Index der Zelle.
+  * @return Index des Blocks.
+  */
+unsigned int HierarchicalPathfinder::getCluster(unsigned int cell) const {
+	return (maze->getX(cell) / clusterSize) + (maze->getY(cell) / clusterSize) * clustersX;
+}
+
+
+/**
+  * Knoten auf einer Zelle liefern und ihn bei Bedarf anlegen.
+  * @param cell Index der Zelle.
+  * @return Index des Knotens.
+  */
+unsigned int HierarchicalPathfinder::getOrAddNode(unsigned int cell) {
+	if (cellNodes[ cell ] == NONE) {
+		Node node;
+		node.cell = cell;
+		node.cluster = getCluster(cell);
+		node.firstEdge = 0;
+		node.edgeCount = 0;
+		cellNodes[ cell ] = nodes.size();
+		nodes.push_back(node);
+	}
+	return cellNodes[ cell ];
+}
+
+
+/**
+  * Die Uebergaenge einer Seite eines Blocks suchen und fuer jeden
+  * zusammenhaengenden Abschnitt Knoten und Kanten anlegen. Ein
+  * kurzer Abschnitt bekommt einen Knoten in der Mitte, ein langer
+  * je einen an beiden Enden. Die Gegenrichtung legt die Suche an
+  * der gegenueberliegenden Seite des Nachbarblocks an, bei
+  * symmetrischen Ausgaengen mit denselben Zellen.
+  * @param cluster   Index des Blocks.
+  * @param direction Seite des Blocks (Konstante der Klasse 'Direction').
+  * @param links     Erhaelt die Kanten zwischen den Bloecken als
+  *                  Zellpaare (von, nach).
+  */
+void HierarchicalPathfinder::findEntrances(unsigned int cluster, unsigned int direction,
+										   std::vector<unsigned int>& links) {
+	unsigned int left = (cluster % clustersX) * clusterSize;
+	unsigned int top = (cluster / clustersX) * clusterSize;
+	unsigned int right = std::min(left + clusterSize, maze->getWidth()) - 1;
+	unsigned int bottom = std::min(top + clusterSize, maze->getHeight()) - 1;
+
+	// Erste Zelle der Seite, Abstand zweier Zellen entlang der Seite
+	// und die Richtung, in der die Seite durchlaufen wird
+	unsigned int first = maze->getIndex((direction == Direction::RIGHT) ? right : left,
+										(direction == Direction::DOWN) ? bottom : top);
+	bool vertical = (direction == Direction::UP || direction == Direction::DOWN);
+	unsigned int stride = vertical ? 1 : maze->getWidth();
+	unsigned int along = vertical ? Direction::RIGHT : Direction::DOWN;
+	unsigned int count = vertical ? right - left + 1 : bottom - top + 1;
+
+	unsigned int runStart = NONE;
+	unsigned int previous = NONE;
+	for (unsigned int position = 0; position <= count; ++position) {
+		unsigned int cell = first + position * stride;
+		bool crossing = position < count && maze->isOpen(cell, direction)
+					 && getCluster(maze->getNeighbour(cell, direction)) != cluster;
+
+		// Ein Abschnitt geht nur weiter, wenn die Zellen auf beiden
+		// Seiten des Uebergangs untereinander verbunden sind.
+		bool joined = crossing && runStart != NONE
+				   && maze->isOpen(previous, along)
+				   && maze->isOpen(maze->getNeighbour(previous, direction), along);
+
+		if (runStart != NONE && !joined) {
+			unsigned int length = position - runStart;
+			unsigned int picks[2] = { runStart + length / 2, NONE };
+			if (length >= LONG_ENTRANCE) {
+				picks[ 0 ] = runStart;
+				picks[ 1 ] = position - 1;
+			}
+			for (unsigned int pick = 0; pick < 2 && picks[ pick ] != NONE; ++pick) {
+				unsigned int from = first + picks[ pick ] * stride;
+				unsigned int to = maze->getNeighbour(from, direction);
+				getOrAddNode(from);
+				getOrAddNode(to);
+				links.push_back(from);
+				links.push_back(to);
+			}
+			runStart = NONE;
+		}
+		if (crossing && runStart == NONE) {
+			runStart = position;
+		}
+		previous = cell;
+	}
+}
+
+
+/**
+  * Breitensuche innerhalb eines Blocks.
+  * @param search   Arbeitsspeicher der Suche.
+  * @param origin   Startzelle.
+  * @param reversed <code>true</code>, um entgegen der Laufrichtung
+  *                 zu suchen (Entfernungen zur Startzelle hin).
+  * @param target   Zelle, bei der die Suche abbrechen darf, oder NONE.
+  */
+void HierarchicalPathfinder::searchCluster(Search& search, unsigned int origin, bool reversed, unsigned int target) {
+	if (++search.stamp == 0) {
+		std::fill(search.stamps.begin(), search.stamps.end(), 0);
+		search.stamp = 1;
+	}
+
+	unsigned int cluster = getCluster(origin);
+	search.queue.clear();
+	search.queue.push_back(origin);
+	search.stamps[ origin ] = search.stamp;
+	search.distances[ origin ] = 0;
+	search.parents[ origin ] = NONE;
+
+	for (unsigned int head = 0; head < search.queue.size(); ++head) {
+		unsigned int cell = search.queue[ head ];
+		if (cell == target) {
+			break;
+		}
+
+		for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+			unsigned int next;
+			if (reversed) {
+				// Vorgaenger: Nachbar, von dem aus es hierher geht
+				next = maze->getNeighbour(cell, direction);
+				if (!maze->isOpen(next, MazeGrid::getOpposite(direction))) {
+					continue;
+				}
+			}
+			else {
+				if (!maze->isOpen(cell, direction)) {
+					continue;
+				}
+				next = maze->getNeighbour(cell, direction);
+			}
+
+			if (search.stamps[ next ] != search.stamp && getCluster(next) == cluster) {
+				search.stamps[ next ] = search.stamp;
+				search.distances[ next ] = search.distances[ cell ] + 1;
+				search.parents[ next ] = cell;
+				search.queue.push_back(next);
+			}
+		}
+	}
+}
+
+
+/**
+  * Wurde die Zelle bei der letzten Suche erreicht?
+  * @param search Arbeitsspeicher der Suche.
+  * @param cell   Index der Zelle.
+  * @return <code>true</code>, wenn die Zelle erreicht wurde.
+  */
+bool HierarchicalPathfinder::isReached(const Search& search, unsigned int cell) const {
+	return search.stamps[ cell ] == search.stamp;
+}
+
+
+/**
+  * Zellfolge einer Kante innerhalb eines Blocks ermitteln und
+  * aufbewahren.
+  * @param node Startknoten.
+  * @param edge Index der Kante.
+  */
+void HierarchicalPathfinder::refineEdge(unsigned int node, unsigned int edge) {
+	unsigned int target = nodes[ edges[ edge ].target ].cell;
+	searchCluster(forward, nodes[ node ].cell, false, target);
+
+	unsigned int firstCell = edgeCells.size();
+	for (unsigned int cell = target; cell != nodes[ node ].cell; cell = forward.parents[ cell ]) {
+		edgeCells.push_back(cell);
+	}
+	std::reverse(edgeCells.begin() + firstCell, edgeCells.end());
+	edges[ edge ].firstCell = firstCell;
+}
+
+
+/**
+  * Untere Schranke fuer die Weglaenge zwischen zwei Zellen. Da die
+  * Tunnel am Rand auf die andere Seite fuehren, wird in jeder Achse
+  * auch der Weg um den Rand herum beruecksichtigt.
+  * @param from Index der ersten Zelle.
+  * @param to   Index der zweiten Zelle.
+  * @return Abstand in Zellen.
+  */
+unsigned int HierarchicalPathfinder::estimate(unsigned int from, unsigned int to) const {
+	unsigned int fromX = maze->getX(from), toX = maze->getX(to);
+	unsigned int fromY = maze->getY(from), toY = maze->getY(to);
+	unsigned int dx = (fromX > toX) ? fromX - toX : toX - fromX;
+	unsigned int dy = (fromY > toY) ? fromY - toY : toY - fromY;
+	return std::min(dx, maze->getWidth() - dx) + std::min(dy, maze->getHeight() - dy);
+}
+
+
+/**
+  * Richtung des Schrittes zwischen zwei benachbarten Zellen.
+  * @param from Index der Ausgangszelle.
+  * @param to   Index der Nachbarzelle.
+  * @return Konstante der Klasse 'Direction' oder Direction::NONE.
+  */
+unsigned int HierarchicalPathfinder::getStepDirection(unsigned int from, unsigned int to) const {
+	for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+		if (maze->isOpen(from, direction) && maze->getNeighbour(from, direction) == to) {
+			return direction;
+		}
+	}
+	return Direction::NONE;
+}
+
+
+/**
+  * Anzahl Knoten des abstrakten Graphen auslesen.
+  * @return Anzahl Knoten.
+  */
+unsigned int HierarchicalPathfinder::getNodeCount() const {
+	return nodes.size();
+}
+
+
+/**
+  * Anzahl gerichteter Kanten des abstrakten Graphen auslesen.
+  * @return Anzahl Kanten.
+  */
+unsigned int HierarchicalPathfinder::getEdgeCount() const {
+	return edges.size();
+}
+
+
+/**
+  * Einen Weg zwischen zwei Zellen suchen. Liegen beide im selben
+  * Block, wird zuerst dort gesucht. Sonst werden Start und Ziel
+  * ueber Breitensuchen in ihren Bloecken an die Knoten angebunden
+  * und der abstrakte Graph mit A* durchsucht. Das Ziel ist dabei
+  * ein zusaetzlicher, virtueller Knoten.
+  * @param start Index der Startzelle.
+  * @param goal  Index der Zielzelle.
+  * @param path  Erhaelt die Zellen des Weges ohne Start, mit Ziel.
+  * @return Laenge des Weges oder NONE, wenn das Ziel nicht
+  *         erreichbar ist.
+  */
+unsigned int HierarchicalPathfinder::findPath(unsigned int start, unsigned int goal, std::vector<unsigned int>& path) {
+	path.clear();
+	if (maze == 0) {
+		return NONE;
+	}
+	if (start == goal) {
+		return 0;
+	}
+
+	unsigned int goalCluster = getCluster(goal);
+	if (getCluster(start) == goalCluster) {
+		searchCluster(forward, start, false, goal);
+		if (isReached(forward, goal)) {
+			for (unsigned int cell = goal; cell != start; cell = forward.parents[ cell ]) {
+				path.push_back(cell);
+			}
+			std::reverse(path.begin(), path.end());
+			return path.size();
+		}
+	}
+
+	searchCluster(forward, start, false, NONE);
+	searchCluster(backward, goal, true, NONE);
+
+	if (++nodeStamp == 0) {
+		std::fill(nodeStamps.begin(), nodeStamps.end(), 0);
+		nodeStamp = 1;
+	}
+
+	typedef std::pair<unsigned int, unsigned int> Entry;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+	unsigned int goalNode = nodes.size();
+
+	unsigned int startCluster = getCluster(start);
+	for (unsigned int first = clusterFirst[ startCluster ]; first < clusterFirst[ startCluster + 1 ]; ++first) {
+		unsigned int node = clusterNodes[ first ];
+		if (isReached(forward, nodes[ node ].cell)) {
+			nodeStamps[ node ] = nodeStamp;
+			nodeCosts[ node ] = forward.distances[ nodes[ node ].cell ];
+			nodeParents[ node ] = NONE;
+			nodeParentEdges[ node ] = NONE;
+			open.push(Entry(nodeCosts[ node ] + estimate(nodes[ node ].cell, goal), node));
+		}
+	}
+
+	bool found = false;
+	while (!open.empty()) {
+		Entry entry = open.top();
+		open.pop();
+
+		unsigned int node = entry.second;
+		if (node == goalNode) {
+			found = true;
+			break;
+		}
+
+		// Veraltete Eintraege ueberspringen
+		unsigned int cost = nodeCosts[ node ];
+		if (entry.first != cost + estimate(nodes[ node ].cell, goal)) {
+			continue;
+		}
+
+		// Vom Block des Ziels aus geht es direkt zum Ziel.
+		if (nodes[ node ].cluster == goalCluster && isReached(backward, nodes[ node ].cell)) {
+			unsigned int total = cost + backward.distances[ nodes[ node ].cell ];
+			if (nodeStamps[ goalNode ] != nodeStamp || total < nodeCosts[ goalNode ]) {
+				nodeStamps[ goalNode ] = nodeStamp;
+				nodeCosts[ goalNode ] = total;
+				nodeParents[ goalNode ] = node;
+				nodeParentEdges[ goalNode ] = NONE;
+				open.push(Entry(total, goalNode));
+			}
+		}
+
+		for (unsigned int index = nodes[ node ].firstEdge; index < nodes[ node ].firstEdge + nodes[ node ].edgeCount; ++index) {
+			unsigned int target = edges[ index ].target;
+			unsigned int total = cost + edges[ index ].cost;
+			if (nodeStamps[ target ] != nodeStamp || total < nodeCosts[ target ]) {
+				nodeStamps[ target ] = nodeStamp;
+				nodeCosts[ target ] = total;
+				nodeParents[ target ] = node;
+				nodeParentEdges[ target ] = index;
+				open.push(Entry(total + estimate(nodes[ target ].cell, goal), target));
+			}
+		}
+	}
+
+	if (!found) {
+		return NONE;
+	}
+
+	// Knotenfolge vom Ziel aus zurueckverfolgen
+	route.clear();
+	for (unsigned int node = nodeParents[ goalNode ]; node != NONE; node = nodeParents[ node ]) {
+		route.push_back(node);
+	}
+	std::reverse(route.begin(), route.end());
+
+	// Vom Start zum ersten Knoten (muss vor dem Verfeinern der Kanten
+	// geschehen, da dabei dieselbe Suche verwendet wird)
+	for (unsigned int cell = nodes[ route.front() ].cell; cell != start; cell = forward.parents[ cell ]) {
+		path.push_back(cell);
+	}
+	std::reverse(path.begin(), path.end());
+
+	for (unsigned int index = 1; index < route.size(); ++index) {
+		unsigned int edge = nodeParentEdges[ route[ index ] ];
+		if (edges[ edge ].firstCell == NONE) {
+			refineEdge(route[ index - 1 ], edge);
+		}
+		path.insert(path.end(), edgeCells.begin() + edges[ edge ].firstCell,
+					edgeCells.begin() + edges[ edge ].firstCell + edges[ edge ].cost);
+	}
+
+	// Vom letzten Knoten zum Ziel
+	for (unsigned int cell = nodes[ route.back() ].cell; cell != goal;) {
+		cell = backward.parents[ cell ];
+		path.push_back(cell);
+	}
+
+	return path.size();
+}
+
+
+/**
+  * Richtung des ersten Schrittes auf dem Weg zu einer Zelle. Die
+  * Antwort haengt nur von Start und Ziel ab, aufbewahrt werden nur
+  * die Antworten fuer genau diese Paare.
+  * @param start Index der Startzelle.
+  * @param goal  Index der Zielzelle.
+  * @return Konstante der Klasse 'Direction' oder Direction::NONE,
+  *         wenn das Ziel nicht erreichbar ist oder Start und Ziel
+  *         uebereinstimmen.
+  */
+unsigned int HierarchicalPathfinder::getDirection(unsigned int start, unsigned int goal) {
+	if (maze == 0 || start == goal) {
+		return Direction::NONE;
+	}
+
+	for (unsigned int index = 0; index < cachedPaths.size(); ++index) {
+		const CachedPath& cached = cachedPaths[ index ];
+		if (cached.start == start && cached.goal == goal) {
+			return cached.direction;
+		}
+	}
+
+	CachedPath& cached = cachedPaths[ nextCachedPath ];
+	nextCachedPath = (nextCachedPath + 1) % cachedPaths.size();
+
+	cached.start = start;
+	cached.goal = goal;
+	cached.direction = (findPath(start, goal, foundPath) != NONE)
+		? getStepDirection(start, foundPath.front()) : (unsigned int) Direction::NONE;
+	return cached.direction;
+}
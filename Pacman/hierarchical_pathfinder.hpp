@@ -0,0 +1,235 @@
+#ifndef HIERARCHICAL_PATHFINDER_H
+#define HIERARCHICAL_PATHFINDER_H
+
+#include <vector>
+
+class MazeGrid;
+
+/**
+  * Hierarchische Wegsuche nach dem Vorbild von HPA*. Das Labyrinth
+  * wird in quadratische Bloecke (Cluster) zerlegt. An den Uebergaengen
+  * zwischen zwei Bloecken (auch durch Tunnel) liegen die Knoten eines
+  * abstrakten Graphen, innerhalb eines Blocks sind sie ueber die
+  * Laenge ihres kuerzesten Weges verbunden. Eine Anfrage durchsucht
+  * nur die Bloecke von Start und Ziel sowie den abstrakten Graphen.
+  * Die Zellfolgen der abstrakten Kanten werden erst bei Bedarf
+  * ermittelt und dann aufbewahrt, ebenso die Antworten der letzten
+  * Anfragen.
+  */
+class HierarchicalPathfinder {
+public:
+	// Kennzeichnet "keine Zelle", "kein Knoten" bzw. "kein Weg".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	// Kantenlaenge eines Blocks, wenn nichts anderes angegeben ist.
+	static const unsigned int DEFAULT_CLUSTER_SIZE = 16;
+
+	// Ab dieser Laenge bekommt ein Uebergang zwei Knoten (an den
+	// Enden) statt einem in der Mitte.
+	static const unsigned int LONG_ENTRANCE = 6;
+
+	// Anzahl aufbewahrter Antworten von getDirection().
+	static const unsigned int CACHED_PATHS = 32;
+
+private:
+	// Knoten des abstrakten Graphen: eine Zelle an einem Uebergang.
+	struct Node {
+		unsigned int cell;
+		unsigned int cluster;
+		// Abgehende Kanten im Vektor 'edges'
+		unsigned int firstEdge;
+		unsigned int edgeCount;
+	};
+
+	// Gerichtete Kante des abstrakten Graphen.
+	struct Edge {
+		unsigned int target;
+		unsigned int cost;
+		// Zellfolge im Vektor 'edgeCells' (ohne Start, mit Ziel)
+		// oder NONE, solange sie noch nicht ermittelt wurde
+		unsigned int firstCell;
+	};
+
+	// Antwort einer frueheren Anfrage von getDirection(). Aufbewahrt
+	// wird nur genau das Paar aus Start und Ziel: Ein Stueck eines
+	// gefundenen Weges ist nicht immer der Weg, den eine neue Suche ab
+	// seinem Anfang liefert, und die Richtung darf nicht davon abhaengen,
+	// welche Wege gerade aufbewahrt sind (z.B. nach Field::copyStateFrom()).
+	struct CachedPath {
+		unsigned int start;
+		unsigned int goal;
+		unsigned int direction;
+	};
+
+	// Labyrinth, fuer das der Graph aufgebaut wurde
+	const MazeGrid* maze;
+
+	// Kantenlaenge eines Blocks
+	unsigned int clusterSize;
+
+	// Anzahl Bloecke in der Breite und in der Hoehe
+	unsigned int clustersX;
+	unsigned int clustersY;
+
+	// Abstrakter Graph
+	std::vector<Node> nodes;
+	std::vector<Edge> edges;
+	std::vector<unsigned int> edgeCells;
+
+	// Knoten je Zelle oder NONE
+	std::vector<unsigned int> cellNodes;
+
+	// Knoten je Block: Block b besitzt die Knoten
+	// clusterNodes[ clusterFirst[b] ] bis clusterNodes[ clusterFirst[b + 1] - 1 ]
+	std::vector<unsigned int> clusterFirst;
+	std::vector<unsigned int> clusterNodes;
+
+	// Arbeitsspeicher der Breitensuchen innerhalb eines Blocks. Eine
+	// Zelle gilt nur als besucht, wenn ihr Stempel dem aktuellen
+	// entspricht, so muss vor einer Suche nichts geloescht werden.
+	struct Search {
+		std::vector<unsigned int> stamps;
+		std::vector<unsigned int> distances;
+		std::vector<unsigned int> parents;
+		std::vector<unsigned int> queue;
+		unsigned int stamp;
+	};
+	Search forward;
+	Search backward;
+
+	// Arbeitsspeicher der Suche im abstrakten Graphen
+	std::vector<unsigned int> nodeStamps;
+	std::vector<unsigned int> nodeCosts;
+	std::vector<unsigned int> nodeParents;
+	std::vector<unsigned int> nodeParentEdges;
+	unsigned int nodeStamp;
+
+	// Knotenfolge und Zellen des zuletzt gefundenen Weges
+	std::vector<unsigned int> route;
+	std::vector<unsigned int> foundPath;
+
+	// Antworten der letzten Anfragen und die als naechstes zu ersetzende
+	std::vector<CachedPath> cachedPaths;
+	unsigned int nextCachedPath;
+
+	/**
+	  * Block einer Zelle ermitteln.
+	  * @param cell Index der Zelle.
+	  * @return Index des Blocks.
+	  */
+	unsigned int getCluster(unsigned int cell) const;
+
+	/**
+	  * Knoten auf einer Zelle liefern und ihn bei Bedarf anlegen.
+	  * @param cell Index der Zelle.
+	  * @return Index des Knotens.
+	  */
+	unsigned int getOrAddNode(unsigned int cell);
+
+	/**
+	  * Die Uebergaenge einer Seite eines Blocks suchen und fuer jeden
+	  * zusammenhaengenden Abschnitt Knoten und Kanten anlegen.
+	  * @param cluster   Index des Blocks.
+	  * @param direction Seite des Blocks (Konstante der Klasse 'Direction').
+	  * @param links     Erhaelt die Kanten zwischen den Bloecken als
+	  *                  Zellpaare (von, nach).
+	  */
+	void findEntrances(unsigned int cluster, unsigned int direction,
+					   std::vector<unsigned int>& links);
+
+	/**
+	  * Breitensuche innerhalb eines Blocks.
+	  * @param search   Arbeitsspeicher der Suche.
+	  * @param origin   Startzelle.
+	  * @param reversed <code>true</code>, um entgegen der Laufrichtung
+	  *                 zu suchen (Entfernungen zur Startzelle hin).
+	  * @param target   Zelle, bei der die Suche abbrechen darf, oder NONE.
+	  */
+	void searchCluster(Search& search, unsigned int origin, bool reversed, unsigned int target);
+
+	/**
+	  * Wurde die Zelle bei der letzten Suche erreicht?
+	  * @param search Arbeitsspeicher der Suche.
+	  * @param cell   Index der Zelle.
+	  * @return <code>true</code>, wenn die Zelle erreicht wurde.
+	  */
+	bool isReached(const Search& search, unsigned int cell) const;
+
+	/**
+	  * Zellfolge einer Kante innerhalb eines Blocks ermitteln und
+	  * aufbewahren.
+	  * @param node Startknoten.
+	  * @param edge Index der Kante.
+	  */
+	void refineEdge(unsigned int node, unsigned int edge);
+
+	/**
+	  * Untere Schranke fuer die Weglaenge zwischen zwei Zellen. Da die
+	  * Tunnel am Rand auf die andere Seite fuehren, wird in jeder Achse
+	  * auch der Weg um den Rand herum beruecksichtigt.
+	  * @param from Index der ersten Zelle.
+	  * @param to   Index der zweiten Zelle.
+	  * @return Abstand in Zellen.
+	  */
+	unsigned int estimate(unsigned int from, unsigned int to) const;
+
+	/**
+	  * Richtung des Schrittes zwischen zwei benachbarten Zellen.
+	  * @param from Index der Ausgangszelle.
+	  * @param to   Index der Nachbarzelle.
+	  * @return Konstante der Klasse 'Direction' oder Direction::NONE.
+	  */
+	unsigned int getStepDirection(unsigned int from, unsigned int to) const;
+
+public:
+	/**
+	  * Eine Wegsuche ohne Labyrinth erzeugen.
+	  * @param clusterSize Kantenlaenge eines Blocks in Zellen.
+	  */
+	HierarchicalPathfinder(unsigned int clusterSize = DEFAULT_CLUSTER_SIZE);
+
+	/**
+	  * Den abstrakten Graphen fuer ein Labyrinth aufbauen. Das
+	  * Labyrinth muss bis zum naechsten Aufruf unveraendert bleiben.
+	  * @param maze Labyrinth.
+	  */
+	void build(const MazeGrid& maze);
+
+	/**
+	  * Anzahl Knoten des abstrakten Graphen auslesen.
+	  * @return Anzahl Knoten.
+	  */
+	unsigned int getNodeCount() const;
+
+	/**
+	  * Anzahl gerichteter Kanten des abstrakten Graphen auslesen.
+	  * @return Anzahl Kanten.
+	  */
+	unsigned int getEdgeCount() const;
+
+	/**
+	  * Einen Weg zwischen zwei Zellen suchen. Der Weg ist nicht in
+	  * jedem Fall der kuerzeste, da er ueber die Knoten an den
+	  * Uebergaengen fuehrt.
+	  * @param start Index der Startzelle.
+	  * @param goal  Index der Zielzelle.
+	  * @param path  Erhaelt die Zellen des Weges ohne Start, mit Ziel.
+	  * @return Laenge des Weges oder NONE, wenn das Ziel nicht
+	  *         erreichbar ist.
+	  */
+	unsigned int findPath(unsigned int start, unsigned int goal, std::vector<unsigned int>& path);
+
+	/**
+	  * Richtung des ersten Schrittes auf dem Weg zu einer Zelle, also
+	  * des Weges von findPath(). Wurde dasselbe Paar aus Start und Ziel
+	  * zuvor schon angefragt, wird die aufbewahrte Antwort verwendet.
+	  * @param start Index der Startzelle.
+	  * @param goal  Index der Zielzelle.
+	  * @return Konstante der Klasse 'Direction' oder Direction::NONE,
+	  *         wenn das Ziel nicht erreichbar ist oder Start und Ziel
+	  *         uebereinstimmen.
+	  */
+	unsigned int getDirection(unsigned int start, unsigned int goal);
+};
+
+#endif // HIERARCHICAL_PATHFINDER_H
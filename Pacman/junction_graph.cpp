@@ -0,0 +1,301 @@
+#include "direction.hpp"
+#include "junction_graph.hpp"
+#include "maze_grid.hpp"
+
+const unsigned int JunctionGraph::NONE;
+
+
+/**
+  * Einen leeren Graphen erzeugen.
+  */
+JunctionGraph::JunctionGraph() {
+}
+
+
+/**
+  * Einen Knoten auf einer Zelle anlegen.
+  * @param cell Index der Zelle.
+  */
+void JunctionGraph::addNode(unsigned int cell) {
+	Node node;
+	node.cell = cell;
+	for (unsigned int index = 0; index < 4; ++index) {
+		node.edges[ index ] = NONE;
+	}
+	cellNodes[ cell ] = nodes.size();
+	nodes.push_back(node);
+}
+
+
+/**
+  * Den Korridor ab einem Knoten in einer Richtung bis zum
+  * naechsten Knoten verfolgen und als Kante eintragen. In einer
+  * Korridorzelle bleibt neben der Gegenrichtung genau ein Ausgang.
+  * @param maze      Labyrinth.
+  * @param node      Startknoten.
+  * @param direction Richtung des ersten Schrittes.
+  */
+void JunctionGraph::traceEdge(const MazeGrid& maze, unsigned int node, unsigned int direction) {
+	unsigned int edgeIndex = edges.size();
+
+	Edge edge;
+	edge.from = node;
+	edge.reverse = NONE;
+	edge.firstDirection = direction;
+	edge.firstCell = corridorCells.size();
+
+	unsigned int cell = maze.getNeighbour(nodes[ node ].cell, direction);
+	unsigned int length = 1;
+	while (cellNodes[ cell ] == NONE) {
+		direction = maze.getExits(cell) & ~MazeGrid::getOpposite(direction);
+
+		corridorCells.push_back(cell);
+		cellEdges[ cell ] = edgeIndex;
+		cellSteps[ cell ] = length;
+		cellDirections[ cell ] = (unsigned char) direction;
+
+		cell = maze.getNeighbour(cell, direction);
+		length++;
+	}
+
+	edge.to = cellNodes[ cell ];
+	edge.length = length;
+	edge.lastDirection = direction;
+	nodes[ node ].edges[ MazeGrid::getDirectionIndex(edge.firstDirection) ] = edgeIndex;
+	edges.push_back(edge);
+}
+
+
+/**
+  * Den Graphen fuer ein Labyrinth neu aufbauen. Zellen mit
+  * Einbahnausgaengen (z.B. ein Tunnel mit nur einem Ende) werden
+  * ebenfalls zu Knoten, damit jeder Korridor in beide Richtungen
+  * begehbar ist. Ein Ring ganz ohne Kreuzung bekommt einen
+  * Knoten auf einer beliebigen seiner Zellen.
+  * @param maze Labyrinth.
+  */
+void JunctionGraph::build(const MazeGrid& maze) {
+	unsigned int cellCount = maze.getCellCount();
+	nodes.clear();
+	edges.clear();
+	corridorCells.clear();
+	cellNodes.assign(cellCount, NONE);
+	cellEdges.assign(cellCount, NONE);
+	cellSteps.assign(cellCount, 0);
+	cellDirections.assign(cellCount, Direction::NONE);
+
+	// Aus welchen Richtungen kann eine Zelle betreten werden?
+	std::vector<unsigned char> entries(cellCount, Direction::NONE);
+	for (unsigned int cell = 0; cell < cellCount; ++cell) {
+		unsigned int exits = maze.getExits(cell);
+		for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+			if (exits & direction) {
+				entries[ maze.getNeighbour(cell, direction) ] |= MazeGrid::getOpposite(direction);
+			}
+		}
+	}
+
+	// Knoten sind alle begehbaren Zellen, die kein reiner Korridor sind.
+	for (unsigned int cell = 0; cell < cellCount; ++cell) {
+		unsigned int exits = maze.getExits(cell);
+		if (exits == Direction::NONE && entries[ cell ] == Direction::NONE) {
+			continue;
+		}
+		if (MazeGrid::countExits(exits) != 2 || exits != entries[ cell ]) {
+			addNode(cell);
+		}
+	}
+
+	unsigned int junctionCount = nodes.size();
+	for (unsigned int node = 0; node < junctionCount; ++node) {
+		unsigned int exits = maze.getExits(nodes[ node ].cell);
+		for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+			if (exits & direction) {
+				traceEdge(maze, node, direction);
+			}
+		}
+	}
+
+	// Uebrig gebliebene Korridorzellen liegen auf Ringen ohne Kreuzung.
+	for (unsigned int cell = 0; cell < cellCount; ++cell) {
+		if (cellNodes[ cell ] == NONE && cellEdges[ cell ] == NONE && maze.getExits(cell) != Direction::NONE) {
+			addNode(cell);
+			unsigned int exits = maze.getExits(cell);
+			for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+				if (exits & direction) {
+					traceEdge(maze, nodes.size() - 1, direction);
+				}
+			}
+		}
+	}
+
+	// Gegenkanten zuordnen: Sie verlassen den Zielknoten entgegen
+	// dem letzten Schritt.
+	for (unsigned int index = 0; index < edges.size(); ++index) {
+		Edge& edge = edges[ index ];
+		unsigned int candidate = nodes[ edge.to ].edges[ MazeGrid::getDirectionIndex(MazeGrid::getOpposite(edge.lastDirection)) ];
+		if (candidate != NONE && edges[ candidate ].to == edge.from && edges[ candidate ].length == edge.length) {
+			edge.reverse = candidate;
+		}
+	}
+}
+
+
+/**
+  * Anzahl Knoten auslesen.
+  * @return Anzahl Knoten.
+  */
+unsigned int JunctionGraph::getNodeCount() const {
+	return nodes.size();
+}
+
+
+/**
+  * Einen Knoten auslesen.
+  * @param node Index des Knotens.
+  * @return Referenz auf den Knoten.
+  */
+const JunctionGraph::Node& JunctionGraph::getNode(unsigned int node) const {
+	return nodes[ node ];
+}
+
+
+/**
+  * Anzahl gerichteter Kanten auslesen.
+  * @return Anzahl Kanten.
+  */
+unsigned int JunctionGraph::getEdgeCount() const {
+	return edges.size();
+}
+
+
+/**
+  * Eine Kante auslesen.
+  * @param edge Index der Kante.
+  * @return Referenz auf die Kante.
+  */
+const JunctionGraph::Edge& JunctionGraph::getEdge(unsigned int edge) const {
+	return edges[ edge ];
+}
+
+
+/**
+  * Knoten auf einer Zelle ermitteln.
+  * @param cell Index der Zelle.
+  * @return Index des Knotens oder NONE, wenn die Zelle in einem
+  *         Korridor liegt oder geschlossen ist.
+  */
+unsigned int JunctionGraph::getNodeAt(unsigned int cell) const {
+	return cellNodes[ cell ];
+}
+
+
+/**
+  * Zelle ermitteln, die nach 'step' Schritten auf einer Kante
+  * erreicht ist.
+  * @param edge Index der Kante.
+  * @param step Schritte ab dem Startknoten (0 bis Laenge).
+  * @return Index der Zelle.
+  */
+unsigned int JunctionGraph::getCellOnEdge(unsigned int edge, unsigned int step) const {
+	const Edge& current = edges[ edge ];
+	if (step == 0) {
+		return nodes[ current.from ].cell;
+	}
+	if (step >= current.length) {
+		return nodes[ current.to ].cell;
+	}
+	return corridorCells[ current.firstCell + step - 1 ];
+}
+
+
+/**
+  * Nach wievielen Schritten auf einer Kante wird eine Zelle
+  * erreicht? Der Startknoten selbst zaehlt nicht. Eine Korridorzelle
+  * liegt nur auf den beiden Kanten ihres Korridors.
+  * @param edge Index der Kante.
+  * @param cell Index der Zelle.
+  * @return Schritte (1 bis Laenge) oder NONE, wenn die Zelle
+  *         nicht hinter dem Startknoten auf der Kante liegt.
+  */
+unsigned int JunctionGraph::getStepOnEdge(unsigned int edge, unsigned int cell) const {
+	const Edge& current = edges[ edge ];
+	if (cell == nodes[ current.to ].cell) {
+		return current.length;
+	}
+
+	unsigned int known = cellEdges[ cell ];
+	if (known == edge) {
+		return cellSteps[ cell ];
+	}
+	if (known != NONE && edges[ known ].reverse == edge) {
+		return current.length - cellSteps[ cell ];
+	}
+	return NONE;
+}
+
+
+/**
+  * Richtung des Schrittes, mit dem auf einer Kante die Zelle
+  * nach 'step' Schritten betreten wird.
+  * @param maze Labyrinth, fuer das der Graph aufgebaut wurde.
+  * @param edge Index der Kante.
+  * @param step Schritte ab dem Startknoten (1 bis Laenge).
+  * @return Eine der Konstanten der Klasse 'Direction'.
+  */
+unsigned int JunctionGraph::getArrivalDirection(const MazeGrid& maze, unsigned int edge, unsigned int step) const {
+	const Edge& current = edges[ edge ];
+	if (step >= current.length) {
+		return current.lastDirection;
+	}
+	if (step <= 1) {
+		return current.firstDirection;
+	}
+
+	// Betreten wird die Zelle entgegen dem Ausgang, der zurueck fuehrt.
+	unsigned int cell = getCellOnEdge(edge, step);
+	if (cellEdges[ cell ] == edge) {
+		return MazeGrid::getOpposite(maze.getExits(cell) & ~cellDirections[ cell ]);
+	}
+	return MazeGrid::getOpposite(cellDirections[ cell ]);
+}
+
+
+/**
+  * Auf welcher Kante befindet sich eine Figur, die auf einer Zelle
+  * steht und in Richtung 'direction' weiterlaeuft?
+  * @param maze      Labyrinth, fuer das der Graph aufgebaut wurde.
+  * @param cell      Index der Zelle.
+  * @param direction Laufrichtung (eine der Konstanten der Klasse 'Direction').
+  * @param edge      Erhaelt den Index der Kante.
+  * @param step      Erhaelt die Anzahl Schritte vom Startknoten
+  *                  der Kante bis zur Zelle.
+  * @return <code>false</code>, wenn die Zelle in dieser Richtung
+  *         nicht verlassen werden kann.
+  */
+bool JunctionGraph::locate(const MazeGrid& maze, unsigned int cell, unsigned int direction,
+						   unsigned int& edge, unsigned int& step) const {
+	if (MazeGrid::countExits(direction) != 1 || !maze.isOpen(cell, direction)) {
+		return false;
+	}
+
+	unsigned int node = cellNodes[ cell ];
+	if (node != NONE) {
+		edge = nodes[ node ].edges[ MazeGrid::getDirectionIndex(direction) ];
+		step = 0;
+		return edge != NONE;
+	}
+
+	unsigned int known = cellEdges[ cell ];
+	if (known == NONE) {
+		return false;
+	}
+	if (direction == cellDirections[ cell ]) {
+		edge = known;
+		step = cellSteps[ cell ];
+		return true;
+	}
+	edge = edges[ known ].reverse;
+	step = edges[ known ].length - cellSteps[ cell ];
+	return edge != NONE;
+}
@@ -0,0 +1,177 @@
+#ifndef JUNCTION_GRAPH_H
+#define JUNCTION_GRAPH_H
+
+#include <vector>
+
+class MazeGrid;
+
+/**
+  * Kreuzungsgraph des Labyrinths. Knoten sind alle Zellen, an denen
+  * eine Figur eine Entscheidung treffen kann oder muss (Kreuzungen,
+  * Sackgassen), Kanten sind die Korridore dazwischen. Innerhalb eines
+  * Korridors hat jede Zelle genau zwei Ausgaenge, eine Figur laeuft
+  * also nur geradeaus oder um die einzige Ecke. Jeder Korridor wird
+  * durch zwei gerichtete Kanten beschrieben, eine je Laufrichtung.
+  */
+class JunctionGraph {
+public:
+	// Kennzeichnet "kein Knoten" bzw. "keine Kante".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	// Eine Kreuzung bzw. Sackgasse.
+	struct Node {
+		// Zelle im Labyrinth
+		unsigned int cell;
+		// Abgehende Kante je Richtung (Index siehe
+		// MazeGrid::getDirectionIndex()) oder NONE
+		unsigned int edges[4];
+	};
+
+	// Ein in einer Richtung durchlaufener Korridor.
+	struct Edge {
+		// Start- und Zielknoten
+		unsigned int from;
+		unsigned int to;
+		// Kante fuer die Gegenrichtung oder NONE (Einbahnstrasse)
+		unsigned int reverse;
+		// Anzahl Schritte vom Start- bis zum Zielknoten (Gewicht)
+		unsigned int length;
+		// Richtung des ersten und des letzten Schrittes
+		unsigned int firstDirection;
+		unsigned int lastDirection;
+		// Position der inneren Zellen (length - 1 Stueck) im
+		// Vektor 'corridorCells'
+		unsigned int firstCell;
+	};
+
+private:
+	// Alle Knoten
+	std::vector<Node> nodes;
+
+	// Alle gerichteten Kanten
+	std::vector<Edge> edges;
+
+	// Innere Zellen aller Kanten in Laufrichtung hintereinander
+	std::vector<unsigned int> corridorCells;
+
+	// Je Zelle: Knoten, der auf ihr liegt, oder NONE
+	std::vector<unsigned int> cellNodes;
+
+	// Je Korridorzelle: eine der beiden Kanten durch die Zelle, die
+	// Anzahl Schritte vom Startknoten bis zur Zelle und die Richtung,
+	// in der die Kante die Zelle verlaesst
+	std::vector<unsigned int> cellEdges;
+	std::vector<unsigned int> cellSteps;
+	std::vector<unsigned char> cellDirections;
+
+	/**
+	  * Einen Knoten auf einer Zelle anlegen.
+	  * @param cell Index der Zelle.
+	  */
+	void addNode(unsigned int cell);
+
+	/**
+	  * Den Korridor ab einem Knoten in einer Richtung bis zum
+	  * naechsten Knoten verfolgen und als Kante eintragen.
+	  * @param maze      Labyrinth.
+	  * @param node      Startknoten.
+	  * @param direction Richtung des ersten Schrittes.
+	  */
+	void traceEdge(const MazeGrid& maze, unsigned int node, unsigned int direction);
+
+public:
+	/**
+	  * Einen leeren Graphen erzeugen.
+	  */
+	JunctionGraph();
+
+	/**
+	  * Den Graphen fuer ein Labyrinth neu aufbauen. Zellen mit
+	  * Einbahnausgaengen (z.B. ein Tunnel mit nur einem Ende) werden
+	  * ebenfalls zu Knoten, damit jeder Korridor in beide Richtungen
+	  * begehbar ist. Ein Ring ganz ohne Kreuzung bekommt einen
+	  * Knoten auf einer beliebigen seiner Zellen.
+	  * @param maze Labyrinth.
+	  */
+	void build(const MazeGrid& maze);
+
+	/**
+	  * Anzahl Knoten auslesen.
+	  * @return Anzahl Knoten.
+	  */
+	unsigned int getNodeCount() const;
+
+	/**
+	  * Einen Knoten auslesen.
+	  * @param node Index des Knotens.
+	  * @return Referenz auf den Knoten.
+	  */
+	const Node& getNode(unsigned int node) const;
+
+	/**
+	  * Anzahl gerichteter Kanten auslesen.
+	  * @return Anzahl Kanten.
+	  */
+	unsigned int getEdgeCount() const;
+
+	/**
+	  * Eine Kante auslesen.
+	  * @param edge Index der Kante.
+	  * @return Referenz auf die Kante.
+	  */
+	const Edge& getEdge(unsigned int edge) const;
+
+	/**
+	  * Knoten auf einer Zelle ermitteln.
+	  * @param cell Index der Zelle.
+	  * @return Index des Knotens oder NONE, wenn die Zelle in einem
+	  *         Korridor liegt oder geschlossen ist.
+	  */
+	unsigned int getNodeAt(unsigned int cell) const;
+
+	/**
+	  * Zelle ermitteln, die nach 'step' Schritten auf einer Kante
+	  * erreicht ist.
+	  * @param edge Index der Kante.
+	  * @param step Schritte ab dem Startknoten (0 bis Laenge).
+	  * @return Index der Zelle.
+	  */
+	unsigned int getCellOnEdge(unsigned int edge, unsigned int step) const;
+
+	/**
+	  * Nach wievielen Schritten auf einer Kante wird eine Zelle
+	  * erreicht? Der Startknoten selbst zaehlt nicht.
+	  * @param edge Index der Kante.
+	  * @param cell Index der Zelle.
+	  * @return Schritte (1 bis Laenge) oder NONE, wenn die Zelle
+	  *         nicht hinter dem Startknoten auf der Kante liegt.
+	  */
+	unsigned int getStepOnEdge(unsigned int edge, unsigned int cell) const;
+
+	/**
+	  * Richtung des Schrittes, mit dem auf einer Kante die Zelle
+	  * nach 'step' Schritten betreten wird.
+	  * @param maze Labyrinth, fuer das der Graph aufgebaut wurde.
+	  * @param edge Index der Kante.
+	  * @param step Schritte ab dem Startknoten (1 bis Laenge).
+	  * @return Eine der Konstanten der Klasse 'Direction'.
+	  */
+	unsigned int getArrivalDirection(const MazeGrid& maze, unsigned int edge, unsigned int step) const;
+
+	/**
+	  * Auf welcher Kante befindet sich eine Figur, die auf einer Zelle
+	  * steht und in Richtung 'direction' weiterlaeuft?
+	  * @param maze      Labyrinth, fuer das der Graph aufgebaut wurde.
+	  * @param cell      Index der Zelle.
+	  * @param direction Laufrichtung (eine der Konstanten der Klasse 'Direction').
+	  * @param edge      Erhaelt den Index der Kante.
+	  * @param step      Erhaelt die Anzahl Schritte vom Startknoten
+	  *                  der Kante bis zur Zelle.
+	  * @return <code>false</code>, wenn die Zelle in dieser Richtung
+	  *         nicht verlassen werden kann.
+	  */
+	bool locate(const MazeGrid& maze, unsigned int cell, unsigned int direction,
+				unsigned int& edge, unsigned int& step) const;
+};
+
+#endif // JUNCTION_GRAPH_H
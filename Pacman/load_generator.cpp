@@ -0,0 +1,301 @@
+#include "game_server.hpp"
+#include "load_generator.hpp"
+#include "state_stream.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <boost/bind.hpp>
+#include <boost/enable_shared_from_this.hpp>
+
+/**
+  * Ein simulierter Spieler mit eigener Verbindung.
+  */
+class LoadGenerator::Client : public boost::enable_shared_from_this<LoadGenerator::Client> {
+	boost::asio::generic::stream_protocol::socket socket;
+	boost::asio::deadline_timer timer;
+	Statistics& statistics;
+
+	// Empfangene, noch nicht gelesene Bytes
+	std::vector<unsigned char> received;
+	unsigned char input[ 1024 ];
+
+	// Datenstrom der Staende
+	StateDecoder decoder;
+
+	// Gerade gesendete und danach zu sendende Bytes
+	std::vector<unsigned char> sending;
+	std::vector<unsigned char> pending;
+	bool writing;
+
+	// Zufallsgenerator der Tasten
+	boost::uint32_t random;
+
+	// Zeitpunkt des letzten Standes
+	boost::posix_time::ptime lastMessage;
+
+	/**
+	  * Naechste Zufallszahl.
+	  * @return Zufallszahl.
+	  */
+	boost::uint32_t nextRandom() {
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		return random;
+	}
+
+	/**
+	  * Verbindung aufgebaut: lesen und Tasten druecken.
+	  * @param error Fehler beim Verbinden.
+	  */
+	void handleConnect(const boost::system::error_code& error) {
+		if (error) {
+			++statistics.failed;
+			return;
+		}
+		++statistics.connected;
+		read();
+		press(boost::system::error_code());
+	}
+
+	/**
+	  * Auf Staende warten.
+	  */
+	void read() {
+		socket.async_read_some(boost::asio::buffer(input),
+			boost::bind(&Client::handleRead, shared_from_this(),
+						boost::asio::placeholders::error, boost::asio::placeholders::bytes_transferred));
+	}
+
+	/**
+	  * Vollstaendige Staende zaehlen und die Abstaende messen.
+	  * @param error Fehler beim Lesen.
+	  * @param bytes Anzahl empfangener Bytes.
+	  */
+	void handleRead(const boost::system::error_code& error, std::size_t bytes) {
+		if (error) {
+			if (error != boost::asio::error::operation_aborted) {
+				++statistics.disconnected;
+			}
+			timer.cancel();
+			return;
+		}
+		statistics.bytes += bytes;
+		received.insert(received.end(), input, input + bytes);
+
+		unsigned int offset = 0;
+		unsigned int length;
+		while (offset < received.size()
+			   && (length = decoder.decode(&received[ offset ], received.size() - offset)) != 0) {
+			// Ein fehlerhafter Stand beendet die Verbindung.
+			if (length == StateDecoder::INVALID) {
+				++statistics.disconnected;
+				close();
+				return;
+			}
+			offset += length;
+			++statistics.messages;
+
+			boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+			if (!lastMessage.is_not_a_date_time()) {
+				boost::uint64_t gap = (now - lastMessage).total_microseconds();
+				statistics.gapSum += gap;
+				statistics.maxGap = std::max(statistics.maxGap, gap);
+				if (gap > 2 * 1000000 / GameServer::TICKS_PER_SECOND) {
+					++statistics.lateMessages;
+				}
+			}
+			lastMessage = now;
+		}
+		received.erase(received.begin(), received.begin() + offset);
+		if (offset > 0) {
+			decoder.acknowledge(pending);
+			send();
+		}
+		read();
+	}
+
+	/**
+	  * Die gesammelten Bytes senden, falls nicht schon gesendet wird.
+	  */
+	void send() {
+		if (writing || pending.empty()) {
+			return;
+		}
+		sending.swap(pending);
+		pending.clear();
+		writing = true;
+		boost::asio::async_write(socket, boost::asio::buffer(sending),
+			boost::bind(&Client::handleWrite, shared_from_this(), boost::asio::placeholders::error));
+	}
+
+	/**
+	  * Eine zufaellige Richtung druecken oder loslassen und die naechste
+	  * Taste in 50 bis 500 ms planen.
+	  * @param error Fehler des Zeitgebers.
+	  */
+	void press(const boost::system::error_code& error) {
+		if (error) {
+			return;
+		}
+		static const unsigned char Keys[ 5 ] = { 0, 1, 2, 4, 8 };
+		pending.push_back(Keys[ nextRandom() % 5 ]);
+		++statistics.keys;
+		send();
+
+		timer.expires_from_now(boost::posix_time::milliseconds(50 + nextRandom() % 450));
+		timer.async_wait(boost::bind(&Client::press, shared_from_this(), boost::asio::placeholders::error));
+	}
+
+	/**
+	  * Bytes gesendet, inzwischen gesammelte hinterher senden.
+	  * @param error Fehler beim Senden.
+	  */
+	void handleWrite(const boost::system::error_code& error) {
+		writing = false;
+		if (error) {
+			close();
+			return;
+		}
+		send();
+	}
+
+public:
+	/**
+	  * Spieler erzeugen.
+	  * @param service    Ereignisschleife.
+	  * @param statistics Zaehler.
+	  * @param seed       Startwert des Zufallsgenerators.
+	  */
+	Client(boost::asio::io_service& service, Statistics& statistics, unsigned int seed)
+			:	socket(service), timer(service), statistics(statistics), writing(false)
+	{
+		random = (boost::uint32_t) (seed * 2654435761u) ^ 0x9E3779B9u;
+	}
+
+	/**
+	  * Verbinden.
+	  * @param endpoint Adresse des Servers.
+	  */
+	void connect(const boost::asio::generic::stream_protocol::endpoint& endpoint) {
+		socket.async_connect(endpoint,
+			boost::bind(&Client::handleConnect, shared_from_this(), boost::asio::placeholders::error));
+	}
+
+	/**
+	  * Verbindung schliessen und Zeitgeber anhalten.
+	  */
+	void close() {
+		boost::system::error_code ignored;
+		timer.cancel(ignored);
+		socket.close(ignored);
+	}
+};
+
+
+/**
+  * Lastprobe erzeugen.
+  */
+LoadGenerator::LoadGenerator()
+		:	seconds(0)
+{
+	std::memset(&statistics, 0, sizeof(statistics));
+}
+
+
+/**
+  * Beenden.
+  */
+LoadGenerator::~LoadGenerator() {
+}
+
+
+/**
+  * Alle Spieler verbinden und eine Zeit lang spielen lassen. Danach
+  * werden alle Verbindungen geschlossen.
+  * @param endpoint Adresse des Servers.
+  * @param count    Anzahl Spieler.
+  * @param duration Dauer in Sekunden.
+  */
+void LoadGenerator::run(const boost::asio::generic::stream_protocol::endpoint& endpoint, unsigned int count,
+						unsigned int duration) {
+	std::memset(&statistics, 0, sizeof(statistics));
+	clients.clear();
+	for (unsigned int index = 0; index < count; ++index) {
+		clients.push_back(boost::shared_ptr<Client>(new Client(service, statistics, index + 1)));
+		clients.back()->connect(endpoint);
+	}
+
+	boost::posix_time::ptime begin = boost::posix_time::microsec_clock::universal_time();
+	boost::asio::deadline_timer end(service, boost::posix_time::seconds(duration));
+	end.async_wait(boost::bind(&boost::asio::io_service::stop, &service));
+	service.reset();
+	service.run();
+	seconds = (boost::posix_time::microsec_clock::universal_time() - begin).total_microseconds() / 1e6;
+
+	for (unsigned int index = 0; index < clients.size(); ++index) {
+		clients[ index ]->close();
+	}
+	service.reset();
+	service.poll();
+	clients.clear();
+}
+
+
+/**
+  * Spieler ueber TCP auf der Loopback-Schnittstelle verbinden.
+  * @param port     Port des Servers.
+  * @param count    Anzahl Spieler.
+  * @param duration Dauer in Sekunden.
+  */
+void LoadGenerator::run(unsigned short port, unsigned int count, unsigned int duration) {
+	boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port);
+	run(boost::asio::generic::stream_protocol::endpoint(endpoint), count, duration);
+}
+
+
+/**
+  * Spieler ueber einen Unix-Domain-Socket verbinden.
+  * @param path     Pfad des Sockets.
+  * @param count    Anzahl Spieler.
+  * @param duration Dauer in Sekunden.
+  */
+void LoadGenerator::run(const std::string& path, unsigned int count, unsigned int duration) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	boost::asio::local::stream_protocol::endpoint endpoint(path);
+	run(boost::asio::generic::stream_protocol::endpoint(endpoint), count, duration);
+#else
+	throw boost::system::system_error(boost::asio::error::operation_not_supported);
+#endif
+}
+
+
+/**
+  * Zaehler der letzten Messung auslesen.
+  * @return Zaehler.
+  */
+const LoadGenerator::Statistics& LoadGenerator::getStatistics() const {
+	return statistics;
+}
+
+
+/**
+  * Ergebnis der letzten Messung ausgeben: Verbindungen, Staende je
+  * Spieler und Sekunde (im Soll TICKS_PER_SECOND), Abstaende.
+  * @param out Ausgabe.
+  */
+void LoadGenerator::report(std::ostream& out) const {
+	double perClient = statistics.connected > 0 && seconds > 0
+		? statistics.messages / (statistics.connected * seconds) : 0;
+	double meanGap = statistics.messages > statistics.connected
+		? (double) statistics.gapSum / (statistics.messages - statistics.connected) / 1000 : 0;
+
+	out << "connected " << statistics.connected << ", failed " << statistics.failed
+		<< ", disconnected " << statistics.disconnected << std::endl;
+	out << "keys " << statistics.keys << ", states " << statistics.messages
+		<< " (" << perClient << " per player and second), bytes " << statistics.bytes
+		<< " (" << (statistics.messages > 0 ? (double) statistics.bytes / statistics.messages : 0)
+		<< " per state)" << std::endl;
+	out << "gap mean " << meanGap << " ms, max " << statistics.maxGap / 1000.0 << " ms, late "
+		<< statistics.lateMessages << std::endl;
+}
@@ -0,0 +1,104 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+/**
+  * Lastprobe fuer GameServer: Viele simulierte Spieler in einem
+  * Thread verbinden sich, druecken in zufaelligen Abstaenden Tasten
+  * und lesen die Staende mit. Gemessen wird, ob der Server jeden
+  * Spieler im Takt bedient.
+  */
+class LoadGenerator {
+	class Client;
+
+public:
+	// Zaehler ueber alle Spieler
+	struct Statistics {
+		unsigned int connected;
+		unsigned int failed;
+		unsigned int disconnected;
+		boost::uint64_t messages;
+		boost::uint64_t bytes;
+		boost::uint64_t keys;
+
+		// Abstaende aufeinanderfolgender Staende eines Spielers in
+		// Mikrosekunden: Summe, Groesster, Anzahl mehr als doppelt so
+		// lang wie ein Takt
+		boost::uint64_t gapSum;
+		boost::uint64_t maxGap;
+		boost::uint64_t lateMessages;
+	};
+
+private:
+	// Ereignisschleife aller Spieler
+	boost::asio::io_service service;
+
+	// Die Spieler
+	std::vector<boost::shared_ptr<Client> > clients;
+
+	// Zaehler und Dauer der Messung in Sekunden
+	Statistics statistics;
+	double seconds;
+
+	/**
+	  * Alle Spieler verbinden und eine Zeit lang spielen lassen.
+	  * @param endpoint Adresse des Servers.
+	  * @param count    Anzahl Spieler.
+	  * @param duration Dauer in Sekunden.
+	  */
+	void run(const boost::asio::generic::stream_protocol::endpoint& endpoint, unsigned int count,
+			 unsigned int duration);
+
+	// Nicht kopierbar
+	LoadGenerator(const LoadGenerator&);
+	LoadGenerator& operator=(const LoadGenerator&);
+
+public:
+	/**
+	  * Lastprobe erzeugen.
+	  */
+	LoadGenerator();
+
+	/**
+	  * Beenden.
+	  */
+	~LoadGenerator();
+
+	/**
+	  * Spieler ueber TCP auf der Loopback-Schnittstelle verbinden und
+	  * eine Zeit lang spielen lassen.
+	  * @param port     Port des Servers.
+	  * @param count    Anzahl Spieler.
+	  * @param duration Dauer in Sekunden.
+	  */
+	void run(unsigned short port, unsigned int count, unsigned int duration);
+
+	/**
+	  * Spieler ueber einen Unix-Domain-Socket verbinden und eine Zeit
+	  * lang spielen lassen.
+	  * @param path     Pfad des Sockets.
+	  * @param count    Anzahl Spieler.
+	  * @param duration Dauer in Sekunden.
+	  */
+	void run(const std::string& path, unsigned int count, unsigned int duration);
+
+	/**
+	  * Zaehler der letzten Messung auslesen.
+	  * @return Zaehler.
+	  */
+	const Statistics& getStatistics() const;
+
+	/**
+	  * Ergebnis der letzten Messung ausgeben.
+	  * @param out Ausgabe.
+	  */
+	void report(std::ostream& out) const;
+};
+
+#endif // LOAD_GENERATOR_H
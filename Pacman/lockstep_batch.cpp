@@ -0,0 +1,431 @@
+#include "field.hpp"
+#include "game_view.hpp"
+#include "ghost.hpp"
+#include "lockstep_batch.hpp"
+#include "maze_grid.hpp"
+#include "pacman.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+const unsigned int LockstepBatch::NO_ACTION;
+
+
+namespace {
+/**
+  * Naechste Zahl eines Zufallsgenerators, wie GameController::random().
+  * @param state Zustand des Generators.
+  * @return Zufallszahl.
+  */
+boost::uint32_t nextRandom(boost::uint32_t& state) {
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+/**
+  * Startzustand eines Zufallsgenerators, wie GameController::setRandomSeed().
+  * @param seed Startwert.
+  * @return Zustand des Generators.
+  */
+boost::uint32_t seedRandom(unsigned int seed) {
+	boost::uint32_t state = (boost::uint32_t) (seed * 2654435761u) ^ 0x9E3779B9u;
+	return state != 0 ? state : 0x9E3779B9u;
+}
+}
+
+
+/**
+  * Spiele mit dem Level eines Spielfeldes erzeugen.
+  * @param field Spielfeld mit dem gewuenschten Level.
+  * @param count Anzahl Spiele.
+  * @param seed  Startwert des Zufallsgenerators des ersten Spiels.
+  */
+LockstepBatch::LockstepBatch(Field& field, unsigned int count, unsigned int seed)
+		:	count(count), padded((count + LANES - 1) / LANES * LANES)
+{
+	GameView view = field.getView();
+	const MazeGrid& maze = view.getMaze();
+
+	ghostCount = view.getGhostCount();
+	cellCount = maze.getCellCount();
+	foodWords = (cellCount + 31) / 32;
+
+	exitTable.resize(cellCount);
+	neighbourTable.resize(4 * cellCount);
+	for (unsigned int cell = 0; cell < cellCount; ++cell) {
+		exitTable[ cell ] = maze.getExits(cell);
+		for (unsigned int bit = 0; bit < 4; ++bit) {
+			bool open = (exitTable[ cell ] & (1 << bit)) != 0;
+			neighbourTable[ bit * cellCount + cell ] = open ? maze.getNeighbour(cell, 1 << bit) : cell;
+		}
+	}
+
+	static const boost::int32_t Reverse[ 5 ] = { 4, 8, 1, 2, 0 };
+	reverseTable.assign(Reverse, Reverse + 5);
+
+	countTable.resize(16);
+	nthTable.assign(16 * 4, 0);
+	for (unsigned int exits = 0; exits < 16; ++exits) {
+		unsigned int found = 0;
+		for (unsigned int bit = 0; bit < 4; ++bit) {
+			if ((exits & (1 << bit)) != 0) {
+				nthTable[ exits * 4 + found++ ] = bit;
+			}
+		}
+		countTable[ exits ] = found;
+	}
+
+	startCells.push_back(view.getPacmanCell());
+	for (unsigned int ghost = 0; ghost < ghostCount; ++ghost) {
+		startCells.push_back(view.getGhostCell(ghost));
+	}
+	startFood.assign(foodWords, 0);
+	startFoodCount = 0;
+	for (unsigned int cell = 0; cell < cellCount; ++cell) {
+		if (view.isFood(cell)) {
+			startFood[ cell / 32 ] |= 1u << (cell % 32);
+			++startFoodCount;
+		}
+	}
+
+	cells.resize((ghostCount + 1) * padded);
+	directions.resize((ghostCount + 1) * padded);
+	countdowns.resize((ghostCount + 1) * padded);
+	randomStates.resize(padded);
+	actions.resize(padded);
+	points.resize(padded);
+	foodLeft.resize(padded);
+	states.resize(padded);
+	food.resize(foodWords * padded);
+
+	reset(seed);
+}
+
+
+/**
+  * Alle Spiele neu beginnen. Die Spiele hinter der gewuenschten
+  * Anzahl gelten als beendet und werden nie berechnet.
+  * @param seed Startwert des Zufallsgenerators des ersten Spiels.
+  */
+void LockstepBatch::reset(unsigned int seed) {
+	for (unsigned int figure = 0; figure <= ghostCount; ++figure) {
+		boost::int32_t speed = figure == 0 ? Pacman::NORMAL_PERIOD : Ghost::NORMAL_PERIOD;
+		std::fill(cells.begin() + figure * padded, cells.begin() + (figure + 1) * padded, startCells[ figure ]);
+		std::fill(directions.begin() + figure * padded, directions.begin() + (figure + 1) * padded, (boost::int32_t) NO_ACTION);
+		std::fill(countdowns.begin() + figure * padded, countdowns.begin() + (figure + 1) * padded, speed);
+	}
+	for (unsigned int word = 0; word < foodWords; ++word) {
+		std::fill(food.begin() + word * padded, food.begin() + (word + 1) * padded, startFood[ word ]);
+	}
+	for (unsigned int game = 0; game < padded; ++game) {
+		randomStates[ game ] = seedRandom(seed + game);
+		actions[ game ] = NO_ACTION;
+		points[ game ] = 0;
+		foodLeft[ game ] = startFoodCount;
+		states[ game ] = game < count ? Running : Cleared;
+	}
+}
+
+
+/**
+  * Aktion fuer die folgenden Schritte von Pacman eines Spiels.
+  * @param game   Index des Spiels.
+  * @param action Bitposition der Richtung oder NO_ACTION.
+  */
+void LockstepBatch::setAction(unsigned int game, unsigned int action) {
+	actions[ game ] = std::min(action, NO_ACTION);
+}
+
+
+/**
+  * Einen Takt eines Spiels ohne Vektorbefehle berechnen. Zuerst zieht
+  * Pacman, dann ziehen die Geister nacheinander, nach jedem Zug wird
+  * auf eine Kollision geprueft. Der Zustand wird erst am Ende gesetzt,
+  * damit die Reihenfolge der Vektorfassung entspricht.
+  * @param game Index des Spiels.
+  */
+void LockstepBatch::tickLane(unsigned int game) {
+	if (states[ game ] != Running) {
+		return;
+	}
+	bool caught = false;
+
+	boost::int32_t& pacmanCell = cells[ game ];
+	boost::int32_t& pacmanDirection = directions[ game ];
+	if (--countdowns[ game ] == 0) {
+		countdowns[ game ] = Pacman::NORMAL_PERIOD;
+		boost::int32_t exits = exitTable[ pacmanCell ];
+		if ((exits & (1 << actions[ game ])) != 0) {
+			pacmanDirection = actions[ game ];
+		}
+		if ((exits & (1 << pacmanDirection)) != 0) {
+			pacmanCell = neighbourTable[ pacmanDirection * cellCount + pacmanCell ];
+			boost::uint32_t& word = food[ (pacmanCell / 32) * padded + game ];
+			boost::uint32_t bit = 1u << (pacmanCell % 32);
+			if ((word & bit) != 0) {
+				word &= ~bit;
+				points[ game ] += GameController::DOT_POINTS;
+				--foodLeft[ game ];
+			}
+		}
+	}
+	for (unsigned int ghost = 1; ghost <= ghostCount; ++ghost) {
+		caught |= cells[ ghost * padded + game ] == pacmanCell;
+	}
+
+	for (unsigned int ghost = 1; ghost <= ghostCount; ++ghost) {
+		unsigned int index = ghost * padded + game;
+		if (--countdowns[ index ] == 0) {
+			countdowns[ index ] = Ghost::NORMAL_PERIOD;
+			boost::int32_t exits = exitTable[ cells[ index ] ];
+			boost::int32_t options = exits & ~reverseTable[ directions[ index ] ];
+			if (options == 0) {
+				options = exits;
+			}
+			if (options != 0) {
+				boost::uint32_t random = nextRandom(randomStates[ game ]);
+				boost::uint32_t choice = ((random & 0xFFFF) * countTable[ options ]) >> 16;
+				directions[ index ] = nthTable[ options * 4 + choice ];
+				cells[ index ] = neighbourTable[ directions[ index ] * cellCount + cells[ index ] ];
+			}
+		}
+		caught |= cells[ index ] == pacmanCell;
+	}
+
+	if (caught) {
+		states[ game ] = Caught;
+	} else if (foodLeft[ game ] == 0) {
+		states[ game ] = Cleared;
+	}
+}
+
+
+/**
+  * Einen Takt von LANES Spielen mit AVX2 berechnen. Figuren, die nicht
+  * an der Reihe sind oder nicht ziehen koennen, und beendete Spiele
+  * werden ueber Masken ausgeblendet. Nur das Loeschen gefressenen
+  * Essens geschieht je Spiel, es betrifft selten mehr als ein Spiel.
+  * @param first Index des ersten Spiels.
+  */
+void LockstepBatch::tickLanes(unsigned int first) {
+#if defined(__AVX2__)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i cellStride = _mm256_set1_epi32(cellCount);
+	const int* exitBase = (const int*) &exitTable[ 0 ];
+	const int* neighbourBase = (const int*) &neighbourTable[ 0 ];
+
+	__m256i* stateVector = (__m256i*) &states[ first ];
+	__m256i running = _mm256_cmpeq_epi32(_mm256_loadu_si256(stateVector), _mm256_set1_epi32(Running));
+	if (_mm256_testz_si256(running, running)) {
+		return;
+	}
+
+	// Pacman. Alle Figuren ziehen nur alle paar Takte, in den Takten
+	// dazwischen bleibt es beim Nachfuehren der Zaehler.
+	__m256i* countdownVector = (__m256i*) &countdowns[ first ];
+	__m256i countdown = _mm256_sub_epi32(_mm256_loadu_si256(countdownVector), _mm256_and_si256(running, one));
+	__m256i due = _mm256_and_si256(running, _mm256_cmpeq_epi32(countdown, zero));
+	_mm256_storeu_si256(countdownVector, _mm256_blendv_epi8(countdown, _mm256_set1_epi32(Pacman::NORMAL_PERIOD), due));
+
+	__m256i* pacmanCellVector = (__m256i*) &cells[ first ];
+	__m256i pacmanCell = _mm256_loadu_si256(pacmanCellVector);
+	__m256i caught = zero;
+	bool moved = false;
+
+	if (!_mm256_testz_si256(due, due)) {
+		__m256i* pacmanDirectionVector = (__m256i*) &directions[ first ];
+		__m256i pacmanDirection = _mm256_loadu_si256(pacmanDirectionVector);
+		__m256i action = _mm256_loadu_si256((const __m256i*) &actions[ first ]);
+		__m256i exits = _mm256_i32gather_epi32(exitBase, pacmanCell, 4);
+
+		__m256i turn = _mm256_and_si256(exits, _mm256_sllv_epi32(one, action));
+		turn = _mm256_andnot_si256(_mm256_cmpeq_epi32(turn, zero), due);
+		pacmanDirection = _mm256_blendv_epi8(pacmanDirection, action, turn);
+		_mm256_storeu_si256(pacmanDirectionVector, pacmanDirection);
+		__m256i move = _mm256_and_si256(exits, _mm256_sllv_epi32(one, pacmanDirection));
+		move = _mm256_andnot_si256(_mm256_cmpeq_epi32(move, zero), due);
+
+		if (!_mm256_testz_si256(move, move)) {
+			moved = true;
+			__m256i target = _mm256_add_epi32(_mm256_mullo_epi32(pacmanDirection, cellStride), pacmanCell);
+			target = _mm256_blendv_epi8(pacmanCell, target, move);
+			pacmanCell = _mm256_blendv_epi8(pacmanCell, _mm256_i32gather_epi32(neighbourBase, target, 4), move);
+			_mm256_storeu_si256(pacmanCellVector, pacmanCell);
+
+			// Essen unter Pacman
+			__m256i lane = _mm256_add_epi32(_mm256_set1_epi32(first), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			__m256i wordIndex = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(pacmanCell, 5),
+				_mm256_set1_epi32(padded)), lane);
+			__m256i bit = _mm256_sllv_epi32(one, _mm256_and_si256(pacmanCell, _mm256_set1_epi32(31)));
+			__m256i word = _mm256_i32gather_epi32((const int*) &food[ 0 ], wordIndex, 4);
+			__m256i eaten = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_and_si256(word, bit), zero), move);
+
+			int eatenMask = _mm256_movemask_ps(_mm256_castsi256_ps(eaten));
+			if (eatenMask != 0) {
+				boost::int32_t indices[ LANES ];
+				boost::int32_t bits[ LANES ];
+				_mm256_storeu_si256((__m256i*) indices, wordIndex);
+				_mm256_storeu_si256((__m256i*) bits, bit);
+				for (unsigned int index = 0; index < LANES; ++index) {
+					if ((eatenMask & (1 << index)) != 0) {
+						food[ indices[ index ] ] &= ~(boost::uint32_t) bits[ index ];
+					}
+				}
+
+				__m256i* pointVector = (__m256i*) &points[ first ];
+				__m256i* foodVector = (__m256i*) &foodLeft[ first ];
+				_mm256_storeu_si256(pointVector, _mm256_add_epi32(_mm256_loadu_si256(pointVector),
+					_mm256_and_si256(eaten, _mm256_set1_epi32(GameController::DOT_POINTS))));
+				_mm256_storeu_si256(foodVector, _mm256_sub_epi32(_mm256_loadu_si256(foodVector),
+					_mm256_and_si256(eaten, one)));
+			}
+
+			for (unsigned int ghost = 1; ghost <= ghostCount; ++ghost) {
+				__m256i ghostCell = _mm256_loadu_si256((const __m256i*) &cells[ ghost * padded + first ]);
+				caught = _mm256_or_si256(caught, _mm256_cmpeq_epi32(ghostCell, pacmanCell));
+			}
+		}
+	}
+
+	// Geister
+	__m256i* randomVector = (__m256i*) &randomStates[ first ];
+	__m256i random = _mm256_loadu_si256(randomVector);
+	for (unsigned int ghost = 1; ghost <= ghostCount; ++ghost) {
+		unsigned int index = ghost * padded + first;
+		countdownVector = (__m256i*) &countdowns[ index ];
+		countdown = _mm256_sub_epi32(_mm256_loadu_si256(countdownVector), _mm256_and_si256(running, one));
+		due = _mm256_and_si256(running, _mm256_cmpeq_epi32(countdown, zero));
+		_mm256_storeu_si256(countdownVector, _mm256_blendv_epi8(countdown, _mm256_set1_epi32(Ghost::NORMAL_PERIOD), due));
+		if (_mm256_testz_si256(due, due)) {
+			continue;
+		}
+
+		__m256i* cellVector = (__m256i*) &cells[ index ];
+		__m256i* directionVector = (__m256i*) &directions[ index ];
+		__m256i cell = _mm256_loadu_si256(cellVector);
+		__m256i direction = _mm256_loadu_si256(directionVector);
+
+		__m256i exits = _mm256_i32gather_epi32(exitBase, cell, 4);
+		__m256i reverse = _mm256_i32gather_epi32((const int*) &reverseTable[ 0 ], direction, 4);
+		__m256i options = _mm256_andnot_si256(reverse, exits);
+		options = _mm256_blendv_epi8(options, exits, _mm256_cmpeq_epi32(options, zero));
+		__m256i move = _mm256_andnot_si256(_mm256_cmpeq_epi32(options, zero), due);
+
+		__m256i next = _mm256_xor_si256(random, _mm256_slli_epi32(random, 13));
+		next = _mm256_xor_si256(next, _mm256_srli_epi32(next, 17));
+		next = _mm256_xor_si256(next, _mm256_slli_epi32(next, 5));
+		random = _mm256_blendv_epi8(random, next, move);
+
+		__m256i optionCount = _mm256_i32gather_epi32((const int*) &countTable[ 0 ], options, 4);
+		__m256i choice = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_and_si256(random, _mm256_set1_epi32(0xFFFF)),
+			optionCount), 16);
+		__m256i chosen = _mm256_i32gather_epi32((const int*) &nthTable[ 0 ],
+			_mm256_add_epi32(_mm256_slli_epi32(options, 2), choice), 4);
+		direction = _mm256_blendv_epi8(direction, chosen, move);
+
+		__m256i target = _mm256_add_epi32(_mm256_mullo_epi32(direction, cellStride), cell);
+		target = _mm256_blendv_epi8(cell, target, move);
+		cell = _mm256_blendv_epi8(cell, _mm256_i32gather_epi32(neighbourBase, target, 4), move);
+		_mm256_storeu_si256(cellVector, cell);
+		_mm256_storeu_si256(directionVector, direction);
+
+		caught = _mm256_or_si256(caught, _mm256_cmpeq_epi32(cell, pacmanCell));
+		moved = true;
+	}
+	_mm256_storeu_si256(randomVector, random);
+
+	// Ende der Spiele. Ohne Zug ist weder ein Geist auf Pacman getroffen
+	// noch Essen verschwunden.
+	if (!moved) {
+		return;
+	}
+	__m256i state = _mm256_loadu_si256(stateVector);
+	__m256i cleared = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) &foodLeft[ first ]), zero);
+	caught = _mm256_and_si256(caught, running);
+	cleared = _mm256_andnot_si256(caught, _mm256_and_si256(cleared, running));
+	state = _mm256_blendv_epi8(state, _mm256_set1_epi32(Caught), caught);
+	state = _mm256_blendv_epi8(state, _mm256_set1_epi32(Cleared), cleared);
+	_mm256_storeu_si256(stateVector, state);
+#else
+	for (unsigned int game = first; game < first + LANES; ++game) {
+		tickLane(game);
+	}
+#endif
+}
+
+
+/**
+  * Einen Takt aller laufenden Spiele berechnen, mit AVX2, falls
+  * verfuegbar.
+  */
+void LockstepBatch::tick() {
+	for (unsigned int first = 0; first < padded; first += LANES) {
+		tickLanes(first);
+	}
+}
+
+
+/**
+  * Einen Takt aller laufenden Spiele ohne Vektorbefehle berechnen.
+  */
+void LockstepBatch::tickScalar() {
+	for (unsigned int game = 0; game < padded; ++game) {
+		tickLane(game);
+	}
+}
+
+
+/**
+  * Anzahl Spiele auslesen.
+  * @return Anzahl Spiele.
+  */
+unsigned int LockstepBatch::getCount() const {
+	return count;
+}
+
+
+/**
+  * Zustand eines Spiels auslesen.
+  * @param game Index des Spiels.
+  * @return Zustand.
+  */
+LockstepBatch::LaneState LockstepBatch::getState(unsigned int game) const {
+	return (LaneState) states[ game ];
+}
+
+
+/**
+  * Punkte eines Spiels auslesen.
+  * @param game Index des Spiels.
+  * @return Punktezahl.
+  */
+unsigned int LockstepBatch::getPoints(unsigned int game) const {
+	return points[ game ];
+}
+
+
+/**
+  * Verbleibendes Essen eines Spiels auslesen.
+  * @param game Index des Spiels.
+  * @return Anzahl Essensportionen.
+  */
+unsigned int LockstepBatch::getFoodLeft(unsigned int game) const {
+	return foodLeft[ game ];
+}
+
+
+/**
+  * Zelle einer Figur auslesen.
+  * @param game   Index des Spiels.
+  * @param figure 0 fuer Pacman, 1 und folgende fuer die Geister.
+  * @return Index der Zelle wie in MazeGrid.
+  */
+unsigned int LockstepBatch::getCell(unsigned int game, unsigned int figure) const {
+	return cells[ figure * padded + game ];
+}
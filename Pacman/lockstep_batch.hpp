@@ -0,0 +1,167 @@
+#ifndef LOCKSTEP_BATCH_H
+#define LOCKSTEP_BATCH_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include "game_controller.hpp"
+
+class Field;
+
+/**
+  * Viele Spiele desselben Levels im Gleichschritt, z.B. fuer
+  * Simulationen einer Suche oder fuer Lernverfahren. Der Zustand liegt
+  * spielweise nebeneinander (ein Feld je Groesse, ein Element je
+  * Spiel), damit ein Takt mit AVX2 fuer LANES Spiele auf einmal
+  * berechnet werden kann: Zellen, Richtungen, Zaehler der Figuren und
+  * Zufallsgeneratoren liegen in den Spuren eines Vektors. Spiele, die
+  * anders verlaufen (andere Figur an der Reihe, Weg versperrt, Spiel
+  * vorbei), werden ueber Masken behandelt.
+  *
+  * Nachgebildet wird der Kern von GameController::move() und canMove():
+  * Bewegung entlang der begehbaren Richtungen samt Tunnel, Essen und
+  * Kollision von Pacman mit einem Geist. Die Geister irren zufaellig
+  * ohne Umkehr umher (wie RandomPolicy), Pillen, Kirschen, Modi und
+  * Pausen gibt es nicht. Ein Spiel endet, wenn ein Geist Pacman faengt
+  * oder alles Essen gefressen ist.
+  */
+class LockstepBatch {
+public:
+	// Anzahl Spiele je Vektor. Die Anzahl der Spiele wird intern auf
+	// ein Vielfaches aufgerundet.
+	static const unsigned int LANES = 8;
+
+	// Zustand eines Spiels
+	enum LaneState { Running = 0, Caught, Cleared };
+
+	// Aktion "Richtung beibehalten", sonst Bitposition der Richtung
+	static const unsigned int NO_ACTION = 4;
+
+private:
+	// Anzahl Spiele, aufgerundete Anzahl und Anzahl Geister
+	unsigned int count;
+	unsigned int padded;
+	unsigned int ghostCount;
+
+	// Anzahl Zellen und 32-Bit-Woerter der Essensbits je Spiel
+	unsigned int cellCount;
+	unsigned int foodWords;
+
+	// Tabellen als 32-Bit-Werte fuer Gather-Zugriffe: begehbare
+	// Richtungen je Zelle, Nachbarzelle je Richtung und Zelle
+	// (Richtung * cellCount + Zelle), Bit der Gegenrichtung je
+	// Richtung (4 = keine), Anzahl Bits und n-tes Bit einer
+	// Richtungskombination (Kombination * 4 + n)
+	std::vector<boost::int32_t> exitTable;
+	std::vector<boost::int32_t> neighbourTable;
+	std::vector<boost::int32_t> reverseTable;
+	std::vector<boost::int32_t> countTable;
+	std::vector<boost::int32_t> nthTable;
+
+	// Startzustand: Zelle je Figur (0 ist Pacman), Essensbits
+	std::vector<boost::int32_t> startCells;
+	std::vector<boost::uint32_t> startFood;
+	boost::int32_t startFoodCount;
+
+	// Zustand, Index [Figur * padded + Spiel]
+	std::vector<boost::int32_t> cells;
+	std::vector<boost::int32_t> directions;
+	std::vector<boost::int32_t> countdowns;
+
+	// Zustand, Index [Spiel]
+	std::vector<boost::uint32_t> randomStates;
+	std::vector<boost::int32_t> actions;
+	std::vector<boost::int32_t> points;
+	std::vector<boost::int32_t> foodLeft;
+	std::vector<boost::int32_t> states;
+
+	// Essensbits, Index [Wort * padded + Spiel]
+	std::vector<boost::uint32_t> food;
+
+	/**
+	  * Einen Takt eines Spiels ohne Vektorbefehle berechnen.
+	  * @param game Index des Spiels.
+	  */
+	void tickLane(unsigned int game);
+
+	/**
+	  * Einen Takt von LANES Spielen mit AVX2 berechnen.
+	  * @param first Index des ersten Spiels.
+	  */
+	void tickLanes(unsigned int first);
+
+	// Nicht kopierbar
+	LockstepBatch(const LockstepBatch&);
+	LockstepBatch& operator=(const LockstepBatch&);
+
+public:
+	/**
+	  * Spiele mit dem Level eines Spielfeldes erzeugen. Uebernommen
+	  * werden Labyrinth, Startzellen der Figuren und Essen.
+	  * @param field Spielfeld mit dem gewuenschten Level.
+	  * @param count Anzahl Spiele.
+	  * @param seed  Startwert des Zufallsgenerators des ersten Spiels.
+	  */
+	LockstepBatch(Field& field, unsigned int count, unsigned int seed = GameController::DEFAULT_SEED);
+
+	/**
+	  * Alle Spiele neu beginnen, Spiel i mit dem Startwert seed + i.
+	  * @param seed Startwert des Zufallsgenerators des ersten Spiels.
+	  */
+	void reset(unsigned int seed);
+
+	/**
+	  * Aktion fuer die folgenden Schritte von Pacman eines Spiels.
+	  * @param game   Index des Spiels.
+	  * @param action Bitposition der Richtung oder NO_ACTION.
+	  */
+	void setAction(unsigned int game, unsigned int action);
+
+	/**
+	  * Einen Takt aller laufenden Spiele berechnen, mit AVX2, falls
+	  * verfuegbar.
+	  */
+	void tick();
+
+	/**
+	  * Einen Takt aller laufenden Spiele ohne Vektorbefehle berechnen,
+	  * mit demselben Ergebnis wie tick().
+	  */
+	void tickScalar();
+
+	/**
+	  * Anzahl Spiele auslesen.
+	  * @return Anzahl Spiele.
+	  */
+	unsigned int getCount() const;
+
+	/**
+	  * Zustand eines Spiels auslesen.
+	  * @param game Index des Spiels.
+	  * @return Zustand.
+	  */
+	LaneState getState(unsigned int game) const;
+
+	/**
+	  * Punkte eines Spiels auslesen.
+	  * @param game Index des Spiels.
+	  * @return Punktezahl.
+	  */
+	unsigned int getPoints(unsigned int game) const;
+
+	/**
+	  * Verbleibendes Essen eines Spiels auslesen.
+	  * @param game Index des Spiels.
+	  * @return Anzahl Essensportionen.
+	  */
+	unsigned int getFoodLeft(unsigned int game) const;
+
+	/**
+	  * Zelle einer Figur auslesen.
+	  * @param game   Index des Spiels.
+	  * @param figure 0 fuer Pacman, 1 und folgende fuer die Geister.
+	  * @return Index der Zelle wie in MazeGrid.
+	  */
+	unsigned int getCell(unsigned int game, unsigned int figure) const;
+};
+
+#endif // LOCKSTEP_BATCH_H
@@ -0,0 +1,593 @@
+#include "lockstep_peer.hpp"
+#include "game_view.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+namespace {
+
+// Kennung und Version der Einstellungen des Gastgebers
+const unsigned char LOCKSTEP_MAGIC[ 2 ] = { 'P', 'L' };
+const unsigned char LOCKSTEP_VERSION = 2;
+
+// Laenge der Einstellungen: Kennung, Version, Figur des Gastgebers,
+// Verzoegerung, Rollback-Takte, Startwert
+const unsigned int HELLO_SIZE = 10;
+
+// Kein Rollback ausstehend
+const boost::uint32_t NO_ROLLBACK = 0xFFFFFFFFu;
+
+// Noch kein voller Stand festgehalten
+const boost::uint32_t NO_STATE = 0xFFFFFFFFu;
+
+/**
+  * Eine Zahl als Little Endian schreiben.
+  * @param data  Ziel.
+  * @param value Zahl.
+  * @param bytes Anzahl Bytes.
+  */
+void writeNumber(unsigned char* data, boost::uint64_t value, unsigned int bytes) {
+	for (unsigned int index = 0; index < bytes; ++index) {
+		data[ index ] = (unsigned char) (value >> (8 * index));
+	}
+}
+
+/**
+  * Eine Zahl als Little Endian lesen.
+  * @param data  Quelle.
+  * @param bytes Anzahl Bytes.
+  * @return Zahl.
+  */
+boost::uint64_t readNumber(const unsigned char* data, unsigned int bytes) {
+	boost::uint64_t value = 0;
+	for (unsigned int index = 0; index < bytes; ++index) {
+		value |= (boost::uint64_t) data[ index ] << (8 * index);
+	}
+	return value;
+}
+
+/**
+  * Ein empfangenes Byte als Richtung lesen, Unbekanntes gilt als NONE.
+  * @param value Byte.
+  * @return Richtung.
+  */
+Direction toDirection(unsigned char value) {
+	if (value == Direction::UP || value == Direction::LEFT || value == Direction::DOWN
+		|| value == Direction::RIGHT) {
+		return Direction(value);
+	}
+	return Direction::NONE;
+}
+
+}
+
+
+/**
+  * Seite ohne Verbindung erzeugen.
+  */
+LockstepPeer::LockstepPeer()
+		:	socket(service), role(PacmanRole), status(Connecting), delay(INPUT_DELAY), rollback(0), step(0),
+			confirmed(0), recorded(0), rollbackFrom(NO_ROLLBACK), localInputs(HISTORY, Direction::NONE),
+			remoteInputs(HISTORY, Direction::NONE), remoteSteps(HISTORY, 0), usedInputs(HISTORY, Direction::NONE),
+			snapshots(HISTORY), hashes(HISTORY, 0), desyncStep(0)
+{
+	std::memset(&statistics, 0, sizeof(statistics));
+}
+
+
+/**
+  * Verbindung geordnet trennen: Nach dem eigenen Ende wird gelesen,
+  * bis auch der Partner trennt. Ungelesene Daten beim Schliessen
+  * wuerden die Verbindung zuruecksetzen, und der Partner verloere
+  * die letzten, schon gesendeten Eingaben.
+  */
+LockstepPeer::~LockstepPeer() {
+	if (socket.is_open()) {
+		boost::system::error_code error;
+		socket.shutdown(boost::asio::socket_base::shutdown_send, error);
+		unsigned char frame[ FRAME_SIZE ];
+		while (!error) {
+			boost::asio::read(socket, boost::asio::buffer(frame), error);
+		}
+		socket.close(error);
+	}
+}
+
+
+/**
+  * Auf den Partner warten und die Einstellungen senden.
+  * @param endpoint Eigene Adresse.
+  * @param role     Eigene Figur.
+  * @param seed     Startwert des Zufallsgenerators.
+  * @param rollback Erlaubte Takte mit vorhergesagter Eingabe.
+  */
+void LockstepPeer::accept(const boost::asio::generic::stream_protocol::endpoint& endpoint, Role role,
+						  unsigned int seed, unsigned int rollback) {
+	boost::asio::basic_socket_acceptor<boost::asio::generic::stream_protocol> acceptor(service, endpoint);
+	acceptor.accept(socket);
+
+	unsigned char hello[ HELLO_SIZE ];
+	hello[ 0 ] = LOCKSTEP_MAGIC[ 0 ];
+	hello[ 1 ] = LOCKSTEP_MAGIC[ 1 ];
+	hello[ 2 ] = LOCKSTEP_VERSION;
+	// Mit Rollback gilt die eigene Eingabe sofort
+	unsigned int delay = rollback > 0 ? 0 : INPUT_DELAY;
+	hello[ 3 ] = (unsigned char) role;
+	hello[ 4 ] = (unsigned char) delay;
+	hello[ 5 ] = (unsigned char) rollback;
+	writeNumber(hello + 6, seed, 4);
+	boost::asio::write(socket, boost::asio::buffer(hello));
+
+	start(role, seed, delay, rollback);
+}
+
+
+/**
+  * Mit dem Gastgeber verbinden und seine Einstellungen uebernehmen.
+  * Die eigene Figur ist die, die der Gastgeber nicht steuert.
+  * @param endpoint Adresse des Gastgebers.
+  */
+void LockstepPeer::connect(const boost::asio::generic::stream_protocol::endpoint& endpoint) {
+	socket.connect(endpoint);
+
+	unsigned char hello[ HELLO_SIZE ];
+	boost::asio::read(socket, boost::asio::buffer(hello));
+	if (hello[ 0 ] != LOCKSTEP_MAGIC[ 0 ] || hello[ 1 ] != LOCKSTEP_MAGIC[ 1 ] || hello[ 2 ] != LOCKSTEP_VERSION
+		|| hello[ 3 ] > GhostRole || hello[ 4 ] + hello[ 5 ] == 0 || hello[ 4 ] + hello[ 5 ] >= HISTORY / 4) {
+		throw std::runtime_error("lockstep: incompatible host");
+	}
+
+	Role hostRole = Role(hello[ 3 ]);
+	start(hostRole == PacmanRole ? GhostRole : PacmanRole, (unsigned int) readNumber(hello + 6, 4),
+		  hello[ 4 ], hello[ 5 ]);
+}
+
+
+/**
+  * Das Spiel fuer beide Seiten gleich aufbauen: Der Jaeger gehoert in
+  * allen Levels dem Geisterspieler. Die ersten Takte bis zur ersten
+  * gesendeten Eingabe laufen auf beiden Seiten ohne Taste. Fuer
+  * Rollbacks werden die Spielfelder der gesicherten Staende einmal
+  * aufgebaut, danach kostet das Sichern nur noch eine Kopie.
+  * @param role     Eigene Figur.
+  * @param seed     Startwert des Zufallsgenerators.
+  * @param delay    Takte zwischen Eingabe und Wirkung.
+  * @param rollback Erlaubte Takte mit vorhergesagter Eingabe.
+  */
+void LockstepPeer::start(Role role, unsigned int seed, unsigned int delay, unsigned int rollback) {
+	assert(delay + rollback > 0 && delay + rollback < HISTORY / 4);
+	boost::system::error_code ignored;
+	socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+
+	this->role = role;
+	this->delay = delay;
+	this->rollback = rollback;
+	for (unsigned int level = 1; level <= field.getMaxLevels(); ++level) {
+		field.setGhostPolicy(level, PlayerGhosts);
+	}
+	field.setRandomSeed(seed);
+
+	saved.clear();
+	for (unsigned int index = 0; rollback > 0 && index <= rollback; ++index) {
+		saved.push_back(boost::shared_ptr<Field>(new Field()));
+		saved.back()->copyStateFrom(field);
+	}
+
+	// Eine Abweichung faellt spaetestens delay + 2 * rollback + 1 Takte
+	// nach dem Festhalten auf, so lange bleibt der volle Stand liegen
+	states.clear();
+	for (unsigned int index = 0; index < delay + 2 * rollback + 4; ++index) {
+		states.push_back(boost::shared_ptr<Field>(new Field()));
+	}
+	stateSteps.assign(states.size(), NO_STATE);
+
+	for (unsigned int tick = 0; tick < delay; ++tick) {
+		localInputs[ tick ] = Direction::NONE;
+		remoteInputs[ tick ] = Direction::NONE;
+		remoteSteps[ tick ] = tick;
+	}
+	confirmed = delay;
+	status = Running;
+}
+
+
+/**
+  * Auf den Partner ueber TCP warten.
+  * @param port     Port.
+  * @param role     Eigene Figur.
+  * @param seed     Startwert des Zufallsgenerators.
+  * @param rollback Erlaubte Takte mit vorhergesagter Eingabe.
+  */
+void LockstepPeer::host(unsigned short port, Role role, unsigned int seed, unsigned int rollback) {
+	boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port);
+	accept(boost::asio::generic::stream_protocol::endpoint(endpoint), role, seed, rollback);
+}
+
+
+/**
+  * Auf den Partner ueber einen Unix-Domain-Socket warten.
+  * @param path     Pfad des Sockets.
+  * @param role     Eigene Figur.
+  * @param seed     Startwert des Zufallsgenerators.
+  * @param rollback Erlaubte Takte mit vorhergesagter Eingabe.
+  */
+void LockstepPeer::host(const std::string& path, Role role, unsigned int seed, unsigned int rollback) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	std::remove(path.c_str());
+	boost::asio::local::stream_protocol::endpoint endpoint(path);
+	accept(boost::asio::generic::stream_protocol::endpoint(endpoint), role, seed, rollback);
+#else
+	throw boost::system::system_error(boost::asio::error::operation_not_supported);
+#endif
+}
+
+
+/**
+  * Mit einem Gastgeber ueber TCP verbinden.
+  * @param port Port des Gastgebers.
+  */
+void LockstepPeer::join(unsigned short port) {
+	boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port);
+	connect(boost::asio::generic::stream_protocol::endpoint(endpoint));
+}
+
+
+/**
+  * Mit einem Gastgeber ueber einen Unix-Domain-Socket verbinden.
+  * @param path Pfad des Sockets.
+  */
+void LockstepPeer::join(const std::string& path) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	boost::asio::local::stream_protocol::endpoint endpoint(path);
+	connect(boost::asio::generic::stream_protocol::endpoint(endpoint));
+#else
+	throw boost::system::system_error(boost::asio::error::operation_not_supported);
+#endif
+}
+
+
+/**
+  * Eine Nachricht des Partners lesen: Die Eingabe wird fuer ihren Takt
+  * abgelegt, der Hash wartet, bis derselbe Takt hier festgehalten ist.
+  * Die Eingaben kommen in der Reihenfolge der Takte an. War der Takt
+  * schon mit einer anderen Vorhersage gerechnet, steht ein Rollback an.
+  * @return <code>false</code>, wenn die Verbindung getrennt wurde.
+  */
+bool LockstepPeer::receive() {
+	unsigned char frame[ FRAME_SIZE ];
+	boost::system::error_code error;
+	boost::asio::read(socket, boost::asio::buffer(frame), error);
+	if (error) {
+		// Der Partner hat getrennt, es ist alles gelesen
+		status = Disconnected;
+		socket.close(error);
+		return false;
+	}
+
+	boost::uint32_t tick = (boost::uint32_t) readNumber(frame, 4);
+	if (tick != confirmed || tick > step + 2 * delay + rollback + 1) {
+		// Luecke oder Takt aus der Zukunft, der Partner haelt sich nicht
+		// an das Protokoll
+		status = Disconnected;
+		socket.close(error);
+		return false;
+	}
+	unsigned char input = (unsigned char) toDirection(frame[ 4 ]).getValue();
+	remoteInputs[ tick % HISTORY ] = input;
+	remoteSteps[ tick % HISTORY ] = tick;
+	++confirmed;
+	if (tick < step && usedInputs[ tick % HISTORY ] != input) {
+		rollbackFrom = std::min(rollbackFrom, tick);
+	}
+
+	if (tick >= delay + rollback) {
+		remoteHashes.push_back(std::make_pair(tick - delay - rollback, readNumber(frame + 5, 8)));
+		compareHashes();
+	}
+	return true;
+}
+
+
+/**
+  * Alle schon eingetroffenen Nachrichten lesen, ohne zu warten.
+  */
+void LockstepPeer::poll() {
+	boost::system::error_code error;
+	while (status == Running && socket.available(error) >= FRAME_SIZE && !error) {
+		receive();
+	}
+}
+
+
+/**
+  * Einen Takt ausfuehren, wie PacmanWindow::update(). Fehlt die Eingabe
+  * des Partners, haelt er dieselbe Richtung wie in seiner letzten
+  * bekannten Eingabe.
+  * @param tick Takt, der Stand des Spielfeldes ist der Stand davor.
+  */
+void LockstepPeer::simulate(boost::uint32_t tick) {
+	unsigned int index = tick % HISTORY;
+	unsigned char predicted = confirmed > 0 ? remoteInputs[ (confirmed - 1) % HISTORY ] : (unsigned char) Direction::NONE;
+	usedInputs[ index ] = tick < confirmed ? remoteInputs[ index ] : predicted;
+	if (rollback > 0) {
+		saved[ tick % saved.size() ]->copyStateFrom(field);
+	}
+
+	Direction local(localInputs[ index ]);
+	Direction remote(usedInputs[ index ]);
+	Direction pacmanInput = role == PacmanRole ? local : remote;
+	Direction ghostInput = role == PacmanRole ? remote : local;
+
+	field.nextTick();
+	if (field.getState() == Playing) {
+		if (pacmanInput != Direction::NONE) {
+			field.keyPressed(pacmanInput);
+		}
+		field.ghostKeyPressed(ghostInput);
+	}
+}
+
+
+/**
+  * Nach einer falschen Vorhersage zum Stand vor ihrem Takt
+  * zurueckkehren und bis zum aktuellen Takt neu rechnen, mit den
+  * inzwischen bekannten Eingaben und neuen Vorhersagen fuer den Rest.
+  */
+void LockstepPeer::resimulate() {
+	if (rollbackFrom >= step) {
+		rollbackFrom = NO_ROLLBACK;
+		return;
+	}
+	assert(step - rollbackFrom <= rollback);
+	boost::posix_time::ptime begin = boost::posix_time::microsec_clock::universal_time();
+
+	field.copyStateFrom(*saved[ rollbackFrom % saved.size() ]);
+	for (boost::uint32_t tick = rollbackFrom; tick < step; ++tick) {
+		simulate(tick);
+	}
+
+	++statistics.rollbacks;
+	statistics.maxDepth = std::max(statistics.maxDepth, (unsigned int) (step - rollbackFrom));
+	statistics.resimulatedTicks += step - rollbackFrom;
+	statistics.rollbackMicroseconds +=
+		(boost::posix_time::microsec_clock::universal_time() - begin).total_microseconds();
+	rollbackFrom = NO_ROLLBACK;
+}
+
+
+/**
+  * Hashes und Staende festhalten, deren Eingaben jetzt beide Seiten
+  * kennen. Der Stand vor dem aktuellen Takt ist das Spielfeld selbst,
+  * aeltere liegen bei den gesicherten Staenden. Verglichen wird erst
+  * danach, damit der eigene Hash vorher hinausgeht.
+  */
+void LockstepPeer::recordHashes() {
+	while (recorded <= std::min(confirmed, step)) {
+		Field& state = recorded == step ? field : *saved[ recorded % saved.size() ];
+		snapshots[ recorded % HISTORY ].read(state);
+		hashes[ recorded % HISTORY ] = state.getView().getStateHash();
+		states[ recorded % states.size() ]->copyStateFrom(state);
+		stateSteps[ recorded % states.size() ] = recorded;
+		++recorded;
+	}
+}
+
+
+/**
+  * Hashes des Partners mit den eigenen vergleichen. Sie kommen in der
+  * Reihenfolge der Takte an, der erste noch nicht festgehaltene
+  * beendet den Vergleich.
+  */
+void LockstepPeer::compareHashes() {
+	while (status == Running && !remoteHashes.empty() && remoteHashes.front().first < recorded) {
+		boost::uint32_t tick = remoteHashes.front().first;
+		boost::uint64_t remoteHash = remoteHashes.front().second;
+		assert(recorded - tick <= HISTORY);
+		if (hashes[ tick % HISTORY ] != remoteHash) {
+			desyncStep = tick;
+			reportDesync(remoteHash);
+		}
+		remoteHashes.pop_front();
+	}
+}
+
+
+/**
+  * Den eigenen Stand vor dem ersten abweichenden Takt in eine Datei
+  * schreiben ("lockstep-<Figur>-<Takt>.txt") und nichts mehr senden.
+  * Nach dem sichtbaren Stand folgt der volle Stand des Controllers, der
+  * auch Abweichungen im Zufallsgenerator, im Zeitrad oder in einer
+  * Tastenanfrage zeigt.
+  * Der Partner findet dieselbe Abweichung und schreibt seinen Stand.
+  * Ist der eigene Hash dieses Taktes noch nicht gesendet (der Partner
+  * ist mit Rollback voraus), folgen bis dahin Nachrichten ohne Taste.
+  * Aufgerufen wird nur nach dem Senden in advance().
+  * @param remoteHash Hash des Partners fuer diesen Takt.
+  */
+void LockstepPeer::reportDesync(boost::uint64_t remoteHash) {
+	status = Desynced;
+
+	for (boost::uint32_t tick = step + delay + 1; tick <= desyncStep + delay + rollback; ++tick) {
+		unsigned char frame[ FRAME_SIZE ];
+		writeNumber(frame, tick, 4);
+		frame[ 4 ] = Direction::NONE;
+		writeNumber(frame + 5, hashes[ (tick - delay - rollback) % HISTORY ], 8);
+		boost::system::error_code ignored;
+		boost::asio::write(socket, boost::asio::buffer(frame), ignored);
+	}
+
+	std::ostringstream path;
+	path << "lockstep-" << (role == PacmanRole ? "pacman" : "ghost") << "-" << desyncStep << ".txt";
+	dumpPath = path.str();
+
+	std::ofstream out(dumpPath.c_str());
+	out << "step " << desyncStep << std::endl;
+	out << std::hex << "hash " << hashes[ desyncStep % HISTORY ] << ", remote " << remoteHash << std::dec << std::endl;
+	writeState(snapshots[ desyncStep % HISTORY ], field.getMaze(), out);
+	if (stateSteps[ desyncStep % states.size() ] == desyncStep) {
+		states[ desyncStep % states.size() ]->writeState(out);
+	} else {
+		out << "full state no longer kept" << std::endl;
+	}
+
+	boost::system::error_code ignored;
+	socket.shutdown(boost::asio::socket_base::shutdown_send, ignored);
+}
+
+
+/**
+  * Einen Takt weiterschalten. Die eigene Nachricht geht vor dem
+  * Vergleich hinaus, damit der Partner eine Abweichung ebenfalls
+  * findet. Ihr Hash gehoert zum Stand rollback Takte zurueck, der
+  * schon endgueltig ist.
+  * @param input Gehaltene Richtung, NONE ohne Taste.
+  * @return <code>false</code>, wenn das Spiel angehalten ist.
+  */
+bool LockstepPeer::advance(Direction input) {
+	if (status != Running) {
+		return false;
+	}
+	recordHashes();
+
+	boost::uint32_t tick = step + delay;
+	localInputs[ tick % HISTORY ] = (unsigned char) input.getValue();
+	unsigned char frame[ FRAME_SIZE ];
+	writeNumber(frame, tick, 4);
+	frame[ 4 ] = (unsigned char) input.getValue();
+	writeNumber(frame + 5, step >= rollback ? hashes[ (step - rollback) % HISTORY ] : 0, 8);
+	boost::system::error_code error;
+	boost::asio::write(socket, boost::asio::buffer(frame), error);
+	if (error) {
+		status = Disconnected;
+		socket.close(error);
+		return false;
+	}
+
+	// Hoechstens rollback Takte vorhersagen, sonst warten
+	compareHashes();
+	poll();
+	while (status == Running && confirmed + rollback <= step) {
+		receive();
+	}
+	if (status != Running) {
+		return false;
+	}
+
+	resimulate();
+	recordHashes();
+	compareHashes();
+	if (status != Running) {
+		return false;
+	}
+
+	simulate(step);
+	++step;
+	return true;
+}
+
+
+/**
+  * Das gemeinsame Spiel.
+  * @return Spielfeld.
+  */
+Field& LockstepPeer::getField() {
+	return field;
+}
+
+
+/**
+  * Eigene Figur auslesen.
+  * @return Figur.
+  */
+LockstepPeer::Role LockstepPeer::getRole() const {
+	return role;
+}
+
+
+/**
+  * Zustand der Verbindung auslesen.
+  * @return Zustand.
+  */
+LockstepPeer::Status LockstepPeer::getStatus() const {
+	return status;
+}
+
+
+/**
+  * Anzahl ausgefuehrter Takte auslesen.
+  * @return Takte.
+  */
+boost::uint32_t LockstepPeer::getStep() const {
+	return step;
+}
+
+
+/**
+  * Erlaubte Takte mit vorhergesagter Eingabe auslesen.
+  * @return Takte, 0 im reinen Lockstep.
+  */
+unsigned int LockstepPeer::getRollback() const {
+	return rollback;
+}
+
+
+/**
+  * Zaehler der Rollbacks auslesen.
+  * @return Zaehler.
+  */
+const LockstepPeer::Statistics& LockstepPeer::getStatistics() const {
+	return statistics;
+}
+
+
+/**
+  * Datei mit dem eigenen Stand nach einer Abweichung auslesen.
+  * @return Pfad, leer ohne Abweichung.
+  */
+const std::string& LockstepPeer::getDumpPath() const {
+	return dumpPath;
+}
+
+
+/**
+  * Einen Stand als Text schreiben. In der Karte steht '.' fuer Essen,
+  * 'o' fuer eine Pille oder Kirsche, 'P' fuer Pacman und '0' bis '9'
+  * fuer die Geister.
+  * @param state Stand.
+  * @param maze  Labyrinth des Standes.
+  * @param out   Ausgabe.
+  */
+void LockstepPeer::writeState(const StateSnapshot& state, const MazeGrid& maze, std::ostream& out) {
+	out << "tick " << state.tick << std::endl;
+	out << "points " << state.points << std::endl;
+	out << "lives " << (unsigned int) state.lives << std::endl;
+	out << "state " << (unsigned int) state.state << std::endl;
+	for (unsigned int index = 0; index < state.figures.size(); ++index) {
+		const StateSnapshot::Figure& figure = state.figures[ index ];
+		out << "figure " << index << " x " << (unsigned int) figure.x << " y " << (unsigned int) figure.y
+			<< " direction " << (unsigned int) figure.direction << " state " << (unsigned int) figure.state << std::endl;
+	}
+
+	std::vector<char> map(maze.getCellCount(), ' ');
+	for (unsigned int cell = 0; cell < map.size(); ++cell) {
+		if (state.isFood(cell)) {
+			map[ cell ] = '.';
+		}
+	}
+	for (unsigned int index = 0; index < state.items.size(); ++index) {
+		map[ state.items[ index ] ] = 'o';
+	}
+	for (unsigned int index = state.figures.size(); index-- > 0; ) {
+		const StateSnapshot::Figure& figure = state.figures[ index ];
+		map[ maze.getIndex(figure.x, figure.y) ] = index == 0 ? 'P' : char('0' + (index - 1) % 10);
+	}
+	for (unsigned int y = 0; y < maze.getHeight(); ++y) {
+		out << "|" << std::string(&map[ maze.getIndex(0, y) ], maze.getWidth()) << "|" << std::endl;
+	}
+}
@@ -0,0 +1,318 @@
+#ifndef LOCKSTEP_PEER_H
+#define LOCKSTEP_PEER_H
+
+#include <deque>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include "field.hpp"
+#include "state_stream.hpp"
+
+/**
+  * Eine Seite eines Spiels zweier Menschen gegeneinander: Einer steuert
+  * Pacman, der andere den Jaeger unter den Geistern (siehe
+  * PlayerPolicy). Beide Seiten rechnen dasselbe Spiel mit demselben
+  * Startwert und tauschen nur ihre Eingaben aus, jeden Takt eine Nachricht
+  * fester Groesse, unabhaengig vom Spielfeld.
+  *
+  * Im reinen Lockstep wird ein Takt erst ausgefuehrt, wenn beide
+  * Eingaben vorliegen. Die eigene Eingabe gilt erst INPUT_DELAY Takte
+  * spaeter, so verdeckt die Verzoegerung die Laufzeit im Netz.
+  *
+  * Mit Rollback (ROLLBACK_TICKS) gilt die eigene Eingabe sofort, die des
+  * Partners wird vorhergesagt: Er haelt dieselbe Richtung wie zuletzt.
+  * Vor jedem Takt wird der Stand gesichert (Field::copyStateFrom()).
+  * Trifft eine Eingabe ein, die von der Vorhersage abweicht, kehrt das
+  * Spiel zum Stand vor ihrem Takt zurueck und rechnet die Takte bis
+  * jetzt ohne Fenster neu. Fehlen die Eingaben des Partners fuer mehr
+  * als ROLLBACK_TICKS Takte, wird wie im Lockstep gewartet.
+  *
+  * Mit jeder Eingabe geht der Hash eines Standes mit, dessen Eingaben
+  * beide Seiten kennen (siehe GameController::getStateHash()). Weicht
+  * er vom Hash des Partners fuer denselben Takt ab, laufen die Spiele
+  * auseinander: Das Spiel haelt an, und jede Seite schreibt ihren Stand
+  * dieses Taktes als Text in eine Datei, damit beide verglichen werden
+  * koennen.
+  *
+  * Nachricht (13 Bytes, Little Endian): Takt der Eingabe (32 Bit),
+  * gehaltene Richtung (Konstante aus Direction), Hash des Standes vor
+  * dem Takt der Eingabe minus Verzoegerung und Rollback-Takten (64 Bit).
+  */
+class LockstepPeer {
+public:
+	// Gesteuerte Figur
+	enum Role { PacmanRole = 0, GhostRole };
+
+	// Zustand der Verbindung
+	enum Status { Connecting = 0, Running, Desynced, Disconnected };
+
+	// Takte zwischen Eingabe und Wirkung im Lockstep, 50 ms bei 60
+	// Takten je Sekunde
+	static const unsigned int INPUT_DELAY = 3;
+
+	// Hoechstens so viele Takte mit vorhergesagter Eingabe des Partners
+	// im Modus mit Rollback, 133 ms bei 60 Takten je Sekunde
+	static const unsigned int ROLLBACK_TICKS = 8;
+
+	// Zaehler der Rollbacks
+	struct Statistics {
+		unsigned int rollbacks;
+		unsigned int maxDepth;
+		boost::uint64_t resimulatedTicks;
+
+		// Dauer aller Rollbacks samt Wiederherstellen in Mikrosekunden
+		boost::uint64_t rollbackMicroseconds;
+	};
+
+	// So viele Takte werden fuer Eingaben und Hashes aufbewahrt
+	static const unsigned int HISTORY = 128;
+
+	// Groesse einer Nachricht in Bytes
+	static const unsigned int FRAME_SIZE = 13;
+
+private:
+	boost::asio::io_service service;
+	boost::asio::generic::stream_protocol::socket socket;
+
+	// Das gemeinsam gerechnete Spiel
+	Field field;
+
+	Role role;
+	Status status;
+	unsigned int delay;
+
+	// Erlaubte Takte mit vorhergesagter Eingabe, 0 im reinen Lockstep
+	unsigned int rollback;
+
+	// Naechster auszufuehrender Takt
+	boost::uint32_t step;
+
+	// Erster Takt, fuer den die Eingabe des Partners fehlt
+	boost::uint32_t confirmed;
+
+	// Erster Takt, dessen endgueltiger Stand noch nicht festgehalten ist
+	boost::uint32_t recorded;
+
+	// Frueheste falsch vorhergesagte Eingabe oder NO_ROLLBACK
+	boost::uint32_t rollbackFrom;
+
+	// Eingaben je Takt, Index Takt % HISTORY. Beim Partner zeigt
+	// remoteSteps, fuer welchen Takt der Eintrag gilt, usedInputs, was
+	// beim Rechnen des Taktes angenommen wurde.
+	std::vector<unsigned char> localInputs;
+	std::vector<unsigned char> remoteInputs;
+	std::vector<boost::uint32_t> remoteSteps;
+	std::vector<unsigned char> usedInputs;
+
+	// Gesicherte Staende vor den letzten Takten fuer Rollbacks, Index
+	// Takt % (rollback + 1)
+	std::vector<boost::shared_ptr<Field> > saved;
+
+	// Endgueltige Staende und Hashes vor jedem Takt, Index Takt % HISTORY
+	std::vector<StateSnapshot> snapshots;
+	std::vector<boost::uint64_t> hashes;
+
+	// Vollstaendige endgueltige Staende der letzten Takte fuer die Datei
+	// bei einer Abweichung, Index Takt % states.size(). stateSteps zeigt,
+	// fuer welchen Takt der Eintrag gilt.
+	std::vector<boost::shared_ptr<Field> > states;
+	std::vector<boost::uint32_t> stateSteps;
+
+	// Hashes des Partners fuer Takte, die hier noch nicht erreicht sind
+	std::deque<std::pair<boost::uint32_t, boost::uint64_t> > remoteHashes;
+
+	Statistics statistics;
+
+	// Erster abweichender Takt und Datei mit dem eigenen Stand
+	boost::uint32_t desyncStep;
+	std::string dumpPath;
+
+	/**
+	  * Verbindung aufbauen und die Einstellungen des Gastgebers senden.
+	  * @param endpoint Eigene Adresse.
+	  * @param role     Eigene Figur.
+	  * @param seed     Startwert des Zufallsgenerators.
+	  * @param rollback Erlaubte Takte mit vorhergesagter Eingabe.
+	  */
+	void accept(const boost::asio::generic::stream_protocol::endpoint& endpoint, Role role, unsigned int seed,
+				unsigned int rollback);
+
+	/**
+	  * Mit dem Gastgeber verbinden und seine Einstellungen uebernehmen.
+	  * @param endpoint Adresse des Gastgebers.
+	  */
+	void connect(const boost::asio::generic::stream_protocol::endpoint& endpoint);
+
+	/**
+	  * Das Spiel fuer beide Seiten gleich aufbauen.
+	  * @param role     Eigene Figur.
+	  * @param seed     Startwert des Zufallsgenerators.
+	  * @param delay    Takte zwischen Eingabe und Wirkung.
+	  * @param rollback Erlaubte Takte mit vorhergesagter Eingabe.
+	  */
+	void start(Role role, unsigned int seed, unsigned int delay, unsigned int rollback);
+
+	/**
+	  * Eine Nachricht des Partners lesen, wartet bis sie vollstaendig ist.
+	  * @return <code>false</code>, wenn die Verbindung getrennt wurde
+	  *         oder die Nachricht nicht den erwarteten Takt traegt.
+	  */
+	bool receive();
+
+	/**
+	  * Alle schon eingetroffenen Nachrichten lesen, ohne zu warten.
+	  */
+	void poll();
+
+	/**
+	  * Einen Takt mit der eigenen und der bekannten oder vorhergesagten
+	  * Eingabe des Partners ausfuehren, im Modus mit Rollback den Stand
+	  * davor sichern.
+	  * @param tick Takt, der Stand des Spielfeldes ist der Stand davor.
+	  */
+	void simulate(boost::uint32_t tick);
+
+	/**
+	  * Nach einer falschen Vorhersage zum Stand vor ihrem Takt
+	  * zurueckkehren und bis zum aktuellen Takt neu rechnen.
+	  */
+	void resimulate();
+
+	/**
+	  * Hashes und Staende festhalten, deren Eingaben jetzt beide Seiten
+	  * kennen.
+	  */
+	void recordHashes();
+
+	/**
+	  * Hashes des Partners mit den eigenen vergleichen, soweit der
+	  * Stand hier schon festgehalten ist.
+	  */
+	void compareHashes();
+
+	/**
+	  * Den eigenen Stand vor dem ersten abweichenden Takt samt Zaehlern,
+	  * Zufallsgenerator, Zeitrad und allen Figuren in eine Datei
+	  * schreiben und nichts mehr senden.
+	  * @param remoteHash Hash des Partners fuer diesen Takt.
+	  */
+	void reportDesync(boost::uint64_t remoteHash);
+
+	// Nicht kopierbar
+	LockstepPeer(const LockstepPeer&);
+	LockstepPeer& operator=(const LockstepPeer&);
+
+public:
+	/**
+	  * Seite ohne Verbindung erzeugen.
+	  */
+	LockstepPeer();
+
+	/**
+	  * Verbindung trennen.
+	  */
+	~LockstepPeer();
+
+	/**
+	  * Auf den Partner ueber TCP auf der Loopback-Schnittstelle warten.
+	  * Der Gastgeber legt Figuren, Startwert und Verzoegerung fest.
+	  * @param port     Port.
+	  * @param role     Eigene Figur, der Partner steuert die andere.
+	  * @param seed     Startwert des Zufallsgenerators.
+	  * @param rollback 0 fuer reinen Lockstep, sonst erlaubte Takte mit
+	  *                 vorhergesagter Eingabe (z.B. ROLLBACK_TICKS).
+	  */
+	void host(unsigned short port, Role role, unsigned int seed, unsigned int rollback = 0);
+
+	/**
+	  * Auf den Partner ueber einen Unix-Domain-Socket warten.
+	  * @param path     Pfad des Sockets.
+	  * @param role     Eigene Figur, der Partner steuert die andere.
+	  * @param seed     Startwert des Zufallsgenerators.
+	  * @param rollback 0 fuer reinen Lockstep, sonst erlaubte Takte mit
+	  *                 vorhergesagter Eingabe.
+	  */
+	void host(const std::string& path, Role role, unsigned int seed, unsigned int rollback = 0);
+
+	/**
+	  * Mit einem wartenden Gastgeber ueber TCP verbinden.
+	  * @param port Port des Gastgebers.
+	  */
+	void join(unsigned short port);
+
+	/**
+	  * Mit einem wartenden Gastgeber ueber einen Unix-Domain-Socket
+	  * verbinden.
+	  * @param path Pfad des Sockets.
+	  */
+	void join(const std::string& path);
+
+	/**
+	  * Einen Takt weiterschalten, wie PacmanWindow::update(): Die
+	  * eigene Eingabe senden, die Eingaben des Partners lesen, nach
+	  * falschen Vorhersagen neu rechnen und den Takt ausfuehren. Gewartet
+	  * wird nur, wenn dem Partner zu viele Eingaben fehlen.
+	  * @param input Gehaltene Richtung, NONE ohne Taste.
+	  * @return <code>false</code>, wenn das Spiel wegen Abweichung oder
+	  *         getrennter Verbindung angehalten ist.
+	  */
+	bool advance(Direction input);
+
+	/**
+	  * Das gemeinsame Spiel, nur zum Lesen und Zeichnen.
+	  * @return Spielfeld.
+	  */
+	Field& getField();
+
+	/**
+	  * Eigene Figur auslesen.
+	  * @return Figur.
+	  */
+	Role getRole() const;
+
+	/**
+	  * Zustand der Verbindung auslesen.
+	  * @return Zustand.
+	  */
+	Status getStatus() const;
+
+	/**
+	  * Anzahl ausgefuehrter Takte auslesen.
+	  * @return Takte.
+	  */
+	boost::uint32_t getStep() const;
+
+	/**
+	  * Erlaubte Takte mit vorhergesagter Eingabe auslesen.
+	  * @return Takte, 0 im reinen Lockstep.
+	  */
+	unsigned int getRollback() const;
+
+	/**
+	  * Zaehler der Rollbacks auslesen.
+	  * @return Zaehler.
+	  */
+	const Statistics& getStatistics() const;
+
+	/**
+	  * Datei mit dem eigenen Stand nach einer Abweichung auslesen.
+	  * @return Pfad, leer ohne Abweichung.
+	  */
+	const std::string& getDumpPath() const;
+
+	/**
+	  * Einen Stand als Text schreiben, eine Zeile je Wert und Figur und
+	  * das Essen als Karte, damit sich zwei Staende zeilenweise
+	  * vergleichen lassen.
+	  * @param state Stand.
+	  * @param maze  Labyrinth des Standes.
+	  * @param out   Ausgabe.
+	  */
+	static void writeState(const StateSnapshot& state, const MazeGrid& maze, std::ostream& out);
+};
+
+#endif // LOCKSTEP_PEER_H
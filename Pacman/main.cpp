@@ -1,9 +1,533 @@
 #include <Gosu/AutoLink.hpp>
 #include <Gosu/Gosu.hpp>
 
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "game_server.hpp"
+#include "game_view.hpp"
+#include "load_generator.hpp"
+#include "lockstep_batch.hpp"
+#include "lockstep_peer.hpp"
+#include "maze_bitboard.hpp"
+#include "maze_grid.hpp"
+#include "pacman_env.hpp"
 #include "pacman_window.hpp"
+#include "shared_batch.hpp"
+
+/**
+  * Ohne Fenster gegen einen Partner spielen, die Tasten druecken
+  * zufaellig, z.B. um das Auseinanderlaufen zweier Prozesse zu pruefen.
+  * @param peer  Verbundener Partner.
+  * @param ticks Hoechstens so viele Takte.
+  */
+void playLockstep(LockstepPeer& peer, unsigned int ticks) {
+	static const unsigned int Keys[ 5 ] = { Direction::NONE, Direction::UP, Direction::LEFT,
+											 Direction::DOWN, Direction::RIGHT };
+	unsigned int random = peer.getRole() == LockstepPeer::PacmanRole ? 2463534242u : 88675123u;
+	Direction held = Direction::NONE;
+	while (peer.getStep() < ticks && peer.getField().getState() != GameOver) {
+		if (peer.getStep() % 20 == 0) {
+			random ^= random << 13;
+			random ^= random >> 17;
+			random ^= random << 5;
+			held = Keys[ random % 5 ];
+		}
+		if (!peer.advance(held)) {
+			break;
+		}
+	}
+
+	GameView view = peer.getField().getView();
+	std::cout << "ticks " << peer.getStep() << ", points " << view.getPoints() << ", lives "
+			  << view.getLives() << ", hash " << std::hex << view.getStateHash() << std::dec << std::endl;
+	const LockstepPeer::Statistics& statistics = peer.getStatistics();
+	if (peer.getRollback() > 0 && statistics.resimulatedTicks > 0) {
+		double tickMicroseconds = (double) statistics.rollbackMicroseconds / statistics.resimulatedTicks;
+		std::cout << "rollbacks " << statistics.rollbacks << " (max depth " << statistics.maxDepth
+				  << "), resimulated " << statistics.resimulatedTicks << " ticks, " << tickMicroseconds
+				  << " us each, " << (unsigned int) (16667 / std::max(tickMicroseconds, 0.001))
+				  << " per 16 ms frame" << std::endl;
+	}
+	if (peer.getStatus() == LockstepPeer::Desynced) {
+		std::cout << "desync, state written to " << peer.getDumpPath() << std::endl;
+	}
+	else if (peer.getStatus() == LockstepPeer::Disconnected) {
+		std::cout << "disconnected" << std::endl;
+	}
+}
+
+/**
+  * Naechste Zahl des Zufallsgenerators der Messungen.
+  * @param random Zustand des Zufallsgenerators.
+  * @return Zufallszahl.
+  */
+unsigned int nextBenchRandom(unsigned int& random) {
+	random ^= random << 13;
+	random ^= random >> 17;
+	random ^= random << 5;
+	return random;
+}
+
+/**
+  * Naechste Aktion der zufaellig spielenden Spieler in benchmarkBatch()
+  * und benchmarkEnv().
+  * @param random Zustand des Zufallsgenerators.
+  * @return Bitposition einer Richtung.
+  */
+unsigned int nextBenchAction(unsigned int& random) {
+	return nextBenchRandom(random) % 4;
+}
+
+/**
+  * Durchgang zwischen einer Zelle und ihrem Nachbarn in beide
+  * Richtungen oeffnen.
+  * @param maze      Labyrinth.
+  * @param cell      Index der Zelle.
+  * @param direction Eine der Konstanten der Klasse 'Direction'.
+  */
+void openBenchPassage(MazeGrid& maze, unsigned int cell, unsigned int direction) {
+	unsigned int neighbour = maze.getNeighbour(cell, direction);
+	maze.setExits(cell, maze.getExits(cell) | direction);
+	maze.setExits(neighbour, maze.getExits(neighbour) | MazeGrid::getOpposite(direction));
+}
+
+/**
+  * Quadratisches Labyrinth fuer benchmarkBitboard() erzeugen: Gaenge
+  * zwischen den Zellen mit geraden Koordinaten per Tiefensuche, dazu
+  * zusaetzliche Durchgaenge fuer Kreise und Tunnel ueber den Rand.
+  * @param maze   Erhaelt das Labyrinth.
+  * @param size   Kantenlaenge in Zellen.
+  * @param random Zustand des Zufallsgenerators.
+  */
+void buildBenchMaze(MazeGrid& maze, unsigned int size, unsigned int& random) {
+	maze.resize(size, size);
+	std::vector<bool> visited(size * size, false);
+	std::vector<unsigned int> stack(1, 0);
+	visited[ 0 ] = true;
+	while (!stack.empty()) {
+		unsigned int cell = stack.back();
+		unsigned int x = maze.getX(cell);
+		unsigned int y = maze.getY(cell);
+		unsigned int options[ 4 ];
+		unsigned int count = 0;
+		if (y >= 2 && !visited[ cell - 2 * size ]) {
+			options[ count++ ] = Direction::UP;
+		}
+		if (x >= 2 && !visited[ cell - 2 ]) {
+			options[ count++ ] = Direction::LEFT;
+		}
+		if (y + 2 < size && !visited[ cell + 2 * size ]) {
+			options[ count++ ] = Direction::DOWN;
+		}
+		if (x + 2 < size && !visited[ cell + 2 ]) {
+			options[ count++ ] = Direction::RIGHT;
+		}
+		if (count == 0) {
+			stack.pop_back();
+			continue;
+		}
+		unsigned int direction = options[ nextBenchRandom(random) % count ];
+		unsigned int middle = maze.getNeighbour(cell, direction);
+		unsigned int target = maze.getNeighbour(middle, direction);
+		openBenchPassage(maze, cell, direction);
+		openBenchPassage(maze, middle, direction);
+		visited[ target ] = true;
+		stack.push_back(target);
+	}
+
+	for (unsigned int passage = 0; passage < size * size / 20; ++passage) {
+		unsigned int x = nextBenchRandom(random) % (size / 2) * 2;
+		unsigned int y = nextBenchRandom(random) % (size / 2) * 2;
+		unsigned int direction = 1u << nextBenchAction(random);
+		if ((direction == Direction::UP && y >= 2) || (direction == Direction::LEFT && x >= 2)
+			|| (direction == Direction::DOWN && y + 2 < size) || (direction == Direction::RIGHT && x + 2 < size)) {
+			unsigned int cell = maze.getIndex(x, y);
+			openBenchPassage(maze, cell, direction);
+			openBenchPassage(maze, maze.getNeighbour(cell, direction), direction);
+		}
+	}
+	for (unsigned int y = 0; y < size; y += 2) {
+		if (nextBenchRandom(random) % 8 == 0) {
+			openBenchPassage(maze, maze.getIndex(0, y), Direction::LEFT);
+		}
+	}
+	for (unsigned int x = 0; x < size; x += 2) {
+		if (nextBenchRandom(random) % 8 == 0) {
+			openBenchPassage(maze, maze.getIndex(x, 0), Direction::UP);
+		}
+	}
+}
+
+/**
+  * LockstepBatch mit Vektorbefehlen und ohne gegen einzelne Spiele mit
+  * GameController messen. Alle Spiele beginnen mit dem Startwert
+  * DEFAULT_SEED + Index, die Spieler waehlen alle 20 Takte zufaellig
+  * eine Richtung, in beiden Faellen dieselbe. Gezaehlt werden nur
+  * Takte laufender Spiele, beim Stapel ermittelt ein erster, nicht
+  * gemessener Durchlauf ihre Anzahl.
+  * @param games Anzahl Spiele.
+  * @param ticks Anzahl Takte.
+  */
+void benchmarkBatch(unsigned int games, unsigned int ticks) {
+	Field level;
+	LockstepBatch batch(level, games);
+
+	std::cout << "batch-bench: " << games << " games, " << ticks << " ticks" << std::endl;
+	unsigned long gameTicks = 0;
+	for (unsigned int pass = 0; pass < 3; ++pass) {
+		bool counting = pass == 0;
+		bool vector = pass != 2;
+		unsigned int random = 2463534242u;
+		batch.reset(GameController::DEFAULT_SEED);
+
+		boost::posix_time::ptime begin = boost::posix_time::microsec_clock::universal_time();
+		for (unsigned int tick = 0; tick < ticks; ++tick) {
+			if (tick % 20 == 0) {
+				for (unsigned int game = 0; game < games; ++game) {
+					batch.setAction(game, nextBenchAction(random));
+				}
+			}
+			if (counting) {
+				for (unsigned int game = 0; game < games; ++game) {
+					gameTicks += batch.getState(game) == LockstepBatch::Running ? 1 : 0;
+				}
+			}
+			if (vector) {
+				batch.tick();
+			}
+			else {
+				batch.tickScalar();
+			}
+		}
+		boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - begin;
+		if (!counting) {
+			std::cout << "  LockstepBatch::" << (vector ? "tick()" : "tickScalar()") << ": "
+					  << elapsed.total_microseconds() << " us, " << gameTicks << " running game-ticks, "
+					  << (gameTicks > 0 ? elapsed.total_microseconds() * 1000.0 / gameTicks : 0.0)
+					  << " ns each" << std::endl;
+		}
+	}
+
+	// Dieselbe Arbeit mit einzelnen Spielen nach allen Regeln
+	std::vector<Field*> fields;
+	for (unsigned int game = 0; game < games; ++game) {
+		fields.push_back(new Field());
+		fields.back()->setRandomSeed(GameController::DEFAULT_SEED + game);
+	}
+	gameTicks = 0;
+	unsigned int random = 2463534242u;
+	std::vector<unsigned int> actions(games, 0);
+	boost::posix_time::ptime begin = boost::posix_time::microsec_clock::universal_time();
+	for (unsigned int tick = 0; tick < ticks; ++tick) {
+		for (unsigned int game = 0; game < games; ++game) {
+			if (tick % 20 == 0) {
+				actions[ game ] = nextBenchAction(random);
+			}
+			Field& field = *fields[ game ];
+			if (field.getState() == GameOver) {
+				continue;
+			}
+			field.nextTick();
+			++gameTicks;
+			if (field.getState() == Playing) {
+				field.keyPressed(Direction(1u << actions[ game ]));
+			}
+		}
+	}
+	boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - begin;
+	std::cout << "  Field::nextTick(): " << elapsed.total_microseconds() << " us, "
+			  << gameTicks << " running game-ticks, "
+			  << (gameTicks > 0 ? elapsed.total_microseconds() * 1000.0 / gameTicks : 0.0)
+			  << " ns each" << std::endl;
+	for (unsigned int game = 0; game < games; ++game) {
+		delete fields[ game ];
+	}
+}
+
+/**
+  * PacmanEnv mit und ohne Makroschritte messen (siehe
+  * GameController::setCorridorSteps()). Episode i beginnt mit dem
+  * Startwert i + 1, der Spieler waehlt in jedem Schritt zufaellig eine
+  * Richtung, in beiden Laeufen mit demselben Zufallsgenerator. Der Hash
+  * wird in jedem Takt geprueft, die gemessene Zeit enthaelt das.
+  * @param episodes Anzahl Episoden je Lauf.
+  */
+void benchmarkEnv(unsigned int episodes) {
+	std::cout << "env-bench: " << episodes << " episodes" << std::endl;
+	for (unsigned int pass = 0; pass < 2; ++pass) {
+		bool corridor = pass == 1;
+		PacmanEnv env;
+		env.setCorridorSteps(corridor);
+		unsigned int random = 2463534242u;
+		unsigned long steps = 0;
+		unsigned long ticks = 0;
+		unsigned long mismatches = 0;
+		double rewards = 0.0;
+
+		boost::posix_time::ptime begin = boost::posix_time::microsec_clock::universal_time();
+		for (unsigned int episode = 0; episode < episodes; ++episode) {
+			env.reset(episode + 1);
+			env.getField().setHashVerification(true);
+			unsigned int firstTick = env.getField().getView().getTickCount();
+			bool done = false;
+			while (!done) {
+				float reward;
+				env.step(nextBenchAction(random), 0, reward, done);
+				rewards += reward;
+				++steps;
+			}
+			ticks += env.getField().getView().getTickCount() - firstTick;
+			mismatches += env.getField().getHashMismatches();
+		}
+		boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - begin;
+		std::cout << "  " << (corridor ? "corridor steps: " : "cell steps:     ")
+				  << steps << " steps, " << ticks << " ticks, "
+				  << (episodes > 0 ? rewards / episodes : 0.0) << " reward per episode, "
+				  << elapsed.total_microseconds() << " us, "
+				  << mismatches << " hash mismatches" << std::endl;
+	}
+}
+
+/**
+  * Offenes Labyrinth fuer benchmarkBitboard() erzeugen: Alle Zellen
+  * sind offen, ein Fuenftel wird zufaellig geschlossen. Die Fronten
+  * der Suche sind hier breit, in den Gaengen von buildBenchMaze() nur
+  * eine Zelle.
+  * @param maze   Erhaelt das Labyrinth.
+  * @param size   Kantenlaenge in Zellen.
+  * @param random Zustand des Zufallsgenerators.
+  */
+void buildOpenBenchMaze(MazeGrid& maze, unsigned int size, unsigned int& random) {
+	maze.resize(size, size);
+	for (unsigned int cell = 0; cell < maze.getCellCount(); ++cell) {
+		maze.setExits(cell, Direction::ALL);
+	}
+	for (unsigned int wall = 0; wall < size * size / 5; ++wall) {
+		unsigned int cell = nextBenchRandom(random) % maze.getCellCount();
+		maze.setExits(cell, Direction::NONE);
+		for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+			unsigned int neighbour = maze.getNeighbour(cell, direction);
+			maze.setExits(neighbour, maze.getExits(neighbour) & ~MazeGrid::getOpposite(direction));
+		}
+	}
+}
+
+/**
+  * Eine Zeile von benchmarkBitboard(): Flutfuellungen ab zufaelligen
+  * offenen Zellen erst mit der gewoehnlichen Breitensuche, dann mit
+  * floodFill() allein und mit getDistances() messen. Danach wird fuer
+  * jede Suche geprueft, ob beide dasselbe Abstandsfeld liefern.
+  * @param name     Art des Labyrinths.
+  * @param maze     Labyrinth.
+  * @param searches Anzahl Suchen.
+  * @param count    Startzellen je Suche.
+  * @param random   Zustand des Zufallsgenerators.
+  */
+void benchmarkFloodFill(const char* name, const MazeGrid& maze, unsigned int searches,
+						unsigned int count, unsigned int& random) {
+	MazeBitboard bitboard;
+	bitboard.build(maze);
+
+	std::vector<unsigned int> open;
+	for (unsigned int cell = 0; cell < maze.getCellCount(); ++cell) {
+		if (maze.getExits(cell) != Direction::NONE) {
+			open.push_back(cell);
+		}
+	}
+	std::vector<std::vector<unsigned int> > sources(searches);
+	for (unsigned int search = 0; search < searches; ++search) {
+		for (unsigned int source = 0; source < count; ++source) {
+			sources[ search ].push_back(open[ nextBenchRandom(random) % open.size() ]);
+		}
+	}
+
+	std::vector<unsigned int> scalar;
+	std::vector<unsigned int> distances;
+	boost::posix_time::ptime begin = boost::posix_time::microsec_clock::universal_time();
+	for (unsigned int search = 0; search < searches; ++search) {
+		bitboard.floodFillScalar(maze, sources[ search ], scalar);
+	}
+	boost::posix_time::ptime scalarEnd = boost::posix_time::microsec_clock::universal_time();
+	for (unsigned int search = 0; search < searches; ++search) {
+		bitboard.floodFill(sources[ search ]);
+	}
+	boost::posix_time::ptime fillEnd = boost::posix_time::microsec_clock::universal_time();
+	for (unsigned int search = 0; search < searches; ++search) {
+		bitboard.floodFill(sources[ search ]);
+		bitboard.getDistances(distances);
+	}
+	boost::posix_time::ptime distancesEnd = boost::posix_time::microsec_clock::universal_time();
+
+	unsigned int mismatches = 0;
+	for (unsigned int search = 0; search < searches; ++search) {
+		bitboard.floodFillScalar(maze, sources[ search ], scalar);
+		bitboard.floodFill(sources[ search ]);
+		bitboard.getDistances(distances);
+		mismatches += scalar == distances ? 0 : 1;
+	}
+
+	double divisor = searches > 0 ? searches : 1;
+	std::cout << "  " << name << " " << maze.getWidth() << "x" << maze.getHeight() << ", "
+			  << count << (count == 1 ? " source: scalar " : " sources: scalar ")
+			  << (scalarEnd - begin).total_microseconds() / divisor << " us, floodFill() "
+			  << (fillEnd - scalarEnd).total_microseconds() / divisor << " us, with getDistances() "
+			  << (distancesEnd - fillEnd).total_microseconds() / divisor << " us per search, "
+			  << mismatches << " mismatches" << std::endl;
+}
+
+/**
+  * Flutfuellung ueber MazeBitboard gegen die gewoehnliche Breitensuche
+  * (MazeBitboard::floodFillScalar()) messen: im Labyrinth des Spiels
+  * und in erzeugten Labyrinthen mit Gaengen und offenen Flaechen von
+  * 21x21 bis 1024x1024 Zellen, je mit einer Startzelle und mit einer
+  * je vier Zellen Kantenlaenge.
+  * @param searches Anzahl Suchen je Labyrinth und Zahl der Startzellen.
+  */
+void benchmarkBitboard(unsigned int searches) {
+	static const unsigned int Sizes[ 4 ] = { 21, 64, 256, 1024 };
+
+	std::cout << "bitboard-bench: " << searches << " searches per maze" << std::endl;
+	unsigned int random = 2463534242u;
+	{
+		Field level;
+		benchmarkFloodFill("level", level.getMaze(), searches, 1, random);
+		benchmarkFloodFill("level", level.getMaze(), searches, level.getMaze().getWidth() / 4 + 1, random);
+	}
+	for (unsigned int open = 0; open < 2; ++open) {
+		for (unsigned int index = 0; index < 4; ++index) {
+			MazeGrid maze;
+			if (open == 0) {
+				buildBenchMaze(maze, Sizes[ index ], random);
+			}
+			else {
+				buildOpenBenchMaze(maze, Sizes[ index ], random);
+			}
+			const char* name = open == 0 ? "maze" : "open";
+			benchmarkFloodFill(name, maze, searches, 1, random);
+			benchmarkFloodFill(name, maze, searches, Sizes[ index ] / 4 + 1, random);
+		}
+	}
+}
 
 int main(int argc, char *argv[]) {
+	// Ohne Fenster: LockstepBatch gegen einzelne Spiele messen, Anzahl
+	// Spiele und Takte, z.B. "--batch-bench 1024 2000".
+	if (argc >= 4 && std::string(argv[ 1 ]) == "--batch-bench") {
+		benchmarkBatch(std::atoi(argv[ 2 ]), std::atoi(argv[ 3 ]));
+		return 0;
+	}
+
+	// Ohne Fenster: Flutfuellung ueber Bitboards gegen die gewoehnliche
+	// Breitensuche messen, Anzahl Suchen je Labyrinth, z.B.
+	// "--bitboard-bench 100".
+	if (argc >= 3 && std::string(argv[ 1 ]) == "--bitboard-bench") {
+		benchmarkBitboard(std::atoi(argv[ 2 ]));
+		return 0;
+	}
+
+	// Ohne Fenster: PacmanEnv mit und ohne Makroschritte messen, Anzahl
+	// Episoden, z.B. "--env-bench 200".
+	if (argc >= 3 && std::string(argv[ 1 ]) == "--env-bench") {
+		benchmarkEnv(std::atoi(argv[ 2 ]));
+		return 0;
+	}
+
+	// Ohne Fenster: Spiele fuer einen Trainingsprozess bereitstellen
+	// (siehe SharedBatchServer), z.B. "--shared-batch pacman 64".
+	if (argc >= 4 && std::string(argv[ 1 ]) == "--shared-batch") {
+		SharedBatchServer server(argv[ 2 ], std::atoi(argv[ 3 ]));
+		server.serve();
+		return 0;
+	}
+
+	// Ohne Fenster: Spiele fuer viele Clients bereitstellen (siehe
+	// GameServer). Die Adresse ist ein Port auf der Loopback-Schnittstelle
+	// oder der Pfad eines Unix-Domain-Sockets, z.B. "--server 7000 4".
+	if (argc >= 4 && std::string(argv[ 1 ]) == "--server") {
+		GameServer server(std::atoi(argv[ 3 ]));
+		if (std::atoi(argv[ 2 ]) > 0) {
+			server.listen((unsigned short) std::atoi(argv[ 2 ]));
+		}
+		else {
+			server.listen(std::string(argv[ 2 ]));
+		}
+		server.run();
+		return 0;
+	}
+
+	// Lastprobe gegen einen laufenden Server: Adresse, Anzahl Spieler
+	// und Dauer in Sekunden, z.B. "--load-test 7000 2000 10".
+	if (argc >= 5 && std::string(argv[ 1 ]) == "--load-test") {
+		LoadGenerator generator;
+		if (std::atoi(argv[ 2 ]) > 0) {
+			generator.run((unsigned short) std::atoi(argv[ 2 ]), std::atoi(argv[ 3 ]), std::atoi(argv[ 4 ]));
+		}
+		else {
+			generator.run(std::string(argv[ 2 ]), std::atoi(argv[ 3 ]), std::atoi(argv[ 4 ]));
+		}
+		generator.report(std::cout);
+		return 0;
+	}
+
+	// Zwei Menschen gegeneinander (siehe LockstepPeer): Der Gastgeber
+	// waehlt seine Figur und mit "--rollback" statt "--lockstep" den
+	// Modus mit Vorhersage, z.B. "--lockstep host 7100 ghost" und
+	// "--lockstep join 7100". Mit einer Anzahl Takte am Ende spielen
+	// beide Seiten ohne Fenster mit zufaelligen Tasten.
+	if (argc >= 4 && (std::string(argv[ 1 ]) == "--lockstep" || std::string(argv[ 1 ]) == "--rollback")) {
+		unsigned int rollback = std::string(argv[ 1 ]) == "--rollback" ? LockstepPeer::ROLLBACK_TICKS : 0;
+		bool host = std::string(argv[ 2 ]) == "host";
+		int ticksArgument = host ? 5 : 4;
+		LockstepPeer peer;
+		if (host) {
+			LockstepPeer::Role role = argc >= 5 && std::string(argv[ 4 ]) == "ghost"
+				? LockstepPeer::GhostRole : LockstepPeer::PacmanRole;
+			if (std::atoi(argv[ 3 ]) > 0) {
+				peer.host((unsigned short) std::atoi(argv[ 3 ]), role, (unsigned int) std::time(0), rollback);
+			}
+			else {
+				peer.host(std::string(argv[ 3 ]), role, (unsigned int) std::time(0), rollback);
+			}
+		}
+		else if (std::atoi(argv[ 3 ]) > 0) {
+			peer.join((unsigned short) std::atoi(argv[ 3 ]));
+		}
+		else {
+			peer.join(std::string(argv[ 3 ]));
+		}
+
+		if (argc > ticksArgument) {
+			playLockstep(peer, std::atoi(argv[ ticksArgument ]));
+		}
+		else {
+			PacmanWindow w(&peer);
+			w.show();
+		}
+		return 0;
+	}
+
+	// Fenster mit Pruefung des nachgefuehrten Hashes in jedem Takt
+	// (siehe GameController::setHashVerification()), "--verify-hash".
+	if (argc >= 2 && std::string(argv[ 1 ]) == "--verify-hash") {
+		PacmanWindow w(0, Pacman::TURN_BUFFER_TICKS, true);
+		w.show();
+		return 0;
+	}
+
+	// Fenster mit anderer Frist fuer vorgemerkte Richtungen in Takten,
+	// z.B. "--turn-buffer 0" fuer das alte Verhalten ohne Vormerken.
+	if (argc >= 3 && std::string(argv[ 1 ]) == "--turn-buffer") {
+		PacmanWindow w(0, std::atoi(argv[ 2 ]));
+		w.show();
+		return 0;
+	}
+
 	/*QApplication a(argc, argv);
 	PacmanWindow w;
 	w.show();
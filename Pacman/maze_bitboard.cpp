@@ -0,0 +1,464 @@
+#include "direction.hpp"
+#include "maze_bitboard.hpp"
+#include "maze_grid.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+const unsigned int MazeBitboard::NONE;
+
+
+namespace {
+typedef boost::uint64_t Word;
+
+/**
+  * Naechste Front fuer die Woerter [begin, end) berechnen: Die Front
+  * wird mit den Masken der Richtungen verknuepft und verschoben,
+  * bereits besuchte Zellen fallen heraus.
+  */
+void expandWords(const Word* frontier, const Word* up, const Word* left,
+				 const Word* down, const Word* right, const Word* visited,
+				 Word* next, unsigned int begin, unsigned int end, unsigned int stride) {
+	unsigned int word = begin;
+
+#if defined(__AVX2__)
+	for (; word + 4 <= end; word += 4) {
+		__m256i current = _mm256_loadu_si256((const __m256i*) (frontier + word));
+		__m256i before  = _mm256_loadu_si256((const __m256i*) (frontier + word - 1));
+		__m256i after   = _mm256_loadu_si256((const __m256i*) (frontier + word + 1));
+		__m256i above   = _mm256_loadu_si256((const __m256i*) (frontier + word - stride));
+		__m256i below   = _mm256_loadu_si256((const __m256i*) (frontier + word + stride));
+
+		__m256i toRight = _mm256_and_si256(current, _mm256_loadu_si256((const __m256i*) (right + word)));
+		__m256i carryRight = _mm256_and_si256(before, _mm256_loadu_si256((const __m256i*) (right + word - 1)));
+		__m256i toLeft = _mm256_and_si256(current, _mm256_loadu_si256((const __m256i*) (left + word)));
+		__m256i carryLeft = _mm256_and_si256(after, _mm256_loadu_si256((const __m256i*) (left + word + 1)));
+
+		__m256i result = _mm256_or_si256(
+			_mm256_or_si256(_mm256_slli_epi64(toRight, 1), _mm256_srli_epi64(carryRight, 63)),
+			_mm256_or_si256(_mm256_srli_epi64(toLeft, 1), _mm256_slli_epi64(carryLeft, 63)));
+		result = _mm256_or_si256(result,
+			_mm256_or_si256(_mm256_and_si256(above, _mm256_loadu_si256((const __m256i*) (down + word - stride))),
+							_mm256_and_si256(below, _mm256_loadu_si256((const __m256i*) (up + word + stride)))));
+
+		result = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*) (visited + word)), result);
+		_mm256_storeu_si256((__m256i*) (next + word), result);
+	}
+#endif
+
+	for (; word < end; ++word) {
+		Word result = ((frontier[ word ] & right[ word ]) << 1)
+					| ((frontier[ word - 1 ] & right[ word - 1 ]) >> 63)
+					| ((frontier[ word ] & left[ word ]) >> 1)
+					| ((frontier[ word + 1 ] & left[ word + 1 ]) << 63)
+					| (frontier[ word - stride ] & down[ word - stride ])
+					| (frontier[ word + stride ] & up[ word + stride ]);
+		next[ word ] = result & ~visited[ word ];
+	}
+}
+
+/**
+  * Index des niedrigsten gesetzten Bits ermitteln.
+  * @param value Wort, das nicht 0 sein darf.
+  * @return Position des Bits (0-63).
+  */
+unsigned int lowestBit(Word value) {
+	static const unsigned int DeBruijnBits[64] = {
+		 0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+		62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+		63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+		46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+	};
+	return DeBruijnBits[ ((value & (~value + 1)) * 0x03F79D71B4CB0A89ULL) >> 58 ];
+}
+
+/**
+  * Gesetzte Bits eines Wortes zaehlen.
+  * @param value Wort.
+  * @return Anzahl gesetzter Bits.
+  */
+unsigned int countBits(Word value) {
+	value = value - ((value >> 1) & 0x5555555555555555ULL);
+	value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (unsigned int) ((value * 0x0101010101010101ULL) >> 56);
+}
+}
+
+
+/**
+  * Ein leeres Brett erzeugen.
+  */
+MazeBitboard::MazeBitboard() {
+	width = 0;
+	height = 0;
+	stride = 1;
+}
+
+
+/**
+  * Masken fuer ein Labyrinth aufbauen. Ausgaenge ueber den Rand
+  * werden nicht in die Masken aufgenommen, sondern als Tunnel
+  * vermerkt, da sie nicht durch Verschieben erreichbar sind.
+  * @param maze Labyrinth.
+  */
+void MazeBitboard::build(const MazeGrid& maze) {
+	width = maze.getWidth();
+	height = maze.getHeight();
+	stride = (width + 63) / 64 + 1;
+
+	unsigned int wordCount = stride * (height + 2);
+	openUp.assign(wordCount, 0);
+	openLeft.assign(wordCount, 0);
+	openDown.assign(wordCount, 0);
+	openRight.assign(wordCount, 0);
+	outside.assign(wordCount, ~Word(0));
+	tunnelSources.assign(wordCount, 0);
+	tunnels.clear();
+
+	visited.assign(wordCount, 0);
+	frontier.assign(wordCount, 0);
+	next.assign(wordCount, 0);
+	active.clear();
+	touched.clear();
+	ringWords.clear();
+	ringBits.clear();
+	ringOffsets.assign(1, 0);
+
+	for (unsigned int y = 0; y < height; ++y) {
+		for (unsigned int x = 0; x < width; ++x) {
+			unsigned int word = (y + 1) * stride + x / 64;
+			Word bit = Word(1) << (x % 64);
+			unsigned int cell = maze.getIndex(x, y);
+			unsigned int exits = maze.getExits(cell);
+			outside[ word ] &= ~bit;
+
+			// Welche Ausgaenge fuehren ueber den Rand?
+			unsigned int wrapping = Direction::NONE;
+			if (x == 0)          wrapping |= Direction::LEFT;
+			if (x == width - 1)  wrapping |= Direction::RIGHT;
+			if (y == 0)          wrapping |= Direction::UP;
+			if (y == height - 1) wrapping |= Direction::DOWN;
+
+			if ((exits & Direction::UP)    && !(wrapping & Direction::UP))    openUp[ word ]    |= bit;
+			if ((exits & Direction::LEFT)  && !(wrapping & Direction::LEFT))  openLeft[ word ]  |= bit;
+			if ((exits & Direction::DOWN)  && !(wrapping & Direction::DOWN))  openDown[ word ]  |= bit;
+			if ((exits & Direction::RIGHT) && !(wrapping & Direction::RIGHT)) openRight[ word ] |= bit;
+
+			for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+				if ((exits & wrapping & direction) == 0) {
+					continue;
+				}
+				unsigned int target = maze.getNeighbour(cell, direction);
+				unsigned int targetX = maze.getX(target);
+				unsigned int targetY = maze.getY(target);
+
+				Tunnel tunnel;
+				tunnel.sourceWord = word;
+				tunnel.sourceBit = bit;
+				tunnel.targetWord = (targetY + 1) * stride + targetX / 64;
+				tunnel.targetBit = Word(1) << (targetX % 64);
+				tunnels.push_back(tunnel);
+				tunnelSources[ word ] |= bit;
+			}
+		}
+	}
+}
+
+
+/**
+  * Bits in der naechsten Front setzen und das Wort vormerken.
+  * @param word Index des Wortes.
+  * @param bits Zu setzende Bits.
+  */
+void MazeBitboard::mark(unsigned int word, Word bits) {
+	if (bits != 0) {
+		if (next[ word ] == 0) {
+			touched.push_back(word);
+		}
+		next[ word ] |= bits;
+	}
+}
+
+
+/**
+  * Einen Ring erweitern, indem nur die Woerter der Front bearbeitet
+  * werden. Jedes Wort traegt zu sich selbst, seinen Nachbarwoertern
+  * in der Zeile und den Woertern darueber und darunter bei.
+  */
+void MazeBitboard::expandSparse() {
+	touched.clear();
+	for (std::vector<unsigned int>::const_iterator iter = active.begin(); iter != active.end(); ++iter) {
+		unsigned int word = *iter;
+		Word current = frontier[ word ];
+
+		Word toRight = current & openRight[ word ];
+		mark(word, toRight << 1);
+		mark(word + 1, toRight >> 63);
+
+		Word toLeft = current & openLeft[ word ];
+		mark(word, toLeft >> 1);
+		mark(word - 1, toLeft << 63);
+
+		mark(word + stride, current & openDown[ word ]);
+		mark(word - stride, current & openUp[ word ]);
+
+		if (current & tunnelSources[ word ]) {
+			for (std::vector<Tunnel>::const_iterator tunnel = tunnels.begin(); tunnel != tunnels.end(); ++tunnel) {
+				if (tunnel->sourceWord == word && (current & tunnel->sourceBit)) {
+					mark(tunnel->targetWord, tunnel->targetBit);
+				}
+			}
+		}
+	}
+
+	for (std::vector<unsigned int>::const_iterator iter = active.begin(); iter != active.end(); ++iter) {
+		frontier[ *iter ] = 0;
+	}
+	active.clear();
+
+	for (std::vector<unsigned int>::const_iterator iter = touched.begin(); iter != touched.end(); ++iter) {
+		unsigned int word = *iter;
+		Word fresh = next[ word ] & ~visited[ word ];
+		next[ word ] = 0;
+		if (fresh != 0) {
+			visited[ word ] |= fresh;
+			frontier[ word ] = fresh;
+			active.push_back(word);
+		}
+	}
+}
+
+
+/**
+  * Einen Ring erweitern, indem das ganze Brett bearbeitet wird.
+  * Die leeren Randwoerter sorgen dafuer, dass kein Sonderfall fuer
+  * Zeilenanfang und -ende noetig ist.
+  */
+void MazeBitboard::expandDense() {
+	unsigned int begin = stride;
+	unsigned int end = stride * (height + 1);
+	expandWords(&frontier[ 0 ], &openUp[ 0 ], &openLeft[ 0 ], &openDown[ 0 ], &openRight[ 0 ],
+				&visited[ 0 ], &next[ 0 ], begin, end, stride);
+
+	for (std::vector<Tunnel>::const_iterator tunnel = tunnels.begin(); tunnel != tunnels.end(); ++tunnel) {
+		if (frontier[ tunnel->sourceWord ] & tunnel->sourceBit) {
+			next[ tunnel->targetWord ] |= tunnel->targetBit & ~visited[ tunnel->targetWord ];
+		}
+	}
+
+	// Die neue Front uebernehmen, die alte wird zum leeren Puffer.
+	frontier.swap(next);
+	for (std::vector<unsigned int>::const_iterator iter = active.begin(); iter != active.end(); ++iter) {
+		next[ *iter ] = 0;
+	}
+	active.clear();
+
+	for (unsigned int word = begin; word < end; ++word) {
+		if (frontier[ word ] != 0) {
+			visited[ word ] |= frontier[ word ];
+			active.push_back(word);
+		}
+	}
+}
+
+
+/**
+  * Die Woerter der neuen Front als naechsten Ring ablegen.
+  */
+void MazeBitboard::appendRing() {
+	for (std::vector<unsigned int>::const_iterator iter = active.begin(); iter != active.end(); ++iter) {
+		ringWords.push_back(*iter);
+		ringBits.push_back(frontier[ *iter ]);
+	}
+	ringOffsets.push_back(ringWords.size());
+}
+
+
+/**
+  * Flutfuellung ab einer oder mehreren Startzellen. Ring 0 enthaelt
+  * die Startzellen, Ring r alle Zellen im Abstand r.
+  * @param sources     Startzellen.
+  * @param maxDistance Hoechstens bis zu diesem Abstand suchen.
+  * @return Anzahl Ringe.
+  */
+unsigned int MazeBitboard::floodFill(const std::vector<unsigned int>& sources, unsigned int maxDistance) {
+	visited = outside;
+	ringWords.clear();
+	ringBits.clear();
+	ringOffsets.assign(1, 0);
+
+	for (std::vector<unsigned int>::const_iterator iter = sources.begin(); iter != sources.end(); ++iter) {
+		unsigned int word = (*iter / width + 1) * stride + (*iter % width) / 64;
+		Word bit = Word(1) << ((*iter % width) % 64);
+		if (visited[ word ] & bit) {
+			continue;
+		}
+		if (frontier[ word ] == 0) {
+			active.push_back(word);
+		}
+		frontier[ word ] |= bit;
+		visited[ word ] |= bit;
+	}
+	appendRing();
+
+	unsigned int wordCount = stride * (height + 2);
+	for (unsigned int distance = 1; distance <= maxDistance && !active.empty(); ++distance) {
+		if (active.size() * DENSE_RATIO >= wordCount) {
+			expandDense();
+		}
+		else {
+			expandSparse();
+		}
+		if (!active.empty()) {
+			appendRing();
+		}
+	}
+
+	// Die Front muss fuer die naechste Suche leer sein.
+	for (std::vector<unsigned int>::const_iterator iter = active.begin(); iter != active.end(); ++iter) {
+		frontier[ *iter ] = 0;
+	}
+	active.clear();
+
+	return getRingCount();
+}
+
+
+/**
+  * Flutfuellung ab einer einzelnen Startzelle.
+  * @param source      Startzelle.
+  * @param maxDistance Hoechstens bis zu diesem Abstand suchen.
+  * @return Anzahl Ringe.
+  */
+unsigned int MazeBitboard::floodFill(unsigned int source, unsigned int maxDistance) {
+	std::vector<unsigned int> sources(1, source);
+	return floodFill(sources, maxDistance);
+}
+
+
+/**
+  * Anzahl Ringe der letzten Flutfuellung auslesen.
+  * @return Anzahl Ringe.
+  */
+unsigned int MazeBitboard::getRingCount() const {
+	return ringOffsets.size() - 1;
+}
+
+
+/**
+  * Anzahl Zellen eines Ringes auslesen.
+  * @param ring Index des Ringes (= Abstand).
+  * @return Anzahl Zellen.
+  */
+unsigned int MazeBitboard::getRingSize(unsigned int ring) const {
+	unsigned int size = 0;
+	for (unsigned int index = ringOffsets[ ring ]; index < ringOffsets[ ring + 1 ]; ++index) {
+		size += countBits(ringBits[ index ]);
+	}
+	return size;
+}
+
+
+/**
+  * Zellen eines Ringes auslesen.
+  * @param ring  Index des Ringes (= Abstand).
+  * @param cells Erhaelt die Zellen des Ringes.
+  */
+void MazeBitboard::getRingCells(unsigned int ring, std::vector<unsigned int>& cells) const {
+	cells.clear();
+	for (unsigned int index = ringOffsets[ ring ]; index < ringOffsets[ ring + 1 ]; ++index) {
+		unsigned int y = ringWords[ index ] / stride - 1;
+		unsigned int x = (ringWords[ index ] % stride) * 64;
+		for (Word bits = ringBits[ index ]; bits != 0; bits &= bits - 1) {
+			cells.push_back(y * width + x + lowestBit(bits));
+		}
+	}
+}
+
+
+/**
+  * Anzahl erreichter Zellen der letzten Flutfuellung auslesen.
+  * @return Anzahl Zellen in allen Ringen.
+  */
+unsigned int MazeBitboard::getReachedCount() const {
+	unsigned int count = 0;
+	for (std::vector<Word>::const_iterator iter = ringBits.begin(); iter != ringBits.end(); ++iter) {
+		count += countBits(*iter);
+	}
+	return count;
+}
+
+
+/**
+  * Wurde eine Zelle bei der letzten Flutfuellung erreicht?
+  * @param cell Index der Zelle.
+  * @return <code>true</code>, wenn sie erreicht wurde.
+  */
+bool MazeBitboard::isReached(unsigned int cell) const {
+	unsigned int x = cell % width;
+	unsigned int word = (cell / width + 1) * stride + x / 64;
+	return (visited[ word ] & (Word(1) << (x % 64))) != 0;
+}
+
+
+/**
+  * Abstandsfeld der letzten Flutfuellung erzeugen.
+  * @param distances Erhaelt je Zelle den Abstand oder NONE.
+  */
+void MazeBitboard::getDistances(std::vector<unsigned int>& distances) const {
+	distances.assign(width * height, NONE);
+	for (unsigned int ring = 0; ring < getRingCount(); ++ring) {
+		for (unsigned int index = ringOffsets[ ring ]; index < ringOffsets[ ring + 1 ]; ++index) {
+			unsigned int y = ringWords[ index ] / stride - 1;
+			unsigned int x = (ringWords[ index ] % stride) * 64;
+			for (Word bits = ringBits[ index ]; bits != 0; bits &= bits - 1) {
+				distances[ y * width + x + lowestBit(bits) ] = ring;
+			}
+		}
+	}
+}
+
+
+/**
+  * Vergleich fuer floodFill() und getDistances(): gewoehnliche
+  * Breitensuche mit Warteschlange, eine Zelle nach der anderen. Tunnel
+  * ergeben sich aus MazeGrid::getNeighbour().
+  * @param maze        Labyrinth, fuer das build() aufgerufen wurde.
+  * @param sources     Startzellen.
+  * @param distances   Erhaelt je Zelle den Abstand oder NONE.
+  * @param maxDistance Hoechstens bis zu diesem Abstand suchen.
+  */
+void MazeBitboard::floodFillScalar(const MazeGrid& maze, const std::vector<unsigned int>& sources,
+								   std::vector<unsigned int>& distances, unsigned int maxDistance) {
+	static const unsigned int Directions[ 4 ] = { Direction::UP, Direction::LEFT, Direction::DOWN, Direction::RIGHT };
+
+	distances.assign(maze.getCellCount(), NONE);
+	queue.clear();
+	for (std::vector<unsigned int>::const_iterator iter = sources.begin(); iter != sources.end(); ++iter) {
+		if (distances[ *iter ] == NONE) {
+			distances[ *iter ] = 0;
+			queue.push_back(*iter);
+		}
+	}
+
+	for (unsigned int head = 0; head < queue.size(); ++head) {
+		unsigned int cell = queue[ head ];
+		unsigned int distance = distances[ cell ] + 1;
+		if (distance > maxDistance) {
+			break;
+		}
+		for (unsigned int index = 0; index < 4; ++index) {
+			if (maze.isOpen(cell, Directions[ index ])) {
+				unsigned int neighbour = maze.getNeighbour(cell, Directions[ index ]);
+				if (distances[ neighbour ] == NONE) {
+					distances[ neighbour ] = distance;
+					queue.push_back(neighbour);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,187 @@
+#ifndef MAZE_BITBOARD_H
+#define MAZE_BITBOARD_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+class MazeGrid;
+
+/**
+  * Flutfuellung (Breitensuche) ueber Bitboards. Jede Zeile des
+  * Labyrinths belegt einige 64-Bit-Woerter, ein Bit je Zelle. Fuer jede
+  * Richtung gibt es eine Maske der Zellen, die in diese Richtung
+  * verlassen werden koennen. Ein Ring der Suche entsteht, indem die
+  * Front mit den Masken verknuepft und um eine Zelle (links/rechts)
+  * bzw. eine Zeile (oben/unten) verschoben wird. Tunnel am Rand werden
+  * gesondert behandelt.
+  *
+  * Ist die Front klein, werden nur ihre Woerter bearbeitet. Ist sie
+  * gross, wird das ganze Brett in einem Durchlauf erweitert, mit AVX2
+  * vier Woerter auf einmal, falls der Compiler es unterstuetzt.
+  */
+class MazeBitboard {
+public:
+	// Kennzeichnet "keine Zelle" bzw. "nicht erreicht".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	// Ab einer Front von 1/DENSE_RATIO aller Woerter wird das ganze
+	// Brett auf einmal erweitert.
+	static const unsigned int DENSE_RATIO = 16;
+
+private:
+	typedef boost::uint64_t Word;
+
+	// Ausgang ueber den Rand: Quellbit und Zielbit
+	struct Tunnel {
+		unsigned int sourceWord;
+		Word sourceBit;
+		unsigned int targetWord;
+		Word targetBit;
+	};
+
+	// Groesse des Labyrinths
+	unsigned int width;
+	unsigned int height;
+
+	// Woerter pro Zeile inkl. eines leeren Wortes am Zeilenende, damit
+	// beim Verschieben nichts in die naechste Zeile uebertraegt. Ober-
+	// und unterhalb des Labyrinths liegt je eine leere Zeile.
+	unsigned int stride;
+
+	// Masken je Richtung (ohne Tunnel)
+	std::vector<Word> openUp;
+	std::vector<Word> openLeft;
+	std::vector<Word> openDown;
+	std::vector<Word> openRight;
+
+	// Alle Bits ausserhalb des Labyrinths, gelten stets als besucht
+	std::vector<Word> outside;
+
+	// Zellen mit Tunnel und die Tunnel selbst
+	std::vector<Word> tunnelSources;
+	std::vector<Tunnel> tunnels;
+
+	// Zustand der Suche: besuchte Zellen, aktuelle Front, naechste Front
+	std::vector<Word> visited;
+	std::vector<Word> frontier;
+	std::vector<Word> next;
+
+	// Woerter der aktuellen Front bzw. der naechsten Front
+	std::vector<unsigned int> active;
+	std::vector<unsigned int> touched;
+
+	// Nicht leere Woerter aller Ringe hintereinander (Index und Bits);
+	// Ring r liegt zwischen ringOffsets[r] und ringOffsets[r + 1]. Die
+	// Zellen werden erst beim Auslesen ermittelt.
+	std::vector<unsigned int> ringWords;
+	std::vector<Word> ringBits;
+	std::vector<unsigned int> ringOffsets;
+
+	// Warteschlange von floodFillScalar()
+	std::vector<unsigned int> queue;
+
+	/**
+	  * Bits in der naechsten Front setzen und das Wort vormerken.
+	  * @param word Index des Wortes.
+	  * @param bits Zu setzende Bits.
+	  */
+	void mark(unsigned int word, Word bits);
+
+	/**
+	  * Einen Ring erweitern, indem nur die Woerter der Front bearbeitet
+	  * werden.
+	  */
+	void expandSparse();
+
+	/**
+	  * Einen Ring erweitern, indem das ganze Brett bearbeitet wird.
+	  */
+	void expandDense();
+
+	/**
+	  * Die Woerter der neuen Front als naechsten Ring ablegen.
+	  */
+	void appendRing();
+
+public:
+	/**
+	  * Ein leeres Brett erzeugen.
+	  */
+	MazeBitboard();
+
+	/**
+	  * Masken fuer ein Labyrinth aufbauen.
+	  * @param maze Labyrinth.
+	  */
+	void build(const MazeGrid& maze);
+
+	/**
+	  * Flutfuellung ab einer oder mehreren Startzellen. Ring 0 enthaelt
+	  * die Startzellen, Ring r alle Zellen im Abstand r.
+	  * @param sources     Startzellen.
+	  * @param maxDistance Hoechstens bis zu diesem Abstand suchen.
+	  * @return Anzahl Ringe.
+	  */
+	unsigned int floodFill(const std::vector<unsigned int>& sources, unsigned int maxDistance = NONE);
+
+	/**
+	  * Flutfuellung ab einer einzelnen Startzelle.
+	  * @param source      Startzelle.
+	  * @param maxDistance Hoechstens bis zu diesem Abstand suchen.
+	  * @return Anzahl Ringe.
+	  */
+	unsigned int floodFill(unsigned int source, unsigned int maxDistance = NONE);
+
+	/**
+	  * Anzahl Ringe der letzten Flutfuellung auslesen.
+	  * @return Anzahl Ringe.
+	  */
+	unsigned int getRingCount() const;
+
+	/**
+	  * Anzahl Zellen eines Ringes auslesen.
+	  * @param ring Index des Ringes (= Abstand).
+	  * @return Anzahl Zellen.
+	  */
+	unsigned int getRingSize(unsigned int ring) const;
+
+	/**
+	  * Zellen eines Ringes auslesen.
+	  * @param ring  Index des Ringes (= Abstand).
+	  * @param cells Erhaelt die Zellen des Ringes.
+	  */
+	void getRingCells(unsigned int ring, std::vector<unsigned int>& cells) const;
+
+	/**
+	  * Anzahl erreichter Zellen der letzten Flutfuellung auslesen.
+	  * @return Anzahl Zellen in allen Ringen.
+	  */
+	unsigned int getReachedCount() const;
+
+	/**
+	  * Wurde eine Zelle bei der letzten Flutfuellung erreicht?
+	  * @param cell Index der Zelle.
+	  * @return <code>true</code>, wenn sie erreicht wurde.
+	  */
+	bool isReached(unsigned int cell) const;
+
+	/**
+	  * Abstandsfeld der letzten Flutfuellung erzeugen.
+	  * @param distances Erhaelt je Zelle den Abstand oder NONE.
+	  */
+	void getDistances(std::vector<unsigned int>& distances) const;
+
+	/**
+	  * Vergleich fuer floodFill() und getDistances(): gewoehnliche
+	  * Breitensuche mit Warteschlange ueber die Zellen des Labyrinths.
+	  * Aendert den Stand der letzten Flutfuellung nicht.
+	  * @param maze        Labyrinth, fuer das build() aufgerufen wurde.
+	  * @param sources     Startzellen.
+	  * @param distances   Erhaelt je Zelle den Abstand oder NONE.
+	  * @param maxDistance Hoechstens bis zu diesem Abstand suchen.
+	  */
+	void floodFillScalar(const MazeGrid& maze, const std::vector<unsigned int>& sources,
+						 std::vector<unsigned int>& distances, unsigned int maxDistance = NONE);
+};
+
+#endif // MAZE_BITBOARD_H
@@ -0,0 +1,179 @@
+#include "direction.hpp"
+#include "maze_grid.hpp"
+
+/**
+  * Ein leeres Labyrinth ohne Zellen erzeugen.
+  */
+MazeGrid::MazeGrid() {
+	resize(0, 0);
+}
+
+
+/**
+  * Ein Labyrinth erzeugen, in dem alle Zellen geschlossen sind.
+  * @param width  Anzahl Zellen in der Breite.
+  * @param height Anzahl Zellen in der Hoehe.
+  */
+MazeGrid::MazeGrid(unsigned int width, unsigned int height) {
+	resize(width, height);
+}
+
+
+/**
+  * Groesse neu festlegen, danach sind alle Zellen geschlossen.
+  * @param width  Anzahl Zellen in der Breite.
+  * @param height Anzahl Zellen in der Hoehe.
+  */
+void MazeGrid::resize(unsigned int width, unsigned int height) {
+	this->width = width;
+	this->height = height;
+	exits.assign(width * height, Direction::NONE);
+}
+
+
+/**
+  * Anzahl Zellen in der Breite auslesen.
+  * @return Breite in Zellen.
+  */
+unsigned int MazeGrid::getWidth() const {
+	return width;
+}
+
+
+/**
+  * Anzahl Zellen in der Hoehe auslesen.
+  * @return Hoehe in Zellen.
+  */
+unsigned int MazeGrid::getHeight() const {
+	return height;
+}
+
+
+/**
+  * Anzahl aller Zellen auslesen.
+  * @return Breite * Hoehe.
+  */
+unsigned int MazeGrid::getCellCount() const {
+	return exits.size();
+}
+
+
+/**
+  * Index der Zelle an der Koordinate (x,y) ermitteln.
+  * @param x X-Koordinate der Zelle.
+  * @param y Y-Koordinate der Zelle.
+  * @return Index der Zelle.
+  */
+unsigned int MazeGrid::getIndex(unsigned int x, unsigned int y) const {
+	return y * width + x;
+}
+
+
+/**
+  * X-Koordinate einer Zelle ermitteln.
+  * @param index Index der Zelle.
+  * @return X-Koordinate.
+  */
+unsigned int MazeGrid::getX(unsigned int index) const {
+	return index % width;
+}
+
+
+/**
+  * Y-Koordinate einer Zelle ermitteln.
+  * @param index Index der Zelle.
+  * @return Y-Koordinate.
+  */
+unsigned int MazeGrid::getY(unsigned int index) const {
+	return index / width;
+}
+
+
+/**
+  * Richtungen eintragen, in die die Zelle verlassen werden kann.
+  * @param index Index der Zelle.
+  * @param exits Bitkombination der Konstanten der Klasse 'Direction'.
+  */
+void MazeGrid::setExits(unsigned int index, unsigned int exits) {
+	this->exits[ index ] = (unsigned char) (exits & Direction::ALL);
+}
+
+
+/**
+  * Richtungen auslesen, in die die Zelle verlassen werden kann.
+  * @param index Index der Zelle.
+  * @return Bitkombination der Konstanten der Klasse 'Direction'.
+  */
+unsigned int MazeGrid::getExits(unsigned int index) const {
+	return exits[ index ];
+}
+
+
+/**
+  * Kann die Zelle in Richtung 'direction' verlassen werden?
+  * @param index     Index der Zelle.
+  * @param direction Eine der Konstanten der Klasse 'Direction'.
+  * @return <code>true</code>, wenn kein Rahmen im Weg ist.
+  */
+bool MazeGrid::isOpen(unsigned int index, unsigned int direction) const {
+	return (exits[ index ] & direction) != 0;
+}
+
+
+/**
+  * Nachbarzelle in einer Richtung ermitteln. Am Rand geht es
+  * wie durch einen Tunnel auf der anderen Seite weiter, Rahmen
+  * werden nicht beachtet.
+  * @param index     Index der Zelle.
+  * @param direction Eine der Konstanten der Klasse 'Direction'.
+  * @return Index der Nachbarzelle.
+  */
+unsigned int MazeGrid::getNeighbour(unsigned int index, unsigned int direction) const {
+	unsigned int x = index % width;
+	unsigned int y = index / width;
+	switch (direction) {
+		case Direction::UP:    y = (y == 0) ? height - 1 : y - 1; break;
+		case Direction::LEFT:  x = (x == 0) ? width - 1 : x - 1;  break;
+		case Direction::DOWN:  y = (y == height - 1) ? 0 : y + 1; break;
+		case Direction::RIGHT: x = (x == width - 1) ? 0 : x + 1;  break;
+	}
+	return y * width + x;
+}
+
+
+/**
+  * Anzahl gesetzter Richtungen in einer Bitkombination zaehlen.
+  * @param exits Bitkombination der Konstanten der Klasse 'Direction'.
+  * @return Anzahl Richtungen (0-4).
+  */
+unsigned int MazeGrid::countExits(unsigned int exits) {
+	static const unsigned int Counts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	return Counts[ exits & Direction::ALL ];
+}
+
+
+/**
+  * Position einer Richtung in der Bitkombination ermitteln, z.B.
+  * als Index in Tabellen mit einem Eintrag je Richtung.
+  * @param direction Eine der Konstanten der Klasse 'Direction'.
+  * @return 0 (oben), 1 (links), 2 (unten) oder 3 (rechts).
+  */
+unsigned int MazeGrid::getDirectionIndex(unsigned int direction) {
+	switch (direction) {
+		case Direction::LEFT:  return 1;
+		case Direction::DOWN:  return 2;
+		case Direction::RIGHT: return 3;
+	}
+	return 0;
+}
+
+
+/**
+  * Gegenrichtung ermitteln. Oben/unten und links/rechts liegen
+  * jeweils zwei Bits auseinander.
+  * @param direction Eine der Konstanten der Klasse 'Direction'.
+  * @return Um 180 Grad gedrehte Richtung.
+  */
+unsigned int MazeGrid::getOpposite(unsigned int direction) {
+	return ((direction << 2) | (direction >> 2)) & Direction::ALL;
+}
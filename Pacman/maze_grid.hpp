@@ -0,0 +1,144 @@
+#ifndef MAZE_GRID_H
+#define MAZE_GRID_H
+
+#include <vector>
+
+/**
+  * Kompakte Sicht auf das Labyrinth fuer Suchverfahren. Fuer jede
+  * Zelle wird nur festgehalten, in welche Richtungen eine Figur sie
+  * verlassen kann (Bitkombination der Konstanten der Klasse
+  * 'Direction', Tunnel eingeschlossen). Anders als das Spielfeld ist
+  * die Groesse nicht fest vorgegeben, die Zellen werden zeilenweise
+  * ueber einen Index angesprochen.
+  */
+class MazeGrid {
+public:
+	// Kennzeichnet "keine Zelle".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+private:
+	// Anzahl Zellen in der Breite
+	unsigned int width;
+
+	// Anzahl Zellen in der Hoehe
+	unsigned int height;
+
+	// Moegliche Richtungen je Zelle, Index ist y * width + x
+	std::vector<unsigned char> exits;
+
+public:
+	/**
+	  * Ein leeres Labyrinth ohne Zellen erzeugen.
+	  */
+	MazeGrid();
+
+	/**
+	  * Ein Labyrinth erzeugen, in dem alle Zellen geschlossen sind.
+	  * @param width  Anzahl Zellen in der Breite.
+	  * @param height Anzahl Zellen in der Hoehe.
+	  */
+	MazeGrid(unsigned int width, unsigned int height);
+
+	/**
+	  * Groesse neu festlegen, danach sind alle Zellen geschlossen.
+	  * @param width  Anzahl Zellen in der Breite.
+	  * @param height Anzahl Zellen in der Hoehe.
+	  */
+	void resize(unsigned int width, unsigned int height);
+
+	/**
+	  * Anzahl Zellen in der Breite auslesen.
+	  * @return Breite in Zellen.
+	  */
+	unsigned int getWidth() const;
+
+	/**
+	  * Anzahl Zellen in der Hoehe auslesen.
+	  * @return Hoehe in Zellen.
+	  */
+	unsigned int getHeight() const;
+
+	/**
+	  * Anzahl aller Zellen auslesen.
+	  * @return Breite * Hoehe.
+	  */
+	unsigned int getCellCount() const;
+
+	/**
+	  * Index der Zelle an der Koordinate (x,y) ermitteln.
+	  * @param x X-Koordinate der Zelle.
+	  * @param y Y-Koordinate der Zelle.
+	  * @return Index der Zelle.
+	  */
+	unsigned int getIndex(unsigned int x, unsigned int y) const;
+
+	/**
+	  * X-Koordinate einer Zelle ermitteln.
+	  * @param index Index der Zelle.
+	  * @return X-Koordinate.
+	  */
+	unsigned int getX(unsigned int index) const;
+
+	/**
+	  * Y-Koordinate einer Zelle ermitteln.
+	  * @param index Index der Zelle.
+	  * @return Y-Koordinate.
+	  */
+	unsigned int getY(unsigned int index) const;
+
+	/**
+	  * Richtungen eintragen, in die die Zelle verlassen werden kann.
+	  * @param index Index der Zelle.
+	  * @param exits Bitkombination der Konstanten der Klasse 'Direction'.
+	  */
+	void setExits(unsigned int index, unsigned int exits);
+
+	/**
+	  * Richtungen auslesen, in die die Zelle verlassen werden kann.
+	  * @param index Index der Zelle.
+	  * @return Bitkombination der Konstanten der Klasse 'Direction'.
+	  */
+	unsigned int getExits(unsigned int index) const;
+
+	/**
+	  * Kann die Zelle in Richtung 'direction' verlassen werden?
+	  * @param index     Index der Zelle.
+	  * @param direction Eine der Konstanten der Klasse 'Direction'.
+	  * @return <code>true</code>, wenn kein Rahmen im Weg ist.
+	  */
+	bool isOpen(unsigned int index, unsigned int direction) const;
+
+	/**
+	  * Nachbarzelle in einer Richtung ermitteln. Am Rand geht es
+	  * wie durch einen Tunnel auf der anderen Seite weiter, Rahmen
+	  * werden nicht beachtet.
+	  * @param index     Index der Zelle.
+	  * @param direction Eine der Konstanten der Klasse 'Direction'.
+	  * @return Index der Nachbarzelle.
+	  */
+	unsigned int getNeighbour(unsigned int index, unsigned int direction) const;
+
+	/**
+	  * Anzahl gesetzter Richtungen in einer Bitkombination zaehlen.
+	  * @param exits Bitkombination der Konstanten der Klasse 'Direction'.
+	  * @return Anzahl Richtungen (0-4).
+	  */
+	static unsigned int countExits(unsigned int exits);
+
+	/**
+	  * Position einer Richtung in der Bitkombination ermitteln, z.B.
+	  * als Index in Tabellen mit einem Eintrag je Richtung.
+	  * @param direction Eine der Konstanten der Klasse 'Direction'.
+	  * @return 0 (oben), 1 (links), 2 (unten) oder 3 (rechts).
+	  */
+	static unsigned int getDirectionIndex(unsigned int direction);
+
+	/**
+	  * Gegenrichtung ermitteln.
+	  * @param direction Eine der Konstanten der Klasse 'Direction'.
+	  * @return Um 180 Grad gedrehte Richtung.
+	  */
+	static unsigned int getOpposite(unsigned int direction);
+};
+
+#endif // MAZE_GRID_H
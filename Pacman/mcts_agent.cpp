@@ -0,0 +1,553 @@
+#include "field.hpp"
+#include "game_controller.hpp"
+#include "game_view.hpp"
+#include "mcts_agent.hpp"
+#include "timing_wheel.hpp"
+
+#include <cmath>
+#include <utility>
+#include <boost/cstdint.hpp>
+
+namespace {
+// Gewicht der Erkundung in der UCT-Formel
+const double EXPLORATION = 0.7;
+
+// Bewertung einer Simulation, die Pacman ueberlebt, ohne zu fressen
+const double SURVIVAL_VALUE = 0.5;
+
+/**
+  * Aktuelle Uhrzeit fuer das Zeitbudget.
+  * @return Zeitpunkt.
+  */
+boost::posix_time::ptime now() {
+	return boost::posix_time::microsec_clock::universal_time();
+}
+
+/**
+  * Anzahl gesetzter Bits einer Richtungskombination.
+  * @param mask Bitkombination der Konstanten der Klasse 'Direction'.
+  * @return Anzahl Richtungen.
+  */
+unsigned int countMoves(unsigned int mask) {
+	unsigned int count = 0;
+	for (; mask != 0; mask &= mask - 1) {
+		++count;
+	}
+	return count;
+}
+
+/**
+  * Die n-te gesetzte Bitposition einer Richtungskombination.
+  * @param mask  Bitkombination der Konstanten der Klasse 'Direction'.
+  * @param index Nummer der gesuchten Richtung (ab 0).
+  * @return Bitposition.
+  */
+unsigned int nthMove(unsigned int mask, unsigned int index) {
+	for (unsigned int move = 0; move < 4; ++move) {
+		if ((mask & (1u << move)) != 0 && index-- == 0) {
+			return move;
+		}
+	}
+	return 0;
+}
+}
+
+
+/**
+  * Arbeitsthread der Suche mit eigenem Spielfeld und eigenem Baum.
+  * Er ist zugleich der automatische Spieler seines Spielfeldes: In
+  * jeder Simulation entscheidet er zuerst entlang des Baumes, danach
+  * zufaellig.
+  */
+class MctsWorker: public PacmanAgent {
+	// Knoten des Baumes, Kinder je Bitposition der Richtung
+	struct Node {
+		unsigned int children[ 4 ];
+		unsigned int legal;
+		unsigned int visits;
+		double value;
+	};
+
+	// Kennzeichnet "kein Kind".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	// Auftraggeber mit Auftrag und Statistik der Wurzel
+	MctsAgent& agent;
+
+	// Spielfeld fuer die Simulationen
+	Field field;
+
+	// Baum der laufenden Entscheidung, Knoten 0 ist die Wurzel
+	std::vector<Node> nodes;
+
+	// Weg der laufenden Simulation durch den Baum
+	std::vector<unsigned int> path;
+
+	// Hash des Spielstandes und Knoten jeder Entscheidung im Baum
+	std::vector<std::pair<boost::uint64_t, unsigned int> > visited;
+
+	// Erweiterungen, deren Zug aus der Tabelle stammt
+	unsigned int tableHits;
+
+	// <code>true</code>, solange die Simulation im Baum absteigt
+	bool inTree;
+
+	// Schritte der laufenden Simulation
+	unsigned int decisions;
+
+	// Zustand des Zufallsgenerators (xorshift)
+	boost::uint32_t seed;
+
+	/**
+	  * Naechste Zufallszahl.
+	  * @return Zufallszahl.
+	  */
+	unsigned int random() {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		return seed;
+	}
+
+	/**
+	  * Einen neuen Knoten anlegen.
+	  * @return Index des Knotens.
+	  */
+	unsigned int addNode() {
+		Node node;
+		for (unsigned int move = 0; move < 4; ++move) {
+			node.children[ move ] = NONE;
+		}
+		node.legal = Direction::NONE;
+		node.visits = 0;
+		node.value = 0.0;
+		nodes.push_back(node);
+		return nodes.size() - 1;
+	}
+
+	/**
+	  * Eine Simulation ab dem Spielstand der Wurzel.
+	  * @param root Spielfeld mitten in der Entscheidung.
+	  * @param move Bitposition der Richtung an der Wurzel.
+	  * @return Bewertung zwischen 0 und 1.
+	  */
+	double simulate(const Field& root, unsigned int move) {
+		if (nodes[ 0 ].children[ move ] == NONE) {
+			unsigned int child = addNode();
+			nodes[ 0 ].children[ move ] = child;
+		}
+		path.assign(1, nodes[ 0 ].children[ move ]);
+		visited.clear();
+		inTree = true;
+		decisions = 1;
+
+		field.copyStateFrom(root);
+		field.setRandomSeed(random());
+		unsigned int points = field.getPoints();
+		unsigned int lives = field.getLives();
+		field.resumeTick(Direction(1u << move));
+		while (decisions < MctsAgent::HORIZON && field.getState() == Playing) {
+			field.advanceUntilNextEvent(TimingWheel::NONE);
+		}
+
+		double value;
+		if (field.getLives() < lives || field.getState() == GameOver) {
+			value = 0.0;
+		}
+		else if (field.getState() == LevelOver) {
+			value = 1.0;
+		}
+		else {
+			double gained = (field.getPoints() - points) / double(MctsAgent::HORIZON * GameController::DOT_POINTS);
+			value = SURVIVAL_VALUE + (1.0 - SURVIVAL_VALUE) * (gained < 1.0 ? gained : 1.0);
+		}
+
+		for (std::vector<unsigned int>::iterator iter = path.begin(); iter != path.end(); ++iter) {
+			nodes[ *iter ].visits++;
+			nodes[ *iter ].value += value;
+		}
+		storeVisited();
+		return value;
+	}
+
+	/**
+	  * Fuer jeden Spielstand, in dem die Simulation im Baum entschieden
+	  * hat, den bisher besten Zug in der gemeinsamen Tabelle ablegen.
+	  * Als Tiefe dient die Anzahl der Besuche des Knotens.
+	  */
+	void storeVisited() {
+		for (unsigned int index = 0; index < visited.size(); ++index) {
+			const Node& node = nodes[ visited[ index ].second ];
+			unsigned int best = NONE;
+			double bestValue = -1.0;
+			for (unsigned int move = 0; move < 4; ++move) {
+				unsigned int child = node.children[ move ];
+				if (child != NONE && nodes[ child ].visits > 0 &&
+					nodes[ child ].value / nodes[ child ].visits > bestValue) {
+					best = move;
+					bestValue = nodes[ child ].value / nodes[ child ].visits;
+				}
+			}
+			if (best != NONE) {
+				agent.table.store(visited[ index ].first, float(bestValue), node.visits, Direction(1u << best));
+			}
+		}
+	}
+
+	/**
+	  * Im Baum absteigen: Einen noch nicht versuchten Zug erweitern,
+	  * bevorzugt den besten Zug laut Tabelle, sonst das Kind mit der
+	  * besten UCT-Bewertung waehlen.
+	  * @param legal Erlaubte Richtungen als Bitkombination.
+	  * @param hash  Hash des Spielstandes.
+	  * @return Bitposition der Richtung.
+	  */
+	unsigned int selectInTree(unsigned int legal, boost::uint64_t hash) {
+		unsigned int current = path.back();
+		nodes[ current ].legal = legal;
+		visited.push_back(std::make_pair(hash, current));
+
+		unsigned int untried = 0;
+		for (unsigned int move = 0; move < 4; ++move) {
+			if ((legal & (1u << move)) != 0 && nodes[ current ].children[ move ] == NONE) {
+				untried |= 1u << move;
+			}
+		}
+		if (untried != 0) {
+			TranspositionTable::Entry entry;
+			unsigned int move;
+			if (agent.table.probe(hash, entry) && (entry.best.getValue() & untried) != 0) {
+				move = nthMove(entry.best.getValue() & untried, 0);
+				++tableHits;
+			}
+			else {
+				move = nthMove(untried, random() % countMoves(untried));
+			}
+			unsigned int child = addNode();
+			nodes[ current ].children[ move ] = child;
+			path.push_back(child);
+			inTree = false;
+			return move;
+		}
+
+		unsigned int best = 0;
+		double bestScore = -1.0;
+		double logVisits = std::log(double(nodes[ current ].visits));
+		for (unsigned int move = 0; move < 4; ++move) {
+			if ((legal & (1u << move)) == 0) {
+				continue;
+			}
+			const Node& child = nodes[ nodes[ current ].children[ move ] ];
+			double score = child.value / child.visits + EXPLORATION * std::sqrt(logVisits / child.visits);
+			if (score > bestScore) {
+				best = move;
+				bestScore = score;
+			}
+		}
+		path.push_back(nodes[ current ].children[ best ]);
+		return best;
+	}
+
+public:
+	/**
+	  * Arbeitsthread vorbereiten.
+	  * @param agent Auftraggeber.
+	  * @param seed  Startwert des Zufallsgenerators, nicht 0.
+	  */
+	MctsWorker(MctsAgent& agent, boost::uint32_t seed)
+			:	agent(agent), tableHits(0), inTree(false), decisions(0), seed(seed)
+	{
+		field.setPacmanAgent(this);
+	}
+
+	/**
+	  * Hauptschleife des Threads: Auf einen Auftrag warten, bis zum
+	  * Ende des Zeitbudgets simulieren und die Anzahl melden.
+	  */
+	void operator()() {
+		unsigned int seen = 0;
+		for (;;) {
+			const Field* root;
+			boost::posix_time::ptime deadline;
+			{
+				boost::mutex::scoped_lock lock(agent.mutex);
+				while (agent.generation == seen && !agent.stopping) {
+					agent.jobReady.wait(lock);
+				}
+				if (agent.stopping) {
+					return;
+				}
+				seen = agent.generation;
+				root = agent.root;
+				deadline = agent.deadline;
+			}
+
+			nodes.clear();
+			addNode();
+			tableHits = 0;
+			unsigned int rollouts = 0;
+			do {
+				unsigned int move = agent.beginRootMove(random());
+				agent.endRootMove(move, simulate(*root, move));
+				++rollouts;
+			} while (now() < deadline);
+
+			boost::mutex::scoped_lock lock(agent.mutex);
+			agent.lastRollouts += rollouts;
+			agent.lastTableHits += tableHits;
+			if (--agent.pending == 0) {
+				agent.jobDone.notify_all();
+			}
+		}
+	}
+
+	/**
+	  * Richtung in der Simulation waehlen: im Baum nach UCT, danach
+	  * zufaellig, aber nur in Sackgassen umkehren.
+	  * @param view Sicht auf das Spielfeld des Threads.
+	  * @return Gewuenschte Richtung.
+	  */
+	virtual Direction decide(const GameView& view) {
+		++decisions;
+		unsigned int legal = 0;
+		for (unsigned int move = 0; move < 4; ++move) {
+			if (view.canPacmanMove(Direction(1u << move))) {
+				legal |= 1u << move;
+			}
+		}
+		if (legal == 0) {
+			return Direction::NONE;
+		}
+		if (inTree) {
+			return Direction(1u << selectInTree(legal, view.getStateHash()));
+		}
+
+		unsigned int forward = legal & ~view.getPacmanDirection().turn180Degree().getValue();
+		if (forward != 0) {
+			legal = forward;
+		}
+		return Direction(1u << nthMove(legal, random() % countMoves(legal)));
+	}
+};
+
+
+/**
+  * Spieler samt Threadpool erzeugen.
+  * @param threadCount Anzahl Threads, 0 fuer einen je Kern.
+  * @param budget      Zeitbudget je Entscheidung in Millisekunden.
+  */
+MctsAgent::MctsAgent(unsigned int threadCount, unsigned int budget) {
+	this->root = 0;
+	this->rootLegal = Direction::NONE;
+	this->generation = 0;
+	this->pending = 0;
+	this->stopping = false;
+	this->lastRollouts = 0;
+	this->lastTableHits = 0;
+	this->lastSeconds = 0.0;
+	this->totalRollouts = 0;
+	setTimeBudget(budget);
+
+	if (threadCount == 0) {
+		threadCount = boost::thread::hardware_concurrency();
+	}
+	if (threadCount == 0) {
+		threadCount = 1;
+	}
+	for (unsigned int index = 0; index < threadCount; ++index) {
+		workers.push_back(new MctsWorker(*this, 2463534242u + 7919u * index));
+	}
+	for (unsigned int index = 0; index < threadCount; ++index) {
+		threads.create_thread(boost::ref(*workers[ index ]));
+	}
+}
+
+
+/**
+  * Threadpool beenden.
+  */
+MctsAgent::~MctsAgent() {
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	threads.join_all();
+	for (std::vector<MctsWorker*>::iterator iter = workers.begin(); iter != workers.end(); ++iter) {
+		delete *iter;
+	}
+}
+
+
+/**
+  * Richtung per Suche waehlen. Der Aufrufer wartet, bis alle Threads
+  * ihr Zeitbudget verbraucht haben.
+  * @param view Nur lesende Sicht auf den Spielstand.
+  * @return Gewuenschte Richtung.
+  */
+Direction MctsAgent::decide(const GameView& view) {
+	unsigned int legal = 0;
+	for (unsigned int move = 0; move < 4; ++move) {
+		if (view.canPacmanMove(Direction(1u << move))) {
+			legal |= 1u << move;
+		}
+	}
+	if (countMoves(legal) < 2) {
+		return Direction(legal);
+	}
+
+	boost::posix_time::ptime start = now();
+	{
+		boost::mutex::scoped_lock lock(mutex);
+		for (unsigned int move = 0; move < 4; ++move) {
+			rootMoves[ move ].visits = 0;
+			rootMoves[ move ].virtualVisits = 0;
+			rootMoves[ move ].value = 0.0;
+		}
+		rootLegal = legal;
+		root = &view.getField();
+		deadline = start + boost::posix_time::milliseconds(budget);
+		lastRollouts = 0;
+		lastTableHits = 0;
+		table.nextGeneration();
+		pending = workers.size();
+		++generation;
+		jobReady.notify_all();
+		while (pending > 0) {
+			jobDone.wait(lock);
+		}
+		root = 0;
+	}
+	lastSeconds = (now() - start).total_microseconds() / 1e6;
+	totalRollouts += lastRollouts;
+
+	unsigned int best = nthMove(legal, 0);
+	for (unsigned int move = 0; move < 4; ++move) {
+		if ((legal & (1u << move)) != 0 && rootMoves[ move ].visits > rootMoves[ best ].visits) {
+			best = move;
+		}
+	}
+	return Direction(1u << best);
+}
+
+
+/**
+  * Einen Zug an der Wurzel fuer die naechste Simulation waehlen: nach
+  * UCT, wobei laufende Simulationen als verlorene Besuche zaehlen.
+  * @param random Zufallszahl fuer die Wahl unter unbesuchten Zuegen.
+  * @return Bitposition der Richtung.
+  */
+unsigned int MctsAgent::beginRootMove(unsigned int random) {
+	boost::mutex::scoped_lock lock(mutex);
+	unsigned int total = 0;
+	unsigned int unvisited = 0;
+	for (unsigned int move = 0; move < 4; ++move) {
+		if ((rootLegal & (1u << move)) != 0) {
+			unsigned int visits = rootMoves[ move ].visits + rootMoves[ move ].virtualVisits;
+			total += visits;
+			if (visits == 0) {
+				unvisited |= 1u << move;
+			}
+		}
+	}
+
+	unsigned int best = 0;
+	if (unvisited != 0) {
+		best = nthMove(unvisited, random % countMoves(unvisited));
+	}
+	else {
+		double bestScore = -1.0;
+		double logVisits = std::log(double(total));
+		for (unsigned int move = 0; move < 4; ++move) {
+			if ((rootLegal & (1u << move)) == 0) {
+				continue;
+			}
+			double visits = rootMoves[ move ].visits + rootMoves[ move ].virtualVisits;
+			double score = rootMoves[ move ].value / visits + EXPLORATION * std::sqrt(logVisits / visits);
+			if (score > bestScore) {
+				best = move;
+				bestScore = score;
+			}
+		}
+	}
+	rootMoves[ best ].virtualVisits += VIRTUAL_LOSS;
+	return best;
+}
+
+
+/**
+  * Ergebnis einer Simulation eintragen und den virtuellen Verlust
+  * wieder abziehen.
+  * @param move  Bitposition der Richtung.
+  * @param value Bewertung zwischen 0 und 1.
+  */
+void MctsAgent::endRootMove(unsigned int move, double value) {
+	boost::mutex::scoped_lock lock(mutex);
+	rootMoves[ move ].virtualVisits -= VIRTUAL_LOSS;
+	rootMoves[ move ].visits++;
+	rootMoves[ move ].value += value;
+}
+
+
+/**
+  * Zeitbudget je Entscheidung festlegen.
+  * @param budget Millisekunden, hoechstens MAX_BUDGET.
+  */
+void MctsAgent::setTimeBudget(unsigned int budget) {
+	this->budget = (budget < 1) ? 1 : ((budget > MAX_BUDGET) ? MAX_BUDGET : budget);
+}
+
+
+/**
+  * Zeitbudget je Entscheidung auslesen.
+  * @return Millisekunden.
+  */
+unsigned int MctsAgent::getTimeBudget() const {
+	return budget;
+}
+
+
+/**
+  * Anzahl Arbeitsthreads auslesen.
+  * @return Anzahl Threads.
+  */
+unsigned int MctsAgent::getThreadCount() const {
+	return workers.size();
+}
+
+
+/**
+  * Anzahl Simulationen der letzten Entscheidung auslesen.
+  * @return Anzahl Simulationen.
+  */
+unsigned int MctsAgent::getLastRollouts() const {
+	return lastRollouts;
+}
+
+
+/**
+  * Simulationen je Sekunde bei der letzten Entscheidung.
+  * @return Simulationen je Sekunde aller Threads zusammen.
+  */
+double MctsAgent::getRolloutsPerSecond() const {
+	return (lastSeconds > 0.0) ? lastRollouts / lastSeconds : 0.0;
+}
+
+
+/**
+  * Anzahl der Erweiterungen bei der letzten Entscheidung, deren Zug
+  * aus der Transpositionstabelle stammt.
+  * @return Anzahl Treffer.
+  */
+unsigned int MctsAgent::getLastTableHits() const {
+	return lastTableHits;
+}
+
+
+/**
+  * Anzahl aller bisherigen Simulationen auslesen.
+  * @return Anzahl Simulationen.
+  */
+unsigned long long MctsAgent::getTotalRollouts() const {
+	return totalRollouts;
+}
@@ -0,0 +1,182 @@
+#ifndef MCTS_AGENT_H
+#define MCTS_AGENT_H
+
+#include <vector>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include "pacman.hpp"
+#include "pacman_agent.hpp"
+#include "simulation_thread.hpp"
+#include "transposition_table.hpp"
+
+class Field;
+class MctsWorker;
+
+/**
+  * Suchender Spieler: Monte-Carlo-Baumsuche ueber Pacmans Schritte.
+  * Jede Simulation kopiert den Spielstand in das eigene Spielfeld
+  * eines Arbeitsthreads und spielt von dort mit zufaelligen Schritten
+  * weiter. Die Threads eines festen Pools bauen getrennte Baeume
+  * (Wurzelparallelisierung), teilen sich aber die Statistik der Zuege
+  * an der Wurzel. Ein virtueller Verlust auf den gerade simulierten
+  * Zuegen lenkt die anderen Threads auf andere Zuege. Ueber eine
+  * gemeinsame Transpositionstabelle erfahren die Threads, welcher Zug
+  * in einem Spielstand bisher am besten war, auch aus frueheren
+  * Entscheidungen. Gesucht wird, bis das Zeitbudget des Schrittes
+  * verbraucht ist.
+  */
+class MctsAgent: public PacmanAgent {
+	friend class MctsWorker;
+
+public:
+	// Zeitbudget je Entscheidung in Millisekunden: unter einem Takt von
+	// SimulationThread::TICKS_PER_SECOND, damit die Simulation im Takt bleibt.
+	static const unsigned int DEFAULT_BUDGET = 10;
+
+	// Hoechstes Zeitbudget: die Zeit zwischen zwei Schritten von Pacman.
+	static const unsigned int MAX_BUDGET = Pacman::NORMAL_PERIOD * 1000 / SimulationThread::TICKS_PER_SECOND;
+
+	// Anzahl Schritte von Pacman je Simulation
+	static const unsigned int HORIZON = 40;
+
+	// So viele verlorene Besuche zaehlt ein Zug an der Wurzel, solange
+	// ein Thread ihn simuliert.
+	static const unsigned int VIRTUAL_LOSS = 3;
+
+private:
+	// Statistik eines Zuges an der Wurzel
+	struct RootMove {
+		unsigned int visits;
+		unsigned int virtualVisits;
+		double value;
+	};
+
+	// Zuege an der Wurzel, Index ist die Bitposition der Richtung
+	RootMove rootMoves[ 4 ];
+
+	// Erlaubte Richtungen an der Wurzel als Bitkombination
+	unsigned int rootLegal;
+
+	// Zu durchsuchender Spielstand und Ende der Suche
+	const Field* root;
+	boost::posix_time::ptime deadline;
+
+	// Zeitbudget in Millisekunden
+	unsigned int budget;
+
+	// Schuetzt alle gemeinsamen Daten von Auftrag und Statistik
+	boost::mutex mutex;
+
+	// Neuer Auftrag bzw. alle Threads fertig
+	boost::condition_variable jobReady;
+	boost::condition_variable jobDone;
+
+	// Zaehler der Auftraege, Anzahl noch suchender Threads und
+	// Kennzeichen zum Beenden des Pools
+	unsigned int generation;
+	unsigned int pending;
+	bool stopping;
+
+	// Gemeinsame Tabelle aller Threads, ohne Sperren beschrieben
+	TranspositionTable table;
+
+	// Simulationen, Treffer in der Tabelle und Dauer der letzten
+	// Entscheidung, Summe aller Simulationen
+	unsigned int lastRollouts;
+	unsigned int lastTableHits;
+	double lastSeconds;
+	unsigned long long totalRollouts;
+
+	// Arbeitsthreads samt ihren Spielfeldern
+	std::vector<MctsWorker*> workers;
+	boost::thread_group threads;
+
+	/**
+	  * Einen Zug an der Wurzel fuer die naechste Simulation waehlen
+	  * und mit dem virtuellen Verlust belegen.
+	  * @param random Zufallszahl fuer den Gleichstand.
+	  * @return Bitposition der Richtung.
+	  */
+	unsigned int beginRootMove(unsigned int random);
+
+	/**
+	  * Ergebnis einer Simulation eintragen und den virtuellen Verlust
+	  * wieder abziehen.
+	  * @param move  Bitposition der Richtung.
+	  * @param value Bewertung zwischen 0 und 1.
+	  */
+	void endRootMove(unsigned int move, double value);
+
+	// Nicht kopierbar
+	MctsAgent(const MctsAgent&);
+	MctsAgent& operator=(const MctsAgent&);
+
+public:
+	/**
+	  * Spieler samt Threadpool erzeugen.
+	  * @param threadCount Anzahl Threads, 0 fuer einen je Kern.
+	  * @param budget      Zeitbudget je Entscheidung in Millisekunden.
+	  */
+	MctsAgent(unsigned int threadCount = 0, unsigned int budget = DEFAULT_BUDGET);
+
+	/**
+	  * Threadpool beenden.
+	  */
+	virtual ~MctsAgent();
+
+	/**
+	  * Richtung per Suche waehlen. Gibt es nur eine Moeglichkeit, wird
+	  * nicht gesucht.
+	  * @param view Nur lesende Sicht auf den Spielstand.
+	  * @return Gewuenschte Richtung.
+	  */
+	virtual Direction decide(const GameView& view);
+
+	/**
+	  * Zeitbudget je Entscheidung festlegen.
+	  * @param budget Millisekunden, hoechstens MAX_BUDGET.
+	  */
+	void setTimeBudget(unsigned int budget);
+
+	/**
+	  * Zeitbudget je Entscheidung auslesen.
+	  * @return Millisekunden.
+	  */
+	unsigned int getTimeBudget() const;
+
+	/**
+	  * Anzahl Arbeitsthreads auslesen.
+	  * @return Anzahl Threads.
+	  */
+	unsigned int getThreadCount() const;
+
+	/**
+	  * Anzahl Simulationen der letzten Entscheidung auslesen.
+	  * @return Anzahl Simulationen.
+	  */
+	unsigned int getLastRollouts() const;
+
+	/**
+	  * Simulationen je Sekunde bei der letzten Entscheidung, das Mass
+	  * fuer die Geschwindigkeit der Simulation.
+	  * @return Simulationen je Sekunde aller Threads zusammen.
+	  */
+	double getRolloutsPerSecond() const;
+
+	/**
+	  * Anzahl der Erweiterungen bei der letzten Entscheidung, deren
+	  * Zug aus der Transpositionstabelle stammt.
+	  * @return Anzahl Treffer.
+	  */
+	unsigned int getLastTableHits() const;
+
+	/**
+	  * Anzahl aller bisherigen Simulationen auslesen.
+	  * @return Anzahl Simulationen.
+	  */
+	unsigned long long getTotalRollouts() const;
+};
+
+#endif // MCTS_AGENT_H
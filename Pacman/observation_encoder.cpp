@@ -0,0 +1,186 @@
+#include "game_view.hpp"
+#include "maze_grid.hpp"
+#include "observation_encoder.hpp"
+#include "pacman_env.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENCODER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+/**
+  * Bytes mit den Werten 0 und 1 in Gleitkommazahlen umwandeln.
+  * @param source Bytes.
+  * @param target Erhaelt die Zahlen.
+  * @param count  Anzahl Elemente.
+  */
+void convertToFloat(const unsigned char* source, float* target, unsigned int count) {
+	unsigned int index = 0;
+
+#if defined(ENCODER_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; index + 16 <= count; index += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i*) (source + index));
+		__m128i low = _mm_unpacklo_epi8(bytes, zero);
+		__m128i high = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_ps(target + index,      _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)));
+		_mm_storeu_ps(target + index + 4,  _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)));
+		_mm_storeu_ps(target + index + 8,  _mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)));
+		_mm_storeu_ps(target + index + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)));
+	}
+#endif
+
+	for (; index < count; ++index) {
+		target[ index ] = source[ index ];
+	}
+}
+
+/**
+  * Elemente auf 0 setzen.
+  * @param target Erhaelt die Nullen.
+  * @param count  Anzahl Elemente.
+  */
+void clearFloats(float* target, unsigned int count) {
+	unsigned int index = 0;
+
+#if defined(ENCODER_SSE2)
+	const __m128 zero = _mm_setzero_ps();
+	for (; index + 16 <= count; index += 16) {
+		_mm_storeu_ps(target + index,      zero);
+		_mm_storeu_ps(target + index + 4,  zero);
+		_mm_storeu_ps(target + index + 8,  zero);
+		_mm_storeu_ps(target + index + 12, zero);
+	}
+#endif
+
+	for (; index < count; ++index) {
+		target[ index ] = 0.0f;
+	}
+}
+}
+
+
+/**
+  * Vorrat eines Platzes nachfuehren. Essen verschwindet nur unter
+  * Pacman. Stimmt die Anzahl danach nicht (neues Level, neues Spiel),
+  * werden alle vorraetigen Ebenen neu eingelesen.
+  * @param slot Platz.
+  * @param view Sicht auf das Spiel.
+  * @return Vorraetige Ebenen.
+  */
+const unsigned char* ObservationEncoder::updateSlot(unsigned int slot, const GameView& view) {
+	if (slot >= slots.size()) {
+		Slot empty;
+		empty.level = 0;
+		empty.food = 0;
+		slots.resize(slot + 1, empty);
+	}
+	Slot& cache = slots[ slot ];
+
+	unsigned int level = view.getLevelNumber();
+	unsigned int food = view.getFoodCount();
+	if (cache.level == level && food < cache.food) {
+		unsigned int cell = view.getPacmanCell();
+		unsigned char& plane = cache.planes[ FoodPlane * PLANE_SIZE + cell ];
+		if (plane != 0 && !view.isFood(cell)) {
+			plane = 0;
+			--cache.food;
+		}
+	}
+
+	if (cache.level != level || cache.food != food) {
+		const MazeGrid& maze = view.getMaze();
+		cache.planes.resize(CACHED_PLANES * PLANE_SIZE);
+		for (unsigned int cell = 0; cell < PLANE_SIZE; ++cell) {
+			cache.planes[ WallPlane * PLANE_SIZE + cell ] = maze.getExits(cell) == 0 ? 1 : 0;
+			cache.planes[ PrisonExitPlane * PLANE_SIZE + cell ] = view.isPrisonExit(cell) ? 1 : 0;
+			cache.planes[ FoodPlane * PLANE_SIZE + cell ] = view.isFood(cell) ? 1 : 0;
+		}
+		cache.level = level;
+		cache.food = food;
+	}
+	return &cache.planes[ 0 ];
+}
+
+
+/**
+  * Die Figuren in die bereits geloeschten Ebenen eintragen.
+  * @param view   Sicht auf das Spiel.
+  * @param planes Anfang des Tensors des Spiels.
+  * @param one    Wert fuer "trifft zu".
+  */
+template <class Element>
+void ObservationEncoder::writeFigures(const GameView& view, Element* planes, Element one) {
+	view.getItemCells(pills, cherries);
+	for (std::vector<unsigned int>::iterator iter = pills.begin(); iter != pills.end(); ++iter) {
+		planes[ PillPlane * PLANE_SIZE + *iter ] = one;
+	}
+	for (std::vector<unsigned int>::iterator iter = cherries.begin(); iter != cherries.end(); ++iter) {
+		planes[ CherryPlane * PLANE_SIZE + *iter ] = one;
+	}
+
+	unsigned int ghostPlane = view.getGhostHarmlessTicks() > 0 ? FrightenedPlane : GhostPlane;
+	for (unsigned int index = 0; index < view.getGhostCount(); ++index) {
+		if (view.getGhostState(index) == Alive) {
+			planes[ ghostPlane * PLANE_SIZE + view.getGhostCell(index) ] = one;
+		}
+	}
+	planes[ PacmanPlane * PLANE_SIZE + view.getPacmanCell() ] = one;
+}
+
+
+/**
+  * Einen Spielstand als Bytes kodieren.
+  * @param slot   Platz, dessen Vorrat benutzt wird.
+  * @param view   Sicht auf das Spiel.
+  * @param planes Erhaelt OBSERVATION_SIZE Bytes.
+  */
+void ObservationEncoder::encode(unsigned int slot, const GameView& view, unsigned char* planes) {
+	const unsigned char* cached = updateSlot(slot, view);
+	std::copy(cached, cached + CACHED_PLANES * PLANE_SIZE, planes);
+	std::fill(planes + CACHED_PLANES * PLANE_SIZE, planes + OBSERVATION_SIZE, 0);
+	writeFigures(view, planes, (unsigned char) 1);
+}
+
+
+/**
+  * Einen Spielstand als Gleitkommazahlen kodieren. Die vorraetigen
+  * Ebenen werden direkt aus den Bytes umgewandelt.
+  * @param slot   Platz, dessen Vorrat benutzt wird.
+  * @param view   Sicht auf das Spiel.
+  * @param planes Erhaelt OBSERVATION_SIZE Zahlen.
+  */
+void ObservationEncoder::encode(unsigned int slot, const GameView& view, float* planes) {
+	convertToFloat(updateSlot(slot, view), planes, CACHED_PLANES * PLANE_SIZE);
+	clearFloats(planes + CACHED_PLANES * PLANE_SIZE, OBSERVATION_SIZE - CACHED_PLANES * PLANE_SIZE);
+	writeFigures(view, planes, 1.0f);
+}
+
+
+/**
+  * Alle Spiele mehrerer Umgebungen in einen zusammenhaengenden
+  * Tensor kodieren.
+  * @param envs   Umgebungen.
+  * @param tensor Erhaelt envs.getCount() * OBSERVATION_SIZE Bytes.
+  */
+void ObservationEncoder::encodeBatch(VectorEnv& envs, unsigned char* tensor) {
+	for (unsigned int index = 0; index < envs.getCount(); ++index) {
+		encode(index, envs.getEnv(index).getField().getView(), tensor + index * OBSERVATION_SIZE);
+	}
+}
+
+
+/**
+  * Alle Spiele mehrerer Umgebungen in einen zusammenhaengenden
+  * Tensor aus Gleitkommazahlen kodieren.
+  * @param envs   Umgebungen.
+  * @param tensor Erhaelt envs.getCount() * OBSERVATION_SIZE Zahlen.
+  */
+void ObservationEncoder::encodeBatch(VectorEnv& envs, float* tensor) {
+	for (unsigned int index = 0; index < envs.getCount(); ++index) {
+		encode(index, envs.getEnv(index).getField().getView(), tensor + index * OBSERVATION_SIZE);
+	}
+}
@@ -0,0 +1,110 @@
+#ifndef OBSERVATION_ENCODER_H
+#define OBSERVATION_ENCODER_H
+
+#include <vector>
+#include "field.hpp"
+
+class GameView;
+class VectorEnv;
+
+/**
+  * Wandelt Spielstaende in Tensoren aus mehreren Ebenen fuer
+  * Lernverfahren um. Jede Ebene hat ein Element je Zelle (zeilenweise
+  * wie MazeGrid) mit dem Wert 1, wenn die Eigenschaft der Ebene auf die
+  * Zelle zutrifft, sonst 0. Ein Spiel belegt OBSERVATION_SIZE Elemente,
+  * mehrere Spiele liegen direkt hintereinander.
+  *
+  * Mauern, Gefaengnisausgaenge und Essen haelt der Kodierer je Spiel
+  * (Platz) vorraetig und kopiert sie nur, das Essen wird dabei
+  * inkrementell nachgefuehrt. Die Ebenen der Figuren werden geloescht
+  * und neu beschrieben. Die Umwandlung in Gleitkommazahlen nutzt SSE2,
+  * falls verfuegbar.
+  */
+class ObservationEncoder {
+public:
+	// Ebenen in der Reihenfolge im Tensor: zuerst die vorraetigen,
+	// danach die der Figuren. Gefaehrliche und harmlose Geister liegen
+	// in verschiedenen Ebenen, zurueckkehrende Geister in keiner.
+	enum Plane { WallPlane = 0, PrisonExitPlane, FoodPlane, PillPlane, CherryPlane,
+				 PacmanPlane, GhostPlane, FrightenedPlane, PLANES };
+
+	// Anzahl Elemente einer Ebene
+	static const unsigned int PLANE_SIZE = Field::FIELD_WIDTH * Field::FIELD_HEIGHT;
+
+	// Anzahl Elemente je Spiel
+	static const unsigned int OBSERVATION_SIZE = PLANES * PLANE_SIZE;
+
+	// Anzahl vorraetig gehaltener Ebenen (WallPlane bis FoodPlane)
+	static const unsigned int CACHED_PLANES = PillPlane;
+
+private:
+	// Vorrat eines Platzes: Level und Essen, fuer die er gilt, und
+	// die vorraetigen Ebenen
+	struct Slot {
+		unsigned int level;
+		unsigned int food;
+		std::vector<unsigned char> planes;
+	};
+
+	// Vorrat je Platz
+	std::vector<Slot> slots;
+
+	// Sammelt die Zellen der Pillen und Kirschen
+	std::vector<unsigned int> pills;
+	std::vector<unsigned int> cherries;
+
+	/**
+	  * Vorrat eines Platzes nachfuehren: Essen unter Pacman entfernen
+	  * und, wenn das nicht reicht, alles neu einlesen.
+	  * @param slot Platz.
+	  * @param view Sicht auf das Spiel.
+	  * @return Vorraetige Ebenen.
+	  */
+	const unsigned char* updateSlot(unsigned int slot, const GameView& view);
+
+	/**
+	  * Die Figuren in die bereits geloeschten Ebenen eintragen.
+	  * @param view   Sicht auf das Spiel.
+	  * @param planes Anfang des Tensors des Spiels.
+	  * @param one    Wert fuer "trifft zu".
+	  */
+	template <class Element>
+	void writeFigures(const GameView& view, Element* planes, Element one);
+
+public:
+	/**
+	  * Einen Spielstand als Bytes kodieren.
+	  * @param slot   Platz, dessen Vorrat benutzt wird, z.B. die
+	  *               Nummer der Umgebung. Ein Platz gehoert immer
+	  *               demselben Spiel.
+	  * @param view   Sicht auf das Spiel.
+	  * @param planes Erhaelt OBSERVATION_SIZE Bytes.
+	  */
+	void encode(unsigned int slot, const GameView& view, unsigned char* planes);
+
+	/**
+	  * Einen Spielstand als Gleitkommazahlen kodieren.
+	  * @param slot   Platz, dessen Vorrat benutzt wird.
+	  * @param view   Sicht auf das Spiel.
+	  * @param planes Erhaelt OBSERVATION_SIZE Zahlen.
+	  */
+	void encode(unsigned int slot, const GameView& view, float* planes);
+
+	/**
+	  * Alle Spiele mehrerer Umgebungen in einen zusammenhaengenden
+	  * Tensor kodieren, Platz i ist die Umgebung i.
+	  * @param envs   Umgebungen.
+	  * @param tensor Erhaelt envs.getCount() * OBSERVATION_SIZE Bytes.
+	  */
+	void encodeBatch(VectorEnv& envs, unsigned char* tensor);
+
+	/**
+	  * Alle Spiele mehrerer Umgebungen in einen zusammenhaengenden
+	  * Tensor aus Gleitkommazahlen kodieren.
+	  * @param envs   Umgebungen.
+	  * @param tensor Erhaelt envs.getCount() * OBSERVATION_SIZE Zahlen.
+	  */
+	void encodeBatch(VectorEnv& envs, float* tensor);
+};
+
+#endif // OBSERVATION_ENCODER_H
@@ -1,6 +1,7 @@
 #include "field.hpp"
 #include "game_controller.hpp"
 #include "pacman.hpp"
+#include "turn_statistics.hpp"
 
 namespace {
 PacmanDescriptor Descriptor = {
@@ -88,45 +89,111 @@ unsigned int Pacman::getAngleFromDirection() const {
 void Pacman::nextTick() {
 	// Mund oeffnen und schliessen
 	if (this->state == Alive) {
-		if (mouthOpening) {
-			mouthOpenAngle += MOUTH_STEP;
-			if (mouthOpenAngle == MAX_MOUTH_ANGLE) {
-				mouthOpening = false;
-			}
-		}
-		else {
-			mouthOpenAngle -= MOUTH_STEP;
-			if (mouthOpenAngle == MIN_MOUTH_ANGLE) {
-				mouthOpening = true;
-			}
-		}
+		animateMouth();
 
-		this->ticks++;
-		if(this->ticks >= this->speed)
-		{
-			this->ticks = 0;
-		}
-		else
+		// Eine Zelle ist zurueckgelegt, der Rest zaehlt fuer die naechste.
+		this->progress += this->speed;
+		if(this->progress < SUBCELLS)
 		{
 			return;
 		}
 
-		// Bewegen
-		if (this->direction != Direction::NONE) {
-			// Der Controller macht das fuer alle Figuren.
-			controller->move(this, this->direction);
+		// Bewegen, je zurueckgelegter Zelle ein Schritt. Schafft Pacman
+		// mehr als eine Zelle im Takt, wird nach jedem Schritt vor dem
+		// letzten auf Kollision geprueft, damit er durch keine Figur
+		// hindurch laeuft. Den letzten prueft der Controller.
+		while(true)
+		{
+			this->progress -= SUBCELLS;
+			if(this->cellsAhead > 0)
+			{
+				// Im Makroschritt schon zurueckgelegte Zelle
+				--this->cellsAhead;
+			}
+			else
+			{
+				applyRequestedDirection();
+				if (this->direction != Direction::NONE) {
+					// Der Controller macht das fuer alle Figuren.
+					controller->move(this, this->direction);
+				}
+			}
+			if(this->progress < SUBCELLS)
+			{
+				break;
+			}
+			controller->handleCollisionWithPacman(this);
+			if(this->state != Alive)
+			{
+				return;
+			}
 		}
 	}
 
 	if(this->state == Dying)
 	{
 		mouthOpenAngle += MOUTH_STEP;
-		if(mouthOpenAngle >= 360) this->state = Dead;
+		if(mouthOpenAngle >= 360) this->setState(Dead);
 	}
 
 }
 
 
+/**
+  * Den Mund um einen Schritt weiter oeffnen bzw. schliessen.
+  */
+void Pacman::animateMouth() {
+	if (mouthOpening) {
+		mouthOpenAngle += MOUTH_STEP;
+		if (mouthOpenAngle == MAX_MOUTH_ANGLE) {
+			mouthOpening = false;
+		}
+	}
+	else {
+		mouthOpenAngle -= MOUTH_STEP;
+		if (mouthOpenAngle == MIN_MOUTH_ANGLE) {
+			mouthOpening = true;
+		}
+	}
+}
+
+
+/**
+  * Nach wievielen Aufrufen von nextTick() bewegt sich Pacman
+  * bzw. ist er endgueltig tot? Solange er stirbt, oeffnet sich
+  * der Mund in jedem Takt weiter, bis er 360 Grad erreicht.
+  * @return Anzahl Takte oder <code>NEVER</code>.
+  */
+unsigned int Pacman::getTicksUntilAction() const {
+	if (this->state == Alive) {
+		return (this->progress < SUBCELLS) ? (SUBCELLS - this->progress + this->speed - 1) / this->speed : 1;
+	}
+	if (this->state == Dying) {
+		if (mouthOpenAngle >= 360) return 1;
+		return (360 - mouthOpenAngle + MOUTH_STEP - 1) / MOUTH_STEP;
+	}
+	return NEVER;
+}
+
+
+/**
+  * Mundanimation und Weg auf der Kante um Takte ohne Bewegung weiterfuehren.
+  * Die Animation wiederholt sich nach MOUTH_CYCLE Schritten.
+  * @param count Anzahl uebersprungener Takte.
+  */
+void Pacman::skipTicks(unsigned int count) {
+	if (this->state == Alive) {
+		for (unsigned int i = 0; i < count % MOUTH_CYCLE; ++i) {
+			animateMouth();
+		}
+		this->progress += count * this->speed;
+	}
+	else if (this->state == Dying) {
+		mouthOpenAngle += MOUTH_STEP * count;
+	}
+}
+
+
 /**
   * Eine Taste wurde gedrueckt, um die Figur in eine bestimmte
   * Richtung zu schicken. 
@@ -135,14 +202,91 @@ void Pacman::nextTick() {
 void Pacman::keyPressed(Direction direction) {
 	// Nur weitermachen, wenn Pacman lebt
 	if(this->getState() != Alive) return;
+	if (direction == Direction::NONE) return;
+
+	// Ein neuer Druck beginnt mit einer anderen Richtung oder nachdem
+	// die Taste losgelassen war. Fuer die Verteilung zaehlt eine
+	// gehaltene Taste ab dem ersten Druck.
+	unsigned int now = controller->getTickCount();
+	if (!(direction == this->pressedDirection) || now > this->lastKeyTick + 1) {
+		this->pressedDirection = direction;
+		this->pressTick = now;
+		this->pressExpired = false;
+	}
+	this->lastKeyTick = now;
+
+	// Wunsch vormerken, solange die Taste gehalten wird, bleibt er frisch
+	this->requestedDirection = direction;
+	this->requestTick = now;
 
 	// Neue Richtung speichern
-	if (direction != Direction::NONE && controller->canMove(this, direction)) {
+	if (controller->canMove(this, direction)) {
 		this->direction = direction;
 	}
 }
 
 
+/**
+  * Vorausgelaufene Zellen eines Makroschrittes eintragen.
+  * @param cells Anzahl Zellen.
+  */
+void Pacman::setCellsAhead(unsigned int cells) {
+	this->cellsAhead = cells;
+}
+
+
+/**
+  * Vorausgelaufene Zellen auslesen.
+  * @return Anzahl noch abzuwartender Schritte.
+  */
+unsigned int Pacman::getCellsAhead() const {
+	return this->cellsAhead;
+}
+
+
+/**
+  * Vor einem Schritt die gewuenschte Richtung uebernehmen, falls sie
+  * jetzt moeglich ist, oder sie verwerfen, wenn sie verfallen ist.
+  * Jede Abbiegung wird mit den Takten seit dem ersten Druck der Taste
+  * in der Verteilung des Controllers gezaehlt, falls eine angemeldet
+  * ist, ein verfallener Wunsch einmal je Druck.
+  */
+void Pacman::applyRequestedDirection() {
+	if (this->requestedDirection == Direction::NONE) {
+		return;
+	}
+
+	// Eine schon in keyPressed() moegliche Richtung gilt ohne Frist.
+	TurnStatistics* statistics = controller->getTurnStatistics();
+	unsigned int waited = controller->getTickCount() - this->requestTick;
+	bool accepted = this->requestedDirection == this->direction;
+	if (accepted || waited <= controller->getTurnBuffer()) {
+		if (controller->canMove(this, this->requestedDirection)) {
+			// Gezaehlt wird nur, wenn der Schritt die Richtung des
+			// letzten Schrittes aendert (Figure::getDirection()).
+			if (statistics != 0 && !(this->requestedDirection == getDirection())) {
+				bool pressed = this->requestedDirection == this->pressedDirection;
+				statistics->recordTurn(controller->getTickCount() - (pressed ? this->pressTick : this->requestTick));
+			}
+			this->direction = this->requestedDirection;
+			this->requestedDirection = Direction::NONE;
+			return;
+		}
+		if (!accepted && waited < controller->getTurnBuffer()) {
+			return;
+		}
+	}
+
+	if (statistics != 0 && !accepted && !this->pressExpired) {
+		statistics->recordExpired();
+	}
+	if (this->requestedDirection == this->pressedDirection) {
+		this->pressExpired = true;
+	}
+	this->requestedDirection = Direction::NONE;
+}
+
+
 /**
   * Kollisionsbehandlung: Diese Figur ist mit der uebergebenen
   * zusammen gestossen.
@@ -159,4 +303,48 @@ void Pacman::reset()
 	this->mouthOpenAngle = MAX_MOUTH_ANGLE;
 	this->mouthOpening = false;
 	this->direction = Direction::NONE;
-}
\ No newline at end of file
+	this->requestedDirection = Direction::NONE;
+	this->requestTick = 0;
+	this->pressedDirection = Direction::NONE;
+	this->pressTick = 0;
+	this->lastKeyTick = 0;
+	this->pressExpired = false;
+	this->cellsAhead = 0;
+}
+
+
+/**
+  * Zustand eines anderen Pacman samt Mund und gewuenschter
+  * Richtung uebernehmen.
+  * @param other Anderer Pacman.
+  */
+void Pacman::copyStateFrom(const Figure& other) {
+	Figure::copyStateFrom(other);
+	const Pacman& pacman = static_cast<const Pacman&>(other);
+	this->mouthOpenAngle = pacman.mouthOpenAngle;
+	this->mouthOpening = pacman.mouthOpening;
+	this->direction = pacman.direction;
+	this->requestedDirection = pacman.requestedDirection;
+	this->requestTick = pacman.requestTick;
+	this->pressedDirection = pacman.pressedDirection;
+	this->pressTick = pacman.pressTick;
+	this->lastKeyTick = pacman.lastKeyTick;
+	this->pressExpired = pacman.pressExpired;
+	this->cellsAhead = pacman.cellsAhead;
+}
+
+
+/**
+  * Zustand samt Mund, Laufrichtung, Richtungswunsch, Tastendruck und
+  * Makroschritt als eine Zeile ohne Zeilenende schreiben.
+  * @param out Ziel der Ausgabe.
+  */
+void Pacman::writeState(std::ostream& out) const {
+	Figure::writeState(out);
+	out << " mouth " << this->mouthOpenAngle << (this->mouthOpening ? " opening" : " closing")
+		<< " heading " << this->direction.getValue()
+		<< " requested " << this->requestedDirection.getValue() << " at " << this->requestTick
+		<< " pressed " << this->pressedDirection.getValue() << " from " << this->pressTick
+		<< " to " << this->lastKeyTick << (this->pressExpired ? " expired" : "")
+		<< " ahead " << this->cellsAhead;
+}
@@ -21,6 +21,10 @@ class Pacman: public Figure {
 	// geoeffnet oder geschlossen werden soll.
 	static const unsigned int MOUTH_STEP = 10;
 
+	// Anzahl Schritte, bis der Mund wieder in derselben
+	// Stellung ist (einmal schliessen und oeffnen).
+	static const unsigned int MOUTH_CYCLE = 2 * (MAX_MOUTH_ANGLE - MIN_MOUTH_ANGLE) / MOUTH_STEP;
+
 	// Oeffnungswinkel des Mundes.
 	unsigned int mouthOpenAngle;
 
@@ -29,12 +33,34 @@ class Pacman: public Figure {
 	bool mouthOpening;
 
 
-	// Geschwindigkeit des Pacman
-	static const unsigned int NORMAL_SPEED = 5;
-
 	// Richtung, in der Pacman gerade luft
 	Direction direction;
 
+	// Zuletzt gewuenschte Richtung, bis Pacman damit einen Schritt
+	// macht oder sie verfaellt, sonst NONE, und der Takt des Wunsches
+	// (bei gehaltener Taste der letzte Aufruf von keyPressed())
+	Direction requestedDirection;
+	unsigned int requestTick;
+
+	// Richtung des laufenden Tastendrucks, sein erster und sein
+	// letzter Takt und ob er schon als verfallen gezaehlt wurde. Ein
+	// Druck endet, wenn die Richtung wechselt oder die Taste einen
+	// Takt lang nicht gemeldet wird.
+	Direction pressedDirection;
+	unsigned int pressTick;
+	unsigned int lastKeyTick;
+	bool pressExpired;
+
+	// Im Makroschritt vorausgelaufene Zellen, deren Schritte Pacman
+	// noch abwartet (siehe GameController::setCorridorSteps())
+	unsigned int cellsAhead;
+
+	/**
+	  * Vor einem Schritt die gewuenschte Richtung uebernehmen, falls sie
+	  * jetzt moeglich ist, oder sie verwerfen, wenn sie verfallen ist.
+	  */
+	void applyRequestedDirection();
+
 	/**
 	  * Blickwinkel und damit Richtung bestimmen, in die der
 	  * Mund zeigen soll. Die Zahl wird als Multiplikator beim
@@ -48,7 +74,23 @@ class Pacman: public Figure {
 	  */
 	unsigned int getAngleFromDirection() const;
 
+	/**
+	  * Den Mund um einen Schritt weiter oeffnen bzw. schliessen.
+	  */
+	void animateMouth();
+
 public:
+	// Geschwindigkeit des Pacman in Teilzellen je Takt
+	static const unsigned int NORMAL_SPEED = 24;
+
+	// Takte je Zelle bei normaler Geschwindigkeit, fuer Rechnungen
+	// ohne Figuren (z.B. LockstepBatch)
+	static const unsigned int NORMAL_PERIOD = SUBCELLS / NORMAL_SPEED;
+
+	// So lange bleibt eine noch nicht moegliche Richtung vorgemerkt,
+	// 200 ms bei 60 Takten je Sekunde, gut zwei Schritte
+	static const unsigned int TURN_BUFFER_TICKS = 12;
+
 	/**
 	  * Pacman erzeugen.
 	  * @param x X-Position der Zelle des Spielfeldes, in der Pacman
@@ -75,13 +117,43 @@ public:
 	  */
 	virtual void nextTick();
 
+	/**
+	  * Nach wievielen Aufrufen von nextTick() bewegt sich Pacman
+	  * bzw. ist er endgueltig tot?
+	  * @return Anzahl Takte oder <code>NEVER</code>.
+	  */
+	virtual unsigned int getTicksUntilAction() const;
+
+	/**
+	  * Mundanimation und Weg auf der Kante um Takte ohne Bewegung weiterfuehren.
+	  * @param count Anzahl uebersprungener Takte.
+	  */
+	virtual void skipTicks(unsigned int count);
+
 	/**
 	  * Eine Taste wurde gedrueckt, um die Figur in eine bestimmte
-	  * Richtung zu schicken. 
+	  * Richtung zu schicken. Ist die Richtung gerade nicht moeglich,
+	  * z.B. kurz vor einer Kreuzung, bleibt sie vorgemerkt und gilt ab
+	  * dem ersten Schritt, an dem sie moeglich ist, solange die Taste
+	  * gehalten wird (Aufruf in jedem Takt) und danach hoechstens
+	  * GameController::getTurnBuffer() Takte lang.
 	  * @param direction Richtung, in die die Figur(en) bewegt werden soll(en).
 	  */
 	void keyPressed(Direction direction);
 
+	/**
+	  * Vorausgelaufene Zellen eines Makroschrittes eintragen. So viele
+	  * Schritte bleibt Pacman stehen.
+	  * @param cells Anzahl Zellen.
+	  */
+	void setCellsAhead(unsigned int cells);
+
+	/**
+	  * Vorausgelaufene Zellen auslesen.
+	  * @return Anzahl noch abzuwartender Schritte.
+	  */
+	unsigned int getCellsAhead() const;
+
 	/**
 	  * Kollisionsbehandlung: Diese Figur ist mit der uebergebenen
 	  * zusammen gestossen.
@@ -90,6 +162,20 @@ public:
 	virtual void handleCollisionWith(Figure* otherFigure);
 
 	void reset();
+
+	/**
+	  * Zustand eines anderen Pacman samt Mund und gewuenschter
+	  * Richtung uebernehmen.
+	  * @param other Anderer Pacman.
+	  */
+	virtual void copyStateFrom(const Figure& other);
+
+	/**
+	  * Zustand samt Mund, Laufrichtung, Richtungswunsch, Tastendruck
+	  * und Makroschritt schreiben.
+	  * @param out Ziel der Ausgabe.
+	  */
+	virtual void writeState(std::ostream& out) const;
 };
 
 #endif // PACMAN_H
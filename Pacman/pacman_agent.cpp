@@ -0,0 +1,166 @@
+#include "game_view.hpp"
+#include "maze_grid.hpp"
+#include "pacman_agent.hpp"
+
+#include <algorithm>
+
+const unsigned int AgentSearch::NONE;
+
+
+namespace {
+/**
+  * Die erste erreichte Zelle mit Essen, Pille oder Kirsche suchen.
+  * @param view   Sicht auf den Spielstand.
+  * @param search Suche ab Pacman.
+  * @param items  Zellen der Pillen und Kirschen.
+  * @return Richtung des ersten Schrittes dorthin oder Direction::NONE.
+  */
+Direction findNearestFood(const GameView& view, const AgentSearch& search,
+						  const std::vector<unsigned int>& items) {
+	const std::vector<unsigned int>& reached = search.getReached();
+	for (unsigned int index = 1; index < reached.size(); ++index) {
+		unsigned int cell = reached[ index ];
+		if (view.isFood(cell) || std::find(items.begin(), items.end(), cell) != items.end()) {
+			return Direction(search.getFirstStep(cell));
+		}
+	}
+	return Direction::NONE;
+}
+}
+
+
+/**
+  * Breitensuche ab einer oder mehreren Zellen. Mit einer Bedrohung
+  * wird eine Zelle nur betreten, wenn die Bedrohung sie spaeter
+  * erreicht: factor * Abstand der Bedrohung > Abstand + margin.
+  * @param maze    Labyrinth.
+  * @param sources Startzellen.
+  * @param threat  Vorherige Suche ab den Bedrohungen oder <code>0</code>.
+  * @param factor  Wievielmal langsamer die Bedrohung ist.
+  * @param margin  Geforderter Vorsprung in Schritten.
+  */
+void AgentSearch::run(const MazeGrid& maze, const std::vector<unsigned int>& sources,
+					  const AgentSearch* threat, unsigned int factor, unsigned int margin) {
+	distances.assign(maze.getCellCount(), NONE);
+	firstSteps.assign(maze.getCellCount(), Direction::NONE);
+	queue.clear();
+
+	for (std::vector<unsigned int>::const_iterator iter = sources.begin(); iter != sources.end(); ++iter) {
+		if (distances[ *iter ] == NONE) {
+			distances[ *iter ] = 0;
+			queue.push_back(*iter);
+		}
+	}
+
+	for (unsigned int head = 0; head < queue.size(); ++head) {
+		unsigned int cell = queue[ head ];
+		unsigned int distance = distances[ cell ] + 1;
+		for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+			if (!maze.isOpen(cell, direction)) {
+				continue;
+			}
+			unsigned int neighbour = maze.getNeighbour(cell, direction);
+			if (distances[ neighbour ] != NONE) {
+				continue;
+			}
+			if (threat != 0) {
+				unsigned int threatDistance = threat->getDistance(neighbour);
+				if (threatDistance != NONE && factor * threatDistance <= distance + margin) {
+					continue;
+				}
+			}
+			distances[ neighbour ] = distance;
+			firstSteps[ neighbour ] = (distance == 1) ? direction : firstSteps[ cell ];
+			queue.push_back(neighbour);
+		}
+	}
+}
+
+
+/**
+  * Abstand einer Zelle bei der letzten Suche.
+  * @param cell Index der Zelle.
+  * @return Anzahl Schritte oder NONE.
+  */
+unsigned int AgentSearch::getDistance(unsigned int cell) const {
+	return distances[ cell ];
+}
+
+
+/**
+  * Richtung des ersten Schrittes auf dem Weg zu einer Zelle.
+  * @param cell Index der Zelle.
+  * @return Konstante der Klasse 'Direction'.
+  */
+unsigned int AgentSearch::getFirstStep(unsigned int cell) const {
+	return firstSteps[ cell ];
+}
+
+
+/**
+  * Erreichte Zellen der letzten Suche in der Reihenfolge ihres
+  * Abstands.
+  * @return Zellen.
+  */
+const std::vector<unsigned int>& AgentSearch::getReached() const {
+	return queue;
+}
+
+
+/**
+  * Richtung zum naechsten Essen waehlen.
+  * @param view Nur lesende Sicht auf den Spielstand.
+  * @return Gewuenschte Richtung.
+  */
+Direction GreedyFoodAgent::decide(const GameView& view) {
+	sources.assign(1, view.getPacmanCell());
+	search.run(view.getMaze(), sources);
+	view.getItemCells(items);
+	return findNearestFood(view, search, items);
+}
+
+
+/**
+  * Richtung zum naechsten sicheren Essen waehlen. Harmlose Geister
+  * werden nur ignoriert, solange sie es noch eine Weile bleiben.
+  * @param view Nur lesende Sicht auf den Spielstand.
+  * @return Gewuenschte Richtung.
+  */
+Direction GhostAvoidingAgent::decide(const GameView& view) {
+	const MazeGrid& maze = view.getMaze();
+	unsigned int pacmanCell = view.getPacmanCell();
+
+	sources.clear();
+	if (view.getGhostHarmlessTicks() <= HARMLESS_RESERVE) {
+		for (unsigned int index = 0; index < view.getGhostCount(); ++index) {
+			if (view.getGhostState(index) == Alive) {
+				sources.push_back(view.getGhostCell(index));
+			}
+		}
+	}
+	ghostSearch.run(maze, sources);
+
+	sources.assign(1, pacmanCell);
+	pacmanSearch.run(maze, sources, &ghostSearch, SPEED_RATIO, SAFETY_MARGIN);
+	view.getItemCells(items);
+	Direction direction = findNearestFood(view, pacmanSearch, items);
+	if (direction != Direction::NONE) {
+		return direction;
+	}
+
+	// Kein sicheres Essen: zum Nachbarn mit dem groessten Abstand
+	// zu den Geistern fliehen.
+	unsigned int best = Direction::NONE;
+	unsigned int bestDistance = 0;
+	for (unsigned int step = Direction::UP; step <= Direction::RIGHT; step <<= 1) {
+		if (!maze.isOpen(pacmanCell, step)) {
+			continue;
+		}
+		unsigned int distance = ghostSearch.getDistance(maze.getNeighbour(pacmanCell, step));
+		if (best == Direction::NONE || distance > bestDistance) {
+			best = step;
+			bestDistance = distance;
+		}
+	}
+	return Direction(best);
+}
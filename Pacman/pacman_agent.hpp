@@ -0,0 +1,142 @@
+#ifndef PACMAN_AGENT_H
+#define PACMAN_AGENT_H
+
+#include <vector>
+#include "direction.hpp"
+
+class GameView;
+class MazeGrid;
+
+/**
+  * Schnittstelle fuer automatische Spieler. Der Controller fragt den
+  * Spieler immer dann nach einer Richtung, wenn Pacman im aktuellen
+  * Takt einen Schritt macht. Der Spieler gehoert nicht dem
+  * Controller und muss laenger leben als seine Anmeldung.
+  */
+class PacmanAgent {
+public:
+	virtual ~PacmanAgent() { }
+
+	/**
+	  * Richtung fuer den naechsten Schritt waehlen.
+	  * @param view Nur lesende Sicht auf den Spielstand.
+	  * @return Gewuenschte Richtung oder Direction::NONE, um die
+	  *         bisherige beizubehalten.
+	  */
+	virtual Direction decide(const GameView& view) = 0;
+};
+
+/**
+  * Breitensuche ueber das Labyrinth mit wiederverwendetem
+  * Arbeitsspeicher, gemeinsame Grundlage der eingebauten Spieler.
+  */
+class AgentSearch {
+	// Abstand je Zelle oder NONE
+	std::vector<unsigned int> distances;
+
+	// Richtung des ersten Schrittes je Zelle
+	std::vector<unsigned int> firstSteps;
+
+	// Warteschlange, zugleich Reihenfolge der erreichten Zellen
+	std::vector<unsigned int> queue;
+
+public:
+	// Kennzeichnet "nicht erreicht".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	/**
+	  * Breitensuche ab einer oder mehreren Zellen. Mit einer Bedrohung
+	  * wird eine Zelle nur betreten, wenn die Bedrohung sie spaeter
+	  * erreicht: factor * Abstand der Bedrohung > Abstand + margin.
+	  * @param maze    Labyrinth.
+	  * @param sources Startzellen.
+	  * @param threat  Vorherige Suche ab den Bedrohungen oder <code>0</code>.
+	  * @param factor  Wievielmal langsamer die Bedrohung ist.
+	  * @param margin  Geforderter Vorsprung in Schritten.
+	  */
+	void run(const MazeGrid& maze, const std::vector<unsigned int>& sources,
+			 const AgentSearch* threat = 0, unsigned int factor = 1, unsigned int margin = 0);
+
+	/**
+	  * Abstand einer Zelle bei der letzten Suche.
+	  * @param cell Index der Zelle.
+	  * @return Anzahl Schritte oder NONE.
+	  */
+	unsigned int getDistance(unsigned int cell) const;
+
+	/**
+	  * Richtung des ersten Schrittes auf dem Weg zu einer Zelle.
+	  * @param cell Index der Zelle.
+	  * @return Konstante der Klasse 'Direction'.
+	  */
+	unsigned int getFirstStep(unsigned int cell) const;
+
+	/**
+	  * Erreichte Zellen der letzten Suche in der Reihenfolge ihres
+	  * Abstands.
+	  * @return Zellen.
+	  */
+	const std::vector<unsigned int>& getReached() const;
+};
+
+/**
+  * Eingebauter Spieler, der stets zur naechsten Essensportion, Pille
+  * oder Kirsche laeuft und die Geister nicht beachtet.
+  */
+class GreedyFoodAgent: public PacmanAgent {
+	// Suche ab Pacman
+	AgentSearch search;
+
+	// Zellen der Startzelle und der Pillen/Kirschen
+	std::vector<unsigned int> sources;
+	std::vector<unsigned int> items;
+
+public:
+	/**
+	  * Richtung zum naechsten Essen waehlen.
+	  * @param view Nur lesende Sicht auf den Spielstand.
+	  * @return Gewuenschte Richtung.
+	  */
+	virtual Direction decide(const GameView& view);
+};
+
+/**
+  * Eingebauter Spieler, der zum naechsten Essen laeuft, das er sicher
+  * vor den gefaehrlichen Geistern erreicht. Eine Zelle gilt als
+  * unsicher, wenn ein Geist sie nicht wesentlich spaeter erreicht als
+  * Pacman, der doppelt so schnell ist. Gibt es kein sicheres Essen,
+  * flieht er zu dem Nachbarn, der am weitesten von den Geistern
+  * entfernt ist.
+  */
+class GhostAvoidingAgent: public PacmanAgent {
+public:
+	// Vorsprung in Schritten, den Pacman auf einer sicheren Zelle
+	// vor den Geistern haben muss.
+	static const unsigned int SAFETY_MARGIN = 2;
+
+	// Wievielmal schneller Pacman als ein gefaehrlicher Geist ist.
+	static const unsigned int SPEED_RATIO = 2;
+
+	// So viele Takte muessen die Geister noch harmlos bleiben, damit
+	// sie ignoriert werden.
+	static const unsigned int HARMLESS_RESERVE = 40;
+
+private:
+	// Suche ab den gefaehrlichen Geistern und ab Pacman
+	AgentSearch ghostSearch;
+	AgentSearch pacmanSearch;
+
+	// Startzellen und Pillen/Kirschen
+	std::vector<unsigned int> sources;
+	std::vector<unsigned int> items;
+
+public:
+	/**
+	  * Richtung zum naechsten sicheren Essen waehlen.
+	  * @param view Nur lesende Sicht auf den Spielstand.
+	  * @return Gewuenschte Richtung.
+	  */
+	virtual Direction decide(const GameView& view);
+};
+
+#endif // PACMAN_AGENT_H
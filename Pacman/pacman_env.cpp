@@ -0,0 +1,263 @@
+#include "game_view.hpp"
+#include "maze_grid.hpp"
+#include "pacman_env.hpp"
+#include "timing_wheel.hpp"
+
+#include <algorithm>
+
+/**
+  * Umgebung mit einem Spiel zum Startwert GameController::DEFAULT_SEED
+  * erzeugen.
+  */
+PacmanEnv::PacmanEnv() {
+	this->decided = false;
+	this->boardLevel = 0;
+	this->boardFood = 0;
+	field.setPacmanAgent(this);
+	reset(GameController::DEFAULT_SEED);
+}
+
+
+/**
+  * Ein neues Spiel beginnen. Der Spielbeginn wird kopiert statt neu
+  * aufgebaut, das ist ein Bruchteil der Kosten eines neuen Spielfeldes.
+  * @param seed        Startwert des Zufallsgenerators des Spiels.
+  * @param observation Erhaelt OBSERVATION_SIZE Bytes oder 0.
+  */
+void PacmanEnv::reset(unsigned int seed, unsigned char* observation) {
+	field.copyStateFrom(start);
+	field.setRandomSeed(seed);
+	boardLevel = 0;
+	if (observation != 0) {
+		observe(observation);
+	}
+}
+
+
+/**
+  * Makroschritte ein- oder ausschalten, auch fuer den Spielbeginn,
+  * von dem jede Episode kopiert wird.
+  * @param enabled <code>true</code> zum Einschalten.
+  */
+void PacmanEnv::setCorridorSteps(bool enabled) {
+	start.setCorridorSteps(enabled);
+	field.setCorridorSteps(enabled);
+}
+
+
+/**
+  * Bis zum naechsten Schritt von Pacman spielen. Die Takte dazwischen
+  * werden im Schnellvorlauf uebersprungen, auch ueber Tod, Start und
+  * Levelwechsel hinweg.
+  * @param action      Aktion (Bitposition der Richtung oder NO_ACTION).
+  * @param observation Erhaelt OBSERVATION_SIZE Bytes oder 0.
+  * @param reward      Erhaelt die Belohnung.
+  * @param done        Erhaelt <code>true</code>, wenn das Spiel vorbei ist.
+  */
+void PacmanEnv::step(unsigned int action, unsigned char* observation, float& reward, bool& done) {
+	this->action = action < NO_ACTION ? Direction(1u << action) : Direction(Direction::NONE);
+	unsigned int points = field.getPoints();
+	unsigned int lives = field.getLives();
+
+	decided = false;
+	while (!decided && field.getState() != GameOver) {
+		field.advanceUntilNextEvent(TimingWheel::NONE);
+	}
+
+	reward = float(field.getPoints() - points) - float(LIFE_PENALTY * (lives - field.getLives()));
+	done = field.getState() == GameOver;
+	if (observation != 0) {
+		observe(observation);
+	}
+}
+
+
+/**
+  * Labyrinth und Essen aller Zellen neu einlesen.
+  * @param view Sicht auf das Spiel.
+  */
+void PacmanEnv::rebuildBoard(const GameView& view) {
+	const MazeGrid& maze = view.getMaze();
+	board.resize(maze.getCellCount());
+	for (unsigned int cell = 0; cell < board.size(); ++cell) {
+		board[ cell ] = (unsigned char) (maze.getExits(cell) | (view.isFood(cell) ? OBS_FOOD : 0));
+	}
+	boardLevel = view.getLevelNumber();
+	boardFood = view.getFoodCount();
+}
+
+
+/**
+  * Beobachtung des aktuellen Spielstandes schreiben. Essen verschwindet
+  * nur dort, wo Pacman steht. Weicht die Anzahl danach noch ab (neues
+  * Level, Start eines Spiels), wird alles neu eingelesen.
+  * @param observation Erhaelt OBSERVATION_SIZE Bytes.
+  */
+void PacmanEnv::observe(unsigned char* observation) {
+	GameView view = field.getView();
+	unsigned int pacmanCell = view.getPacmanCell();
+	if (view.getLevelNumber() == boardLevel && view.getFoodCount() < boardFood &&
+		(board[ pacmanCell ] & OBS_FOOD) != 0 && !view.isFood(pacmanCell)) {
+		board[ pacmanCell ] &= ~OBS_FOOD;
+		--boardFood;
+	}
+	if (view.getLevelNumber() != boardLevel || view.getFoodCount() != boardFood) {
+		rebuildBoard(view);
+	}
+
+	std::copy(board.begin(), board.end(), observation);
+	view.getItemCells(items);
+	for (std::vector<unsigned int>::iterator iter = items.begin(); iter != items.end(); ++iter) {
+		observation[ *iter ] |= OBS_ITEM;
+	}
+	bool harmless = view.getGhostHarmlessTicks() > 0;
+	for (unsigned int index = 0; index < view.getGhostCount(); ++index) {
+		if (view.getGhostState(index) == Alive) {
+			observation[ view.getGhostCell(index) ] |= harmless ? OBS_ITEM : OBS_GHOST;
+		}
+	}
+	observation[ pacmanCell ] |= OBS_PACMAN;
+}
+
+
+/**
+  * Spiel der laufenden Episode auslesen.
+  * @return Spielfeld.
+  */
+Field& PacmanEnv::getField() {
+	return field;
+}
+
+
+/**
+  * Aktion des laufenden step() an den Controller geben.
+  * @param view Nur lesende Sicht auf den Spielstand.
+  * @return Gewuenschte Richtung.
+  */
+Direction PacmanEnv::decide(const GameView& /*view*/) {
+	decided = true;
+	return action;
+}
+
+
+/**
+  * Umgebungen erzeugen und mit aufeinanderfolgenden Startwerten
+  * beginnen.
+  * @param count Anzahl Umgebungen.
+  * @param seed  Startwert der ersten Umgebung.
+  */
+VectorEnv::VectorEnv(unsigned int count, unsigned int seed)
+		:	observations(count * PacmanEnv::OBSERVATION_SIZE), rewards(count), dones(count)
+{
+	observationData = observations.empty() ? 0 : &observations[ 0 ];
+	rewardData = rewards.empty() ? 0 : &rewards[ 0 ];
+	doneData = dones.empty() ? 0 : &dones[ 0 ];
+	for (unsigned int index = 0; index < count; ++index) {
+		envs.push_back(new PacmanEnv());
+	}
+	reset(seed);
+}
+
+
+/**
+  * Aufraeumarbeiten.
+  */
+VectorEnv::~VectorEnv() {
+	for (std::vector<PacmanEnv*>::iterator iter = envs.begin(); iter != envs.end(); ++iter) {
+		delete *iter;
+	}
+}
+
+
+/**
+  * Alle Umgebungen mit aufeinanderfolgenden Startwerten neu beginnen.
+  * @param seed Startwert der ersten Umgebung.
+  */
+void VectorEnv::reset(unsigned int seed) {
+	nextSeed = seed;
+	for (unsigned int index = 0; index < envs.size(); ++index) {
+		envs[ index ]->reset(nextSeed++, observationData + index * PacmanEnv::OBSERVATION_SIZE);
+	}
+	std::fill(rewardData, rewardData + envs.size(), 0.0f);
+	std::fill(doneData, doneData + envs.size(), 0);
+}
+
+
+/**
+  * Alle Umgebungen einen Schritt machen lassen. Beendete Spiele werden
+  * sofort mit dem naechsten Startwert neu begonnen.
+  * @param actions Eine Aktion je Umgebung.
+  */
+void VectorEnv::step(const unsigned char* actions) {
+	for (unsigned int index = 0; index < envs.size(); ++index) {
+		unsigned char* observation = observationData + index * PacmanEnv::OBSERVATION_SIZE;
+		bool done;
+		envs[ index ]->step(actions[ index ], observation, rewardData[ index ], done);
+		doneData[ index ] = done ? 1 : 0;
+		if (done) {
+			envs[ index ]->reset(nextSeed++, observation);
+		}
+	}
+}
+
+
+/**
+  * Die Umgebungen kuenftig in Puffer ausserhalb schreiben lassen.
+  * @param observations Platz fuer getCount() * PacmanEnv::OBSERVATION_SIZE Bytes.
+  * @param rewards      Platz fuer getCount() Belohnungen.
+  * @param dones        Platz fuer getCount() Enden.
+  */
+void VectorEnv::attachBuffers(unsigned char* observations, float* rewards, unsigned char* dones) {
+	std::copy(observationData, observationData + envs.size() * PacmanEnv::OBSERVATION_SIZE, observations);
+	std::copy(rewardData, rewardData + envs.size(), rewards);
+	std::copy(doneData, doneData + envs.size(), dones);
+	observationData = observations;
+	rewardData = rewards;
+	doneData = dones;
+}
+
+
+/**
+  * Anzahl Umgebungen auslesen.
+  * @return Anzahl Umgebungen.
+  */
+unsigned int VectorEnv::getCount() const {
+	return envs.size();
+}
+
+
+/**
+  * Beobachtungen aller Umgebungen auslesen.
+  * @return getCount() * PacmanEnv::OBSERVATION_SIZE Bytes.
+  */
+const unsigned char* VectorEnv::getObservations() const {
+	return observationData;
+}
+
+
+/**
+  * Belohnungen des letzten Schrittes auslesen.
+  * @return Eine Belohnung je Umgebung.
+  */
+const float* VectorEnv::getRewards() const {
+	return rewardData;
+}
+
+
+/**
+  * Enden des letzten Schrittes auslesen.
+  * @return 1 je Umgebung, deren Spiel im letzten Schritt endete, sonst 0.
+  */
+const unsigned char* VectorEnv::getDones() const {
+	return doneData;
+}
+
+
+/**
+  * Eine Umgebung auslesen.
+  * @param index Index der Umgebung.
+  * @return Umgebung.
+  */
+PacmanEnv& VectorEnv::getEnv(unsigned int index) {
+	return *envs[ index ];
+}
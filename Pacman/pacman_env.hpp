@@ -0,0 +1,217 @@
+#ifndef PACMAN_ENV_H
+#define PACMAN_ENV_H
+
+#include <vector>
+#include "field.hpp"
+#include "game_controller.hpp"
+#include "pacman_agent.hpp"
+
+/**
+  * Umgebung fuer Lernverfahren (Reinforcement Learning) ueber einem
+  * Spiel ohne Fenster. Ein Schritt ist eine Entscheidung von Pacman:
+  * step() spielt, bis Pacman mit der uebergebenen Aktion einen
+  * Schritt gemacht hat, und liefert Beobachtung, Belohnung und Ende.
+  *
+  * Die Beobachtung ist ein Byte je Zelle (zeilenweise wie MazeGrid):
+  * Bits 0-3 sind die begehbaren Richtungen, dazu die Bits OBS_*.
+  * Harmlose Geister gelten wie Pillen als fressbar.
+  */
+class PacmanEnv: public PacmanAgent {
+public:
+	// Groesse einer Beobachtung in Bytes
+	static const unsigned int OBSERVATION_SIZE = Field::FIELD_WIDTH * Field::FIELD_HEIGHT;
+
+	// Bits einer Zelle der Beobachtung
+	enum { OBS_FOOD = 0x10, OBS_ITEM = 0x20, OBS_PACMAN = 0x40, OBS_GHOST = 0x80 };
+
+	// Aktionen 0-3 sind die Bitpositionen der Richtungen, NO_ACTION
+	// behaelt die bisherige Richtung bei.
+	static const unsigned int NO_ACTION = 4;
+
+	// Abzug von der Belohnung je verlorenem Leben
+	static const int LIFE_PENALTY = 500;
+
+private:
+	// Unveraenderter Spielbeginn, von dem jede Episode kopiert wird,
+	// und das Spiel der laufenden Episode
+	Field start;
+	Field field;
+
+	// Richtung fuer Pacmans naechsten Schritt und Kennzeichen, dass
+	// er sie im laufenden step() abgeholt hat
+	Direction action;
+	bool decided;
+
+	// Begehbare Richtungen und Essen je Zelle, nachgefuehrt, damit
+	// nicht bei jedem Schritt alle Zellen gelesen werden
+	std::vector<unsigned char> board;
+	unsigned int boardLevel;
+	unsigned int boardFood;
+
+	// Sammelt die Zellen der Pillen und Kirschen
+	std::vector<unsigned int> items;
+
+	/**
+	  * Labyrinth und Essen aller Zellen neu einlesen.
+	  * @param view Sicht auf das Spiel.
+	  */
+	void rebuildBoard(const GameView& view);
+
+	// Nicht kopierbar
+	PacmanEnv(const PacmanEnv&);
+	PacmanEnv& operator=(const PacmanEnv&);
+
+public:
+	/**
+	  * Umgebung mit einem Spiel zum Startwert GameController::DEFAULT_SEED
+	  * erzeugen.
+	  */
+	PacmanEnv();
+
+	/**
+	  * Ein neues Spiel beginnen.
+	  * @param seed        Startwert des Zufallsgenerators des Spiels.
+	  * @param observation Erhaelt OBSERVATION_SIZE Bytes oder 0.
+	  */
+	void reset(unsigned int seed, unsigned char* observation = 0);
+
+	/**
+	  * Makroschritte ein- oder ausschalten: Ein Schritt ist dann ein
+	  * ganzer Korridor bis zur naechsten Kreuzung, Pacman entscheidet
+	  * nur noch an Kreuzungen (siehe GameController::setCorridorSteps()).
+	  * Gilt ab sofort und fuer alle folgenden Episoden.
+	  * @param enabled <code>true</code> zum Einschalten.
+	  */
+	void setCorridorSteps(bool enabled);
+
+	/**
+	  * Bis zum naechsten Schritt von Pacman spielen.
+	  * @param action      Aktion (Bitposition der Richtung oder NO_ACTION).
+	  * @param observation Erhaelt OBSERVATION_SIZE Bytes oder 0.
+	  * @param reward      Erhaelt den Zuwachs der Punkte abzueglich
+	  *                    LIFE_PENALTY je verlorenem Leben.
+	  * @param done        Erhaelt <code>true</code>, wenn das Spiel vorbei ist.
+	  */
+	void step(unsigned int action, unsigned char* observation, float& reward, bool& done);
+
+	/**
+	  * Beobachtung des aktuellen Spielstandes schreiben.
+	  * @param observation Erhaelt OBSERVATION_SIZE Bytes.
+	  */
+	void observe(unsigned char* observation);
+
+	/**
+	  * Spiel der laufenden Episode auslesen.
+	  * @return Spielfeld.
+	  */
+	Field& getField();
+
+	/**
+	  * Vom Controller gerufen, wenn Pacman einen Schritt macht: liefert
+	  * die Aktion des laufenden step().
+	  * @param view Nur lesende Sicht auf den Spielstand.
+	  * @return Gewuenschte Richtung.
+	  */
+	virtual Direction decide(const GameView& view);
+};
+
+/**
+  * Mehrere unabhaengige Umgebungen, die in einem Aufruf gemeinsam
+  * einen Schritt machen. Beobachtungen, Belohnungen und Enden liegen
+  * in vorab angelegten, zusammenhaengenden Puffern, die Beobachtung
+  * der Umgebung i beginnt bei i * PacmanEnv::OBSERVATION_SIZE. Ist ein
+  * Spiel vorbei, beginnt die Umgebung sofort ein neues mit dem
+  * naechsten Startwert, die Beobachtung ist dann dessen erste. Die
+  * Puffer koennen auch ausserhalb liegen, z.B. in gemeinsamem
+  * Speicher mit einem anderen Prozess (siehe attachBuffers()).
+  */
+class VectorEnv {
+	// Die Umgebungen
+	std::vector<PacmanEnv*> envs;
+
+	// Eigene Puffer fuer Beobachtungen, Belohnungen und Enden
+	std::vector<unsigned char> observations;
+	std::vector<float> rewards;
+	std::vector<unsigned char> dones;
+
+	// Benutzte Puffer, die eigenen oder angehaengte
+	unsigned char* observationData;
+	float* rewardData;
+	unsigned char* doneData;
+
+	// Startwert des naechsten neu begonnenen Spiels
+	unsigned int nextSeed;
+
+	// Nicht kopierbar
+	VectorEnv(const VectorEnv&);
+	VectorEnv& operator=(const VectorEnv&);
+
+public:
+	/**
+	  * Umgebungen erzeugen und mit aufeinanderfolgenden Startwerten
+	  * beginnen.
+	  * @param count Anzahl Umgebungen.
+	  * @param seed  Startwert der ersten Umgebung.
+	  */
+	VectorEnv(unsigned int count, unsigned int seed = GameController::DEFAULT_SEED);
+
+	/**
+	  * Aufraeumarbeiten.
+	  */
+	~VectorEnv();
+
+	/**
+	  * Alle Umgebungen mit aufeinanderfolgenden Startwerten neu beginnen.
+	  * @param seed Startwert der ersten Umgebung.
+	  */
+	void reset(unsigned int seed);
+
+	/**
+	  * Alle Umgebungen einen Schritt machen lassen.
+	  * @param actions Eine Aktion je Umgebung (siehe PacmanEnv::step()).
+	  */
+	void step(const unsigned char* actions);
+
+	/**
+	  * Die Umgebungen kuenftig in Puffer ausserhalb schreiben lassen.
+	  * Der aktuelle Inhalt wird dorthin kopiert. Die Puffer gehoeren
+	  * nicht der Umgebung und muessen laenger leben.
+	  * @param observations Platz fuer getCount() * PacmanEnv::OBSERVATION_SIZE Bytes.
+	  * @param rewards      Platz fuer getCount() Belohnungen.
+	  * @param dones        Platz fuer getCount() Enden.
+	  */
+	void attachBuffers(unsigned char* observations, float* rewards, unsigned char* dones);
+
+	/**
+	  * Anzahl Umgebungen auslesen.
+	  * @return Anzahl Umgebungen.
+	  */
+	unsigned int getCount() const;
+
+	/**
+	  * Beobachtungen aller Umgebungen auslesen.
+	  * @return getCount() * PacmanEnv::OBSERVATION_SIZE Bytes.
+	  */
+	const unsigned char* getObservations() const;
+
+	/**
+	  * Belohnungen des letzten Schrittes auslesen.
+	  * @return Eine Belohnung je Umgebung.
+	  */
+	const float* getRewards() const;
+
+	/**
+	  * Enden des letzten Schrittes auslesen.
+	  * @return 1 je Umgebung, deren Spiel im letzten Schritt endete, sonst 0.
+	  */
+	const unsigned char* getDones() const;
+
+	/**
+	  * Eine Umgebung auslesen.
+	  * @param index Index der Umgebung.
+	  * @return Umgebung.
+	  */
+	PacmanEnv& getEnv(unsigned int index);
+};
+
+#endif // PACMAN_ENV_H
@@ -3,73 +3,111 @@
 #include <boost/lexical_cast.hpp>
 using namespace std;
 
-PacmanWindow::PacmanWindow() 
+PacmanWindow::PacmanWindow(LockstepPeer* peer, unsigned int turnBuffer, bool verifyHash) 
 			:	Gosu::Window(800, 600, false), 
 				font(graphics(), Gosu::defaultFontName(), 20)
 {
-	this->field = new Field();
+	this->peer = peer;
+	this->field = peer != 0 ? &peer->getField() : new Field();
+	this->agent = 0;
+	this->verifyHash = verifyHash;
+	if (peer == 0) {
+		this->field->setTurnBuffer(turnBuffer);
+	}
+	this->field->setHashVerification(verifyHash);
+	this->simulation = new SimulationThread(*this->field, peer);
+	this->simulation->start();
 }
 
 PacmanWindow::~PacmanWindow() {
-
+	this->simulation->stop();
+	this->simulation->reportInput(cout);
+	if (this->verifyHash) {
+		cout << "hash mismatches: " << this->field->getHashMismatches() << endl;
+	}
+	delete this->simulation;
+	if (this->peer == 0) {
+		// Ohne Partner gehoert das Spielfeld dem Fenster
+		delete this->field;
+	}
 }
 
 void PacmanWindow::draw()
 {
-	if(this->field->getState() == Playing)
+	// Nur der neueste fertige Stand wird gezeichnet, das laufende Spiel
+	// gehoert dem Thread der Simulation.
+	RenderSnapshot& snapshot = this->simulation->getSnapshot();
+	Field& field = snapshot.field;
+	double tickFraction = this->simulation->getTickFraction(snapshot);
+
+	if(field.getState() == Playing)
 	{
-		this->field->draw(graphics());
-		this->font.draw(L"Points: " + boost::lexical_cast<std::wstring>(this->field->getPoints()), 600, 3, 100);
-		this->font.draw(L"Lives: " + boost::lexical_cast<std::wstring>(this->field->getLives()), 600, 16, 100);
+		field.draw(graphics(), tickFraction);
+		this->font.draw(L"Points: " + boost::lexical_cast<std::wstring>(field.getPoints()), 600, 3, 100);
+		this->font.draw(L"Lives: " + boost::lexical_cast<std::wstring>(field.getLives()), 600, 16, 100);
+		if (snapshot.agent == &this->greedyAgent) {
+			this->font.draw(L"Bot: greedy", 600, 29, 100);
+		}
+		else if (snapshot.agent == &this->avoidingAgent) {
+			this->font.draw(L"Bot: avoiding", 600, 29, 100);
+		}
+		else if (snapshot.agent == &this->mctsAgent) {
+			this->font.draw(L"Bot: MCTS " + boost::lexical_cast<std::wstring>(snapshot.rolloutsPerSecond) + L"/s", 600, 29, 100);
+		}
+		if (this->peer != 0) {
+			this->font.draw(this->peer->getRole() == LockstepPeer::PacmanRole ? L"You: Pacman" : L"You: Ghost", 600, 29, 100);
+			if (snapshot.peerStatus == LockstepPeer::Desynced) {
+				this->font.draw(L"Desync!", 600, 42, 100);
+			}
+			else if (snapshot.peerStatus == LockstepPeer::Disconnected) {
+				this->font.draw(L"Disconnected", 600, 42, 100);
+			}
+		}
 	}
-	else if(this->field->getState() == Starting)
+	else if(field.getState() == Starting)
 	{
-		this->field->draw(graphics());
+		field.draw(graphics(), tickFraction);
 		this->font.draw(L"READY!", 265, 350, 100);
 	}
-	else if(this->field->getState() == LevelOver)
+	else if(field.getState() == LevelOver)
 	{
-		this->field->draw(graphics());
+		field.draw(graphics(), tickFraction);
 		this->font.draw(L"Level Over!", 265, 350, 100);
 	}
-	else if(this->field->getState() == GameOver)
+	else if(field.getState() == GameOver)
 	{
 		this->font.draw(L"Game Over", 265, 350, 100);
 	}
 }
 
-void PacmanWindow::update()
+Direction PacmanWindow::directionOf(Gosu::Button button)
 {
-	// Ticking
-	this->field->nextTick();
-
-	if (this->field->getState() == Playing) {
-		Direction keyDirection = Direction::NONE;
-
-		if(input().down(Gosu::kbUp))
-		{
-			keyDirection = Direction::UP; 
-		}
-
-		if(input().down(Gosu::kbDown))
-		{
-			keyDirection = Direction::DOWN; 
-		}
+	if(button == Gosu::kbUp)
+	{
+		return Direction::UP; 
+	}
 
-		if(input().down(Gosu::kbLeft))
-		{
-			keyDirection = Direction::LEFT; 
-		}
+	if(button == Gosu::kbDown)
+	{
+		return Direction::DOWN; 
+	}
 
-		if(input().down(Gosu::kbRight))
-		{
-			keyDirection = Direction::RIGHT; 
-		}
+	if(button == Gosu::kbLeft)
+	{
+		return Direction::LEFT; 
+	}
 
-		if (keyDirection != Direction::NONE) {
-			this->field->keyPressed(keyDirection);
-		}
+	if(button == Gosu::kbRight)
+	{
+		return Direction::RIGHT; 
 	}
+	return Direction::NONE;
+}
+
+void PacmanWindow::update()
+{
+	// Getickt wird im Thread der Simulation, Tasten kommen als
+	// Ereignisse aus buttonDown() und buttonUp().
 }
 
 void PacmanWindow::buttonDown(Gosu::Button button)
@@ -77,6 +115,32 @@ void PacmanWindow::buttonDown(Gosu::Button button)
 	if(button == Gosu::kbEscape)
 		close();
 
+	// Pfeiltasten mit Zeitstempel an die Simulation, sie wendet sie im
+	// Takt ihres Zeitpunktes an.
+	Direction direction = directionOf(button);
+	if (direction != Direction::NONE) {
+		this->simulation->pushInput(direction, true);
+	}
+
+	// Automatischen Spieler umschalten: keiner, gierig, vorsichtig, Suche
+	// (nicht im Spiel gegeneinander, beide Seiten muessen gleich rechnen)
+	if(button == Gosu::kbB && this->peer == 0)
+	{
+		if (this->agent == 0) {
+			this->agent = &this->greedyAgent;
+		}
+		else if (this->agent == &this->greedyAgent) {
+			this->agent = &this->avoidingAgent;
+		}
+		else if (this->agent == &this->avoidingAgent) {
+			this->agent = &this->mctsAgent;
+		}
+		else {
+			this->agent = 0;
+		}
+		this->simulation->setPacmanAgent(this->agent);
+	}
+
 
 	// Input handling
 	/*if (!this->field->isGameOver()) {
@@ -106,4 +170,12 @@ void PacmanWindow::buttonDown(Gosu::Button button)
 			this->field->keyPressed(keyDirection);
 		}
 	}*/
-}
\ No newline at end of file
+}
+
+void PacmanWindow::buttonUp(Gosu::Button button)
+{
+	Direction direction = directionOf(button);
+	if (direction != Direction::NONE) {
+		this->simulation->pushInput(direction, false);
+	}
+}
@@ -4,6 +4,11 @@
 #include <Gosu/Gosu.hpp>
 #include "field.hpp"
 #include "game_controller.hpp"
+#include "lockstep_peer.hpp"
+#include "mcts_agent.hpp"
+#include "pacman.hpp"
+#include "pacman_agent.hpp"
+#include "simulation_thread.hpp"
 
 class PacmanWindow : public Gosu::Window
 {
@@ -17,8 +22,49 @@ class PacmanWindow : public Gosu::Window
 
 	int count;
 
+	// Eingebaute automatische Spieler, umschaltbar per Taste B
+	GreedyFoodAgent greedyAgent;
+	GhostAvoidingAgent avoidingAgent;
+	MctsAgent mctsAgent;
+
+	// Aktiver Spieler oder 0 fuer die Steuerung per Tastatur
+	PacmanAgent* agent;
+
+	// Verbundener Partner im Spiel gegeneinander oder 0
+	LockstepPeer* peer;
+
+	// Rechnet das Spiel, gezeichnet wird sein neuester Stand
+	SimulationThread* simulation;
+
+	// Wird der nachgefuehrte Hash in jedem Takt geprueft?
+	bool verifyHash;
+
+	void buttonUp(Gosu::Button button);
+
+	/**
+	  * Richtung einer Pfeiltaste.
+	  * @param button Taste.
+	  * @return Richtung, NONE fuer andere Tasten.
+	  */
+	static Direction directionOf(Gosu::Button button);
+
 public:
-	PacmanWindow();
+	/**
+	  * Fenster erzeugen.
+	  * @param peer       Verbundener Partner, dessen Spiel gezeigt und
+	  *                   mit der Tastatur gesteuert wird, oder 0 fuer ein
+	  *                   Spiel allein.
+	  * @param turnBuffer Gueltigkeit einer vorgemerkten Richtung in
+	  *                   Takten im Spiel allein (siehe
+	  *                   Field::setTurnBuffer()).
+	  * @param verifyHash <code>true</code>, um den nachgefuehrten Hash
+	  *                   in jedem Takt mit einer vollstaendigen
+	  *                   Berechnung zu vergleichen (siehe
+	  *                   Field::setHashVerification()). Die Anzahl der
+	  *                   Abweichungen wird beim Schliessen ausgegeben.
+	  */
+	PacmanWindow(LockstepPeer* peer = 0, unsigned int turnBuffer = Pacman::TURN_BUFFER_TICKS,
+				 bool verifyHash = false);
 	~PacmanWindow();
 
 	/**
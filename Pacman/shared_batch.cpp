@@ -0,0 +1,244 @@
+#include "shared_batch.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+#include <boost/thread/thread.hpp>
+
+namespace {
+/**
+  * Abstand auf ein Vielfaches von 64 Bytes (eine Cache-Zeile) runden.
+  * @param offset Abstand in Bytes.
+  * @return Aufgerundeter Abstand.
+  */
+boost::uint32_t alignLine(boost::uint32_t offset) {
+	return (offset + 63) & ~63u;
+}
+}
+
+
+/**
+  * Abfragen vor dem Abgeben der CPU auf diesem Rechner bestimmen. Mit
+  * nur einem Kern kann die Gegenseite waehrenddessen nicht laufen.
+  * @return SPIN_LIMIT, mit nur einem Kern 0.
+  */
+unsigned int SharedBatchServer::getSpinLimit() {
+	return boost::thread::hardware_concurrency() > 1 ? SPIN_LIMIT : 0;
+}
+
+
+/**
+  * Warten, bis eine Folgenummer der Gegenseite einen Wert erreicht.
+  * Zuerst wird nur abgefragt, damit ein schneller Partner ohne
+  * Umweg ueber das Betriebssystem bedient wird, danach wird zwischen
+  * den Abfragen die CPU abgegeben.
+  * @param header    Kopf des gemeinsamen Speichers.
+  * @param sequence  Folgenummer der Gegenseite.
+  * @param value     Erwarteter Wert.
+  * @param spinLimit Abfragen vor dem Abgeben der CPU (getSpinLimit()).
+  * @return <code>false</code>, wenn die Verbindung beendet wurde.
+  */
+bool SharedBatchServer::waitFor(SharedBatchHeader* header, const boost::atomic<boost::uint32_t>& sequence,
+								boost::uint32_t value, unsigned int spinLimit) {
+	for (unsigned int spins = 0; sequence.load(boost::memory_order_acquire) != value; ++spins) {
+		if (header->closed.load(boost::memory_order_acquire) != 0) {
+			return false;
+		}
+		if (spins >= spinLimit) {
+			boost::this_thread::yield();
+		}
+	}
+	return true;
+}
+
+
+/**
+  * Gemeinsamen Speicher anlegen, die Spiele beginnen und den ersten
+  * Stand veroeffentlichen.
+  * @param name  Name des gemeinsamen Speichers.
+  * @param count Anzahl Spiele.
+  * @param seed  Startwert des ersten Spiels.
+  */
+SharedBatchServer::SharedBatchServer(const std::string& name, unsigned int count, unsigned int seed)
+		:	name(name), spinLimit(getSpinLimit()), envs(count, seed)
+{
+	using namespace boost::interprocess;
+
+	boost::uint32_t actionOffset = alignLine(sizeof(SharedBatchHeader));
+	boost::uint32_t rewardOffset = alignLine(actionOffset + count);
+	boost::uint32_t doneOffset = alignLine(rewardOffset + count * sizeof(float));
+	boost::uint32_t observationOffset = alignLine(doneOffset + count);
+	boost::uint32_t size = observationOffset + count * PacmanEnv::OBSERVATION_SIZE;
+
+	shared_memory_object::remove(name.c_str());
+	shared_memory_object created(create_only, name.c_str(), read_write);
+	created.truncate(size);
+	memory.swap(created);
+	mapped_region mapped(memory, read_write);
+	region.swap(mapped);
+
+	char* base = static_cast<char*>(region.get_address());
+	header = new (base) SharedBatchHeader();
+	header->count = count;
+	header->observationSize = PacmanEnv::OBSERVATION_SIZE;
+	header->actionOffset = actionOffset;
+	header->rewardOffset = rewardOffset;
+	header->doneOffset = doneOffset;
+	header->observationOffset = observationOffset;
+	header->closed.store(0, boost::memory_order_relaxed);
+	header->actionSequence.store(0, boost::memory_order_relaxed);
+
+	envs.attachBuffers(reinterpret_cast<unsigned char*>(base + observationOffset),
+					   reinterpret_cast<float*>(base + rewardOffset),
+					   reinterpret_cast<unsigned char*>(base + doneOffset));
+	std::fill(base + actionOffset, base + actionOffset + count, (char) PacmanEnv::NO_ACTION);
+
+	header->magic = SharedBatchHeader::MAGIC;
+	header->stateSequence.store(1, boost::memory_order_release);
+}
+
+
+/**
+  * Verbindung beenden und den gemeinsamen Speicher entfernen. Ein
+  * noch verbundener Client behaelt seine Abbildung, bis er sie loest.
+  */
+SharedBatchServer::~SharedBatchServer() {
+	header->closed.store(1, boost::memory_order_release);
+	boost::interprocess::shared_memory_object::remove(name.c_str());
+}
+
+
+/**
+  * Auf die Aktionen zum letzten Stand warten, alle Spiele einen
+  * Schritt machen lassen und den neuen Stand veroeffentlichen. Die
+  * Spiele lesen die Aktionen direkt aus dem gemeinsamen Speicher.
+  * @return <code>false</code>, wenn der Client die Verbindung beendet hat.
+  */
+bool SharedBatchServer::step() {
+	boost::uint32_t sequence = header->stateSequence.load(boost::memory_order_relaxed);
+	if (!waitFor(header, header->actionSequence, sequence, spinLimit)) {
+		return false;
+	}
+	envs.step(static_cast<unsigned char*>(region.get_address()) + header->actionOffset);
+	header->stateSequence.store(sequence + 1, boost::memory_order_release);
+	return true;
+}
+
+
+/**
+  * Schritte machen, bis der Client die Verbindung beendet.
+  */
+void SharedBatchServer::serve() {
+	while (step()) {
+	}
+}
+
+
+/**
+  * Die Spiele auslesen.
+  * @return Umgebungen.
+  */
+VectorEnv& SharedBatchServer::getEnvs() {
+	return envs;
+}
+
+
+/**
+  * Mit einem laufenden Server verbinden.
+  * @param name Name des gemeinsamen Speichers.
+  */
+SharedBatchClient::SharedBatchClient(const std::string& name) {
+	using namespace boost::interprocess;
+
+	shared_memory_object opened(open_only, name.c_str(), read_write);
+	memory.swap(opened);
+	mapped_region mapped(memory, read_write);
+	region.swap(mapped);
+
+	header = static_cast<SharedBatchHeader*>(region.get_address());
+	sequence = 0;
+	spinLimit = SharedBatchServer::getSpinLimit();
+}
+
+
+/**
+  * Verbindung beenden.
+  */
+SharedBatchClient::~SharedBatchClient() {
+	close();
+}
+
+
+/**
+  * Auf einen neuen Stand warten.
+  * @return <code>false</code>, wenn der Server die Verbindung beendet hat.
+  */
+bool SharedBatchClient::waitForState() {
+	if (!SharedBatchServer::waitFor(header, header->stateSequence, sequence + 1, spinLimit)) {
+		return false;
+	}
+	++sequence;
+	assert(header->magic == SharedBatchHeader::MAGIC);
+	return true;
+}
+
+
+/**
+  * Die in getActions() eingetragenen Aktionen an den Server geben.
+  */
+void SharedBatchClient::sendActions() {
+	header->actionSequence.store(sequence, boost::memory_order_release);
+}
+
+
+/**
+  * Verbindung beenden.
+  */
+void SharedBatchClient::close() {
+	header->closed.store(1, boost::memory_order_release);
+}
+
+
+/**
+  * Anzahl Spiele auslesen.
+  * @return Anzahl Spiele.
+  */
+unsigned int SharedBatchClient::getCount() const {
+	return header->count;
+}
+
+
+/**
+  * Beobachtungen des aktuellen Standes auslesen.
+  * @return getCount() * PacmanEnv::OBSERVATION_SIZE Bytes.
+  */
+const unsigned char* SharedBatchClient::getObservations() const {
+	return static_cast<const unsigned char*>(region.get_address()) + header->observationOffset;
+}
+
+
+/**
+  * Belohnungen des aktuellen Standes auslesen.
+  * @return Eine Belohnung je Spiel.
+  */
+const float* SharedBatchClient::getRewards() const {
+	return reinterpret_cast<const float*>(static_cast<const char*>(region.get_address()) + header->rewardOffset);
+}
+
+
+/**
+  * Enden des aktuellen Standes auslesen.
+  * @return 1 je Spiel, das im letzten Schritt endete, sonst 0.
+  */
+const unsigned char* SharedBatchClient::getDones() const {
+	return static_cast<const unsigned char*>(region.get_address()) + header->doneOffset;
+}
+
+
+/**
+  * Platz fuer die Aktionen zum aktuellen Stand.
+  * @return Eine Aktion je Spiel.
+  */
+unsigned char* SharedBatchClient::getActions() {
+	return static_cast<unsigned char*>(region.get_address()) + header->actionOffset;
+}
@@ -0,0 +1,213 @@
+#ifndef SHARED_BATCH_H
+#define SHARED_BATCH_H
+
+#include <string>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include "pacman_env.hpp"
+
+/**
+  * Kopf des gemeinsamen Speichers zwischen SharedBatchServer und
+  * SharedBatchClient. Dahinter folgen, je auf 64 Bytes ausgerichtet,
+  * die Aktionen, Belohnungen, Enden und Beobachtungen aller Spiele.
+  *
+  * Abgeglichen wird ueber zwei Folgenummern: Der Server erhoeht
+  * 'stateSequence', sobald ein neuer Stand vollstaendig im Speicher
+  * liegt. Der Client setzt 'actionSequence' auf denselben Wert, sobald
+  * er die Aktionen dazu geschrieben hat. Jede Seite schreibt nur ihre
+  * eigene Nummer, die Nummern liegen in getrennten Cache-Zeilen.
+  */
+struct SharedBatchHeader {
+	// Kennung und Version der Aufteilung
+	static const boost::uint32_t MAGIC = 0x50414331;
+
+	boost::uint32_t magic;
+
+	// Anzahl Spiele und Bytes je Beobachtung
+	boost::uint32_t count;
+	boost::uint32_t observationSize;
+
+	// Abstaende der Bereiche vom Anfang des Speichers in Bytes
+	boost::uint32_t actionOffset;
+	boost::uint32_t rewardOffset;
+	boost::uint32_t doneOffset;
+	boost::uint32_t observationOffset;
+
+	// Gesetzt, sobald eine Seite die Verbindung beendet
+	boost::atomic<boost::uint32_t> closed;
+
+	// Nummer des letzten vom Server veroeffentlichten Standes
+	char padding1[ 64 ];
+	boost::atomic<boost::uint32_t> stateSequence;
+
+	// Nummer des Standes, zu dem der Client zuletzt Aktionen schrieb
+	char padding2[ 64 ];
+	boost::atomic<boost::uint32_t> actionSequence;
+	char padding3[ 64 ];
+};
+
+/**
+  * Spiele ohne Fenster fuer einen Trainingsprozess auf demselben
+  * Rechner: Eine VectorEnv schreibt Beobachtungen, Belohnungen und
+  * Enden direkt in gemeinsamen Speicher und liest die Aktionen von
+  * dort, ohne Serialisierung und ohne Kopie. Der andere Prozess
+  * benutzt SharedBatchClient oder bildet dessen Protokoll nach.
+  */
+class SharedBatchServer {
+public:
+	// So oft wird die Folgenummer der Gegenseite abgefragt, bevor der
+	// Thread zwischen den Abfragen die CPU abgibt. Auf Rechnern mit
+	// nur einem Kern wird sie sofort abgegeben.
+	static const unsigned int SPIN_LIMIT = 4000;
+
+	/**
+	  * Abfragen vor dem Abgeben der CPU auf diesem Rechner bestimmen.
+	  * @return SPIN_LIMIT, mit nur einem Kern 0.
+	  */
+	static unsigned int getSpinLimit();
+
+	/**
+	  * Warten, bis eine Folgenummer der Gegenseite einen Wert erreicht.
+	  * @param header    Kopf des gemeinsamen Speichers.
+	  * @param sequence  Folgenummer der Gegenseite.
+	  * @param value     Erwarteter Wert.
+	  * @param spinLimit Abfragen vor dem Abgeben der CPU (getSpinLimit()).
+	  * @return <code>false</code>, wenn die Verbindung beendet wurde.
+	  */
+	static bool waitFor(SharedBatchHeader* header, const boost::atomic<boost::uint32_t>& sequence,
+						boost::uint32_t value, unsigned int spinLimit);
+
+private:
+	// Name und Abbildung des gemeinsamen Speichers
+	std::string name;
+	boost::interprocess::shared_memory_object memory;
+	boost::interprocess::mapped_region region;
+	SharedBatchHeader* header;
+
+	// Abfragen vor dem Abgeben der CPU, einmal im Konstruktor bestimmt
+	unsigned int spinLimit;
+
+	// Die Spiele, ihre Puffer liegen im gemeinsamen Speicher
+	VectorEnv envs;
+
+	// Nicht kopierbar
+	SharedBatchServer(const SharedBatchServer&);
+	SharedBatchServer& operator=(const SharedBatchServer&);
+
+public:
+	/**
+	  * Gemeinsamen Speicher anlegen, die Spiele beginnen und den ersten
+	  * Stand veroeffentlichen. Ein alter Speicher gleichen Namens wird
+	  * ersetzt.
+	  * @param name  Name des gemeinsamen Speichers.
+	  * @param count Anzahl Spiele.
+	  * @param seed  Startwert des ersten Spiels.
+	  */
+	SharedBatchServer(const std::string& name, unsigned int count,
+					  unsigned int seed = GameController::DEFAULT_SEED);
+
+	/**
+	  * Verbindung beenden und den gemeinsamen Speicher entfernen.
+	  */
+	~SharedBatchServer();
+
+	/**
+	  * Auf die Aktionen zum letzten Stand warten, alle Spiele einen
+	  * Schritt machen lassen und den neuen Stand veroeffentlichen.
+	  * @return <code>false</code>, wenn der Client die Verbindung beendet hat.
+	  */
+	bool step();
+
+	/**
+	  * Schritte machen, bis der Client die Verbindung beendet.
+	  */
+	void serve();
+
+	/**
+	  * Die Spiele auslesen.
+	  * @return Umgebungen.
+	  */
+	VectorEnv& getEnvs();
+};
+
+/**
+  * Gegenstueck zu SharedBatchServer im Trainingsprozess.
+  */
+class SharedBatchClient {
+	// Abbildung des gemeinsamen Speichers
+	boost::interprocess::shared_memory_object memory;
+	boost::interprocess::mapped_region region;
+	SharedBatchHeader* header;
+
+	// Nummer des zuletzt gelesenen Standes
+	boost::uint32_t sequence;
+
+	// Abfragen vor dem Abgeben der CPU, einmal im Konstruktor bestimmt
+	unsigned int spinLimit;
+
+	// Nicht kopierbar
+	SharedBatchClient(const SharedBatchClient&);
+	SharedBatchClient& operator=(const SharedBatchClient&);
+
+public:
+	/**
+	  * Mit einem laufenden Server verbinden.
+	  * @param name Name des gemeinsamen Speichers.
+	  */
+	SharedBatchClient(const std::string& name);
+
+	/**
+	  * Verbindung beenden.
+	  */
+	~SharedBatchClient();
+
+	/**
+	  * Auf einen neuen Stand warten.
+	  * @return <code>false</code>, wenn der Server die Verbindung beendet hat.
+	  */
+	bool waitForState();
+
+	/**
+	  * Die in getActions() eingetragenen Aktionen an den Server geben.
+	  */
+	void sendActions();
+
+	/**
+	  * Verbindung beenden, der Server kehrt aus serve() zurueck.
+	  */
+	void close();
+
+	/**
+	  * Anzahl Spiele auslesen.
+	  * @return Anzahl Spiele.
+	  */
+	unsigned int getCount() const;
+
+	/**
+	  * Beobachtungen des aktuellen Standes auslesen.
+	  * @return getCount() * PacmanEnv::OBSERVATION_SIZE Bytes.
+	  */
+	const unsigned char* getObservations() const;
+
+	/**
+	  * Belohnungen des aktuellen Standes auslesen.
+	  * @return Eine Belohnung je Spiel.
+	  */
+	const float* getRewards() const;
+
+	/**
+	  * Enden des aktuellen Standes auslesen.
+	  * @return 1 je Spiel, das im letzten Schritt endete, sonst 0.
+	  */
+	const unsigned char* getDones() const;
+
+	/**
+	  * Platz fuer die Aktionen zum aktuellen Stand.
+	  * @return Eine Aktion je Spiel (siehe PacmanEnv::step()).
+	  */
+	unsigned char* getActions();
+};
+
+#endif // SHARED_BATCH_H
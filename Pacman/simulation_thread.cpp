@@ -0,0 +1,269 @@
+#include "simulation_thread.hpp"
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "game_controller.hpp"
+#include "mcts_agent.hpp"
+
+
+/**
+  * Leeren Stand erzeugen.
+  */
+RenderSnapshot::RenderSnapshot()
+		:	tick(0), time(0), agent(0), rolloutsPerSecond(0), peerStatus(LockstepPeer::Connecting)
+{
+}
+
+
+/**
+  * Thread vorbereiten, alle Puffer erhalten den Anfangsstand.
+  * @param field Zu rechnendes Spiel.
+  * @param peer  Partner oder 0 fuer ein Spiel allein.
+  */
+SimulationThread::SimulationThread(Field& field, LockstepPeer* peer)
+		:	field(field), peer(peer), epoch(boost::posix_time::microsec_clock::universal_time()), droppedInputs(0),
+			requestedAgent(0), agent(0), tick(0), running(false)
+{
+	inputStatistics.presses = 0;
+	inputStatistics.totalMicroseconds = 0;
+	inputStatistics.maxMicroseconds = 0;
+	inputStatistics.dropped = 0;
+
+	// Im Spiel gegeneinander wuerden neu gerechnete Takte doppelt zaehlen.
+	if (peer == 0) {
+		field.setTurnStatistics(&turnStatistics);
+	}
+	for (unsigned int index = 0; index < 3; ++index) {
+		RenderSnapshot& snapshot = snapshots.getBuffer(index);
+		snapshot.field.copyStateFrom(field);
+		snapshot.peerStatus = peer != 0 ? peer->getStatus() : LockstepPeer::Connecting;
+	}
+}
+
+
+/**
+  * Thread anhalten.
+  */
+SimulationThread::~SimulationThread() {
+	stop();
+}
+
+
+/**
+  * Thread starten.
+  */
+void SimulationThread::start() {
+	if (running.exchange(true, boost::memory_order_acq_rel)) {
+		return;
+	}
+	thread = boost::thread(boost::bind(&SimulationThread::run, this));
+}
+
+
+/**
+  * Thread anhalten und auf sein Ende warten.
+  */
+void SimulationThread::stop() {
+	running.store(false, boost::memory_order_release);
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+
+/**
+  * Druck oder Loslassen einer Pfeiltaste einreihen. Bei voller Schlange
+  * wird das Ereignis nur gezaehlt.
+  * @param direction Richtung der Taste.
+  * @param pressed   <code>true</code> beim Druecken.
+  */
+void SimulationThread::pushInput(Direction direction, bool pressed) {
+	InputEvent event;
+	event.time = sinceEpoch(boost::posix_time::microsec_clock::universal_time());
+	event.direction = (unsigned char)direction.getValue();
+	event.pressed = pressed;
+	if (!inputs.push(event)) {
+		droppedInputs.fetch_add(1, boost::memory_order_relaxed);
+	}
+}
+
+
+/**
+  * Automatischen Spieler umschalten.
+  * @param agent Spieler oder 0.
+  */
+void SimulationThread::setPacmanAgent(PacmanAgent* agent) {
+	requestedAgent.store(agent, boost::memory_order_release);
+}
+
+
+/**
+  * Neuesten Stand zum Zeichnen holen.
+  * @return Stand.
+  */
+RenderSnapshot& SimulationThread::getSnapshot() {
+	return snapshots.getFront();
+}
+
+
+/**
+  * Seit dem Takt eines Standes vergangener Anteil eines Taktes. Ist der
+  * naechste Stand ueberfaellig, bleibt es bei einem ganzen Takt.
+  * @param snapshot Gezeichneter Stand.
+  * @return Anteil zwischen 0 und 1.
+  */
+double SimulationThread::getTickFraction(const RenderSnapshot& snapshot) const {
+	boost::int64_t elapsed = sinceEpoch(boost::posix_time::microsec_clock::universal_time()) - snapshot.time;
+	double fraction = double(elapsed) * TICKS_PER_SECOND / 1000000.0;
+	return fraction < 0.0 ? 0.0 : (fraction > 1.0 ? 1.0 : fraction);
+}
+
+
+/**
+  * Verzoegerung der Tasten auslesen.
+  * @return Zaehler.
+  */
+const SimulationThread::InputStatistics& SimulationThread::getInputStatistics() const {
+	return inputStatistics;
+}
+
+
+/**
+  * Verteilung der Verzoegerung bis zum Abbiegen auslesen.
+  * @return Verteilung.
+  */
+const TurnStatistics& SimulationThread::getTurnStatistics() const {
+	return turnStatistics;
+}
+
+
+/**
+  * Verzoegerung der Tasten bis zum Takt und bis zum Abbiegen schreiben.
+  * @param out Ausgabe.
+  */
+void SimulationThread::reportInput(std::ostream& out) const {
+	out << "input: " << inputStatistics.presses << " presses, mean "
+		<< (inputStatistics.presses > 0 ? inputStatistics.totalMicroseconds / inputStatistics.presses : 0)
+		<< " us, max " << inputStatistics.maxMicroseconds << " us to the applying tick, "
+		<< inputStatistics.dropped << " dropped" << std::endl;
+	if (peer == 0) {
+		turnStatistics.report(out);
+	}
+}
+
+
+/**
+  * Mikrosekunden seit dem Erzeugen des Threads.
+  * @param time Zeitpunkt.
+  * @return Mikrosekunden.
+  */
+boost::int64_t SimulationThread::sinceEpoch(const boost::posix_time::ptime& time) const {
+	return (time - epoch).total_microseconds();
+}
+
+
+/**
+  * Takte im festen Raster ausfuehren. Liegt der Thread mehr als eine
+  * Sekunde zurueck (z.B. nach dem Warten auf den Partner), wird das
+  * Raster neu angesetzt, statt die Takte nachzuholen.
+  */
+void SimulationThread::run() {
+	boost::posix_time::ptime nextTick = boost::posix_time::microsec_clock::universal_time();
+	while (running.load(boost::memory_order_acquire)) {
+		boost::int64_t tickTime = sinceEpoch(nextTick);
+		step(tickTime);
+		publish(tickTime);
+
+		nextTick += boost::posix_time::microseconds(1000000 / TICKS_PER_SECOND);
+		boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+		if (nextTick + boost::posix_time::seconds(1) < now) {
+			nextTick = now;
+		}
+		if (now < nextTick) {
+			boost::this_thread::sleep(nextTick);
+		}
+	}
+	inputStatistics.dropped = droppedInputs.load(boost::memory_order_relaxed);
+}
+
+
+/**
+  * Tastenereignisse bis zum Zeitpunkt eines Taktes uebernehmen. Spaetere
+  * bleiben fuer ihren Takt in der Schlange.
+  * @param tickTime Zeitpunkt des Taktes.
+  * @return Anzuwendende Richtung.
+  */
+Direction SimulationThread::drainInputs(boost::int64_t tickTime) {
+	Direction tapped = Direction::NONE;
+	boost::int64_t now = -1;
+	const InputEvent* event;
+	while ((event = inputs.front()) != 0 && event->time <= tickTime) {
+		heldDirections.erase(std::remove(heldDirections.begin(), heldDirections.end(), event->direction),
+							 heldDirections.end());
+		if (event->pressed) {
+			heldDirections.push_back(event->direction);
+			tapped = event->direction;
+
+			if (now < 0) {
+				now = sinceEpoch(boost::posix_time::microsec_clock::universal_time());
+			}
+			boost::uint64_t latency = boost::uint64_t(std::max<boost::int64_t>(now - event->time, 0));
+			++inputStatistics.presses;
+			inputStatistics.totalMicroseconds += latency;
+			inputStatistics.maxMicroseconds = std::max(inputStatistics.maxMicroseconds, latency);
+		}
+		inputs.pop();
+	}
+
+	// Eine Taste, die schon vor dem Takt wieder losgelassen wurde, gilt
+	// fuer diesen einen Takt.
+	return heldDirections.empty() ? tapped : Direction(heldDirections.back());
+}
+
+
+/**
+  * Einen Takt ausfuehren, wie zuvor PacmanWindow::update().
+  * @param tickTime Geplanter Zeitpunkt des Taktes.
+  */
+void SimulationThread::step(boost::int64_t tickTime) {
+	Direction held = drainInputs(tickTime);
+
+	// Im Spiel gegeneinander schaltet der Partner mit beiden Eingaben
+	// weiter, notfalls wartet er auf die Eingabe der Gegenseite.
+	if (peer != 0) {
+		peer->advance(held);
+		++tick;
+		return;
+	}
+
+	PacmanAgent* requested = requestedAgent.load(boost::memory_order_acquire);
+	if (requested != agent) {
+		agent = requested;
+		field.setPacmanAgent(agent);
+	}
+
+	field.nextTick();
+	++tick;
+
+	// Ein automatischer Spieler ersetzt die Tastatur.
+	if (field.getState() == Playing && agent == 0 && held != Direction::NONE) {
+		field.keyPressed(held);
+	}
+}
+
+
+/**
+  * Aktuellen Stand kopieren und fuer das Fenster freigeben.
+  * @param tickTime Geplanter Zeitpunkt des Taktes.
+  */
+void SimulationThread::publish(boost::int64_t tickTime) {
+	RenderSnapshot& snapshot = snapshots.getBack();
+	snapshot.field.copyStateFrom(field);
+	snapshot.tick = tick;
+	snapshot.time = tickTime;
+	snapshot.agent = agent;
+	MctsAgent* search = dynamic_cast<MctsAgent*>(agent);
+	snapshot.rolloutsPerSecond = search != 0 ? unsigned(search->getRolloutsPerSecond()) : 0;
+	snapshot.peerStatus = peer != 0 ? peer->getStatus() : LockstepPeer::Connecting;
+	snapshots.publish();
+}
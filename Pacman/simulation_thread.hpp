@@ -0,0 +1,244 @@
+#ifndef SIMULATION_THREAD_H
+#define SIMULATION_THREAD_H
+
+#include <ostream>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/thread.hpp>
+#include "field.hpp"
+#include "lockstep_peer.hpp"
+#include "pacman_agent.hpp"
+#include "spsc_queue.hpp"
+#include "triple_buffer.hpp"
+#include "turn_statistics.hpp"
+
+/**
+  * Unveraenderlicher Stand fuer einen gezeichneten Frame: eine Kopie des
+  * Spielfeldes nach einem Takt (Zellen samt Essen, Figuren mit Position,
+  * Zustand und Animation) und die Werte der Anzeige.
+  */
+struct RenderSnapshot {
+	// Kopie des Spielfeldes, wird nur noch gezeichnet
+	Field field;
+
+	// Takt, nach dem der Stand kopiert wurde, und sein geplanter
+	// Zeitpunkt in Mikrosekunden seit dem Erzeugen des Threads
+	unsigned int tick;
+	boost::int64_t time;
+
+	// Aktiver automatischer Spieler oder 0
+	PacmanAgent* agent;
+
+	// Rollouts je Sekunde des aktiven Spielers, falls er sucht
+	unsigned int rolloutsPerSecond;
+
+	// Zustand der Verbindung im Spiel gegeneinander
+	LockstepPeer::Status peerStatus;
+
+	/**
+	  * Leeren Stand erzeugen.
+	  */
+	RenderSnapshot();
+};
+
+/**
+  * Rechnet das Spiel in einem eigenen Thread mit festen
+  * TICKS_PER_SECOND, unabhaengig vom Zeichnen. Nach jedem Takt wird der
+  * Stand in einen Dreifachpuffer kopiert (Field::copyStateFrom(), unter
+  * einer Mikrosekunde), das Fenster zeichnet den jeweils neuesten ohne
+  * Sperre. Ein langsamer Frame verzoegert so keinen Takt, ein langsamer
+  * Takt (z.B. der Suche eines automatischen Spielers oder das Warten auf
+  * den Partner) haelt das Zeichnen nicht an.
+  *
+  * Tasten kommen als Ereignisse mit Zeitstempel ueber eine Schlange
+  * ohne Sperren (pushInput(), aus buttonDown() und buttonUp() des
+  * Fensters). Jeder Takt uebernimmt genau die Ereignisse bis zu seinem
+  * geplanten Zeitpunkt, auch wenn er verspaetet gerechnet wird. So geht
+  * kein Druck zwischen zwei Frames verloren, es gilt die zuletzt
+  * gedrueckte der gehaltenen Tasten, und die Verzoegerung bis zur
+  * Anwendung laesst sich messen. Andere Umschaltungen werden atomar
+  * uebergeben und vor dem naechsten Takt uebernommen.
+  */
+class SimulationThread {
+public:
+	// Takte je Sekunde wie das Fenster von Gosu
+	static const unsigned int TICKS_PER_SECOND = 60;
+
+	// Plaetze der Schlange fuer Tastenereignisse
+	static const unsigned int INPUT_CAPACITY = 256;
+
+	// Eine Pfeiltaste wurde gedrueckt oder losgelassen
+	struct InputEvent {
+		// Mikrosekunden seit dem Erzeugen des Threads
+		boost::int64_t time;
+		unsigned char direction;
+		bool pressed;
+	};
+
+	// Verzoegerung vom Druck einer Taste bis zum Takt, der sie anwendet
+	struct InputStatistics {
+		unsigned int presses;
+		boost::uint64_t totalMicroseconds;
+		boost::uint64_t maxMicroseconds;
+
+		// Ereignisse, die bei voller Schlange verworfen wurden
+		unsigned int dropped;
+	};
+
+private:
+	// Gerechnetes Spiel, gehoert nach start() dem Thread
+	Field& field;
+
+	// Partner im Spiel gegeneinander oder 0
+	LockstepPeer* peer;
+
+	// Staende zum Zeichnen
+	TripleBuffer<RenderSnapshot> snapshots;
+
+	// Bezugspunkt der Zeitstempel
+	boost::posix_time::ptime epoch;
+
+	// Tastenereignisse vom Fenster
+	SpscQueue<InputEvent, INPUT_CAPACITY> inputs;
+	boost::atomic<unsigned int> droppedInputs;
+
+	// Gehaltene Richtungen im Thread, die zuletzt gedrueckte am Ende
+	std::vector<unsigned char> heldDirections;
+
+	InputStatistics inputStatistics;
+
+	// Verzoegerung vom Druck bis zum Abbiegen, nur im Spiel allein
+	TurnStatistics turnStatistics;
+
+	// Gewuenschter und im Thread aktiver automatischer Spieler
+	boost::atomic<PacmanAgent*> requestedAgent;
+	PacmanAgent* agent;
+
+	// Gezaehlte Takte
+	unsigned int tick;
+
+	boost::atomic<bool> running;
+	boost::thread thread;
+
+	/**
+	  * Schleife des Threads: Takte im festen Raster ausfuehren, bis
+	  * stop() aufgerufen wird.
+	  */
+	void run();
+
+	/**
+	  * Einen Takt mit den Tastenereignissen bis zu seinem Zeitpunkt
+	  * ausfuehren.
+	  * @param tickTime Geplanter Zeitpunkt des Taktes in Mikrosekunden
+	  *                 seit dem Erzeugen des Threads.
+	  */
+	void step(boost::int64_t tickTime);
+
+	/**
+	  * Tastenereignisse bis zu einem Zeitpunkt uebernehmen.
+	  * @param tickTime Zeitpunkt des Taktes.
+	  * @return Zuletzt gedrueckte gehaltene Richtung, ohne gehaltene Taste
+	  *         die zuletzt in diesem Takt kurz gedrueckte, sonst NONE.
+	  */
+	Direction drainInputs(boost::int64_t tickTime);
+
+	/**
+	  * Mikrosekunden seit dem Erzeugen des Threads.
+	  * @param time Zeitpunkt.
+	  * @return Mikrosekunden.
+	  */
+	boost::int64_t sinceEpoch(const boost::posix_time::ptime& time) const;
+
+	/**
+	  * Aktuellen Stand in den Puffer des Schreibers kopieren und
+	  * freigeben.
+	  * @param tickTime Geplanter Zeitpunkt des Taktes.
+	  */
+	void publish(boost::int64_t tickTime);
+
+	// Nicht kopierbar
+	SimulationThread(const SimulationThread&);
+	SimulationThread& operator=(const SimulationThread&);
+
+public:
+	/**
+	  * Thread vorbereiten, aber noch nicht starten. Alle Puffer erhalten
+	  * den Anfangsstand.
+	  * @param field Zu rechnendes Spiel, waehrend der Thread laeuft nur
+	  *              noch von ihm benutzt.
+	  * @param peer  Partner, der das Spiel weiterschaltet (siehe
+	  *              LockstepPeer::advance()), oder 0 fuer ein Spiel allein.
+	  */
+	SimulationThread(Field& field, LockstepPeer* peer = 0);
+
+	/**
+	  * Thread anhalten.
+	  */
+	~SimulationThread();
+
+	/**
+	  * Thread starten.
+	  */
+	void start();
+
+	/**
+	  * Thread anhalten und auf sein Ende warten. Ein laufender Takt wird
+	  * zu Ende gerechnet.
+	  */
+	void stop();
+
+	/**
+	  * Druck oder Loslassen einer Pfeiltaste mit der aktuellen Zeit
+	  * einreihen, immer aus demselben Thread (dem des Fensters).
+	  * @param direction Richtung der Taste.
+	  * @param pressed   <code>true</code> beim Druecken.
+	  */
+	void pushInput(Direction direction, bool pressed);
+
+	/**
+	  * Automatischen Spieler umschalten, aus einem beliebigen Thread. Er
+	  * wird vor dem naechsten Takt angemeldet.
+	  * @param agent Spieler oder 0 fuer die Steuerung per Tastatur.
+	  */
+	void setPacmanAgent(PacmanAgent* agent);
+
+	/**
+	  * Neuesten Stand zum Zeichnen holen, nur aus dem zeichnenden Thread.
+	  * Er gehoert dem Aufrufer bis zum naechsten Aufruf.
+	  * @return Stand.
+	  */
+	RenderSnapshot& getSnapshot();
+
+	/**
+	  * Seit dem Takt eines Standes vergangener Anteil eines Taktes, um
+	  * die Figuren zwischen den Takten gleiten zu lassen (siehe
+	  * Field::draw()).
+	  * @param snapshot Gezeichneter Stand.
+	  * @return Anteil zwischen 0 und 1.
+	  */
+	double getTickFraction(const RenderSnapshot& snapshot) const;
+
+	/**
+	  * Verzoegerung der Tasten auslesen, erst nach stop().
+	  * @return Zaehler.
+	  */
+	const InputStatistics& getInputStatistics() const;
+
+	/**
+	  * Verteilung der Verzoegerung bis zum Abbiegen auslesen, erst nach
+	  * stop().
+	  * @return Verteilung, leer im Spiel gegeneinander.
+	  */
+	const TurnStatistics& getTurnStatistics() const;
+
+	/**
+	  * Verzoegerung der Tasten bis zum Takt und bis zum Abbiegen
+	  * schreiben, erst nach stop().
+	  * @param out Ausgabe.
+	  */
+	void reportInput(std::ostream& out) const;
+};
+
+#endif // SIMULATION_THREAD_H
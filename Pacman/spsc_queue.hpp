@@ -0,0 +1,76 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <boost/atomic.hpp>
+
+/**
+  * Warteschlange fester Groesse zwischen genau einem schreibenden und
+  * einem lesenden Thread, ohne Sperren. Jeder Thread schreibt nur seinen
+  * eigenen Index, der andere liest ihn mit acquire. Ist die Schlange
+  * voll, schlaegt push() fehl, statt zu warten.
+  * @param T        Typ der Eintraege, kopierbar.
+  * @param CAPACITY Anzahl Plaetze, eine Zweierpotenz.
+  */
+template <class T, unsigned int CAPACITY>
+class SpscQueue {
+	// Zweierpotenz, damit der Ueberlauf der Indizes nichts ausmacht
+	typedef char CapacityIsPowerOfTwo[ (CAPACITY & (CAPACITY - 1)) == 0 ? 1 : -1 ];
+
+	T entries[ CAPACITY ];
+
+	// Naechster zu lesender und naechster zu schreibender Eintrag,
+	// fortlaufend gezaehlt
+	boost::atomic<unsigned int> head;
+	boost::atomic<unsigned int> tail;
+
+	// Nicht kopierbar
+	SpscQueue(const SpscQueue&);
+	SpscQueue& operator=(const SpscQueue&);
+
+public:
+	/**
+	  * Leere Schlange erzeugen.
+	  */
+	SpscQueue()
+			:	head(0), tail(0)
+	{
+	}
+
+	/**
+	  * Einen Eintrag anhaengen, nur im schreibenden Thread.
+	  * @param entry Eintrag.
+	  * @return <code>false</code>, wenn die Schlange voll ist.
+	  */
+	bool push(const T& entry) {
+		unsigned int position = tail.load(boost::memory_order_relaxed);
+		if (position - head.load(boost::memory_order_acquire) == CAPACITY) {
+			return false;
+		}
+		entries[ position % CAPACITY ] = entry;
+		tail.store(position + 1, boost::memory_order_release);
+		return true;
+	}
+
+	/**
+	  * Den aeltesten Eintrag lesen, ohne ihn zu entfernen, nur im
+	  * lesenden Thread.
+	  * @return Eintrag oder 0, wenn die Schlange leer ist.
+	  */
+	const T* front() const {
+		unsigned int position = head.load(boost::memory_order_relaxed);
+		if (position == tail.load(boost::memory_order_acquire)) {
+			return 0;
+		}
+		return &entries[ position % CAPACITY ];
+	}
+
+	/**
+	  * Den aeltesten Eintrag entfernen, nur im lesenden Thread und nur,
+	  * wenn front() einen Eintrag geliefert hat.
+	  */
+	void pop() {
+		head.store(head.load(boost::memory_order_relaxed) + 1, boost::memory_order_release);
+	}
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,454 @@
+#include "field.hpp"
+#include "game_view.hpp"
+#include "maze_grid.hpp"
+#include "state_stream.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+// Kennbits der geaenderten Werte einer Nachricht
+enum Changes { PointsChanged = 1, LivesChanged = 2, StateChanged = 4, ItemsChanged = 8, FiguresChanged = 16 };
+
+/**
+  * Eine Zahl als Varint an einen Puffer anhaengen.
+  * @param buffer Erhaelt die Bytes.
+  * @param value  Zahl.
+  */
+void writeVarint(std::vector<unsigned char>& buffer, boost::uint32_t value) {
+	while (value >= 0x80) {
+		buffer.push_back((unsigned char) (value | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back((unsigned char) value);
+}
+
+/**
+  * Eine Zahl als Varint lesen.
+  * @param data  Naechstes Byte, wird hinter die Zahl gesetzt.
+  * @param end   Ende der Bytes.
+  * @param value Erhaelt die Zahl.
+  * @return <code>false</code>, wenn die Bytes vorher enden.
+  */
+bool readVarint(const unsigned char*& data, const unsigned char* end, boost::uint32_t& value) {
+	value = 0;
+	for (unsigned int shift = 0; data != end && shift < 35; shift += 7) {
+		unsigned char byte = *data++;
+		value |= (boost::uint32_t) (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+  * Aufsteigende Zellen als Anzahl und Abstaende anhaengen.
+  * @param buffer Erhaelt die Bytes.
+  * @param cells  Zellen.
+  */
+void writeCells(std::vector<unsigned char>& buffer, const std::vector<boost::uint32_t>& cells) {
+	writeVarint(buffer, cells.size());
+	boost::uint32_t previous = 0;
+	for (unsigned int index = 0; index < cells.size(); ++index) {
+		writeVarint(buffer, cells[ index ] - previous);
+		previous = cells[ index ];
+	}
+}
+
+/**
+  * Aufsteigende Zellen lesen.
+  * @param data  Naechstes Byte, wird dahinter gesetzt.
+  * @param end   Ende der Bytes.
+  * @param cells Erhaelt die Zellen.
+  * @return <code>false</code>, wenn die Bytes vorher enden.
+  */
+bool readCells(const unsigned char*& data, const unsigned char* end, std::vector<boost::uint32_t>& cells) {
+	boost::uint32_t count;
+	if (!readVarint(data, end, count) || count > (boost::uint32_t) (end - data)) {
+		return false;
+	}
+	cells.resize(count);
+	boost::uint32_t previous = 0;
+	for (unsigned int index = 0; index < count; ++index) {
+		boost::uint32_t gap;
+		if (!readVarint(data, end, gap)) {
+			return false;
+		}
+		previous += gap;
+		cells[ index ] = previous;
+	}
+	return true;
+}
+
+/**
+  * Unterschied zweier Staende ohne Nummern anhaengen.
+  * @param buffer Erhaelt die Bytes.
+  * @param base   Grundlage, die der Empfaenger kennt.
+  * @param state  Neuer Stand.
+  */
+void writeDelta(std::vector<unsigned char>& buffer, const StateSnapshot& base, const StateSnapshot& state) {
+	unsigned int changes = 0;
+	changes |= state.points != base.points ? PointsChanged : 0;
+	changes |= state.lives != base.lives ? LivesChanged : 0;
+	changes |= state.state != base.state ? StateChanged : 0;
+	changes |= state.items != base.items ? ItemsChanged : 0;
+	changes |= state.figures.size() != base.figures.size() ? FiguresChanged : 0;
+
+	writeVarint(buffer, state.tick - base.tick);
+	buffer.push_back((unsigned char) changes);
+	if (changes & PointsChanged) {
+		writeVarint(buffer, state.points);
+	}
+	if (changes & LivesChanged) {
+		buffer.push_back(state.lives);
+	}
+	if (changes & StateChanged) {
+		buffer.push_back(state.state);
+	}
+	if (changes & FiguresChanged) {
+		writeVarint(buffer, state.figures.size());
+	}
+
+	// Gezogene Figuren und geaenderte Zustaende
+	static const StateSnapshot::Figure Missing = { 0, 0, 0, 0 };
+	std::vector<boost::uint32_t> moved;
+	std::vector<boost::uint32_t> changed;
+	for (unsigned int index = 0; index < state.figures.size(); ++index) {
+		const StateSnapshot::Figure& before = index < base.figures.size() ? base.figures[ index ] : Missing;
+		const StateSnapshot::Figure& after = state.figures[ index ];
+		if (after.x != before.x || after.y != before.y || after.direction != before.direction) {
+			moved.push_back(index);
+		}
+		if (after.state != before.state) {
+			changed.push_back(index);
+		}
+	}
+	writeVarint(buffer, moved.size());
+	for (unsigned int index = 0; index < moved.size(); ++index) {
+		const StateSnapshot::Figure& figure = state.figures[ moved[ index ] ];
+		writeVarint(buffer, moved[ index ]);
+		buffer.push_back(figure.x);
+		buffer.push_back(figure.y);
+		buffer.push_back(figure.direction);
+	}
+	writeVarint(buffer, changed.size());
+	for (unsigned int index = 0; index < changed.size(); ++index) {
+		writeVarint(buffer, changed[ index ]);
+		buffer.push_back(state.figures[ changed[ index ] ].state);
+	}
+
+	// Essen, das seit der Grundlage verschwunden (oder bei einem
+	// Schluesselbild vorhanden) ist
+	std::vector<boost::uint32_t> toggled;
+	for (unsigned int word = 0; word < state.food.size(); ++word) {
+		boost::uint32_t bits = state.food[ word ] ^ (word < base.food.size() ? base.food[ word ] : 0);
+		for (unsigned int bit = 0; bits != 0; ++bit, bits >>= 1) {
+			if (bits & 1) {
+				toggled.push_back(word * 32 + bit);
+			}
+		}
+	}
+	writeCells(buffer, toggled);
+
+	if (changes & ItemsChanged) {
+		writeCells(buffer, std::vector<boost::uint32_t>(state.items.begin(), state.items.end()));
+	}
+}
+
+/**
+  * Unterschied auf eine Grundlage anwenden.
+  * @param data  Erstes Byte nach den Nummern.
+  * @param end   Ende der Nachricht.
+  * @param state Enthaelt die Grundlage, erhaelt den neuen Stand.
+  * @return <code>false</code>, wenn die Nachricht beschaedigt ist.
+  */
+bool readDelta(const unsigned char* data, const unsigned char* end, StateSnapshot& state) {
+	boost::uint32_t value;
+	if (!readVarint(data, end, value) || data == end) {
+		return false;
+	}
+	state.tick += value;
+	unsigned int changes = *data++;
+	if ((changes & PointsChanged) && !readVarint(data, end, state.points)) {
+		return false;
+	}
+	if (changes & LivesChanged) {
+		if (data == end) {
+			return false;
+		}
+		state.lives = *data++;
+	}
+	if (changes & StateChanged) {
+		if (data == end) {
+			return false;
+		}
+		state.state = *data++;
+	}
+	if (changes & FiguresChanged) {
+		static const StateSnapshot::Figure Missing = { 0, 0, 0, 0 };
+		if (!readVarint(data, end, value) || value > 255) {
+			return false;
+		}
+		state.figures.resize(value, Missing);
+	}
+
+	boost::uint32_t count;
+	if (!readVarint(data, end, count)) {
+		return false;
+	}
+	for (unsigned int index = 0; index < count; ++index) {
+		if (!readVarint(data, end, value) || value >= state.figures.size() || end - data < 3) {
+			return false;
+		}
+		StateSnapshot::Figure& figure = state.figures[ value ];
+		figure.x = *data++;
+		figure.y = *data++;
+		figure.direction = *data++;
+	}
+	if (!readVarint(data, end, count)) {
+		return false;
+	}
+	for (unsigned int index = 0; index < count; ++index) {
+		if (!readVarint(data, end, value) || value >= state.figures.size() || data == end) {
+			return false;
+		}
+		state.figures[ value ].state = *data++;
+	}
+
+	std::vector<boost::uint32_t> cells;
+	if (!readCells(data, end, cells)) {
+		return false;
+	}
+	for (unsigned int index = 0; index < cells.size(); ++index) {
+		unsigned int word = cells[ index ] / 32;
+		if (cells[ index ] >= Field::FIELD_WIDTH * Field::FIELD_HEIGHT) {
+			return false;
+		}
+		if (word >= state.food.size()) {
+			state.food.resize(word + 1, 0);
+		}
+		state.food[ word ] ^= 1u << (cells[ index ] % 32);
+	}
+
+	if (changes & ItemsChanged) {
+		if (!readCells(data, end, cells)) {
+			return false;
+		}
+		state.items.assign(cells.begin(), cells.end());
+	}
+	return data == end;
+}
+}
+
+
+/**
+  * Leeren Stand erzeugen.
+  */
+StateSnapshot::StateSnapshot()
+		:	tick(0), points(0), lives(0), state(0)
+{
+}
+
+
+/**
+  * Stand eines Spielfeldes uebernehmen.
+  * @param field Spielfeld.
+  */
+void StateSnapshot::read(Field& field) {
+	GameView view = field.getView();
+	const MazeGrid& maze = view.getMaze();
+
+	tick = view.getTickCount();
+	points = view.getPoints();
+	lives = (boost::uint8_t) view.getLives();
+	state = (boost::uint8_t) field.getState();
+
+	figures.resize(1 + view.getGhostCount());
+	for (unsigned int index = 0; index < figures.size(); ++index) {
+		unsigned int cell = index == 0 ? view.getPacmanCell() : view.getGhostCell(index - 1);
+		Figure& figure = figures[ index ];
+		figure.x = (boost::uint8_t) maze.getX(cell);
+		figure.y = (boost::uint8_t) maze.getY(cell);
+		figure.direction = (boost::uint8_t) (index == 0 ? view.getPacmanDirection() : view.getGhostDirection(index - 1)).getValue();
+		figure.state = (boost::uint8_t) (index == 0 ? view.getPacmanState() : view.getGhostState(index - 1));
+	}
+
+	food.assign((maze.getCellCount() + 31) / 32, 0);
+	for (unsigned int cell = 0; cell < maze.getCellCount(); ++cell) {
+		if (view.isFood(cell)) {
+			food[ cell / 32 ] |= 1u << (cell % 32);
+		}
+	}
+
+	std::vector<unsigned int> cells;
+	view.getItemCells(cells);
+	std::sort(cells.begin(), cells.end());
+	items.assign(cells.begin(), cells.end());
+}
+
+
+/**
+  * Liegt in einer Zelle Essen?
+  * @param cell Index der Zelle.
+  * @return <code>true</code>, wenn dort Essen liegt.
+  */
+bool StateSnapshot::isFood(unsigned int cell) const {
+	return cell / 32 < food.size() && (food[ cell / 32 ] & (1u << (cell % 32))) != 0;
+}
+
+
+/**
+  * Datenstrom beginnen.
+  */
+StateEncoder::StateEncoder()
+		:	history(HISTORY), historySequences(HISTORY, 0), sequence(0), acknowledged(0)
+{
+}
+
+
+/**
+  * Bestaetigung des Empfaengers uebernehmen.
+  * @param sequence Nummer der zuletzt gelesenen Nachricht.
+  */
+void StateEncoder::acknowledge(boost::uint32_t sequence) {
+	if (sequence > acknowledged && sequence <= this->sequence) {
+		acknowledged = sequence;
+	}
+}
+
+
+/**
+  * Bestaetigung vom Anfang empfangener Bytes lesen und uebernehmen.
+  * @param data Empfangene Bytes, beginnend mit ACK.
+  * @param size Anzahl empfangener Bytes.
+  * @return Anzahl gelesener Bytes, 0, wenn die Bestaetigung noch
+  *         nicht vollstaendig ist.
+  */
+unsigned int StateEncoder::acknowledge(const unsigned char* data, unsigned int size) {
+	assert(size > 0 && data[ 0 ] == ACK);
+	const unsigned char* next = data + 1;
+	boost::uint32_t number;
+	if (!readVarint(next, data + size, number)) {
+		return 0;
+	}
+	acknowledge(number);
+	return next - data;
+}
+
+
+/**
+  * Naechste Nachricht an einen Puffer anhaengen. Grundlage ist der
+  * zuletzt bestaetigte Stand, solange er noch vorraetig ist.
+  * @param state  Aktueller Stand.
+  * @param buffer Erhaelt die Bytes.
+  */
+void StateEncoder::encode(const StateSnapshot& state, std::vector<unsigned char>& buffer) {
+	static const StateSnapshot Empty;
+
+	++sequence;
+	boost::uint32_t baseline = 0;
+	if (acknowledged != 0 && sequence - acknowledged < HISTORY
+		&& historySequences[ acknowledged % HISTORY ] == acknowledged) {
+		baseline = acknowledged;
+	}
+
+	payload.clear();
+	writeVarint(payload, sequence);
+	writeVarint(payload, baseline != 0 ? sequence - baseline : 0);
+	writeDelta(payload, baseline != 0 ? history[ baseline % HISTORY ] : Empty, state);
+
+	writeVarint(buffer, payload.size());
+	buffer.insert(buffer.end(), payload.begin(), payload.end());
+
+	history[ sequence % HISTORY ] = state;
+	historySequences[ sequence % HISTORY ] = sequence;
+}
+
+
+/**
+  * Nummer der letzten Nachricht auslesen.
+  * @return Nummer.
+  */
+boost::uint32_t StateEncoder::getSequence() const {
+	return sequence;
+}
+
+
+/**
+  * Leser ohne Stand erzeugen.
+  */
+StateDecoder::StateDecoder()
+		:	history(StateEncoder::HISTORY), historySequences(StateEncoder::HISTORY, 0), sequence(0)
+{
+}
+
+
+/**
+  * Eine Nachricht vom Anfang empfangener Bytes lesen. Die Grundlage
+  * muss vorraetig sein, das stellt StateEncoder sicher, solange nur
+  * gelesene Nachrichten bestaetigt werden. Die Bytes kommen aus dem
+  * Netz, eine fehlerhafte Nachricht wird daher auch ohne assert
+  * erkannt und aendert den gelesenen Stand nicht.
+  * @param data Empfangene Bytes.
+  * @param size Anzahl empfangener Bytes.
+  * @return Anzahl gelesener Bytes, 0, wenn die Nachricht noch
+  *         nicht vollstaendig ist, <code>INVALID</code>, wenn sie
+  *         fehlerhaft ist.
+  */
+unsigned int StateDecoder::decode(const unsigned char* data, unsigned int size) {
+	const unsigned char* begin = data;
+	boost::uint32_t length;
+	if (!readVarint(data, begin + size, length) || length > (boost::uint32_t) (begin + size - data)) {
+		return 0;
+	}
+	const unsigned char* end = data + length;
+
+	boost::uint32_t number = 0;
+	boost::uint32_t baseline = 0;
+	if (!readVarint(data, end, number) || !readVarint(data, end, baseline)) {
+		return INVALID;
+	}
+	baseline = baseline != 0 ? number - baseline : 0;
+	if (baseline != 0 && historySequences[ baseline % StateEncoder::HISTORY ] != baseline) {
+		return INVALID;
+	}
+
+	StateSnapshot state = baseline != 0 ? history[ baseline % StateEncoder::HISTORY ] : StateSnapshot();
+	if (!readDelta(data, end, state)) {
+		return INVALID;
+	}
+
+	sequence = number;
+	history[ sequence % StateEncoder::HISTORY ] = state;
+	historySequences[ sequence % StateEncoder::HISTORY ] = sequence;
+	return end - begin;
+}
+
+
+/**
+  * Zuletzt gelesenen Stand auslesen.
+  * @return Stand.
+  */
+const StateSnapshot& StateDecoder::getState() const {
+	return history[ sequence % StateEncoder::HISTORY ];
+}
+
+
+/**
+  * Nummer der zuletzt gelesenen Nachricht auslesen.
+  * @return Nummer.
+  */
+boost::uint32_t StateDecoder::getSequence() const {
+	return sequence;
+}
+
+
+/**
+  * Bestaetigung der zuletzt gelesenen Nachricht anhaengen.
+  * @param buffer Erhaelt die Bytes.
+  */
+void StateDecoder::acknowledge(std::vector<unsigned char>& buffer) const {
+	buffer.push_back((unsigned char) StateEncoder::ACK);
+	writeVarint(buffer, sequence);
+}
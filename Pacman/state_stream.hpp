@@ -0,0 +1,181 @@
+#ifndef STATE_STREAM_H
+#define STATE_STREAM_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+class Field;
+
+/**
+  * Sichtbarer Stand eines Spiels, wie ihn ein Client oder Zuschauer
+  * braucht, um das Spielfeld darzustellen.
+  */
+struct StateSnapshot {
+	// Eine Figur, Index 0 ist Pacman, danach die Geister
+	struct Figure {
+		boost::uint8_t x;
+		boost::uint8_t y;
+		boost::uint8_t direction;
+		boost::uint8_t state;
+	};
+
+	boost::uint32_t tick;
+	boost::uint32_t points;
+	boost::uint8_t lives;
+	boost::uint8_t state;
+	std::vector<Figure> figures;
+
+	// Essen als Bits, Zellen wie in MazeGrid
+	std::vector<boost::uint32_t> food;
+
+	// Zellen der Pillen und Kirschen, aufsteigend
+	std::vector<boost::uint16_t> items;
+
+	/**
+	  * Leeren Stand erzeugen, Grundlage eines Schluesselbildes.
+	  */
+	StateSnapshot();
+
+	/**
+	  * Stand eines Spielfeldes uebernehmen.
+	  * @param field Spielfeld.
+	  */
+	void read(Field& field);
+
+	/**
+	  * Liegt in einer Zelle Essen?
+	  * @param cell Index der Zelle.
+	  * @return <code>true</code>, wenn dort Essen liegt.
+	  */
+	bool isFood(unsigned int cell) const;
+};
+
+/**
+  * Erzeugt den Datenstrom eines Spiels fuer einen Empfaenger: Jede
+  * Nachricht ist der Unterschied zum letzten vom Empfaenger
+  * bestaetigten Stand, ohne Bestaetigung ein Schluesselbild (der
+  * Unterschied zum leeren Stand). Gehen Nachrichten verloren oder
+  * werden beim Senden uebersprungen, bleibt der Strom lesbar.
+  *
+  * Eine Nachricht enthaelt nur die gezogenen Figuren als
+  * (Index, x, y, Richtung), geaenderte Zustaende von Figuren, die
+  * Zellen gefressenen Essens und geaenderte Zaehler. Zahlen werden als
+  * Varint geschrieben (7 Bit je Byte, gesetztes oberstes Bit fuer
+  * "weiter"), aufsteigende Zellen als Abstand zur vorigen.
+  *
+  * Aufbau: Laenge des Rests, Nummer, Abstand zur Nummer der Grundlage
+  * (0 fuer ein Schluesselbild), Takte seit der Grundlage, Kennbits der
+  * geaenderten Werte, die Werte, Figuren, Zustaende, Essen, Pillen und
+  * Kirschen.
+  */
+class StateEncoder {
+public:
+	// So viele gesendete Staende kommen als Grundlage in Frage. Ist
+	// die letzte Bestaetigung aelter, folgt ein Schluesselbild.
+	static const unsigned int HISTORY = 64;
+
+	// Kennung einer Bestaetigung vom Empfaenger, danach folgt die
+	// Nummer als Varint
+	static const unsigned char ACK = 0x80;
+
+private:
+	// Gesendete Staende, Index Nummer % HISTORY
+	std::vector<StateSnapshot> history;
+	std::vector<boost::uint32_t> historySequences;
+
+	// Nummer der letzten gesendeten und der zuletzt bestaetigten
+	// Nachricht (0 fuer keine)
+	boost::uint32_t sequence;
+	boost::uint32_t acknowledged;
+
+	// Inhalt der naechsten Nachricht ohne Laenge
+	std::vector<unsigned char> payload;
+
+public:
+	/**
+	  * Datenstrom beginnen, die erste Nachricht ist ein Schluesselbild.
+	  */
+	StateEncoder();
+
+	/**
+	  * Bestaetigung des Empfaengers uebernehmen. Aeltere und unbekannte
+	  * Nummern werden ignoriert.
+	  * @param sequence Nummer der zuletzt gelesenen Nachricht.
+	  */
+	void acknowledge(boost::uint32_t sequence);
+
+	/**
+	  * Bestaetigung vom Anfang empfangener Bytes lesen und uebernehmen.
+	  * @param data Empfangene Bytes, beginnend mit ACK.
+	  * @param size Anzahl empfangener Bytes.
+	  * @return Anzahl gelesener Bytes, 0, wenn die Bestaetigung noch
+	  *         nicht vollstaendig ist.
+	  */
+	unsigned int acknowledge(const unsigned char* data, unsigned int size);
+
+	/**
+	  * Naechste Nachricht an einen Puffer anhaengen.
+	  * @param state  Aktueller Stand.
+	  * @param buffer Erhaelt die Bytes.
+	  */
+	void encode(const StateSnapshot& state, std::vector<unsigned char>& buffer);
+
+	/**
+	  * Nummer der letzten Nachricht auslesen.
+	  * @return Nummer.
+	  */
+	boost::uint32_t getSequence() const;
+};
+
+/**
+  * Liest den Datenstrom von StateEncoder beim Empfaenger.
+  */
+class StateDecoder {
+	// Gelesene Staende, Index Nummer % StateEncoder::HISTORY
+	std::vector<StateSnapshot> history;
+	std::vector<boost::uint32_t> historySequences;
+
+	// Nummer der zuletzt gelesenen Nachricht
+	boost::uint32_t sequence;
+
+public:
+	// Rueckgabewert von decode() fuer eine fehlerhafte Nachricht
+	static const unsigned int INVALID = ~0u;
+
+	/**
+	  * Leser ohne Stand erzeugen.
+	  */
+	StateDecoder();
+
+	/**
+	  * Eine Nachricht vom Anfang empfangener Bytes lesen.
+	  * @param data Empfangene Bytes.
+	  * @param size Anzahl empfangener Bytes.
+	  * @return Anzahl gelesener Bytes, 0, wenn die Nachricht noch
+	  *         nicht vollstaendig ist, <code>INVALID</code>, wenn sie
+	  *         abgeschnitten ist, ihre Grundlage nicht vorraetig ist
+	  *         oder sie sich nicht lesen laesst.
+	  */
+	unsigned int decode(const unsigned char* data, unsigned int size);
+
+	/**
+	  * Zuletzt gelesenen Stand auslesen.
+	  * @return Stand.
+	  */
+	const StateSnapshot& getState() const;
+
+	/**
+	  * Nummer der zuletzt gelesenen Nachricht auslesen.
+	  * @return Nummer, 0 vor der ersten Nachricht.
+	  */
+	boost::uint32_t getSequence() const;
+
+	/**
+	  * Bestaetigung der zuletzt gelesenen Nachricht an einen Puffer
+	  * anhaengen.
+	  * @param buffer Erhaelt die Bytes.
+	  */
+	void acknowledge(std::vector<unsigned char>& buffer) const;
+};
+
+#endif // STATE_STREAM_H
@@ -0,0 +1,295 @@
+#include "direction.hpp"
+#include "maze_bitboard.hpp"
+#include "maze_grid.hpp"
+#include "targeting_service.hpp"
+
+const unsigned int TargetingService::NONE;
+
+
+/**
+  * Eine Zielermittlung ohne Labyrinth erzeugen.
+  */
+TargetingService::TargetingService() {
+	maze = 0;
+	mode = Chase;
+	pacmanCell = NONE;
+	pacmanField.origin = NONE;
+	ambushField.origin = NONE;
+	flankField.origin = NONE;
+	for (unsigned int personality = 0; personality < PERSONALITIES; ++personality) {
+		scatterCells[ personality ] = NONE;
+		scatterFields[ personality ].origin = NONE;
+		targets[ personality ] = NONE;
+	}
+}
+
+
+/**
+  * Tabellen fuer ein Labyrinth aufbauen. Die naechste begehbare Zelle
+  * ergibt sich aus einer Breitensuche ueber das ganze Spielfeld, die
+  * bei allen begehbaren Zellen zugleich beginnt und Waende ignoriert.
+  * Die Abstandsfelder der Rueckzugsecken bleiben bis zum naechsten
+  * Aufbau gueltig.
+  * @param maze     Labyrinth.
+  * @param bitboard Bitboards desselben Labyrinths.
+  */
+void TargetingService::build(const MazeGrid& maze, MazeBitboard& bitboard) {
+	this->maze = &maze;
+	unsigned int width = maze.getWidth();
+	unsigned int height = maze.getHeight();
+	unsigned int cellCount = maze.getCellCount();
+
+	nearestOpen.assign(cellCount, NONE);
+	std::vector<unsigned int> queue;
+	queue.reserve(cellCount);
+	for (unsigned int cell = 0; cell < cellCount; ++cell) {
+		if (maze.getExits(cell) != Direction::NONE) {
+			nearestOpen[ cell ] = cell;
+			queue.push_back(cell);
+		}
+	}
+	for (unsigned int head = 0; head < queue.size(); ++head) {
+		unsigned int cell = queue[ head ];
+		unsigned int x = maze.getX(cell);
+		unsigned int y = maze.getY(cell);
+		unsigned int neighbours[ 4 ];
+		unsigned int count = 0;
+		if (y > 0)          neighbours[ count++ ] = cell - width;
+		if (x > 0)          neighbours[ count++ ] = cell - 1;
+		if (y < height - 1) neighbours[ count++ ] = cell + width;
+		if (x < width - 1)  neighbours[ count++ ] = cell + 1;
+		for (unsigned int index = 0; index < count; ++index) {
+			if (nearestOpen[ neighbours[ index ] ] == NONE) {
+				nearestOpen[ neighbours[ index ] ] = nearestOpen[ cell ];
+				queue.push_back(neighbours[ index ]);
+			}
+		}
+	}
+
+	scatterCells[ Chaser ]   = snap(width - 1, 0);
+	scatterCells[ Ambusher ] = snap(0, 0);
+	scatterCells[ Flanker ]  = snap(width - 1, height - 1);
+	scatterCells[ Shy ]      = snap(0, height - 1);
+	for (unsigned int personality = 0; personality < PERSONALITIES; ++personality) {
+		scatterFields[ personality ].origin = NONE;
+		fill(bitboard, scatterFields[ personality ], scatterCells[ personality ]);
+	}
+
+	pacmanField.distances.assign(cellCount, NONE);
+	pacmanField.origin = NONE;
+	ambushField.origin = NONE;
+	flankField.origin = NONE;
+	pacmanCell = NONE;
+	setMode(mode);
+}
+
+
+/**
+  * Den Modus wechseln. Im Modus Scatter stehen die Ziele damit
+  * fest, update() ist erst im Modus Chase wieder noetig.
+  * @param mode Neuer Modus.
+  */
+void TargetingService::setMode(GhostMode mode) {
+	this->mode = mode;
+	if (mode == Scatter) {
+		for (unsigned int personality = 0; personality < PERSONALITIES; ++personality) {
+			targets[ personality ] = scatterCells[ personality ];
+		}
+	}
+}
+
+
+/**
+  * Modus auslesen, fuer den die Ziele gelten.
+  * @return Aktueller Modus.
+  */
+GhostMode TargetingService::getMode() const {
+	return mode;
+}
+
+
+/**
+  * Koordinaten auf das Spielfeld beschraenken und die naechste
+  * begehbare Zelle liefern.
+  * @param x X-Koordinate, darf ausserhalb liegen.
+  * @param y Y-Koordinate, darf ausserhalb liegen.
+  * @return Index der Zelle.
+  */
+unsigned int TargetingService::snap(int x, int y) const {
+	int width = maze->getWidth();
+	int height = maze->getHeight();
+	x = (x < 0) ? 0 : ((x >= width) ? width - 1 : x);
+	y = (y < 0) ? 0 : ((y >= height) ? height - 1 : y);
+	return nearestOpen[ maze->getIndex(x, y) ];
+}
+
+
+/**
+  * Abstandsfeld fuer eine Zelle berechnen, falls es nicht schon fuer
+  * diese Zelle gilt. Gemessen wird von der Zelle aus; das stimmt mit
+  * den Abstaenden zu ihr ueberein, solange die Durchgaenge in beide
+  * Richtungen offen sind, wie im Spielfeld.
+  * @param bitboard Bitboards desselben Labyrinths.
+  * @param field    Abstandsfeld.
+  * @param origin   Zelle, von der aus gemessen wird.
+  */
+void TargetingService::fill(MazeBitboard& bitboard, DistanceField& field, unsigned int origin) {
+	if (field.origin != origin) {
+		bitboard.floodFill(origin);
+		bitboard.getDistances(field.distances);
+		field.origin = origin;
+	}
+}
+
+
+/**
+  * Die Ziele fuer den aktuellen Takt berechnen. Ein Abstandsfeld wird
+  * nur neu ermittelt, wenn sich seine Zelle geaendert hat.
+  * @param bitboard         Bitboards desselben Labyrinths.
+  * @param pacmanCell       Zelle von Pacman.
+  * @param pacmanDirection  Laufrichtung von Pacman (Konstante der
+  *                         Klasse 'Direction').
+  * @param chaserCell       Zelle des ersten Verfolgers oder NONE.
+  */
+void TargetingService::update(MazeBitboard& bitboard, unsigned int pacmanCell,
+							  unsigned int pacmanDirection, unsigned int chaserCell) {
+	this->pacmanCell = pacmanCell;
+	fill(bitboard, pacmanField, pacmanCell);
+
+	int x = maze->getX(pacmanCell);
+	int y = maze->getY(pacmanCell);
+	int stepX = 0;
+	int stepY = 0;
+	switch (pacmanDirection) {
+		case Direction::UP:    stepY = -1; break;
+		case Direction::LEFT:  stepX = -1; break;
+		case Direction::DOWN:  stepY = 1;  break;
+		case Direction::RIGHT: stepX = 1;  break;
+	}
+
+	targets[ Chaser ] = pacmanCell;
+	targets[ Ambusher ] = snap(x + stepX * (int) AMBUSH_LOOKAHEAD, y + stepY * (int) AMBUSH_LOOKAHEAD);
+
+	// Den Verfolger an der Zelle vor Pacman spiegeln. Ohne Verfolger
+	// wird Pacman selbst gespiegelt.
+	int pivotX = x + stepX * (int) FLANK_LOOKAHEAD;
+	int pivotY = y + stepY * (int) FLANK_LOOKAHEAD;
+	int chaserX = x;
+	int chaserY = y;
+	if (chaserCell != NONE) {
+		chaserX = maze->getX(chaserCell);
+		chaserY = maze->getY(chaserCell);
+	}
+	targets[ Flanker ] = snap(2 * pivotX - chaserX, 2 * pivotY - chaserY);
+	targets[ Shy ] = pacmanCell;
+
+	fill(bitboard, ambushField, targets[ Ambusher ]);
+	fill(bitboard, flankField, targets[ Flanker ]);
+}
+
+
+/**
+  * Ziel eines Geistes auslesen. Nur der Shy haengt im Modus Chase
+  * von der eigenen Position ab: In der Naehe von Pacman zieht er
+  * sich zurueck.
+  * @param personality Verhalten des Geistes.
+  * @param ghostCell   Zelle des Geistes.
+  * @return Index der Zielzelle.
+  */
+unsigned int TargetingService::getTarget(GhostPersonality personality, unsigned int ghostCell) const {
+	if (mode == Chase && personality == Shy && pacmanField.distances[ ghostCell ] <= SHY_DISTANCE) {
+		return scatterCells[ Shy ];
+	}
+	return targets[ personality ];
+}
+
+
+/**
+  * Rueckzugsecke eines Verhaltens auslesen.
+  * @param personality Verhalten des Geistes.
+  * @return Index der Zelle.
+  */
+unsigned int TargetingService::getScatterCell(GhostPersonality personality) const {
+	return scatterCells[ personality ];
+}
+
+
+/**
+  * Pacmans Zelle bei der letzten Aktualisierung auslesen.
+  * @return Index der Zelle.
+  */
+unsigned int TargetingService::getPacmanCell() const {
+	return pacmanCell;
+}
+
+
+/**
+  * Abstand einer Zelle zu Pacman auslesen.
+  * @param cell Index der Zelle.
+  * @return Anzahl Schritte oder NONE.
+  */
+unsigned int TargetingService::getDistanceToPacman(unsigned int cell) const {
+	return pacmanField.distances[ cell ];
+}
+
+
+/**
+  * Richtung des ersten Schrittes zum Ursprung eines Abstandsfeldes:
+  * Es wird der offene Nachbar mit dem kleinsten Abstand gewaehlt.
+  * @param field Abstandsfeld.
+  * @param cell  Index der Zelle.
+  * @return Konstante der Klasse 'Direction' oder Direction::NONE.
+  */
+unsigned int TargetingService::getStep(const DistanceField& field, unsigned int cell) const {
+	unsigned int best = Direction::NONE;
+	unsigned int bestDistance = field.distances[ cell ];
+	for (unsigned int direction = Direction::UP; direction <= Direction::RIGHT; direction <<= 1) {
+		if (!maze->isOpen(cell, direction)) {
+			continue;
+		}
+		unsigned int distance = field.distances[ maze->getNeighbour(cell, direction) ];
+		if (distance < bestDistance) {
+			best = direction;
+			bestDistance = distance;
+		}
+	}
+	return best;
+}
+
+
+/**
+  * Richtung des ersten Schrittes zu Pacman, abgelesen am
+  * Abstandsfeld.
+  * @param cell Index der Zelle.
+  * @return Konstante der Klasse 'Direction' oder Direction::NONE.
+  */
+unsigned int TargetingService::getDirectionToPacman(unsigned int cell) const {
+	return getStep(pacmanField, cell);
+}
+
+
+/**
+  * Richtung des ersten Schrittes zum Ziel eines Geistes, abgelesen am
+  * Abstandsfeld des Ziels: Im Modus Scatter ist das die eigene Ecke,
+  * sonst Pacman, die Zelle des Ambushers oder die des Flankers; der
+  * Shy weicht in der Naehe von Pacman in seine Ecke aus.
+  * @param personality Verhalten des Geistes.
+  * @param ghostCell   Zelle des Geistes.
+  * @return Konstante der Klasse 'Direction' oder Direction::NONE,
+  *         wenn der Geist am Ziel steht oder es nicht erreicht.
+  */
+unsigned int TargetingService::getDirectionToTarget(GhostPersonality personality, unsigned int ghostCell) const {
+	if (mode == Scatter) {
+		return getStep(scatterFields[ personality ], ghostCell);
+	}
+	switch (personality) {
+		case Ambusher: return getStep(ambushField, ghostCell);
+		case Flanker:  return getStep(flankField, ghostCell);
+		case Shy:
+			if (pacmanField.distances[ ghostCell ] <= SHY_DISTANCE) {
+				return getStep(scatterFields[ Shy ], ghostCell);
+			}
+			return getStep(pacmanField, ghostCell);
+		default:       return getStep(pacmanField, ghostCell);
+	}
+}
@@ -0,0 +1,197 @@
+#ifndef TARGETING_SERVICE_H
+#define TARGETING_SERVICE_H
+
+#include <vector>
+
+class MazeBitboard;
+class MazeGrid;
+
+// Verhalten eines Geistes, festgelegt durch die Ziffer '0' - '3'
+// im Aufbau des Spielfeldes.
+// Chaser:   verfolgt Pacman direkt
+// Ambusher: lauert einige Zellen vor Pacman
+// Flanker:  greift von der anderen Seite als der erste Verfolger an
+// Shy:      verfolgt Pacman nur aus der Ferne, sonst zieht er sich zurueck
+enum GhostPersonality { Chaser = 0, Ambusher, Flanker, Shy };
+
+// Modus aller Geister laut Zeitplan des Levels.
+// Scatter:    jeder Geist zieht sich in seine Ecke zurueck
+// Chase:      jeder Geist verfolgt Pacman gemaess seinem Verhalten
+// Frightened: die Geister sind harmlos, der Zeitplan ruht
+enum GhostMode { Scatter = 0, Chase, Frightened };
+
+/**
+  * Gemeinsame Zielermittlung fuer alle Geister. Einmal je Takt
+  * werden die Ziele festgehalten und fuer jedes Ziel ein Abstandsfeld
+  * ueber die Bitboards berechnet: fuer Pacman, die Zelle des Ambushers
+  * und die des Flankers, jeweils nur, wenn sich die Zelle geaendert
+  * hat. Die Felder der Rueckzugsecken entstehen beim Laden des
+  * Levels. Danach kostet die Richtung eines Geistes nur noch einen
+  * Blick auf seine Nachbarn, egal wie viele Geister es gibt. Ziele
+  * ausserhalb des Spielfeldes oder in Steinen werden auf die naechste
+  * begehbare Zelle verschoben.
+  */
+class TargetingService {
+public:
+	// Kennzeichnet "keine Zelle" bzw. "nicht erreichbar".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+	// Anzahl verschiedener Verhaltensweisen
+	static const unsigned int PERSONALITIES = 4;
+
+	// So viele Zellen vor Pacman lauert der Ambusher.
+	static const unsigned int AMBUSH_LOOKAHEAD = 4;
+
+	// Um diese Zelle vor Pacman wird die Position des Verfolgers
+	// fuer den Flanker gespiegelt.
+	static const unsigned int FLANK_LOOKAHEAD = 2;
+
+	// Naeher als so viele Schritte kommt der Shy nicht freiwillig.
+	static const unsigned int SHY_DISTANCE = 8;
+
+private:
+	// Abstaende von einer Zelle aus und die Zelle, fuer die sie gelten
+	struct DistanceField {
+		unsigned int origin;
+		std::vector<unsigned int> distances;
+	};
+
+	// Labyrinth, fuer das die Tabellen aufgebaut wurden
+	const MazeGrid* maze;
+
+	// Naechste begehbare Zelle je Zelle
+	std::vector<unsigned int> nearestOpen;
+
+	// Rueckzugsecke je Verhalten und ihr Abstandsfeld
+	unsigned int scatterCells[ PERSONALITIES ];
+	DistanceField scatterFields[ PERSONALITIES ];
+
+	// Pacmans Zelle bei der letzten Aktualisierung
+	unsigned int pacmanCell;
+
+	// Abstandsfelder von Pacman, vom Ziel des Ambushers und vom Ziel
+	// des Flankers
+	DistanceField pacmanField;
+	DistanceField ambushField;
+	DistanceField flankField;
+
+	// Modus, fuer den die Ziele gelten
+	GhostMode mode;
+
+	// Ziel je Verhalten (der Shy wird je Geist entschieden)
+	unsigned int targets[ PERSONALITIES ];
+
+	/**
+	  * Koordinaten auf das Spielfeld beschraenken und die naechste
+	  * begehbare Zelle liefern.
+	  * @param x X-Koordinate, darf ausserhalb liegen.
+	  * @param y Y-Koordinate, darf ausserhalb liegen.
+	  * @return Index der Zelle.
+	  */
+	unsigned int snap(int x, int y) const;
+
+	/**
+	  * Abstandsfeld fuer eine Zelle berechnen, falls es nicht schon
+	  * fuer diese Zelle gilt.
+	  * @param bitboard Bitboards desselben Labyrinths.
+	  * @param field    Abstandsfeld.
+	  * @param origin   Zelle, von der aus gemessen wird.
+	  */
+	void fill(MazeBitboard& bitboard, DistanceField& field, unsigned int origin);
+
+	/**
+	  * Richtung des ersten Schrittes zum Ursprung eines Abstandsfeldes:
+	  * der offene Nachbar mit dem kleinsten Abstand.
+	  * @param field Abstandsfeld.
+	  * @param cell  Index der Zelle.
+	  * @return Konstante der Klasse 'Direction' oder Direction::NONE.
+	  */
+	unsigned int getStep(const DistanceField& field, unsigned int cell) const;
+
+public:
+	/**
+	  * Eine Zielermittlung ohne Labyrinth erzeugen.
+	  */
+	TargetingService();
+
+	/**
+	  * Tabellen fuer ein Labyrinth aufbauen. Das Labyrinth muss bis
+	  * zum naechsten Aufruf unveraendert bleiben.
+	  * @param maze     Labyrinth.
+	  * @param bitboard Bitboards desselben Labyrinths.
+	  */
+	void build(const MazeGrid& maze, MazeBitboard& bitboard);
+
+	/**
+	  * Den Modus wechseln. Im Modus Scatter stehen die Ziele damit
+	  * fest, update() ist erst im Modus Chase wieder noetig.
+	  * @param mode Neuer Modus.
+	  */
+	void setMode(GhostMode mode);
+
+	/**
+	  * Modus auslesen, fuer den die Ziele gelten.
+	  * @return Aktueller Modus.
+	  */
+	GhostMode getMode() const;
+
+	/**
+	  * Die Ziele fuer den aktuellen Takt berechnen. Ein Abstandsfeld
+	  * wird nur neu ermittelt, wenn sich seine Zelle geaendert hat.
+	  * @param bitboard         Bitboards desselben Labyrinths.
+	  * @param pacmanCell       Zelle von Pacman.
+	  * @param pacmanDirection  Laufrichtung von Pacman (Konstante der
+	  *                         Klasse 'Direction').
+	  * @param chaserCell       Zelle des ersten Verfolgers oder NONE.
+	  */
+	void update(MazeBitboard& bitboard, unsigned int pacmanCell,
+				unsigned int pacmanDirection, unsigned int chaserCell);
+
+	/**
+	  * Ziel eines Geistes auslesen.
+	  * @param personality Verhalten des Geistes.
+	  * @param ghostCell   Zelle des Geistes.
+	  * @return Index der Zielzelle.
+	  */
+	unsigned int getTarget(GhostPersonality personality, unsigned int ghostCell) const;
+
+	/**
+	  * Rueckzugsecke eines Verhaltens auslesen.
+	  * @param personality Verhalten des Geistes.
+	  * @return Index der Zelle.
+	  */
+	unsigned int getScatterCell(GhostPersonality personality) const;
+
+	/**
+	  * Pacmans Zelle bei der letzten Aktualisierung auslesen.
+	  * @return Index der Zelle.
+	  */
+	unsigned int getPacmanCell() const;
+
+	/**
+	  * Abstand einer Zelle zu Pacman auslesen.
+	  * @param cell Index der Zelle.
+	  * @return Anzahl Schritte oder NONE.
+	  */
+	unsigned int getDistanceToPacman(unsigned int cell) const;
+
+	/**
+	  * Richtung des ersten Schrittes zu Pacman, abgelesen am
+	  * Abstandsfeld.
+	  * @param cell Index der Zelle.
+	  * @return Konstante der Klasse 'Direction' oder Direction::NONE.
+	  */
+	unsigned int getDirectionToPacman(unsigned int cell) const;
+
+	/**
+	  * Richtung des ersten Schrittes zum Ziel eines Geistes (siehe
+	  * getTarget()), abgelesen am Abstandsfeld des Ziels.
+	  * @param personality Verhalten des Geistes.
+	  * @param ghostCell   Zelle des Geistes.
+	  * @return Konstante der Klasse 'Direction' oder Direction::NONE,
+	  *         wenn der Geist am Ziel steht oder es nicht erreicht.
+	  */
+	unsigned int getDirectionToTarget(GhostPersonality personality, unsigned int ghostCell) const;
+};
+
+#endif // TARGETING_SERVICE_H
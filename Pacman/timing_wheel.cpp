@@ -0,0 +1,301 @@
+#include "timing_wheel.hpp"
+#include <cassert>
+
+namespace {
+// Tabelle fuer die Bitsuche nach de Bruijn
+const unsigned int DeBruijnBits[32] = {
+	 0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+	31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+};
+
+/**
+  * Position des niedrigsten gesetzten Bits ermitteln.
+  * @param value Bitmaske, die nicht 0 sein darf.
+  * @return Position des Bits (0-63).
+  */
+unsigned int lowestBit(boost::uint64_t value) {
+	unsigned int low = (unsigned int) value;
+	unsigned int offset = 0;
+	if (low == 0) {
+		low = (unsigned int) (value >> 32);
+		offset = 32;
+	}
+	return offset + DeBruijnBits[((low & (~low + 1)) * 0x077CB531U) >> 27];
+}
+}
+
+/**
+  * Ein leeres Zeitrad ohne Eintraege erzeugen.
+  */
+TimingWheel::TimingWheel() {
+	clear(0);
+}
+
+
+/**
+  * Alle Termine loeschen und die Zeit neu setzen.
+  * @param now Neuer aktueller Zeittakt.
+  */
+void TimingWheel::clear(unsigned int now) {
+	this->now = now;
+	this->count = 0;
+	for (unsigned int bucket = 0; bucket <= OVERFLOW_BUCKET; ++bucket) {
+		heads[ bucket ] = NONE;
+	}
+	for (unsigned int level = 0; level < LEVELS; ++level) {
+		occupied[ level ] = 0;
+	}
+	for (std::vector<Entry>::iterator iter = entries.begin(); iter != entries.end(); ++iter) {
+		iter->bucket = NONE;
+	}
+}
+
+
+/**
+  * Anzahl moeglicher Kennungen festlegen. Beim Verkleinern
+  * werden die betroffenen Termine geloescht.
+  * @param capacity Anzahl Kennungen.
+  */
+void TimingWheel::resize(unsigned int capacity) {
+	for (unsigned int id = capacity; id < entries.size(); ++id) {
+		cancel(id);
+	}
+	Entry unscheduled = { NONE, NONE, NONE, NONE };
+	entries.resize(capacity, unscheduled);
+}
+
+
+/**
+  * Anzahl moeglicher Kennungen auslesen.
+  * @return Anzahl Kennungen.
+  */
+unsigned int TimingWheel::getCapacity() const {
+	return entries.size();
+}
+
+
+/**
+  * Aktuellen Zeittakt des Rades auslesen.
+  * @return Zeittakt.
+  */
+unsigned int TimingWheel::getCurrentTick() const {
+	return now;
+}
+
+
+/**
+  * Fach ermitteln, in das ein Termin relativ zum aktuellen
+  * Zeittakt gehoert. Ein Termin liegt in der untersten Ebene, in
+  * der er sich oberhalb der Ebene nicht mehr vom aktuellen Takt
+  * unterscheidet.
+  * @param due Faelligkeit des Termins (nicht vor dem aktuellen Takt).
+  * @return Index des Faches.
+  */
+unsigned int TimingWheel::getBucket(unsigned int due) const {
+	unsigned int difference = due ^ now;
+	for (unsigned int level = 0; level < LEVELS; ++level) {
+		if ((difference >> (SLOT_BITS * (level + 1))) == 0) {
+			return level * SLOTS + ((due >> (SLOT_BITS * level)) & (SLOTS - 1));
+		}
+	}
+	return OVERFLOW_BUCKET;
+}
+
+
+/**
+  * Einen Eintrag in sein Fach einhaengen.
+  * @param id Kennung des Eintrags.
+  */
+void TimingWheel::link(unsigned int id) {
+	Entry& entry = entries[ id ];
+	entry.bucket = getBucket(entry.due);
+	entry.prev = NONE;
+	entry.next = heads[ entry.bucket ];
+	if (entry.next != NONE) {
+		entries[ entry.next ].prev = id;
+	}
+	heads[ entry.bucket ] = id;
+
+	if (entry.bucket != OVERFLOW_BUCKET) {
+		occupied[ entry.bucket / SLOTS ] |= boost::uint64_t(1) << (entry.bucket % SLOTS);
+	}
+}
+
+
+/**
+  * Einen Eintrag aus seinem Fach aushaengen.
+  * @param id Kennung des Eintrags.
+  */
+void TimingWheel::unlink(unsigned int id) {
+	Entry& entry = entries[ id ];
+	if (entry.prev != NONE) {
+		entries[ entry.prev ].next = entry.next;
+	}
+	else {
+		heads[ entry.bucket ] = entry.next;
+	}
+	if (entry.next != NONE) {
+		entries[ entry.next ].prev = entry.prev;
+	}
+
+	// Ist das Fach jetzt leer?
+	if (heads[ entry.bucket ] == NONE && entry.bucket != OVERFLOW_BUCKET) {
+		occupied[ entry.bucket / SLOTS ] &= ~(boost::uint64_t(1) << (entry.bucket % SLOTS));
+	}
+	entry.bucket = NONE;
+}
+
+
+/**
+  * Alle Eintraege eines Faches relativ zum aktuellen Takt
+  * neu einsortieren.
+  * @param bucket Index des Faches.
+  */
+void TimingWheel::cascade(unsigned int bucket) {
+	unsigned int id = heads[ bucket ];
+	heads[ bucket ] = NONE;
+	if (bucket != OVERFLOW_BUCKET) {
+		occupied[ bucket / SLOTS ] &= ~(boost::uint64_t(1) << (bucket % SLOTS));
+	}
+
+	while (id != NONE) {
+		unsigned int next = entries[ id ].next;
+		link(id);
+		id = next;
+	}
+}
+
+
+/**
+  * Einen Termin eintragen. Ein bereits bestehender Termin
+  * derselben Kennung wird dabei verschoben.
+  * @param id  Kennung des Eintrags.
+  * @param due Faelligkeit, muss nach dem aktuellen Zeittakt liegen.
+  */
+void TimingWheel::schedule(unsigned int id, unsigned int due) {
+	assert(due > now);
+	if (entries[ id ].bucket != NONE) {
+		unlink(id);
+	}
+	else {
+		count++;
+	}
+	entries[ id ].due = due;
+	link(id);
+}
+
+
+/**
+  * Einen Termin loeschen. Ist keiner eingetragen, passiert nichts.
+  * @param id Kennung des Eintrags.
+  */
+void TimingWheel::cancel(unsigned int id) {
+	if (entries[ id ].bucket != NONE) {
+		unlink(id);
+		count--;
+	}
+}
+
+
+/**
+  * Ist fuer die Kennung ein Termin eingetragen?
+  * @param id Kennung des Eintrags.
+  * @return <code>true</code>, wenn ein Termin eingetragen ist.
+  */
+bool TimingWheel::isScheduled(unsigned int id) const {
+	return entries[ id ].bucket != NONE;
+}
+
+
+/**
+  * Faelligkeit eines Termins auslesen.
+  * @param id Kennung des Eintrags.
+  * @return Zeittakt oder NONE, wenn kein Termin eingetragen ist.
+  */
+unsigned int TimingWheel::getDueTick(unsigned int id) const {
+	return isScheduled(id) ? entries[ id ].due : NONE;
+}
+
+
+/**
+  * Gibt es ueberhaupt eingetragene Termine?
+  * @return <code>true</code>, wenn kein Termin eingetragen ist.
+  */
+bool TimingWheel::isEmpty() const {
+	return count == 0;
+}
+
+
+/**
+  * Zeittakt des naechsten faelligen Termins ermitteln. Alle Termine
+  * einer Ebene liegen vor denen der naechsthoeheren Ebene, innerhalb
+  * der untersten Ebene bestimmt das Fach bereits den Takt.
+  * @return Zeittakt oder NONE, wenn kein Termin eingetragen ist.
+  */
+unsigned int TimingWheel::getNextDueTick() const {
+	if (count == 0) {
+		return NONE;
+	}
+
+	if (occupied[ 0 ] != 0) {
+		return (now & ~(SLOTS - 1)) | lowestBit(occupied[ 0 ]);
+	}
+
+	// In hoeheren Ebenen enthaelt ein Fach mehrere Takte.
+	unsigned int bucket = OVERFLOW_BUCKET;
+	for (unsigned int level = 1; level < LEVELS; ++level) {
+		if (occupied[ level ] != 0) {
+			bucket = level * SLOTS + lowestBit(occupied[ level ]);
+			break;
+		}
+	}
+
+	unsigned int earliest = NONE;
+	for (unsigned int id = heads[ bucket ]; id != NONE; id = entries[ id ].next) {
+		if (entries[ id ].due < earliest) {
+			earliest = entries[ id ].due;
+		}
+	}
+	return earliest;
+}
+
+
+/**
+  * Das Rad auf den Zeittakt 'tick' weiterschalten und die Kennungen
+  * aller dann faelligen Termine an 'due' anhaengen. Diese Termine
+  * sind danach geloescht. Zwischen dem aktuellen Takt und 'tick'
+  * darf kein Termin faellig sein, 'tick' darf also hoechstens
+  * getNextDueTick() sein.
+  * @param tick Neuer Zeittakt, muss nach dem aktuellen liegen.
+  * @param due  Vektor, an den die faelligen Kennungen angehaengt werden.
+  */
+void TimingWheel::advance(unsigned int tick, std::vector<unsigned int>& due) {
+	assert(tick > now && tick <= getNextDueTick());
+
+	unsigned int previous = now;
+	now = tick;
+
+	// Ueberall dort, wo der Takt in ein neues Fach einer hoeheren Ebene
+	// gewechselt ist, wird dieses Fach in die unteren Ebenen verteilt.
+	// Alle anderen Faecher bleiben gueltig, da vor 'tick' nichts faellig ist.
+	if ((previous >> (SLOT_BITS * LEVELS)) != (tick >> (SLOT_BITS * LEVELS))) {
+		cascade(OVERFLOW_BUCKET);
+	}
+	for (unsigned int level = LEVELS - 1; level > 0; --level) {
+		if ((previous >> (SLOT_BITS * level)) != (tick >> (SLOT_BITS * level))) {
+			cascade(level * SLOTS + ((tick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+		}
+	}
+
+	unsigned int bucket = tick & (SLOTS - 1);
+	unsigned int id = heads[ bucket ];
+	while (id != NONE) {
+		unsigned int next = entries[ id ].next;
+		entries[ id ].bucket = NONE;
+		count--;
+		due.push_back(id);
+		id = next;
+	}
+	heads[ bucket ] = NONE;
+	occupied[ 0 ] &= ~(boost::uint64_t(1) << bucket);
+}
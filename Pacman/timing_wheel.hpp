@@ -0,0 +1,169 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+
+/**
+  * Hierarchisches Zeitrad (Timing Wheel). Ein Eintrag wird ueber eine
+  * Kennung zwischen 0 und getCapacity() - 1 angesprochen und ist zu
+  * genau einem absoluten Zeittakt faellig. Eintragen, Verschieben und
+  * Loeschen kosten konstante Zeit, das Weiterschalten kostet nur Arbeit
+  * fuer die faelligen Eintraege (plus gelegentliches Umsortieren einer
+  * hoeheren Ebene). Die Zeit kann auch direkt bis zum naechsten
+  * faelligen Eintrag vorgespult werden.
+  */
+class TimingWheel {
+public:
+	// Bits pro Ebene, jede Ebene hat damit 64 Faecher.
+	static const unsigned int SLOT_BITS = 6;
+
+	// Anzahl Faecher pro Ebene.
+	static const unsigned int SLOTS = 1 << SLOT_BITS;
+
+	// Anzahl Ebenen. Termine, die mehr als 2^24 Takte in der
+	// Zukunft liegen, landen in einer Ueberlaufliste.
+	static const unsigned int LEVELS = 4;
+
+	// Kennzeichnet "kein Eintrag" bzw. "kein Termin".
+	static const unsigned int NONE = 0xFFFFFFFF;
+
+private:
+	// Verwaltungsdaten eines Eintrags. Alle Eintraege eines Faches
+	// bilden eine doppelt verkettete Liste ueber ihre Kennungen.
+	struct Entry {
+		unsigned int due;
+		unsigned int bucket;
+		unsigned int prev;
+		unsigned int next;
+	};
+
+	// Index des Faches fuer die Ueberlaufliste
+	static const unsigned int OVERFLOW_BUCKET = LEVELS * SLOTS;
+
+	// Alle Eintraege, Index ist die Kennung
+	std::vector<Entry> entries;
+
+	// Listenkoepfe aller Faecher (inkl. Ueberlaufliste)
+	unsigned int heads[OVERFLOW_BUCKET + 1];
+
+	// Pro Ebene ein Bit je belegtem Fach
+	boost::uint64_t occupied[LEVELS];
+
+	// Aktueller Zeittakt des Rades
+	unsigned int now;
+
+	// Anzahl eingetragener Termine
+	unsigned int count;
+
+	/**
+	  * Fach ermitteln, in das ein Termin relativ zum aktuellen
+	  * Zeittakt gehoert.
+	  * @param due Faelligkeit des Termins (nicht vor dem aktuellen Takt).
+	  * @return Index des Faches.
+	  */
+	unsigned int getBucket(unsigned int due) const;
+
+	/**
+	  * Einen Eintrag in sein Fach einhaengen.
+	  * @param id Kennung des Eintrags.
+	  */
+	void link(unsigned int id);
+
+	/**
+	  * Einen Eintrag aus seinem Fach aushaengen.
+	  * @param id Kennung des Eintrags.
+	  */
+	void unlink(unsigned int id);
+
+	/**
+	  * Alle Eintraege eines Faches relativ zum aktuellen Takt
+	  * neu einsortieren.
+	  * @param bucket Index des Faches.
+	  */
+	void cascade(unsigned int bucket);
+
+public:
+	/**
+	  * Ein leeres Zeitrad ohne Eintraege erzeugen.
+	  */
+	TimingWheel();
+
+	/**
+	  * Alle Termine loeschen und die Zeit neu setzen.
+	  * @param now Neuer aktueller Zeittakt.
+	  */
+	void clear(unsigned int now);
+
+	/**
+	  * Anzahl moeglicher Kennungen festlegen. Beim Verkleinern
+	  * werden die betroffenen Termine geloescht.
+	  * @param capacity Anzahl Kennungen.
+	  */
+	void resize(unsigned int capacity);
+
+	/**
+	  * Anzahl moeglicher Kennungen auslesen.
+	  * @return Anzahl Kennungen.
+	  */
+	unsigned int getCapacity() const;
+
+	/**
+	  * Aktuellen Zeittakt des Rades auslesen.
+	  * @return Zeittakt.
+	  */
+	unsigned int getCurrentTick() const;
+
+	/**
+	  * Einen Termin eintragen. Ein bereits bestehender Termin
+	  * derselben Kennung wird dabei verschoben.
+	  * @param id  Kennung des Eintrags.
+	  * @param due Faelligkeit, muss nach dem aktuellen Zeittakt liegen.
+	  */
+	void schedule(unsigned int id, unsigned int due);
+
+	/**
+	  * Einen Termin loeschen. Ist keiner eingetragen, passiert nichts.
+	  * @param id Kennung des Eintrags.
+	  */
+	void cancel(unsigned int id);
+
+	/**
+	  * Ist fuer die Kennung ein Termin eingetragen?
+	  * @param id Kennung des Eintrags.
+	  * @return <code>true</code>, wenn ein Termin eingetragen ist.
+	  */
+	bool isScheduled(unsigned int id) const;
+
+	/**
+	  * Faelligkeit eines Termins auslesen.
+	  * @param id Kennung des Eintrags.
+	  * @return Zeittakt oder NONE, wenn kein Termin eingetragen ist.
+	  */
+	unsigned int getDueTick(unsigned int id) const;
+
+	/**
+	  * Gibt es ueberhaupt eingetragene Termine?
+	  * @return <code>true</code>, wenn kein Termin eingetragen ist.
+	  */
+	bool isEmpty() const;
+
+	/**
+	  * Zeittakt des naechsten faelligen Termins ermitteln.
+	  * @return Zeittakt oder NONE, wenn kein Termin eingetragen ist.
+	  */
+	unsigned int getNextDueTick() const;
+
+	/**
+	  * Das Rad auf den Zeittakt 'tick' weiterschalten und die Kennungen
+	  * aller dann faelligen Termine an 'due' anhaengen. Diese Termine
+	  * sind danach geloescht. Zwischen dem aktuellen Takt und 'tick'
+	  * darf kein Termin faellig sein, 'tick' darf also hoechstens
+	  * getNextDueTick() sein.
+	  * @param tick Neuer Zeittakt, muss nach dem aktuellen liegen.
+	  * @param due  Vektor, an den die faelligen Kennungen angehaengt werden.
+	  */
+	void advance(unsigned int tick, std::vector<unsigned int>& due);
+};
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,166 @@
+#include "transposition_table.hpp"
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+// Aufteilung des Datenwortes: Bewertung (Bits 0-31), Tiefe (32-39),
+// bester Zug (40-43), Generation (44-51), belegt (52)
+const unsigned int DEPTH_SHIFT = 32;
+const unsigned int BEST_SHIFT = 40;
+const unsigned int GENERATION_SHIFT = 44;
+const boost::uint64_t USED = boost::uint64_t(1) << 52;
+
+/**
+  * Inhalt eines Eintrags zu einem Datenwort zusammensetzen.
+  * @param value      Bewertung.
+  * @param depth      Tiefe.
+  * @param best       Bester Zug.
+  * @param generation Generation.
+  * @return Datenwort, nie 0.
+  */
+boost::uint64_t pack(float value, unsigned int depth, unsigned int best, unsigned int generation) {
+	boost::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return USED | bits | (boost::uint64_t(depth & 0xFF) << DEPTH_SHIFT) |
+		   (boost::uint64_t(best & 0xF) << BEST_SHIFT) | (boost::uint64_t(generation & 0xFF) << GENERATION_SHIFT);
+}
+
+/**
+  * Tiefe aus einem Datenwort lesen.
+  * @param data Datenwort.
+  * @return Tiefe.
+  */
+unsigned int depthOf(boost::uint64_t data) {
+	return (unsigned int) (data >> DEPTH_SHIFT) & 0xFF;
+}
+
+/**
+  * Generation aus einem Datenwort lesen.
+  * @param data Datenwort.
+  * @return Generation (modulo 256).
+  */
+unsigned int generationOf(boost::uint64_t data) {
+	return (unsigned int) (data >> GENERATION_SHIFT) & 0xFF;
+}
+}
+
+
+/**
+  * Eine leere Tabelle erzeugen.
+  * @param bucketBits Zweierlogarithmus der Anzahl Faecher.
+  */
+TranspositionTable::TranspositionTable(unsigned int bucketBits) {
+	unsigned int count = 1u << bucketBits;
+	storage.resize(count + 1);
+	std::size_t address = reinterpret_cast<std::size_t>(&storage[ 0 ]);
+	buckets = reinterpret_cast<Bucket*>((address + sizeof(Bucket) - 1) & ~(sizeof(Bucket) - 1));
+	mask = count - 1;
+	generation = 0;
+	clear();
+}
+
+
+/**
+  * Alle Eintraege loeschen.
+  */
+void TranspositionTable::clear() {
+	for (unsigned int index = 0; index <= mask; ++index) {
+		for (unsigned int way = 0; way < WAYS; ++way) {
+			buckets[ index ].slots[ way ].check = 0;
+			buckets[ index ].slots[ way ].data = 0;
+		}
+	}
+}
+
+
+/**
+  * Eine neue Generation beginnen.
+  */
+void TranspositionTable::nextGeneration() {
+	generation++;
+}
+
+
+/**
+  * Einen Spielstand nachschlagen. Jedes Wort wird genau einmal
+  * gelesen, damit die Pruefung fuer dieselben Werte gilt, die
+  * zurueckgegeben werden.
+  * @param key   Hash des Spielstandes.
+  * @param entry Erhaelt den Inhalt, falls vorhanden.
+  * @return <code>true</code>, wenn der Spielstand gefunden wurde.
+  */
+bool TranspositionTable::probe(boost::uint64_t key, Entry& entry) const {
+	const Bucket& bucket = buckets[ key & mask ];
+	for (unsigned int way = 0; way < WAYS; ++way) {
+		boost::uint64_t data = bucket.slots[ way ].data;
+		boost::uint64_t check = bucket.slots[ way ].check;
+		if (data != 0 && (check ^ data) == key) {
+			boost::uint32_t bits = (boost::uint32_t) data;
+			std::memcpy(&entry.value, &bits, sizeof(bits));
+			entry.depth = depthOf(data);
+			entry.best = Direction((unsigned int) (data >> BEST_SHIFT) & 0xF);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/**
+  * Ergebnis fuer einen Spielstand ablegen.
+  * @param key   Hash des Spielstandes.
+  * @param value Bewertung.
+  * @param depth Tiefe bzw. Guete, hoechstens MAX_DEPTH.
+  * @param best  Bester Zug.
+  */
+void TranspositionTable::store(boost::uint64_t key, float value, unsigned int depth, Direction best) {
+	if (depth > MAX_DEPTH) {
+		depth = MAX_DEPTH;
+	}
+	unsigned int current = generation & 0xFF;
+
+	Bucket& bucket = buckets[ key & mask ];
+	Slot* victim = 0;
+	int victimScore = INT_MAX;
+	for (unsigned int way = 0; way < WAYS; ++way) {
+		Slot& slot = bucket.slots[ way ];
+		boost::uint64_t data = slot.data;
+		boost::uint64_t check = slot.check;
+		int score;
+		if (data == 0) {
+			// Freier Eintrag, wird belegt, sofern derselbe Spielstand
+			// nicht in einem spaeteren Eintrag liegt
+			score = INT_MIN;
+		}
+		else if ((check ^ data) == key) {
+			if (generationOf(data) == current && depthOf(data) > depth) {
+				return;
+			}
+			victim = &slot;
+			break;
+		}
+		else {
+			int age = (int) ((current - generationOf(data)) & 0xFF);
+			score = (int) depthOf(data) - (int) AGE_WEIGHT * age;
+		}
+		if (score < victimScore) {
+			victim = &slot;
+			victimScore = score;
+		}
+	}
+
+	boost::uint64_t data = pack(value, depth, best.getValue(), current);
+	victim->check = key ^ data;
+	victim->data = data;
+}
+
+
+/**
+  * Anzahl Eintraege insgesamt auslesen.
+  * @return Anzahl Eintraege.
+  */
+unsigned int TranspositionTable::getCapacity() const {
+	return (unsigned int) (mask + 1) * WAYS;
+}
@@ -0,0 +1,122 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include "direction.hpp"
+
+/**
+  * Transpositionstabelle fester Groesse fuer Suchverfahren, adressiert
+  * ueber den Hash des Spielstandes (siehe ZobristHash). Die Tabelle
+  * ist mehrfach assoziativ: Ein Hash kann in jedem der WAYS Eintraege
+  * seines Faches liegen, ein Fach fuellt genau eine Cache-Zeile.
+  *
+  * Mehrere Threads duerfen ohne Sperren gleichzeitig lesen und
+  * schreiben. Jeder Eintrag besteht aus zwei 64-Bit-Worten: den Daten
+  * und dem Hash XOR Daten. Ein Leser akzeptiert einen Eintrag nur,
+  * wenn beide Worte zusammenpassen. Ueberschreiben sich zwei Schreiber
+  * oder liest ein Leser mitten in einem Schreibvorgang, passen die
+  * Worte nicht mehr zusammen und der Eintrag gilt als nicht vorhanden.
+  * Schlimmstenfalls geht so ein Ergebnis verloren, falsche Daten
+  * werden (bis auf Hash-Kollisionen) nie geliefert.
+  */
+class TranspositionTable {
+public:
+	// Anzahl Eintraege je Fach
+	static const unsigned int WAYS = 4;
+
+	// Hoechste speicherbare Tiefe
+	static const unsigned int MAX_DEPTH = 255;
+
+	// So viel Tiefe ist ein Eintrag je Generation Alter weniger wert.
+	static const unsigned int AGE_WEIGHT = 8;
+
+	/**
+	  * Inhalt eines Eintrags.
+	  */
+	struct Entry {
+		// Bewertung des Spielstandes
+		float value;
+
+		// Tiefe bzw. Guete der Bewertung, groesser ist besser
+		unsigned int depth;
+
+		// Bester Zug (Konstante der Klasse 'Direction')
+		Direction best;
+	};
+
+private:
+	// Ein Eintrag: Daten und Hash XOR Daten. 'volatile', damit jeder
+	// Zugriff wirklich auf den gemeinsamen Speicher geht.
+	struct Slot {
+		volatile boost::uint64_t check;
+		volatile boost::uint64_t data;
+	};
+
+	// Ein Fach mit WAYS Eintraegen (64 Bytes)
+	struct Bucket {
+		Slot slots[ WAYS ];
+	};
+
+	// Speicher mit einem Fach Reserve fuer die Ausrichtung und die
+	// auf 64 Bytes ausgerichteten Faecher darin
+	std::vector<Bucket> storage;
+	Bucket* buckets;
+
+	// Anzahl Faecher - 1 (Anzahl ist eine Zweierpotenz)
+	boost::uint64_t mask;
+
+	// Laufende Generation, z.B. eine je Entscheidung
+	unsigned int generation;
+
+	// Nicht kopierbar
+	TranspositionTable(const TranspositionTable&);
+	TranspositionTable& operator=(const TranspositionTable&);
+
+public:
+	/**
+	  * Eine leere Tabelle erzeugen.
+	  * @param bucketBits Zweierlogarithmus der Anzahl Faecher.
+	  */
+	TranspositionTable(unsigned int bucketBits = 14);
+
+	/**
+	  * Alle Eintraege loeschen. Darf nicht gleichzeitig mit anderen
+	  * Zugriffen laufen.
+	  */
+	void clear();
+
+	/**
+	  * Eine neue Generation beginnen: Aeltere Eintraege werden bevorzugt
+	  * ersetzt, bleiben aber lesbar.
+	  */
+	void nextGeneration();
+
+	/**
+	  * Einen Spielstand nachschlagen.
+	  * @param key   Hash des Spielstandes.
+	  * @param entry Erhaelt den Inhalt, falls vorhanden.
+	  * @return <code>true</code>, wenn der Spielstand gefunden wurde.
+	  */
+	bool probe(boost::uint64_t key, Entry& entry) const;
+
+	/**
+	  * Ergebnis fuer einen Spielstand ablegen. Ein vorhandener Eintrag
+	  * desselben Spielstandes wird ersetzt, ausser er ist aus derselben
+	  * Generation und tiefer. Sonst wird ein freier Eintrag belegt oder
+	  * der mit der geringsten um das Alter verminderten Tiefe ersetzt.
+	  * @param key   Hash des Spielstandes.
+	  * @param value Bewertung.
+	  * @param depth Tiefe bzw. Guete, hoechstens MAX_DEPTH.
+	  * @param best  Bester Zug.
+	  */
+	void store(boost::uint64_t key, float value, unsigned int depth, Direction best);
+
+	/**
+	  * Anzahl Eintraege insgesamt auslesen.
+	  * @return Anzahl Eintraege.
+	  */
+	unsigned int getCapacity() const;
+};
+
+#endif // TRANSPOSITION_TABLE_H
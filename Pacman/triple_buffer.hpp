@@ -0,0 +1,82 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <boost/atomic.hpp>
+
+/**
+  * Dreifachpuffer zwischen genau einem schreibenden und einem lesenden
+  * Thread, ohne Sperren. Der Schreiber fuellt seinen Puffer und tauscht
+  * ihn gegen den mittleren, der Leser tauscht seinen Puffer gegen den
+  * mittleren, sobald dort ein neuerer liegt. Keiner wartet je auf den
+  * anderen: Schreibt der Schreiber schneller, als gelesen wird, gehen
+  * Zwischenstaende verloren, liest der Leser oefter, erhaelt er
+  * mehrmals denselben Stand.
+  */
+template <class T>
+class TripleBuffer {
+	// Kennbit im mittleren Index: Der Puffer ist neuer als der des Lesers
+	static const unsigned int FRESH = 4;
+
+	T buffers[ 3 ];
+
+	// Puffer des Schreibers und des Lesers, nur im jeweiligen Thread
+	unsigned int back;
+	unsigned int front;
+
+	// Mittlerer Puffer samt FRESH
+	boost::atomic<unsigned int> middle;
+
+	// Nicht kopierbar
+	TripleBuffer(const TripleBuffer&);
+	TripleBuffer& operator=(const TripleBuffer&);
+
+public:
+	/**
+	  * Puffer erzeugen, anfangs ohne neuen Stand.
+	  */
+	TripleBuffer()
+			:	back(0), front(1), middle(2)
+	{
+	}
+
+	/**
+	  * Puffer des Schreibers, nur im schreibenden Thread.
+	  * @return Zu fuellender Puffer.
+	  */
+	T& getBack() {
+		return buffers[ back ];
+	}
+
+	/**
+	  * Den gefuellten Puffer fuer den Leser freigeben, nur im
+	  * schreibenden Thread. Danach gehoert dem Schreiber ein anderer
+	  * Puffer mit einem aelteren Stand.
+	  */
+	void publish() {
+		back = middle.exchange(back | FRESH, boost::memory_order_acq_rel) & ~FRESH;
+	}
+
+	/**
+	  * Den neuesten freigegebenen Puffer holen, nur im lesenden Thread.
+	  * Er bleibt dem Leser bis zum naechsten Aufruf.
+	  * @return Neuester Puffer.
+	  */
+	T& getFront() {
+		if (middle.load(boost::memory_order_relaxed) & FRESH) {
+			front = middle.exchange(front, boost::memory_order_acq_rel) & ~FRESH;
+		}
+		return buffers[ front ];
+	}
+
+	/**
+	  * Alle drei Puffer, z.B. um sie vor dem Start der Threads gleich
+	  * einzurichten.
+	  * @param index Nummer des Puffers (0 bis 2).
+	  * @return Puffer.
+	  */
+	T& getBuffer(unsigned int index) {
+		return buffers[ index ];
+	}
+};
+
+#endif // TRIPLE_BUFFER_H
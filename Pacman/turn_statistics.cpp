@@ -0,0 +1,101 @@
+#include "turn_statistics.hpp"
+
+
+/**
+  * Leere Verteilung erzeugen.
+  */
+TurnStatistics::TurnStatistics()
+		:	histogram(MAX_TICKS + 1, 0), turns(0), expired(0)
+{
+}
+
+
+/**
+  * Eine Abbiegung zaehlen.
+  * @param ticks Takte seit dem Druck der Taste.
+  */
+void TurnStatistics::recordTurn(unsigned int ticks) {
+	++histogram[ ticks < MAX_TICKS ? ticks : MAX_TICKS ];
+	++turns;
+}
+
+
+/**
+  * Einen verfallenen Wunsch zaehlen.
+  */
+void TurnStatistics::recordExpired() {
+	++expired;
+}
+
+
+/**
+  * Anzahl Abbiegungen auslesen.
+  * @return Abbiegungen.
+  */
+unsigned int TurnStatistics::getTurns() const {
+	return turns;
+}
+
+
+/**
+  * Anzahl verfallener Wuensche auslesen.
+  * @return Wuensche.
+  */
+unsigned int TurnStatistics::getExpired() const {
+	return expired;
+}
+
+
+/**
+  * Verteilung auslesen.
+  * @return Anzahl Abbiegungen je Verzoegerung in Takten.
+  */
+const std::vector<unsigned int>& TurnStatistics::getHistogram() const {
+	return histogram;
+}
+
+
+/**
+  * Kleinste Verzoegerung, bis zu der mindestens der gegebene Anteil
+  * der Abbiegungen reicht.
+  * @param fraction Anteil zwischen 0 und 1.
+  * @return Takte.
+  */
+unsigned int TurnStatistics::getPercentile(double fraction) const {
+	unsigned int needed = (unsigned int) (fraction * turns + 0.999999);
+	unsigned int seen = 0;
+	for (unsigned int ticks = 0; ticks < histogram.size(); ++ticks) {
+		seen += histogram[ ticks ];
+		if (seen >= needed && seen > 0) {
+			return ticks;
+		}
+	}
+	return 0;
+}
+
+
+/**
+  * Anzahl, Mittel, Perzentile und Maximum als Zeile schreiben, dazu
+  * die Verteilung ohne leere Eintraege.
+  * @param out Ausgabe.
+  */
+void TurnStatistics::report(std::ostream& out) const {
+	unsigned long total = 0;
+	unsigned int maximum = 0;
+	for (unsigned int ticks = 0; ticks < histogram.size(); ++ticks) {
+		total += (unsigned long) ticks * histogram[ ticks ];
+		if (histogram[ ticks ] > 0) {
+			maximum = ticks;
+		}
+	}
+	out << "turns: " << turns << ", mean " << (turns > 0 ? double(total) / turns : 0.0)
+		<< " ticks, p50 " << getPercentile(0.5) << ", p90 " << getPercentile(0.9)
+		<< ", p99 " << getPercentile(0.99) << ", max " << maximum << ", " << expired << " expired" << std::endl;
+	out << "turn latency histogram (ticks: turns):";
+	for (unsigned int ticks = 0; ticks < histogram.size(); ++ticks) {
+		if (histogram[ ticks ] > 0) {
+			out << " " << ticks << (ticks == MAX_TICKS ? "+" : "") << ":" << histogram[ ticks ];
+		}
+	}
+	out << std::endl;
+}
@@ -0,0 +1,74 @@
+#ifndef TURN_STATISTICS_H
+#define TURN_STATISTICS_H
+
+#include <ostream>
+#include <vector>
+
+/**
+  * Verteilung der Verzoegerung vom Druck einer Richtungstaste bis zu
+  * dem Schritt, mit dem Pacman tatsaechlich abbiegt, in Takten (siehe
+  * Pacman::keyPressed()). Wuensche, die vor dem Abbiegen verfallen,
+  * werden getrennt gezaehlt.
+  */
+class TurnStatistics {
+public:
+	// Laengere Verzoegerungen landen im letzten Eintrag
+	static const unsigned int MAX_TICKS = 64;
+
+private:
+	// Anzahl Abbiegungen je Verzoegerung in Takten
+	std::vector<unsigned int> histogram;
+
+	unsigned int turns;
+	unsigned int expired;
+
+	/**
+	  * Verzoegerung, unter der ein Anteil der Abbiegungen liegt.
+	  * @param fraction Anteil zwischen 0 und 1.
+	  * @return Takte.
+	  */
+	unsigned int getPercentile(double fraction) const;
+
+public:
+	/**
+	  * Leere Verteilung erzeugen.
+	  */
+	TurnStatistics();
+
+	/**
+	  * Eine Abbiegung zaehlen.
+	  * @param ticks Takte seit dem Druck der Taste.
+	  */
+	void recordTurn(unsigned int ticks);
+
+	/**
+	  * Einen verfallenen Wunsch zaehlen.
+	  */
+	void recordExpired();
+
+	/**
+	  * Anzahl Abbiegungen auslesen.
+	  * @return Abbiegungen.
+	  */
+	unsigned int getTurns() const;
+
+	/**
+	  * Anzahl verfallener Wuensche auslesen.
+	  * @return Wuensche.
+	  */
+	unsigned int getExpired() const;
+
+	/**
+	  * Verteilung auslesen.
+	  * @return Anzahl Abbiegungen je Verzoegerung in Takten.
+	  */
+	const std::vector<unsigned int>& getHistogram() const;
+
+	/**
+	  * Anzahl, Mittel, Perzentile und Maximum als Zeile schreiben.
+	  * @param out Ausgabe.
+	  */
+	void report(std::ostream& out) const;
+};
+
+#endif // TURN_STATISTICS_H
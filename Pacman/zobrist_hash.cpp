@@ -0,0 +1,99 @@
+#include "zobrist_hash.hpp"
+
+namespace {
+// Art des Bestandteils in den oberen Bits der Eingabe
+enum KeyKind { FigureKey = 1, FoodKey, ScalarKey };
+
+/**
+  * Eingabe zu einem Schluessel mischen (Finalisierer von SplitMix64).
+  * Benachbarte Eingaben ergeben unabhaengig wirkende Schluessel.
+  * @param input Koordinaten des Bestandteils.
+  * @return Schluessel.
+  */
+boost::uint64_t mix(boost::uint64_t input) {
+	boost::uint64_t z = input + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+  * Koordinaten eines Bestandteils zu einer Eingabe zusammensetzen.
+  * @param kind Art des Bestandteils.
+  * @param a    Erste Koordinate (bis 2^24).
+  * @param b    Zweite Koordinate (bis 2^32).
+  * @return Eingabe fuer mix().
+  */
+boost::uint64_t compose(KeyKind kind, unsigned int a, unsigned int b) {
+	return (boost::uint64_t(kind) << 56) | (boost::uint64_t(a & 0xFFFFFF) << 32) | b;
+}
+}
+
+
+/**
+  * Hash eines leeren Standes erzeugen, alle Zaehlgroessen sind 0.
+  */
+ZobristHash::ZobristHash() {
+	clear();
+}
+
+
+/**
+  * Auf den leeren Stand zuruecksetzen. Auch die Schluessel der
+  * Zaehlgroessen mit dem Wert 0 sind enthalten.
+  */
+void ZobristHash::clear() {
+	value = 0;
+	for (unsigned int scalar = 0; scalar < SCALARS; ++scalar) {
+		scalars[ scalar ] = 0;
+		value ^= scalarKey(Scalar(scalar), 0);
+	}
+}
+
+
+/**
+  * Schluessel einer Figur.
+  * @param figure Index der Figur in der Figurenliste.
+  * @param x      X-Koordinate der Zelle.
+  * @param y      Y-Koordinate der Zelle.
+  * @param state  Zustand der Figur.
+  * @return Schluessel.
+  */
+boost::uint64_t ZobristHash::figureKey(unsigned int figure, unsigned int x, unsigned int y, FigureState state) {
+	return mix(compose(FigureKey, figure * 4 + state, (y << 16) | x));
+}
+
+
+/**
+  * Schluessel von Essen in einer Zelle.
+  * @param x X-Koordinate der Zelle.
+  * @param y Y-Koordinate der Zelle.
+  * @return Schluessel.
+  */
+boost::uint64_t ZobristHash::foodKey(unsigned int x, unsigned int y) {
+	return mix(compose(FoodKey, 0, (y << 16) | x));
+}
+
+
+/**
+  * Schluessel einer Zaehlgroesse mit einem Wert.
+  * @param scalar Zaehlgroesse.
+  * @param value  Wert.
+  * @return Schluessel.
+  */
+boost::uint64_t ZobristHash::scalarKey(Scalar scalar, unsigned int value) {
+	return mix(compose(ScalarKey, scalar, value));
+}
+
+
+/**
+  * Neuen Wert einer Zaehlgroesse eintragen.
+  * @param scalar Zaehlgroesse.
+  * @param value  Neuer Wert.
+  */
+void ZobristHash::setScalar(Scalar scalar, unsigned int value) {
+	if (scalars[ scalar ] != value) {
+		this->value ^= scalarKey(scalar, scalars[ scalar ]) ^ scalarKey(scalar, value);
+		scalars[ scalar ] = value;
+	}
+}
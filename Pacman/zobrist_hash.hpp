@@ -0,0 +1,104 @@
+#ifndef ZOBRIST_HASH_H
+#define ZOBRIST_HASH_H
+
+#include <boost/cstdint.hpp>
+#include "figure.hpp"
+
+/**
+  * Inkrementeller 64-Bit-Hash eines Spielstandes nach Zobrist. Jeder
+  * Bestandteil (Figur an einer Zelle in einem Zustand, Essen in einer
+  * Zelle, Wert einer Zaehlgroesse) hat einen Schluessel, der Hash ist
+  * das XOR aller Schluessel des Standes. Eine Aenderung kostet damit
+  * nur ein oder zwei XOR. Die Schluessel werden nicht zufaellig
+  * erzeugt und abgelegt, sondern aus den Koordinaten des Bestandteils
+  * gemischt: So stimmen sie in allen Prozessen und auf allen Rechnern
+  * ueberein, ohne dass eine Tabelle verteilt werden muss.
+  */
+class ZobristHash {
+public:
+	// Zaehlgroessen, deren aktueller Wert jeweils mit einem
+	// Schluessel eingeht.
+	enum Scalar { Points = 0, Lives, HarmlessTicks, Mode, State, SCALARS };
+
+private:
+	// Aktueller Hash
+	boost::uint64_t value;
+
+	// Aktueller Wert jeder Zaehlgroesse
+	unsigned int scalars[ SCALARS ];
+
+public:
+	/**
+	  * Hash eines leeren Standes erzeugen, alle Zaehlgroessen sind 0.
+	  */
+	ZobristHash();
+
+	/**
+	  * Auf den leeren Stand zuruecksetzen.
+	  */
+	void clear();
+
+	/**
+	  * Schluessel einer Figur.
+	  * @param figure Index der Figur in der Figurenliste.
+	  * @param x      X-Koordinate der Zelle.
+	  * @param y      Y-Koordinate der Zelle.
+	  * @param state  Zustand der Figur.
+	  * @return Schluessel.
+	  */
+	static boost::uint64_t figureKey(unsigned int figure, unsigned int x, unsigned int y, FigureState state);
+
+	/**
+	  * Schluessel von Essen in einer Zelle.
+	  * @param x X-Koordinate der Zelle.
+	  * @param y Y-Koordinate der Zelle.
+	  * @return Schluessel.
+	  */
+	static boost::uint64_t foodKey(unsigned int x, unsigned int y);
+
+	/**
+	  * Schluessel einer Zaehlgroesse mit einem Wert.
+	  * @param scalar Zaehlgroesse.
+	  * @param value  Wert.
+	  * @return Schluessel.
+	  */
+	static boost::uint64_t scalarKey(Scalar scalar, unsigned int value);
+
+	/**
+	  * Eine Figur hinzunehmen oder entfernen.
+	  * @param figure Index der Figur in der Figurenliste.
+	  * @param x      X-Koordinate der Zelle.
+	  * @param y      Y-Koordinate der Zelle.
+	  * @param state  Zustand der Figur.
+	  */
+	void toggleFigure(unsigned int figure, unsigned int x, unsigned int y, FigureState state) {
+		value ^= figureKey(figure, x, y, state);
+	}
+
+	/**
+	  * Essen in einer Zelle hinzunehmen oder entfernen.
+	  * @param x X-Koordinate der Zelle.
+	  * @param y Y-Koordinate der Zelle.
+	  */
+	void toggleFood(unsigned int x, unsigned int y) {
+		value ^= foodKey(x, y);
+	}
+
+	/**
+	  * Neuen Wert einer Zaehlgroesse eintragen: Der Schluessel des
+	  * alten Wertes geht heraus, der des neuen hinein.
+	  * @param scalar Zaehlgroesse.
+	  * @param value  Neuer Wert.
+	  */
+	void setScalar(Scalar scalar, unsigned int value);
+
+	/**
+	  * Aktuellen Hash auslesen.
+	  * @return Hash.
+	  */
+	boost::uint64_t getValue() const {
+		return value;
+	}
+};
+
+#endif // ZOBRIST_HASH_H